@@ -0,0 +1,610 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Implements classes in columnstore.h.
+ *
+ * \ingroup module_analysisdata
+ */
+#include "gmxpre.h"
+
+#include "columnstore.h"
+
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "gromacs/fileio/gmxfio.h"
+#include "gromacs/utility/arrayref.h"
+#include "gromacs/utility/exceptions.h"
+#include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/stringutil.h"
+
+namespace gmx
+{
+
+namespace
+{
+
+//! Magic string at the start of every column-store file.
+const char c_magic[] = "GMXCOLST";
+//! Length of the magic string, without the terminating null.
+const size_t c_magicLength = sizeof(c_magic) - 1;
+//! Version of the file format.
+const uint32_t c_version = 1;
+//! Maximum number of rows in a block.
+const size_t c_maxRowsPerBlock = 4096;
+//! Number of buffered values that triggers writing a block.
+const size_t c_maxValuesPerBlock = 1 << 20;
+
+//! Unsigned integer type with the same size as \c real.
+#if GMX_DOUBLE
+typedef uint64_t RealBits;
+#else
+typedef uint32_t RealBits;
+#endif
+
+//! Appends \p value to \p buffer as \p size little-endian bytes.
+void appendInteger(std::vector<uint8_t>* buffer, uint64_t value, int size)
+{
+    for (int i = 0; i < size; ++i)
+    {
+        buffer->push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+//! Appends a length-prefixed string to \p buffer.
+void appendString(std::vector<uint8_t>* buffer, const std::string& value)
+{
+    appendInteger(buffer, value.size(), 4);
+    buffer->insert(buffer->end(), value.begin(), value.end());
+}
+
+/*! \brief
+ * Run-length encodes runs of zero bytes in \p data and appends the result.
+ *
+ * The output consists of runs, each starting with a control byte.
+ * A control byte below 128 is followed by that many plus one literal bytes.
+ * A control byte of 128 or above stands for (c - 127) zero bytes.
+ * Zero runs shorter than three bytes are kept in literal runs, as they
+ * would not save any space.
+ */
+void appendRunLengthEncoded(std::vector<uint8_t>* buffer, ArrayRef<const uint8_t> data)
+{
+    const size_t size = data.size();
+    size_t       i    = 0;
+    while (i < size)
+    {
+        size_t zeroCount = 0;
+        while (i + zeroCount < size && zeroCount < 128 && data[i + zeroCount] == 0)
+        {
+            ++zeroCount;
+        }
+        if (zeroCount >= 3 || (zeroCount > 0 && i + zeroCount == size))
+        {
+            buffer->push_back(static_cast<uint8_t>(0x80 | (zeroCount - 1)));
+            i += zeroCount;
+            continue;
+        }
+        // Collect literal bytes up to the next zero run worth encoding.
+        size_t literalEnd = i;
+        while (literalEnd < size && literalEnd - i < 128)
+        {
+            if (data[literalEnd] == 0 && literalEnd + 2 < size && data[literalEnd + 1] == 0
+                && data[literalEnd + 2] == 0)
+            {
+                break;
+            }
+            ++literalEnd;
+        }
+        buffer->push_back(static_cast<uint8_t>(literalEnd - i - 1));
+        buffer->insert(buffer->end(), data.begin() + i, data.begin() + literalEnd);
+        i = literalEnd;
+    }
+}
+
+/*! \brief
+ * Compresses a column of integer values and appends it to \p buffer.
+ *
+ * Each value is XORed with the previous one, so that slowly varying data
+ * produces mostly zero bits in the high bytes, and the bytes are then
+ * ordered by significance over the whole column, so that these zeros
+ * form long runs for appendRunLengthEncoded().  The compressed length
+ * is written before the data.
+ */
+template<typename Bits>
+void appendColumn(std::vector<uint8_t>* buffer, ArrayRef<const Bits> values)
+{
+    const size_t         count = values.size();
+    std::vector<uint8_t> planes(count * sizeof(Bits));
+    Bits                 previous = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Bits delta = values[i] ^ previous;
+        previous         = values[i];
+        for (size_t b = 0; b < sizeof(Bits); ++b)
+        {
+            planes[b * count + i] = static_cast<uint8_t>(delta >> (8 * b));
+        }
+    }
+    std::vector<uint8_t> encoded;
+    appendRunLengthEncoded(&encoded, planes);
+    appendInteger(buffer, encoded.size(), 4);
+    buffer->insert(buffer->end(), encoded.begin(), encoded.end());
+}
+
+//! Returns the bit pattern of \p value.
+template<typename Bits, typename Value>
+Bits toBits(Value value)
+{
+    static_assert(sizeof(Bits) == sizeof(Value), "Bit pattern type must match the value type");
+    Bits bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+//! Returns the value with bit pattern \p bits.
+template<typename Value, typename Bits>
+Value fromBits(Bits bits)
+{
+    static_assert(sizeof(Bits) == sizeof(Value), "Bit pattern type must match the value type");
+    Value value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/*! \brief
+ * Checks that \p format is a printf() format for a single floating-point value.
+ *
+ * Only formats like those produced by AbstractPlotModule are accepted, so
+ * that a corrupted file cannot pass arbitrary formats to printf().
+ */
+bool isValidNumberFormat(const std::string& format)
+{
+    size_t i = 0;
+    if (i < format.size() && format[i] == ' ')
+    {
+        ++i;
+    }
+    if (i >= format.size() || format[i] != '%')
+    {
+        return false;
+    }
+    ++i;
+    while (i < format.size()
+           && (std::isdigit(static_cast<unsigned char>(format[i])) || format[i] == '.'))
+    {
+        ++i;
+    }
+    return i + 1 == format.size() && std::strchr("eEfFgG", format[i]) != nullptr;
+}
+
+/*! \brief
+ * Reads a column-store file.
+ *
+ * Throws FileIOError on any error.
+ */
+class ColumnStoreReader
+{
+public:
+    explicit ColumnStoreReader(const std::string& filename) :
+        filename_(filename), fp_(gmx_fio_fopen(filename.c_str(), "rb"))
+    {
+    }
+    ~ColumnStoreReader() { gmx_fio_fclose(fp_); }
+
+    //! Throws an error about invalid contents.
+    [[noreturn]] void invalid() const
+    {
+        GMX_THROW(FileIOError(formatString("'%s' is not a valid column-store file", filename_.c_str())));
+    }
+    //! Reads \p size bytes, returning false on end of file at the start.
+    bool readBytes(void* data, size_t size, bool bAllowEof = false)
+    {
+        const size_t count = std::fread(data, 1, size, fp_);
+        if (count == 0 && size > 0 && bAllowEof && std::feof(fp_))
+        {
+            return false;
+        }
+        if (count != size)
+        {
+            invalid();
+        }
+        return true;
+    }
+    //! Reads a little-endian integer of \p size bytes.
+    uint64_t readInteger(int size)
+    {
+        uint8_t bytes[8];
+        readBytes(bytes, size);
+        return decodeInteger(bytes, size);
+    }
+    //! Reads a length-prefixed string.
+    std::string readString()
+    {
+        const size_t length = readInteger(4);
+        std::string  value(length, '\0');
+        readBytes(&value[0], length);
+        return value;
+    }
+    //! Reads a compressed column of \p count values.
+    template<typename Bits>
+    std::vector<Bits> readColumn(size_t count)
+    {
+        std::vector<uint8_t> encoded(readInteger(4));
+        readBytes(encoded.data(), encoded.size());
+        std::vector<uint8_t> planes;
+        planes.reserve(count * sizeof(Bits));
+        for (size_t i = 0; i < encoded.size();)
+        {
+            const uint8_t control = encoded[i++];
+            if (control & 0x80)
+            {
+                planes.insert(planes.end(), (control & 0x7f) + 1, 0);
+            }
+            else
+            {
+                const size_t length = control + 1;
+                if (i + length > encoded.size())
+                {
+                    invalid();
+                }
+                planes.insert(planes.end(), encoded.begin() + i, encoded.begin() + i + length);
+                i += length;
+            }
+        }
+        if (planes.size() != count * sizeof(Bits))
+        {
+            invalid();
+        }
+        std::vector<Bits> values(count);
+        Bits              previous = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            Bits delta = 0;
+            for (size_t b = 0; b < sizeof(Bits); ++b)
+            {
+                delta |= static_cast<Bits>(planes[b * count + i]) << (8 * b);
+            }
+            values[i] = previous ^ delta;
+            previous  = values[i];
+        }
+        return values;
+    }
+
+    //! Decodes a little-endian integer of \p size bytes.
+    static uint64_t decodeInteger(const uint8_t* bytes, int size)
+    {
+        uint64_t value = 0;
+        for (int i = 0; i < size; ++i)
+        {
+            value |= static_cast<uint64_t>(bytes[i]) << (8 * i);
+        }
+        return value;
+    }
+
+private:
+    std::string filename_;
+    FILE*       fp_;
+};
+
+} // namespace
+
+/********************************************************************
+ * AnalysisColumnStoreWriter::Impl
+ */
+
+/*! \internal \brief
+ * Private implementation class for AnalysisColumnStoreWriter.
+ *
+ * \ingroup module_analysisdata
+ */
+class AnalysisColumnStoreWriter::Impl
+{
+public:
+    Impl(const std::string& filename, bool bHaveX);
+    ~Impl();
+
+    //! Writes \p buffer to the file.
+    void write(const std::vector<uint8_t>& buffer);
+    //! Writes buffered rows as a block and clears the buffers.
+    void flushBlock();
+    //! Writes the end marker and closes the file.
+    void close();
+
+    std::string filename_;
+    FILE*       fp_;
+    bool        bHaveX_;
+    //! Number of values in each buffered row.
+    std::vector<uint32_t> rowLengths_;
+    //! Bit patterns of the x value of each buffered row.
+    std::vector<uint64_t> x_;
+    //! Bit patterns of buffered values; column j has values for rows longer than j.
+    std::vector<std::vector<RealBits>> columns_;
+    //! Number of values in the current row.
+    size_t currentRowLength_;
+    //! Total number of buffered values.
+    size_t valueCount_;
+    //! Whether startRow() has been called without finishRow().
+    bool bInRow_;
+};
+
+AnalysisColumnStoreWriter::Impl::Impl(const std::string& filename, bool bHaveX) :
+    filename_(filename),
+    fp_(gmx_fio_fopen(filename.c_str(), "wb")),
+    bHaveX_(bHaveX),
+    currentRowLength_(0),
+    valueCount_(0),
+    bInRow_(false)
+{
+}
+
+AnalysisColumnStoreWriter::Impl::~Impl()
+{
+    if (fp_ != nullptr)
+    {
+        gmx_fio_fclose(fp_);
+    }
+}
+
+void AnalysisColumnStoreWriter::Impl::write(const std::vector<uint8_t>& buffer)
+{
+    if (std::fwrite(buffer.data(), 1, buffer.size(), fp_) != buffer.size())
+    {
+        GMX_THROW(FileIOError(formatString("Failed to write to '%s'", filename_.c_str())));
+    }
+}
+
+void AnalysisColumnStoreWriter::Impl::flushBlock()
+{
+    if (rowLengths_.empty())
+    {
+        return;
+    }
+    std::vector<uint8_t> buffer;
+    appendInteger(&buffer, rowLengths_.size(), 4);
+    appendInteger(&buffer, columns_.size(), 4);
+    appendColumn<uint32_t>(&buffer, rowLengths_);
+    if (bHaveX_)
+    {
+        appendColumn<uint64_t>(&buffer, x_);
+    }
+    for (const auto& column : columns_)
+    {
+        appendColumn<RealBits>(&buffer, column);
+    }
+    write(buffer);
+    rowLengths_.clear();
+    x_.clear();
+    columns_.clear();
+    valueCount_ = 0;
+}
+
+void AnalysisColumnStoreWriter::Impl::close()
+{
+    if (fp_ != nullptr)
+    {
+        flushBlock();
+        std::vector<uint8_t> buffer;
+        appendInteger(&buffer, 0, 4);
+        write(buffer);
+        FILE* fp = fp_;
+        fp_      = nullptr;
+        if (gmx_fio_fclose(fp) != 0)
+        {
+            GMX_THROW(FileIOError(formatString("Failed to close '%s'", filename_.c_str())));
+        }
+    }
+}
+
+/********************************************************************
+ * AnalysisColumnStoreWriter
+ */
+
+AnalysisColumnStoreWriter::AnalysisColumnStoreWriter(const std::string& filename,
+                                                     const std::string& header,
+                                                     bool               bHaveX,
+                                                     const std::string& xformat,
+                                                     const std::string& yformat) :
+    impl_(new Impl(filename, bHaveX))
+{
+    std::vector<uint8_t> buffer(c_magic, c_magic + c_magicLength);
+    appendInteger(&buffer, c_version, 4);
+    buffer.push_back(sizeof(real));
+    buffer.push_back(bHaveX ? 1 : 0);
+    appendString(&buffer, header);
+    appendString(&buffer, xformat);
+    appendString(&buffer, yformat);
+    impl_->write(buffer);
+}
+
+AnalysisColumnStoreWriter::~AnalysisColumnStoreWriter()
+{
+    try
+    {
+        impl_->close();
+    }
+    catch (const GromacsException&)
+    {
+    }
+}
+
+void AnalysisColumnStoreWriter::startRow(double x)
+{
+    GMX_ASSERT(!impl_->bInRow_, "Previous row not finished");
+    impl_->bInRow_           = true;
+    impl_->currentRowLength_ = 0;
+    if (impl_->bHaveX_)
+    {
+        impl_->x_.push_back(toBits<uint64_t>(x));
+    }
+}
+
+void AnalysisColumnStoreWriter::addValue(real y)
+{
+    GMX_ASSERT(impl_->bInRow_, "Row not started");
+    const size_t column = impl_->currentRowLength_;
+    if (column == impl_->columns_.size())
+    {
+        impl_->columns_.emplace_back();
+    }
+    impl_->columns_[column].push_back(toBits<RealBits>(y));
+    ++impl_->currentRowLength_;
+    ++impl_->valueCount_;
+}
+
+void AnalysisColumnStoreWriter::finishRow()
+{
+    GMX_ASSERT(impl_->bInRow_, "Row not started");
+    impl_->rowLengths_.push_back(impl_->currentRowLength_);
+    impl_->bInRow_ = false;
+    if (impl_->rowLengths_.size() >= c_maxRowsPerBlock || impl_->valueCount_ >= c_maxValuesPerBlock)
+    {
+        impl_->flushBlock();
+    }
+}
+
+void AnalysisColumnStoreWriter::close()
+{
+    GMX_ASSERT(!impl_->bInRow_, "Closing with an unfinished row");
+    impl_->close();
+}
+
+/********************************************************************
+ * convertColumnStoreToXvg()
+ */
+
+void convertColumnStoreToXvg(const std::string& inputFile, const std::string& outputFile)
+{
+    ColumnStoreReader reader(inputFile);
+    char              magic[c_magicLength];
+    reader.readBytes(magic, c_magicLength);
+    if (std::memcmp(magic, c_magic, c_magicLength) != 0)
+    {
+        reader.invalid();
+    }
+    const uint32_t version = reader.readInteger(4);
+    if (version != c_version)
+    {
+        GMX_THROW(FileIOError(formatString("Column-store file '%s' has unsupported version %u",
+                                           inputFile.c_str(), version)));
+    }
+    const int         valueSize = reader.readInteger(1);
+    const bool        bHaveX    = reader.readInteger(1) != 0;
+    const std::string header    = reader.readString();
+    const std::string xformat   = reader.readString();
+    const std::string yformat   = reader.readString();
+    if ((valueSize != 4 && valueSize != 8) || !isValidNumberFormat(xformat)
+        || !isValidNumberFormat(yformat))
+    {
+        reader.invalid();
+    }
+
+    FILE* out = gmx_fio_fopen(outputFile.c_str(), "w");
+    try
+    {
+        std::fputs(header.c_str(), out);
+        uint8_t rowCountBytes[4];
+        while (reader.readBytes(rowCountBytes, 4, true))
+        {
+            const size_t rowCount = ColumnStoreReader::decodeInteger(rowCountBytes, 4);
+            if (rowCount == 0)
+            {
+                break;
+            }
+            const size_t                columnCount = reader.readInteger(4);
+            const std::vector<uint32_t> rowLengths  = reader.readColumn<uint32_t>(rowCount);
+            std::vector<uint64_t>       x;
+            if (bHaveX)
+            {
+                x = reader.readColumn<uint64_t>(rowCount);
+            }
+            // Read the columns and convert the values to double for printing.
+            std::vector<std::vector<double>> columns(columnCount);
+            for (size_t j = 0; j < columnCount; ++j)
+            {
+                const size_t count = std::count_if(rowLengths.begin(), rowLengths.end(),
+                                                   [j](uint32_t length) { return length > j; });
+                if (valueSize == 4)
+                {
+                    for (uint32_t bits : reader.readColumn<uint32_t>(count))
+                    {
+                        columns[j].push_back(fromBits<float>(bits));
+                    }
+                }
+                else
+                {
+                    for (uint64_t bits : reader.readColumn<uint64_t>(count))
+                    {
+                        columns[j].push_back(fromBits<double>(bits));
+                    }
+                }
+            }
+            std::vector<size_t> next(columnCount, 0);
+            for (size_t i = 0; i < rowCount; ++i)
+            {
+                if (rowLengths[i] > columnCount)
+                {
+                    reader.invalid();
+                }
+                if (bHaveX)
+                {
+                    std::fprintf(out, xformat.c_str(), fromBits<double>(x[i]));
+                }
+                for (size_t j = 0; j < rowLengths[i]; ++j)
+                {
+                    std::fprintf(out, yformat.c_str(), columns[j][next[j]++]);
+                }
+                std::fprintf(out, "\n");
+            }
+        }
+    }
+    catch (...)
+    {
+        gmx_fio_fclose(out);
+        throw;
+    }
+    if (gmx_fio_fclose(out) != 0)
+    {
+        GMX_THROW(FileIOError(formatString("Failed to write '%s'", outputFile.c_str())));
+    }
+}
+
+} // namespace gmx
@@ -0,0 +1,135 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \libinternal \file
+ * \brief
+ * Declares gmx::AnalysisColumnStoreWriter for binary output of plot data.
+ *
+ * \inlibraryapi
+ * \ingroup module_analysisdata
+ */
+#ifndef GMX_ANALYSISDATA_MODULES_COLUMNSTORE_H
+#define GMX_ANALYSISDATA_MODULES_COLUMNSTORE_H
+
+#include <string>
+
+#include "gromacs/utility/classhelpers.h"
+#include "gromacs/utility/real.h"
+
+namespace gmx
+{
+
+/*! \libinternal \brief
+ * Writes rows of plot data to a binary column-store file.
+ *
+ * Each row consists of an optional x value and any number of y values,
+ * i.e., it corresponds to one line of an xvg file.  Rows are buffered
+ * and written in blocks.  Within a block, the row lengths, the x values
+ * and each column of y values are stored as separate columns, each
+ * compressed with a light-weight scheme: consecutive values are XORed,
+ * the bytes of the results are grouped by significance, and runs of
+ * zero bytes are run-length encoded.  This works well for the slowly
+ * varying data that analysis tools typically produce.
+ *
+ * The file also stores the header text and the number formats of the
+ * plot, so that convertColumnStoreToXvg() can produce exactly the text
+ * that AbstractPlotModule would have written.
+ *
+ * All integers in the file are little-endian; the y values are stored
+ * with the precision of \c real.
+ *
+ * \inlibraryapi
+ * \ingroup module_analysisdata
+ */
+class AnalysisColumnStoreWriter
+{
+public:
+    /*! \brief
+     * Creates the file and writes its header.
+     *
+     * \param[in] filename  Name of the file to create.
+     * \param[in] header    Text to write before the data when converting
+     *     to xvg.
+     * \param[in] bHaveX    Whether rows have an x value.
+     * \param[in] xformat   printf() format for x values when converting.
+     * \param[in] yformat   printf() format for y values when converting.
+     * \throws    FileIOError if the file cannot be written.
+     */
+    AnalysisColumnStoreWriter(const std::string& filename,
+                              const std::string& header,
+                              bool               bHaveX,
+                              const std::string& xformat,
+                              const std::string& yformat);
+    /*! \brief
+     * Writes any buffered rows and closes the file.
+     *
+     * Errors are ignored; call close() to check them.
+     */
+    ~AnalysisColumnStoreWriter();
+
+    //! Starts a new row with x value \p x (ignored if there is no x).
+    void startRow(double x);
+    //! Appends \p y to the current row.
+    void addValue(real y);
+    //! Finishes the current row.
+    void finishRow();
+    /*! \brief
+     * Writes any buffered rows and closes the file.
+     *
+     * \throws FileIOError if writing fails.
+     */
+    void close();
+
+private:
+    class Impl;
+
+    PrivateImplPointer<Impl> impl_;
+};
+
+/*! \brief
+ * Converts a column-store file to xvg text.
+ *
+ * \param[in] inputFile   Column-store file written by
+ *     AnalysisColumnStoreWriter.
+ * \param[in] outputFile  xvg file to write.
+ * \throws    FileIOError if the input is not a valid column-store file or
+ *     if writing fails.
+ *
+ * \ingroup module_analysisdata
+ */
+void convertColumnStoreToXvg(const std::string& inputFile, const std::string& outputFile);
+
+} // namespace gmx
+
+#endif
@@ -47,10 +47,13 @@
 #include <cstdio>
 #include <cstring>
 
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "gromacs/analysisdata/dataframe.h"
+#include "gromacs/analysisdata/modules/columnstore.h"
+#include "gromacs/fileio/filetypes.h"
 #include "gromacs/fileio/gmxfio.h"
 #include "gromacs/fileio/oenv.h"
 #include "gromacs/fileio/xvgr.h"
@@ -61,6 +64,7 @@
 #include "gromacs/selection/selectioncollection.h"
 #include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/path.h"
 #include "gromacs/utility/programcontext.h"
 #include "gromacs/utility/stringutil.h"
 #include "gromacs/utility/unique_cptr.h"
@@ -68,6 +72,17 @@
 namespace gmx
 {
 
+namespace
+{
+
+//! Closes a file opened with std::tmpfile().
+void closeTemporaryFile(FILE* fp)
+{
+    std::fclose(fp);
+}
+
+} // namespace
+
 /********************************************************************
  * AnalysisDataPlotSettings
  */
@@ -75,7 +90,8 @@ namespace gmx
 AnalysisDataPlotSettings::AnalysisDataPlotSettings() :
     selections_(nullptr),
     timeUnit_(TimeUnit::Default),
-    plotFormat_(XvgFormat::Xmgrace)
+    plotFormat_(XvgFormat::Xmgrace),
+    bColumnStore_(false)
 {
 }
 
@@ -96,6 +112,8 @@ void AnalysisDataPlotSettings::initOptions(IOptionsContainer* options)
 {
     options->addOption(
             EnumOption<XvgFormat>("xvg").enumValue(c_xvgFormatNames).store(&plotFormat_).description("Plot formatting"));
+    options->addOption(BooleanOption("colstore").store(&bColumnStore_).description(
+            "Write plots in binary column-store format (.gcs)"));
 }
 
 
@@ -109,11 +127,16 @@ public:
     explicit Impl(const AnalysisDataPlotSettings& settings);
     ~Impl();
 
+    //! Writes the headers of the plot to \p fp.
+    void writeHeader(FILE* fp) const;
+    //! Returns the headers that writeHeader() writes as a string.
+    std::string formatHeader() const;
     void closeFile();
 
-    AnalysisDataPlotSettings settings_;
-    std::string              filename_;
-    FILE*                    fp_;
+    AnalysisDataPlotSettings                   settings_;
+    std::string                                filename_;
+    FILE*                                      fp_;
+    std::unique_ptr<AnalysisColumnStoreWriter> columnStore_;
 
     bool                     bPlain_;
     bool                     bOmitX_;
@@ -146,8 +169,73 @@ AbstractPlotModule::Impl::~Impl()
 }
 
 
+void AbstractPlotModule::Impl::writeHeader(FILE* fp) const
+{
+    if (bPlain_)
+    {
+        return;
+    }
+    const TimeUnit    timeUnit  = settings_.timeUnit();
+    const XvgFormat   xvgFormat = settings_.plotFormat();
+    gmx_output_env_t* oenv;
+    output_env_init(&oenv, getProgramContext(), timeUnit, FALSE, xvgFormat, 0);
+    const unique_cptr<gmx_output_env_t, output_env_done> oenvGuard(oenv);
+    xvgr_header(fp, title_.c_str(), xlabel_, ylabel_, exvggtXNY, oenv);
+    const SelectionCollection* selections = settings_.selectionCollection();
+    if (selections != nullptr && output_env_get_xvg_format(oenv) != XvgFormat::None)
+    {
+        selections->printXvgrInfo(fp);
+    }
+    if (!subtitle_.empty())
+    {
+        xvgr_subtitle(fp, subtitle_.c_str(), oenv);
+    }
+    if (output_env_get_print_xvgr_codes(oenv) && !legend_.empty())
+    {
+        std::vector<const char*> legend;
+        legend.reserve(legend_.size());
+        for (size_t i = 0; i < legend_.size(); ++i)
+        {
+            legend.push_back(legend_[i].c_str());
+        }
+        xvgr_legend(fp, legend.size(), legend.data(), oenv);
+    }
+}
+
+
+std::string AbstractPlotModule::Impl::formatHeader() const
+{
+    if (bPlain_)
+    {
+        return std::string();
+    }
+    // The xvgr routines only write to a FILE, so go through a temporary file.
+    const unique_cptr<FILE, closeTemporaryFile> fp(std::tmpfile());
+    if (fp == nullptr)
+    {
+        GMX_THROW(FileIOError("Could not create a temporary file for plot headers"));
+    }
+    writeHeader(fp.get());
+    std::string header;
+    std::rewind(fp.get());
+    char   buffer[1024];
+    size_t count;
+    while ((count = std::fread(buffer, 1, sizeof(buffer), fp.get())) > 0)
+    {
+        header.append(buffer, count);
+    }
+    return header;
+}
+
+
 void AbstractPlotModule::Impl::closeFile()
 {
+    if (columnStore_ != nullptr)
+    {
+        // Reset before closing, so that the file is closed also on errors.
+        std::unique_ptr<AnalysisColumnStoreWriter> columnStore = std::move(columnStore_);
+        columnStore->close();
+    }
     if (fp_ != nullptr)
     {
         if (bPlain_)
@@ -301,38 +389,17 @@ void AbstractPlotModule::dataStarted(AbstractAnalysisData* /* data */)
 {
     if (!impl_->filename_.empty())
     {
-        if (impl_->bPlain_)
+        if (impl_->settings_.useColumnStore())
         {
-            impl_->fp_ = gmx_fio_fopen(impl_->filename_.c_str(), "w");
+            const std::string filename =
+                    Path::stripExtension(impl_->filename_) + ftp2ext_with_dot(efGCS);
+            impl_->columnStore_ = std::make_unique<AnalysisColumnStoreWriter>(
+                    filename, impl_->formatHeader(), !impl_->bOmitX_, impl_->xformat_, impl_->yformat_);
         }
         else
         {
-            const TimeUnit    timeUnit  = impl_->settings_.timeUnit();
-            const XvgFormat   xvgFormat = impl_->settings_.plotFormat();
-            gmx_output_env_t* oenv;
-            output_env_init(&oenv, getProgramContext(), timeUnit, FALSE, xvgFormat, 0);
-            const unique_cptr<gmx_output_env_t, output_env_done> oenvGuard(oenv);
-            impl_->fp_ = xvgropen(impl_->filename_.c_str(), impl_->title_.c_str(), impl_->xlabel_,
-                                  impl_->ylabel_, oenv);
-            const SelectionCollection* selections = impl_->settings_.selectionCollection();
-            if (selections != nullptr && output_env_get_xvg_format(oenv) != XvgFormat::None)
-            {
-                selections->printXvgrInfo(impl_->fp_);
-            }
-            if (!impl_->subtitle_.empty())
-            {
-                xvgr_subtitle(impl_->fp_, impl_->subtitle_.c_str(), oenv);
-            }
-            if (output_env_get_print_xvgr_codes(oenv) && !impl_->legend_.empty())
-            {
-                std::vector<const char*> legend;
-                legend.reserve(impl_->legend_.size());
-                for (size_t i = 0; i < impl_->legend_.size(); ++i)
-                {
-                    legend.push_back(impl_->legend_[i].c_str());
-                }
-                xvgr_legend(impl_->fp_, legend.size(), legend.data(), oenv);
-            }
+            impl_->fp_ = gmx_fio_fopen(impl_->filename_.c_str(), "w");
+            impl_->writeHeader(impl_->fp_);
         }
     }
 }
@@ -344,7 +411,11 @@ void AbstractPlotModule::frameStarted(const AnalysisDataFrameHeader& header)
     {
         return;
     }
-    if (!impl_->bOmitX_)
+    if (impl_->columnStore_ != nullptr)
+    {
+        impl_->columnStore_->startRow(header.x() * impl_->xscale_);
+    }
+    else if (!impl_->bOmitX_)
     {
         std::fprintf(impl_->fp_, impl_->xformat_.c_str(), header.x() * impl_->xscale_);
     }
@@ -357,6 +428,11 @@ void AbstractPlotModule::frameFinished(const AnalysisDataFrameHeader& /*header*/
     {
         return;
     }
+    if (impl_->columnStore_ != nullptr)
+    {
+        impl_->columnStore_->finishRow();
+        return;
+    }
     std::fprintf(impl_->fp_, "\n");
 }
 
@@ -369,7 +445,7 @@ void AbstractPlotModule::dataFinished()
 /*! \cond libapi */
 bool AbstractPlotModule::isFileOpen() const
 {
-    return impl_->fp_ != nullptr;
+    return impl_->fp_ != nullptr || impl_->columnStore_ != nullptr;
 }
 
 
@@ -377,11 +453,25 @@ void AbstractPlotModule::writeValue(const AnalysisDataValue& value) const
 {
     GMX_ASSERT(isFileOpen(), "File not opened, but write attempted");
     const real y = value.isSet() ? value.value() : 0.0;
-    std::fprintf(impl_->fp_, impl_->yformat_.c_str(), y);
+    if (impl_->columnStore_ != nullptr)
+    {
+        impl_->columnStore_->addValue(y);
+    }
+    else
+    {
+        std::fprintf(impl_->fp_, impl_->yformat_.c_str(), y);
+    }
     if (impl_->bErrorsAsSeparateColumn_)
     {
         const real dy = value.isSet() ? value.error() : 0.0;
-        std::fprintf(impl_->fp_, impl_->yformat_.c_str(), dy);
+        if (impl_->columnStore_ != nullptr)
+        {
+            impl_->columnStore_->addValue(dy);
+        }
+        else
+        {
+            std::fprintf(impl_->fp_, impl_->yformat_.c_str(), dy);
+        }
     }
 }
 //! \endcond
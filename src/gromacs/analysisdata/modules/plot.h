@@ -80,6 +80,12 @@ public:
      * Returns the plot format.
      */
     XvgFormat plotFormat() const { return plotFormat_; }
+    /*! \brief
+     * Returns whether plots are written in column-store format.
+     *
+     * \see setUseColumnStore()
+     */
+    bool useColumnStore() const { return bColumnStore_; }
 
     /*! \brief
      * Set selection collection to print as comments into the output.
@@ -99,6 +105,17 @@ public:
      * If not called, the default time unit is ps.
      */
     void setTimeUnit(TimeUnit timeUnit) { timeUnit_ = timeUnit; }
+    /*! \brief
+     * Sets whether plots are written in binary column-store format.
+     *
+     * If \p bColumnStore is true, AbstractPlotModule writes the data with
+     * AnalysisColumnStoreWriter into a file with the extension replaced by
+     * `.gcs` instead of writing text.  Such files are much faster to write
+     * for large outputs, and can be converted to the text that would
+     * otherwise have been written with `gmx colstore2xvg`.
+     * If not called, text output is written.
+     */
+    void setUseColumnStore(bool bColumnStore) { bColumnStore_ = bColumnStore; }
 
 
     /*! \brief
@@ -112,6 +129,7 @@ private:
     const SelectionCollection* selections_;
     TimeUnit                   timeUnit_;
     XvgFormat                  plotFormat_;
+    bool                       bColumnStore_;
 };
 
 /*! \brief
@@ -0,0 +1,185 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for gmx::AnalysisColumnStoreWriter and convertColumnStoreToXvg().
+ *
+ * These tests check that plot output written in column-store format and
+ * converted back to xvg matches output written directly as text.
+ *
+ * \ingroup module_analysisdata
+ */
+#include "gmxpre.h"
+
+#include "gromacs/analysisdata/modules/columnstore.h"
+
+#include <cstdio>
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/analysisdata/arraydata.h"
+#include "gromacs/analysisdata/modules/plot.h"
+#include "gromacs/fileio/filetypes.h"
+#include "gromacs/utility/exceptions.h"
+#include "gromacs/utility/stringutil.h"
+#include "gromacs/utility/textreader.h"
+
+#include "testutils/testasserts.h"
+#include "testutils/testfilemanager.h"
+
+namespace
+{
+
+//! Removes comment lines, which contain the creation time, from xvg text.
+std::string stripComments(const std::string& text)
+{
+    std::string result;
+    for (const std::string& line : gmx::splitDelimitedString(text, '\n'))
+    {
+        if (line.empty() || line[0] != '#')
+        {
+            result.append(line);
+            result.append("\n");
+        }
+    }
+    return result;
+}
+
+/*! \brief
+ * Test fixture for column-store output of plot modules.
+ *
+ * Writes the same data once directly as text and once through the column
+ * store, so that the tests can compare the converted output to the text.
+ */
+class ColumnStoreTest : public ::testing::Test
+{
+public:
+    ColumnStoreTest() : data_(), bPlain_(true), bErrors_(false) {}
+
+    //! Sets up \p rowCount rows of \p columnCount slowly varying values.
+    void setupData(int rowCount, int columnCount)
+    {
+        data_.setColumnCount(columnCount);
+        data_.setRowCount(rowCount);
+        data_.allocateValues();
+        data_.setXAxis(0.0, 0.5);
+        for (int i = 0; i < rowCount; ++i)
+        {
+            for (int j = 0; j < columnCount; ++j)
+            {
+                const real value = 0.25 * j + 0.001 * i;
+                data_.value(i, j).setValue(value, 0.1 * value, (i + j) % 7 != 0);
+            }
+        }
+    }
+
+    //! Writes the data to \p filename, optionally in column-store format.
+    void writePlot(const std::string& filename, bool bColumnStore)
+    {
+        gmx::AnalysisDataPlotSettings settings;
+        settings.setUseColumnStore(bColumnStore);
+        auto plot = std::make_shared<gmx::AnalysisDataPlotModule>(settings);
+        plot->setFileName(filename);
+        plot->setPlainOutput(bPlain_);
+        plot->setErrorsAsSeparateColumn(bErrors_);
+        plot->setTitle("Test data");
+        plot->setXLabel("Time (ps)");
+        plot->setYLabel("Value");
+        plot->appendLegend("first");
+        plot->setYFormat(10, 5);
+        data_.addModule(plot);
+    }
+
+    //! Writes the plots and returns the direct and the converted output.
+    std::pair<std::string, std::string> writeAndConvert()
+    {
+        const std::string textFile    = fileManager_.getTemporaryFilePath("direct.xvg");
+        const std::string storeBase   = fileManager_.getTemporaryFilePath("store");
+        const std::string storeFile   = storeBase + ftp2ext_with_dot(efGCS);
+        const std::string convertFile = fileManager_.getTemporaryFilePath("converted.xvg");
+        writePlot(textFile, false);
+        writePlot(storeBase + ".xvg", true);
+        data_.valuesReady();
+        gmx::convertColumnStoreToXvg(storeFile, convertFile);
+        return std::make_pair(gmx::TextReader::readFileToString(textFile),
+                              gmx::TextReader::readFileToString(convertFile));
+    }
+
+    gmx::test::TestFileManager fileManager_;
+    gmx::AnalysisArrayData     data_;
+    bool                       bPlain_;
+    bool                       bErrors_;
+};
+
+TEST_F(ColumnStoreTest, ConvertsToSamePlainOutput)
+{
+    setupData(10, 3);
+    const auto output = writeAndConvert();
+    EXPECT_FALSE(output.first.empty());
+    EXPECT_EQ(output.first, output.second);
+}
+
+TEST_F(ColumnStoreTest, ConvertsToSameXvgOutput)
+{
+    bPlain_  = false;
+    bErrors_ = true;
+    setupData(10, 2);
+    const auto output = writeAndConvert();
+    EXPECT_EQ(stripComments(output.first), stripComments(output.second));
+}
+
+TEST_F(ColumnStoreTest, HandlesMultipleBlocks)
+{
+    setupData(10000, 5);
+    const auto output = writeAndConvert();
+    EXPECT_EQ(output.first, output.second);
+}
+
+TEST_F(ColumnStoreTest, RejectsInvalidInput)
+{
+    const std::string inputFile  = fileManager_.getTemporaryFilePath("invalid.gcs");
+    const std::string outputFile = fileManager_.getTemporaryFilePath("invalid.xvg");
+    FILE*             fp         = std::fopen(inputFile.c_str(), "w");
+    ASSERT_NE(fp, nullptr);
+    std::fputs("# Not a column store\n", fp);
+    std::fclose(fp);
+    EXPECT_THROW_GMX(gmx::convertColumnStoreToXvg(inputFile, outputFile), gmx::FileIOError);
+}
+
+} // namespace
@@ -0,0 +1,169 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ *
+ * \brief Implements functions for ordering the home atoms for locality.
+ *
+ * \ingroup module_domdec
+ */
+
+#include "gmxpre.h"
+
+#include "atomordering.h"
+
+#include <algorithm>
+
+#include "gromacs/math/vec.h"
+#include "gromacs/mdlib/updategroupscog.h"
+#include "gromacs/utility/arrayref.h"
+#include "gromacs/utility/real.h"
+
+/* Uses the algorithm of J. Skilling, AIP Conf. Proc. 707, 381 (2004),
+ * which converts the coordinates to the transposed Hilbert index.
+ */
+int hilbertCurveIndex(const ivec gridPoint)
+{
+    unsigned int x[DIM] = { static_cast<unsigned int>(gridPoint[XX]),
+                            static_cast<unsigned int>(gridPoint[YY]),
+                            static_cast<unsigned int>(gridPoint[ZZ]) };
+
+    /* Inverse undo */
+    for (unsigned int q = 1U << (c_hilbertCurveBitsPerDim - 1); q > 1; q >>= 1)
+    {
+        const unsigned int p = q - 1;
+        for (int d = 0; d < DIM; d++)
+        {
+            if (x[d] & q)
+            {
+                x[XX] ^= p;
+            }
+            else
+            {
+                const unsigned int t = (x[XX] ^ x[d]) & p;
+                x[XX] ^= t;
+                x[d] ^= t;
+            }
+        }
+    }
+
+    /* Gray encode */
+    for (int d = 1; d < DIM; d++)
+    {
+        x[d] ^= x[d - 1];
+    }
+    unsigned int t = 0;
+    for (unsigned int q = 1U << (c_hilbertCurveBitsPerDim - 1); q > 1; q >>= 1)
+    {
+        if (x[DIM - 1] & q)
+        {
+            t ^= q - 1;
+        }
+    }
+    for (int d = 0; d < DIM; d++)
+    {
+        x[d] ^= t;
+    }
+
+    /* Interleave the bits of the transposed index, most significant first */
+    int index = 0;
+    for (int b = c_hilbertCurveBitsPerDim - 1; b >= 0; b--)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            index = (index << 1) | ((x[d] >> b) & 1);
+        }
+    }
+
+    return index;
+}
+
+void dd_sort_order_locality(DDAtomOrdering                 atomOrdering,
+                            gmx::ArrayRef<const int>       globalAtomIndices,
+                            gmx::ArrayRef<const gmx::RVec> x,
+                            const gmx::UpdateGroupsCog*    updateGroupsCog,
+                            std::vector<gmx_cgsort_t>*     sort)
+{
+    for (gmx_cgsort_t& entry : *sort)
+    {
+        entry.ind_gl = globalAtomIndices[entry.ind];
+        entry.nsc    = 0;
+    }
+
+    if (atomOrdering == DDAtomOrdering::HilbertCurve && !sort->empty())
+    {
+        /* With update groups we use the center of geometry, so the atoms
+         * of a group get the same curve index and stay together.
+         */
+        auto position = [updateGroupsCog, x](int a) -> const gmx::RVec& {
+            return updateGroupsCog ? updateGroupsCog->cogForAtom(a) : x[a];
+        };
+
+        rvec lower, upper;
+        copy_rvec(position((*sort)[0].ind), lower);
+        copy_rvec(lower, upper);
+        for (const gmx_cgsort_t& entry : *sort)
+        {
+            const gmx::RVec& pos = position(entry.ind);
+            for (int d = 0; d < DIM; d++)
+            {
+                lower[d] = std::min(lower[d], pos[d]);
+                upper[d] = std::max(upper[d], pos[d]);
+            }
+        }
+        /* Use the same resolution along all dimensions */
+        real maxExtent = 0;
+        for (int d = 0; d < DIM; d++)
+        {
+            maxExtent = std::max(maxExtent, upper[d] - lower[d]);
+        }
+        const int  maxGridIndex = (1 << c_hilbertCurveBitsPerDim) - 1;
+        const real invSpacing   = (maxExtent > 0 ? maxGridIndex / maxExtent : 0);
+
+        for (gmx_cgsort_t& entry : *sort)
+        {
+            const gmx::RVec& pos = position(entry.ind);
+            ivec             gridPoint;
+            for (int d = 0; d < DIM; d++)
+            {
+                gridPoint[d] = std::min(static_cast<int>((pos[d] - lower[d]) * invSpacing), maxGridIndex);
+            }
+            entry.nsc = hilbertCurveIndex(gridPoint);
+        }
+    }
+
+    std::sort(sort->begin(), sort->end(), [](const gmx_cgsort_t& a, const gmx_cgsort_t& b) {
+        return a.nsc < b.nsc || (a.nsc == b.nsc && a.ind_gl < b.ind_gl);
+    });
+}
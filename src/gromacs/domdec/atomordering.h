@@ -0,0 +1,91 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ *
+ * \brief Declares functions for ordering the home atoms for locality.
+ *
+ * With GMX_DD_ATOM_ORDER the home atoms can be ordered along a Hilbert
+ * curve or by molecule, instead of in the order of the non-bonded
+ * search grid, to improve the locality of bonded and update work.
+ *
+ * \ingroup module_domdec
+ */
+#ifndef GMX_DOMDEC_ATOMORDERING_H
+#define GMX_DOMDEC_ATOMORDERING_H
+
+#include <vector>
+
+#include "gromacs/math/vectypes.h"
+
+#include "domdec_internal.h"
+
+namespace gmx
+{
+template<typename>
+class ArrayRef;
+class UpdateGroupsCog;
+} // namespace gmx
+
+//! The number of bits per dimension for the Hilbert curve index
+static constexpr int c_hilbertCurveBitsPerDim = 10;
+
+/*! \brief Returns the index along a Hilbert curve of a point on a grid of 2^c_hilbertCurveBitsPerDim points per dimension
+ *
+ * Consecutive indices correspond to grid points that are neighbors along one dimension.
+ */
+int hilbertCurveIndex(const ivec gridPoint);
+
+/*! \brief Reorders the grid ordered atoms in \p sort for better locality of bonded and update work
+ *
+ * With DDAtomOrdering::HilbertCurve atoms are ordered along a Hilbert curve
+ * through the bounding box of the atoms in \p sort, atoms with the same
+ * curve index are ordered on global index. With \p updateGroupsCog != nullptr
+ * the center of geometry of the update group is used, so the atoms of
+ * a group stay together. With DDAtomOrdering::Molecule atoms are ordered
+ * on global index.
+ *
+ * \param[in]     atomOrdering       The ordering, should not be DDAtomOrdering::Grid
+ * \param[in]     globalAtomIndices  The global atom indices of the local atoms
+ * \param[in]     x                  The local atom coordinates
+ * \param[in]     updateGroupsCog    The update group centers, nullptr without update groups
+ * \param[in,out] sort               The atoms to sort, only \p ind needs to be set on input
+ */
+void dd_sort_order_locality(DDAtomOrdering                 atomOrdering,
+                            gmx::ArrayRef<const int>       globalAtomIndices,
+                            gmx::ArrayRef<const gmx::RVec> x,
+                            const gmx::UpdateGroupsCog*    updateGroupsCog,
+                            std::vector<gmx_cgsort_t>*     sort);
+
+#endif
@@ -257,6 +257,69 @@ void dd_get_constraint_range(const gmx_domdec_t* dd, int* at_start, int* at_end)
     *at_end   = dd->comm->atomRanges.end(DDAtomRanges::Type::Constraints);
 }
 
+//! Packs the coordinates to send in pulse \p ind into \p sendBuffer, applying the PBC shift
+static void packHaloCoordinates(const gmx_domdec_ind_t&        ind,
+                                gmx::ArrayRef<const gmx::RVec> x,
+                                bool                           bPBC,
+                                bool                           bScrew,
+                                const rvec                     shift,
+                                const matrix                   box,
+                                gmx::ArrayRef<gmx::RVec>       sendBuffer)
+{
+    int n = 0;
+    if (!bPBC)
+    {
+        for (int j : ind.index)
+        {
+            sendBuffer[n] = x[j];
+            n++;
+        }
+    }
+    else if (!bScrew)
+    {
+        for (int j : ind.index)
+        {
+            /* We need to shift the coordinates */
+            for (int d = 0; d < DIM; d++)
+            {
+                sendBuffer[n][d] = x[j][d] + shift[d];
+            }
+            n++;
+        }
+    }
+    else
+    {
+        for (int j : ind.index)
+        {
+            /* Shift x */
+            sendBuffer[n][XX] = x[j][XX] + shift[XX];
+            /* Rotate y and z.
+             * This operation requires a special shift force
+             * treatment, which is performed in calc_vir.
+             */
+            sendBuffer[n][YY] = box[YY][YY] - x[j][YY];
+            sendBuffer[n][ZZ] = box[ZZ][ZZ] - x[j][ZZ];
+            n++;
+        }
+    }
+}
+
+//! Copies coordinates received in pulse \p ind, not in place, to their zone locations in \p x
+static void unpackHaloCoordinates(const gmx_domdec_ind_t&        ind,
+                                  int                            nzone,
+                                  gmx::ArrayRef<const gmx::RVec> receiveBuffer,
+                                  gmx::ArrayRef<gmx::RVec>       x)
+{
+    int j = 0;
+    for (int zone = 0; zone < nzone; zone++)
+    {
+        for (int i = ind.cell2at0[zone]; i < ind.cell2at1[zone]; i++)
+        {
+            x[i] = receiveBuffer[j++];
+        }
+    }
+}
+
 void dd_move_x(gmx_domdec_t* dd, const matrix box, gmx::ArrayRef<gmx::RVec> x, gmx_wallcycle* wcycle)
 {
     wallcycle_start(wcycle, ewcMOVEX);
@@ -284,42 +347,7 @@ void dd_move_x(gmx_domdec_t* dd, const matrix box, gmx::ArrayRef<gmx::RVec> x, g
         {
             DDBufferAccess<gmx::RVec> sendBufferAccess(comm->rvecBuffer, ind.nsend[nzone + 1]);
             gmx::ArrayRef<gmx::RVec>& sendBuffer = sendBufferAccess.buffer;
-            int                       n          = 0;
-            if (!bPBC)
-            {
-                for (int j : ind.index)
-                {
-                    sendBuffer[n] = x[j];
-                    n++;
-                }
-            }
-            else if (!bScrew)
-            {
-                for (int j : ind.index)
-                {
-                    /* We need to shift the coordinates */
-                    for (int d = 0; d < DIM; d++)
-                    {
-                        sendBuffer[n][d] = x[j][d] + shift[d];
-                    }
-                    n++;
-                }
-            }
-            else
-            {
-                for (int j : ind.index)
-                {
-                    /* Shift x */
-                    sendBuffer[n][XX] = x[j][XX] + shift[XX];
-                    /* Rotate y and z.
-                     * This operation requires a special shift force
-                     * treatment, which is performed in calc_vir.
-                     */
-                    sendBuffer[n][YY] = box[YY][YY] - x[j][YY];
-                    sendBuffer[n][ZZ] = box[ZZ][ZZ] - x[j][ZZ];
-                    n++;
-                }
-            }
+            packHaloCoordinates(ind, x, bPBC, bScrew, shift, box, sendBuffer);
 
             DDBufferAccess<gmx::RVec> receiveBufferAccess(
                     comm->rvecBuffer2, cd->receiveInPlace ? 0 : ind.nrecv[nzone + 1]);
@@ -338,27 +366,401 @@ void dd_move_x(gmx_domdec_t* dd, const matrix box, gmx::ArrayRef<gmx::RVec> x, g
 
             if (!cd->receiveInPlace)
             {
-                int j = 0;
-                for (int zone = 0; zone < nzone; zone++)
+                unpackHaloCoordinates(ind, nzone, receiveBuffer, x);
+            }
+            nat_tot += ind.nrecv[nzone + 1];
+        }
+        nzone += nzone;
+    }
+
+    wallcycle_stop(wcycle, ewcMOVEX);
+}
+
+//! Packs the forces on the atoms received in pulse \p ind, not in place, into \p sendBuffer
+static void packHaloForces(const gmx_domdec_ind_t&        ind,
+                           int                            nzone,
+                           gmx::ArrayRef<const gmx::RVec> f,
+                           gmx::ArrayRef<gmx::RVec>       sendBuffer)
+{
+    int j = 0;
+    for (int zone = 0; zone < nzone; zone++)
+    {
+        for (int i = ind.cell2at0[zone]; i < ind.cell2at1[zone]; i++)
+        {
+            sendBuffer[j++] = f[i];
+        }
+    }
+}
+
+//! Adds the forces received in pulse \p ind to \p f and, when needed, to shift force \p is
+static void addReceivedHaloForces(const gmx_domdec_ind_t&        ind,
+                                  gmx::ArrayRef<const gmx::RVec> receiveBuffer,
+                                  bool                           shiftForcesNeedPbc,
+                                  bool                           applyScrewPbc,
+                                  int                            is,
+                                  gmx::ArrayRef<gmx::RVec>       f,
+                                  gmx::ArrayRef<gmx::RVec>       fshift)
+{
+    int n = 0;
+    if (!shiftForcesNeedPbc)
+    {
+        for (int j : ind.index)
+        {
+            for (int d = 0; d < DIM; d++)
+            {
+                f[j][d] += receiveBuffer[n][d];
+            }
+            n++;
+        }
+    }
+    else if (!applyScrewPbc)
+    {
+        for (int j : ind.index)
+        {
+            for (int d = 0; d < DIM; d++)
+            {
+                f[j][d] += receiveBuffer[n][d];
+            }
+            /* Add this force to the shift force */
+            for (int d = 0; d < DIM; d++)
+            {
+                fshift[is][d] += receiveBuffer[n][d];
+            }
+            n++;
+        }
+    }
+    else
+    {
+        for (int j : ind.index)
+        {
+            /* Rotate the force */
+            f[j][XX] += receiveBuffer[n][XX];
+            f[j][YY] -= receiveBuffer[n][YY];
+            f[j][ZZ] -= receiveBuffer[n][ZZ];
+            if (shiftForcesNeedPbc)
+            {
+                /* Add this force to the shift force */
+                for (int d = 0; d < DIM; d++)
                 {
-                    for (int i = ind.cell2at0[zone]; i < ind.cell2at1[zone]; i++)
-                    {
-                        x[i] = receiveBuffer[j++];
-                    }
+                    fshift[is][d] += receiveBuffer[n][d];
                 }
             }
-            nat_tot += ind.nrecv[nzone + 1];
+            n++;
+        }
+    }
+}
+
+#if GMX_MPI
+/*! \brief MPI tag offset for non-blocking halo messages
+ *
+ * The pulse index is added, so several pulses between the same pair of ranks
+ * can be in flight simultaneously without matching the wrong receive.
+ */
+static constexpr int c_haloExchangeMpiTagOffset = 100;
+
+//! Sets up the pulses in \p state for the current partitioning and resets the request bookkeeping
+static void setupHaloExchangeState(const gmx_domdec_t& dd, HaloExchangeState* state)
+{
+    const gmx_domdec_comm_t& comm = *dd.comm;
+
+    state->pulses.clear();
+    int nzone   = 1;
+    int nat_tot = comm.atomRanges.numHomeAtoms();
+    for (int d = 0; d < dd.ndim; d++)
+    {
+        for (int p = 0; p < comm.cd[d].numPulses(); p++)
+        {
+            state->pulses.push_back({ d, p, nzone, nat_tot });
+            nat_tot += comm.cd[d].ind[p].nrecv[nzone + 1];
         }
         nzone += nzone;
     }
 
+    const size_t numPulses = state->pulses.size();
+    state->sendBuffers.resize(numPulses);
+    state->receiveBuffers.resize(numPulses);
+    state->sendRequests.resize(numPulses);
+    state->receiveRequests.resize(numPulses);
+    state->sendPosted.assign(numPulses, false);
+    state->sendPending.assign(numPulses, false);
+    state->receivePending.assign(numPulses, false);
+}
+
+//! Returns whether the atom indices to send in pulse \p ind only refer to home atoms
+static bool sendsOnlyHomeAtoms(const gmx_domdec_ind_t& ind, int numHomeAtoms)
+{
+    return std::all_of(ind.index.begin(), ind.index.end(),
+                       [numHomeAtoms](int a) { return a < numHomeAtoms; });
+}
+
+//! Posts a non-blocking receive of \p numElements RVecs from \p rank for pulse \p k
+static void postHaloReceive(const gmx_domdec_t& dd, HaloExchangeState* state, int k, gmx::RVec* buffer, int numElements, int rank)
+{
+    if (numElements > 0)
+    {
+        MPI_Irecv(buffer, numElements * sizeof(gmx::RVec), MPI_BYTE, rank,
+                  c_haloExchangeMpiTagOffset + k, dd.mpi_comm_all, &state->receiveRequests[k]);
+        state->receivePending[k] = true;
+    }
+}
+
+//! Posts a non-blocking send of \p numElements RVecs to \p rank for pulse \p k
+static void postHaloSend(const gmx_domdec_t& dd, HaloExchangeState* state, int k, gmx::RVec* buffer, int numElements, int rank)
+{
+    if (numElements > 0)
+    {
+        MPI_Isend(buffer, numElements * sizeof(gmx::RVec), MPI_BYTE, rank,
+                  c_haloExchangeMpiTagOffset + k, dd.mpi_comm_all, &state->sendRequests[k]);
+        state->sendPending[k] = true;
+    }
+    state->sendPosted[k] = true;
+}
+
+//! Waits for all sends in \p state to complete
+static void waitHaloSends(HaloExchangeState* state)
+{
+    for (size_t k = 0; k < state->pulses.size(); k++)
+    {
+        if (state->sendPending[k])
+        {
+            MPI_Wait(&state->sendRequests[k], MPI_STATUS_IGNORE);
+            state->sendPending[k] = false;
+        }
+    }
+}
+
+//! Packs and sends the coordinates of pulse \p k
+static void sendHaloCoordinates(const gmx_domdec_t& dd, HaloExchangeState* state, int k, gmx::ArrayRef<const gmx::RVec> x)
+{
+    const HaloPulse&        pulse = state->pulses[k];
+    const int               dim   = dd.dim[pulse.dimIndex];
+    const bool              bPBC  = (dd.ci[dim] == 0);
+    const bool              bScrew = (bPBC && dd.unitCellInfo.haveScrewPBC && dim == XX);
+    const gmx_domdec_ind_t& ind    = dd.comm->cd[pulse.dimIndex].ind[pulse.pulse];
+    rvec                    shift  = { 0, 0, 0 };
+    if (bPBC)
+    {
+        copy_rvec(state->box[dim], shift);
+    }
+
+    std::vector<gmx::RVec>& sendBuffer = state->sendBuffers[k];
+    sendBuffer.resize(ind.nsend[pulse.numZones + 1]);
+    packHaloCoordinates(ind, x, bPBC, bScrew, shift, state->box, sendBuffer);
+    postHaloSend(dd, state, k, sendBuffer.data(), sendBuffer.size(), dd.neighbor[pulse.dimIndex][1]);
+}
+
+//! Completes the coordinate receive of pulse \p k, when still in flight
+static void completeHaloCoordinateReceive(const gmx_domdec_t& dd, HaloExchangeState* state, int k, gmx::ArrayRef<gmx::RVec> x)
+{
+    if (state->receivePending[k])
+    {
+        MPI_Wait(&state->receiveRequests[k], MPI_STATUS_IGNORE);
+        state->receivePending[k] = false;
+
+        const HaloPulse&             pulse = state->pulses[k];
+        const gmx_domdec_comm_dim_t& cd    = dd.comm->cd[pulse.dimIndex];
+        if (!cd.receiveInPlace)
+        {
+            unpackHaloCoordinates(cd.ind[pulse.pulse], pulse.numZones, state->receiveBuffers[k], x);
+        }
+    }
+}
+#endif // GMX_MPI
+
+void dd_move_x_start(gmx_domdec_t* dd, const matrix box, gmx::ArrayRef<gmx::RVec> x, gmx_wallcycle* wcycle)
+{
+#if GMX_MPI
+    wallcycle_start(wcycle, ewcMOVEX);
+
+    gmx_domdec_comm_t& comm  = *dd->comm;
+    HaloExchangeState& state = comm.haloExchangeX;
+    GMX_RELEASE_ASSERT(!state.inFlight, "dd_move_x_start() can not be called twice without dd_move_x_finish()");
+
+    setupHaloExchangeState(*dd, &state);
+    copy_mat(box, state.box);
+
+    /* Post all receives up front */
+    const int numPulses = state.pulses.size();
+    for (int k = 0; k < numPulses; k++)
+    {
+        const HaloPulse&             pulse       = state.pulses[k];
+        const gmx_domdec_comm_dim_t& cd          = comm.cd[pulse.dimIndex];
+        const int                    numReceive  = cd.ind[pulse.pulse].nrecv[pulse.numZones + 1];
+        gmx::RVec*                   receiveData = x.data() + pulse.atomStart;
+        if (!cd.receiveInPlace)
+        {
+            state.receiveBuffers[k].resize(numReceive);
+            receiveData = state.receiveBuffers[k].data();
+        }
+        postHaloReceive(*dd, &state, k, receiveData, numReceive, dd->neighbor[pulse.dimIndex][0]);
+    }
+
+    /* Send the pulses that only depend on home atoms, the others are sent
+     * in dd_move_x_finish() as soon as the halo data they depend on has arrived.
+     */
+    const int numHomeAtoms = comm.atomRanges.numHomeAtoms();
+    for (int k = 0; k < numPulses; k++)
+    {
+        const HaloPulse& pulse = state.pulses[k];
+        if (sendsOnlyHomeAtoms(comm.cd[pulse.dimIndex].ind[pulse.pulse], numHomeAtoms))
+        {
+            sendHaloCoordinates(*dd, &state, k, x);
+        }
+    }
+
+    state.inFlight = true;
+
+    wallcycle_stop(wcycle, ewcMOVEX);
+#else
+    dd_move_x(dd, box, x, wcycle);
+#endif
+}
+
+void dd_move_x_finish(gmx_domdec_t* dd, gmx::ArrayRef<gmx::RVec> x, gmx_wallcycle* wcycle)
+{
+#if GMX_MPI
+    wallcycle_start(wcycle, ewcMOVEX);
+
+    HaloExchangeState& state = dd->comm->haloExchangeX;
+    GMX_RELEASE_ASSERT(state.inFlight, "dd_move_x_finish() requires a call to dd_move_x_start()");
+
+    const int numPulses = state.pulses.size();
+    for (int k = 0; k < numPulses; k++)
+    {
+        if (!state.sendPosted[k])
+        {
+            /* This pulse sends halo atoms received in earlier pulses */
+            for (int j = 0; j < k; j++)
+            {
+                completeHaloCoordinateReceive(*dd, &state, j, x);
+            }
+            sendHaloCoordinates(*dd, &state, k, x);
+        }
+    }
+    for (int k = 0; k < numPulses; k++)
+    {
+        completeHaloCoordinateReceive(*dd, &state, k, x);
+    }
+    waitHaloSends(&state);
+
+    state.inFlight = false;
+
     wallcycle_stop(wcycle, ewcMOVEX);
+#else
+    GMX_UNUSED_VALUE(dd);
+    GMX_UNUSED_VALUE(x);
+    GMX_UNUSED_VALUE(wcycle);
+#endif
+}
+
+bool dd_useOverlappedHaloExchange(const gmx_domdec_t& dd)
+{
+    return dd.comm->ddSettings.useOverlappedHaloExchange;
+}
+
+#if GMX_MPI
+/*! \brief Sums the forces over the neighboring cells with non-blocking communication
+ *
+ * All receives are posted up front and each pulse is sent as soon as
+ * the forces it sends have received all contributions from later pulses.
+ * The received forces are added in the same order as in dd_move_f(),
+ * so the results are identical.
+ */
+static void dd_move_f_nonblocking(gmx_domdec_t* dd, gmx::ForceWithShiftForces* forceWithShiftForces)
+{
+    gmx::ArrayRef<gmx::RVec> f      = forceWithShiftForces->force();
+    gmx::ArrayRef<gmx::RVec> fshift = forceWithShiftForces->shiftForces();
+
+    gmx_domdec_comm_t& comm  = *dd->comm;
+    HaloExchangeState& state = comm.haloExchangeF;
+
+    setupHaloExchangeState(*dd, &state);
+
+    /* Post all receives up front */
+    const int numPulses = state.pulses.size();
+    for (int k = 0; k < numPulses; k++)
+    {
+        const HaloPulse& pulse      = state.pulses[k];
+        const int        numReceive = comm.cd[pulse.dimIndex].ind[pulse.pulse].nsend[pulse.numZones + 1];
+        state.receiveBuffers[k].resize(numReceive);
+        postHaloReceive(*dd, &state, k, state.receiveBuffers[k].data(), numReceive,
+                        dd->neighbor[pulse.dimIndex][1]);
+    }
+
+    /* Adds the forces received in pulse k, when still in flight */
+    auto completeReceive = [&](int k) {
+        if (!state.receivePending[k])
+        {
+            return;
+        }
+        MPI_Wait(&state.receiveRequests[k], MPI_STATUS_IGNORE);
+        state.receivePending[k] = false;
+
+        const HaloPulse& pulse = state.pulses[k];
+        /* Only forces in domains near the PBC boundaries need to
+           consider PBC in the treatment of fshift */
+        const bool shiftForcesNeedPbc =
+                (forceWithShiftForces->computeVirial() && dd->ci[dd->dim[pulse.dimIndex]] == 0);
+        const bool applyScrewPbc =
+                (shiftForcesNeedPbc && dd->unitCellInfo.haveScrewPBC && dd->dim[pulse.dimIndex] == XX);
+        ivec vis                      = { 0, 0, 0 };
+        vis[dd->dim[pulse.dimIndex]] = 1;
+        addReceivedHaloForces(comm.cd[pulse.dimIndex].ind[pulse.pulse], state.receiveBuffers[k],
+                              shiftForcesNeedPbc, applyScrewPbc, IVEC2IS(vis), f, fshift);
+    };
+
+    /* Pulses are sent in reverse order. A pulse can only be sent after the forces
+     * of later pulses that act on halo atoms have been added.
+     */
+    const int numHomeAtoms           = comm.atomRanges.numHomeAtoms();
+    bool      laterPulsesUseHaloAtoms = false;
+    for (int k = numPulses - 1; k >= 0; k--)
+    {
+        const HaloPulse&             pulse = state.pulses[k];
+        const gmx_domdec_comm_dim_t& cd    = comm.cd[pulse.dimIndex];
+        const gmx_domdec_ind_t&      ind   = cd.ind[pulse.pulse];
+
+        if (laterPulsesUseHaloAtoms)
+        {
+            for (int j = numPulses - 1; j > k; j--)
+            {
+                completeReceive(j);
+            }
+        }
+
+        const int  numSend = ind.nrecv[pulse.numZones + 1];
+        gmx::RVec* sendData = f.data() + pulse.atomStart;
+        if (!cd.receiveInPlace)
+        {
+            state.sendBuffers[k].resize(numSend);
+            packHaloForces(ind, pulse.numZones, f, state.sendBuffers[k]);
+            sendData = state.sendBuffers[k].data();
+        }
+        postHaloSend(*dd, &state, k, sendData, numSend, dd->neighbor[pulse.dimIndex][0]);
+
+        laterPulsesUseHaloAtoms = laterPulsesUseHaloAtoms || !sendsOnlyHomeAtoms(ind, numHomeAtoms);
+    }
+    for (int k = numPulses - 1; k >= 0; k--)
+    {
+        completeReceive(k);
+    }
+    waitHaloSends(&state);
 }
+#endif // GMX_MPI
 
 void dd_move_f(gmx_domdec_t* dd, gmx::ForceWithShiftForces* forceWithShiftForces, gmx_wallcycle* wcycle)
 {
     wallcycle_start(wcycle, ewcMOVEF);
 
+#if GMX_MPI
+    if (dd->comm->ddSettings.useOverlappedHaloExchange)
+    {
+        dd_move_f_nonblocking(dd, forceWithShiftForces);
+        wallcycle_stop(wcycle, ewcMOVEF);
+        return;
+    }
+#endif
+
     gmx::ArrayRef<gmx::RVec> f      = forceWithShiftForces->force();
     gmx::ArrayRef<gmx::RVec> fshift = forceWithShiftForces->shiftForces();
 
@@ -399,65 +801,12 @@ void dd_move_f(gmx_domdec_t* dd, gmx::ForceWithShiftForces* forceWithShiftForces
             else
             {
                 sendBuffer = sendBufferAccess.buffer;
-                int j      = 0;
-                for (int zone = 0; zone < nzone; zone++)
-                {
-                    for (int i = ind.cell2at0[zone]; i < ind.cell2at1[zone]; i++)
-                    {
-                        sendBuffer[j++] = f[i];
-                    }
-                }
+                packHaloForces(ind, nzone, f, sendBuffer);
             }
             /* Communicate the forces */
             ddSendrecv(dd, d, dddirForward, sendBuffer, receiveBuffer);
             /* Add the received forces */
-            int n = 0;
-            if (!shiftForcesNeedPbc)
-            {
-                for (int j : ind.index)
-                {
-                    for (int d = 0; d < DIM; d++)
-                    {
-                        f[j][d] += receiveBuffer[n][d];
-                    }
-                    n++;
-                }
-            }
-            else if (!applyScrewPbc)
-            {
-                for (int j : ind.index)
-                {
-                    for (int d = 0; d < DIM; d++)
-                    {
-                        f[j][d] += receiveBuffer[n][d];
-                    }
-                    /* Add this force to the shift force */
-                    for (int d = 0; d < DIM; d++)
-                    {
-                        fshift[is][d] += receiveBuffer[n][d];
-                    }
-                    n++;
-                }
-            }
-            else
-            {
-                for (int j : ind.index)
-                {
-                    /* Rotate the force */
-                    f[j][XX] += receiveBuffer[n][XX];
-                    f[j][YY] -= receiveBuffer[n][YY];
-                    f[j][ZZ] -= receiveBuffer[n][ZZ];
-                    if (shiftForcesNeedPbc)
-                    {
-                        /* Add this force to the shift force */
-                        for (int d = 0; d < DIM; d++)
-                        {
-                            fshift[is][d] += receiveBuffer[n][d];
-                        }
-                    }
-                    n++;
-                }
-            }
+            addReceivedHaloForces(ind, receiveBuffer, shiftForcesNeedPbc, applyScrewPbc, is, f, fshift);
         }
         nzone /= 2;
     }
@@ -2873,6 +3222,8 @@ static DDSettings getDDSettings(const gmx::MDLogger&     mdlog,
     ddSettings.nstDDDump           = dd_getenv(mdlog, "GMX_DD_NST_DUMP", 0);
     ddSettings.nstDDDumpGrid       = dd_getenv(mdlog, "GMX_DD_NST_DUMP_GRID", 0);
     ddSettings.DD_debug            = dd_getenv(mdlog, "GMX_DD_DEBUG", 0);
+    ddSettings.useOverlappedHaloExchange = (dd_getenv(mdlog, "GMX_DD_OVERLAP_HALO", 0) != 0);
+    const int atomOrdering               = dd_getenv(mdlog, "GMX_DD_ATOM_ORDER", 0);
 
     if (ddSettings.useSendRecv2)
     {
@@ -2883,6 +3234,29 @@ static DDSettings getDDSettings(const gmx::MDLogger&     mdlog,
                         "communication");
     }
 
+    if (ddSettings.useOverlappedHaloExchange)
+    {
+        GMX_LOG(mdlog.info)
+                .appendText(
+                        "Will use non-blocking halo communication of coordinates and forces, "
+                        "overlapping the coordinate communication with local non-bonded work");
+    }
+
+    if (atomOrdering == static_cast<int>(DDAtomOrdering::HilbertCurve))
+    {
+        ddSettings.atomOrdering = DDAtomOrdering::HilbertCurve;
+        GMX_LOG(mdlog.info).appendText("Will order the home atoms along a Hilbert curve");
+    }
+    else if (atomOrdering == static_cast<int>(DDAtomOrdering::Molecule))
+    {
+        ddSettings.atomOrdering = DDAtomOrdering::Molecule;
+        GMX_LOG(mdlog.info).appendText("Will order the home atoms by molecule");
+    }
+    else if (atomOrdering != static_cast<int>(DDAtomOrdering::Grid))
+    {
+        gmx_fatal(FARGS, "Unsupported value %d for GMX_DD_ATOM_ORDER, use 0, 1 or 2", atomOrdering);
+    }
+
     if (ddSettings.eFlop)
     {
         GMX_LOG(mdlog.info).appendText("Will load balance based on FLOP count");
@@ -216,6 +216,24 @@ void dd_cycles_add(const gmx_domdec_t* dd, float cycles, int ddCycl);
 /*! \brief Communicate the coordinates to the neighboring cells and do pbc. */
 void dd_move_x(struct gmx_domdec_t* dd, const matrix box, gmx::ArrayRef<gmx::RVec> x, gmx_wallcycle* wcycle);
 
+/*! \brief Starts non-blocking communication of the coordinates to the neighboring cells
+ *
+ * Posts all receives and sends the pulses that only contain home atoms.
+ * Until dd_move_x_finish() has been called, only the home atoms in \p x
+ * can be used and \p x should not be modified.
+ * Without MPI this calls dd_move_x().
+ */
+void dd_move_x_start(struct gmx_domdec_t* dd, const matrix box, gmx::ArrayRef<gmx::RVec> x, gmx_wallcycle* wcycle);
+
+/*! \brief Completes the coordinate communication started with dd_move_x_start()
+ *
+ * Pulses that forward halo atoms are sent as soon as their data has arrived.
+ */
+void dd_move_x_finish(struct gmx_domdec_t* dd, gmx::ArrayRef<gmx::RVec> x, gmx_wallcycle* wcycle);
+
+/*! \brief Returns whether the halo coordinate communication should overlap with local work */
+bool dd_useOverlappedHaloExchange(const gmx_domdec_t& dd);
+
 /*! \brief Sum the forces over the neighboring cells.
  *
  * When fshift!=NULL the shift forces are updated to obtain
@@ -48,6 +48,7 @@
 
 #include "gromacs/domdec/domdec.h"
 #include "gromacs/domdec/domdec_struct.h"
+#include "gromacs/domdec/ga2la.h"
 #include "gromacs/mdlib/updategroupscog.h"
 #include "gromacs/timing/cyclecounter.h"
 #include "gromacs/topology/block.h"
@@ -170,7 +171,7 @@ typedef struct domdec_load
 /*! \brief Data needed to sort an atom to the desired location in the local state */
 typedef struct gmx_cgsort
 {
-    /**< Neighborsearch grid cell index */
+    /**< Neighborsearch grid cell index, or space-filling curve index */
     int nsc = 0;
     /**< Global atom/charge group index */
     int ind_gl = 0;
@@ -283,6 +284,17 @@ enum class DlbState
     nr                    /**< The number of DLB states */
 };
 
+/*! \brief The order of the home atoms in the local state after repartitioning
+ *
+ * The values are used with the environment variable GMX_DD_ATOM_ORDER.
+ */
+enum class DDAtomOrdering : int
+{
+    Grid         = 0, /**< The order of the non-bonded search grid */
+    HilbertCurve = 1, /**< Along a Hilbert curve through the home domain */
+    Molecule     = 2  /**< In global atom order, i.e. by molecule and update group */
+};
+
 /*! \brief The PME domain decomposition for one dimension */
 typedef struct gmx_ddpme
 {
@@ -467,6 +479,12 @@ struct DDSettings
     //! Use MPI_Sendrecv communication instead of non-blocking calls
     bool useSendRecv2 = false;
 
+    //! Use non-blocking halo communication for coordinates and forces, overlapping with local work
+    bool useOverlappedHaloExchange = false;
+
+    //! The order of the home atoms in the local state
+    DDAtomOrdering atomOrdering = DDAtomOrdering::Grid;
+
     /* Information for managing the dynamic load balancing */
     //! Maximum DLB scaling per load balancing step in percent
     int dlb_scale_lim = 0;
@@ -497,6 +515,48 @@ struct DDSettings
     DlbState initialDlbState = DlbState::offCanTurnOn;
 };
 
+/*! \brief Describes one pulse of the halo communication, pulses are ordered over all DD dimensions */
+struct HaloPulse
+{
+    //! The DD dimension index
+    int dimIndex;
+    //! The pulse index within the dimension
+    int pulse;
+    //! The number of zones present before this pulse
+    int numZones;
+    //! The first atom of the halo range received in this pulse
+    int atomStart;
+};
+
+/*! \brief State for non-blocking halo communication of coordinates or forces
+ *
+ * Each pulse has its own buffers and requests, so all pulses can be in flight
+ * simultaneously and local computation can overlap with the communication.
+ */
+struct HaloExchangeState
+{
+    //! The pulses over all dimensions
+    std::vector<HaloPulse> pulses;
+    //! The box used for the PBC shift of coordinates
+    matrix box = { { 0 } };
+    //! Send buffer for each pulse
+    std::vector<std::vector<gmx::RVec>> sendBuffers;
+    //! Receive buffer for each pulse, not used when receiving in place
+    std::vector<std::vector<gmx::RVec>> receiveBuffers;
+    //! Send request for each pulse
+    std::vector<MPI_Request> sendRequests;
+    //! Receive request for each pulse
+    std::vector<MPI_Request> receiveRequests;
+    //! Whether the data for each pulse has been packed and its send, if any, posted
+    std::vector<bool> sendPosted;
+    //! Whether a send is in flight for each pulse
+    std::vector<bool> sendPending;
+    //! Whether a receive is in flight for each pulse
+    std::vector<bool> receivePending;
+    //! Whether communication started with dd_move_x_start() has not been finished yet
+    bool inFlight = false;
+};
+
 /*! \brief Information on how the DD ranks are set up */
 struct DDRankSetup
 {
@@ -664,6 +724,14 @@ struct gmx_domdec_comm_t // NOLINT (clang-analyzer-optin.performance.Padding)
     /**< Another rvec comm. buffer */
     DDBuffer<gmx::RVec> rvecBuffer2;
 
+    /**< State for non-blocking halo communication of coordinates */
+    HaloExchangeState haloExchangeX;
+    /**< State for non-blocking halo communication of forces */
+    HaloExchangeState haloExchangeF;
+
+    /**< Buffer for the global to local atom entries to insert into ga2la */
+    std::vector<gmx_ga2la_t::Entry> ga2laEntryBuffer;
+
     /* Communication buffers for local redistribution */
     /**< Charge group flag comm. buffers */
     std::array<std::vector<int>, DIM * 2> cggl_flag;
@@ -51,6 +51,7 @@
 #include <cstring>
 
 #include <algorithm>
+#include <array>
 #include <memory>
 #include <string>
 
@@ -822,20 +823,27 @@ static inline void add_ifunc_for_vsites(t_iatom*           tiatoms,
     }
 
     GMX_ASSERT(nral >= 2 && nral <= 5, "Invalid nral for vsites");
-    for (int k = 2; k < 1 + nral; k++)
+    std::array<int, MAXATOMLIST> constructingAtomsGlobal;
+    std::array<int, MAXATOMLIST> constructingAtomsLocal;
+    const int                    numConstructingAtoms = nral - 1;
+    for (int k = 0; k < numConstructingAtoms; k++)
     {
-        int ak_gl = a_gl + iatoms[k] - a_mol;
-        if (const int* homeIndex = ga2la.findHome(ak_gl))
+        constructingAtomsGlobal[k] = a_gl + iatoms[2 + k] - a_mol;
+    }
+    ga2la.findHomeBatch(
+            gmx::constArrayRefFromArray(constructingAtomsGlobal.data(), numConstructingAtoms),
+            constructingAtomsLocal);
+    for (int k = 0; k < numConstructingAtoms; k++)
+    {
+        if (constructingAtomsLocal[k] >= 0)
         {
-            tiatoms[k] = *homeIndex;
+            tiatoms[2 + k] = constructingAtomsLocal[k];
         }
         else
         {
             /* Copy the global index, convert later in make_local_vsites */
-            tiatoms[k] = -(ak_gl + 1);
+            tiatoms[2 + k] = -(constructingAtomsGlobal[k] + 1);
         }
-        // Note that ga2la_get_home always sets the third parameter if
-        // it returns TRUE
     }
     il->push_back(tiatoms[0], nral, tiatoms + 1);
 }
@@ -1175,22 +1183,29 @@ static inline void check_assign_interactions_atom(int                       i,
                 ivec k_zero, k_plus;
                 int  k;
 
-                bUse = TRUE;
-                clear_ivec(k_zero);
-                clear_ivec(k_plus);
-                for (k = 1; k <= nral && bUse; k++)
+                /* Look up all atoms at once, so the lookups overlap */
+                std::array<int, MAXATOMLIST>                       atomsGlobal;
+                std::array<const gmx_ga2la_t::Entry*, MAXATOMLIST> entries;
+                for (k = 1; k <= nral; k++)
                 {
-                    int k_gl;
                     if (!bInterMolInteractions)
                     {
                         /* Get the global index using the offset in the molecule */
-                        k_gl = i_gl + iatoms[k] - i_mol;
+                        atomsGlobal[k - 1] = i_gl + iatoms[k] - i_mol;
                     }
                     else
                     {
-                        k_gl = iatoms[k];
+                        atomsGlobal[k - 1] = iatoms[k];
                     }
-                    const auto* entry = dd->ga2la->find(k_gl);
+                }
+                dd->ga2la->findBatch(gmx::constArrayRefFromArray(atomsGlobal.data(), nral), entries);
+
+                bUse = TRUE;
+                clear_ivec(k_zero);
+                clear_ivec(k_plus);
+                for (k = 1; k <= nral && bUse; k++)
+                {
+                    const auto* entry = entries[k - 1];
                     if (entry == nullptr || entry->cell >= zones->n)
                     {
                         /* We do not have this atom of this interaction
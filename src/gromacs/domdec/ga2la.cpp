@@ -45,16 +45,21 @@
 
 #include "ga2la.h"
 
+#include <algorithm>
+#include <vector>
+
+#include "gromacs/utility/exceptions.h"
+#include "gromacs/utility/range.h"
+
 /*! \brief Returns whether to use a direct list only
  *
  * There are two methods implemented for finding the local atom number
  * belonging to a global atom number:
  * 1) a simple, direct array
- * 2) a hash table consisting of list of linked lists indexed with
- *    the global number modulo mod.
+ * 2) an open-addressing hash table with the global number as key.
  * Memory requirements:
  * 1) numAtomsTotal*2 ints
- * 2) numAtomsLocal*(2+1-2(1-e^-1/2))*4 ints
+ * 2) numAtomsLocal*(1.5 to 3.5)*3 ints
  * where numAtomsLocal is the number of atoms in the home + communicated zones.
  * Method 1 is faster for low parallelization, 2 for high parallelization.
  * We switch to method 2 when it uses less than half the memory method 1.
@@ -68,6 +73,13 @@ static bool directListIsFaster(int numAtomsTotal, int numAtomsLocal)
             || numAtomsTotal <= numAtomsLocal * c_memoryRatioHashedVersusDirect);
 }
 
+//! Returns the range of atoms out of \p numAtoms that \p thread out of \p numThreads processes
+static gmx::Range<int> atomRange(int numAtoms, int thread, int numThreads)
+{
+    return gmx::Range<int>((numAtoms * static_cast<int64_t>(thread)) / numThreads,
+                           (numAtoms * static_cast<int64_t>(thread + 1)) / numThreads);
+}
+
 gmx_ga2la_t::gmx_ga2la_t(int numAtomsTotal, int numAtomsLocal) :
     usingDirect_(directListIsFaster(numAtomsTotal, numAtomsLocal))
 {
@@ -80,3 +92,150 @@ gmx_ga2la_t::gmx_ga2la_t(int numAtomsTotal, int numAtomsLocal) :
         new (&(data_.hashed)) gmx::HashedMap<Entry>(numAtomsLocal);
     }
 }
+
+void gmx_ga2la_t::insertBatch(gmx::ArrayRef<const int>   globalAtomIndices,
+                              gmx::ArrayRef<const Entry> entries,
+                              int                        numThreads)
+{
+    GMX_ASSERT(entries.size() == globalAtomIndices.size(), "Need one entry per global atom index");
+
+    /* Using threads only pays off with sufficient atoms per thread */
+    constexpr int c_minNumAtomsPerThread = 2048;
+
+    const int numAtoms = globalAtomIndices.ssize();
+    numThreads         = std::max(1, std::min(numThreads, numAtoms / c_minNumAtomsPerThread));
+
+    if (usingDirect_)
+    {
+#pragma omp parallel for num_threads(numThreads) schedule(static)
+        for (int i = 0; i < numAtoms; i++)
+        {
+            GMX_ASSERT(data_.direct[globalAtomIndices[i]].cell == -1,
+                       "The key to be inserted should not be present");
+            data_.direct[globalAtomIndices[i]] = entries[i];
+        }
+
+        return;
+    }
+
+    gmx::HashedMap<Entry>& map = data_.hashed;
+
+    map.reserve(numAtoms);
+
+    if (numThreads == 1)
+    {
+        for (int i = 0; i < numAtoms; i++)
+        {
+            map.insert(globalAtomIndices[i], entries[i]);
+        }
+
+        return;
+    }
+
+    /* Each thread inserts the atoms with home buckets in its own range of buckets.
+     * To avoid every thread looping over all atoms, the atoms are first
+     * partitioned over the threads with a counting sort on home bucket.
+     * The few atoms that would be stored beyond the end of the range
+     * are inserted afterwards by the master thread.
+     */
+    const int numBuckets = map.numBuckets();
+    /* Thread t inserts the atoms with home buckets in [ceil(t*nb/T), ceil((t+1)*nb/T)) */
+    auto threadOfBucket = [numBuckets, numThreads](int bucket) {
+        return static_cast<int>((static_cast<int64_t>(bucket) * numThreads) / numBuckets);
+    };
+    auto bucketRangeBegin = [numBuckets, numThreads](int thread) {
+        return static_cast<int>((static_cast<int64_t>(thread) * numBuckets + numThreads - 1)
+                                / numThreads);
+    };
+
+    /* Element s*numThreads + t counts the atoms in the part of thread s that thread t inserts */
+    threadAtomCounts_.assign(numThreads * numThreads, 0);
+    atomsSortedByThread_.resize(numAtoms);
+    std::vector<int>              numInserted(numThreads, 0);
+    std::vector<int>              numNewlyUsedSlots(numThreads, 0);
+    std::vector<std::vector<int>> overflow(numThreads);
+#pragma omp parallel for num_threads(numThreads) schedule(static)
+    for (int thread = 0; thread < numThreads; thread++)
+    {
+        try
+        {
+            int* atomCounts = threadAtomCounts_.data() + thread * numThreads;
+            for (int i : atomRange(numAtoms, thread, numThreads))
+            {
+                atomCounts[threadOfBucket(map.homeBucket(globalAtomIndices[i]))]++;
+            }
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
+
+    /* Convert the counts to offsets, ordered on inserting thread first */
+    std::vector<int> sortedRangeBegin(numThreads + 1);
+    int              offset = 0;
+    for (int t = 0; t < numThreads; t++)
+    {
+        sortedRangeBegin[t] = offset;
+        for (int s = 0; s < numThreads; s++)
+        {
+            const int count                       = threadAtomCounts_[s * numThreads + t];
+            threadAtomCounts_[s * numThreads + t] = offset;
+            offset += count;
+        }
+    }
+    sortedRangeBegin[numThreads] = offset;
+
+#pragma omp parallel for num_threads(numThreads) schedule(static)
+    for (int thread = 0; thread < numThreads; thread++)
+    {
+        try
+        {
+            int* atomOffsets = threadAtomCounts_.data() + thread * numThreads;
+            for (int i : atomRange(numAtoms, thread, numThreads))
+            {
+                const int t = threadOfBucket(map.homeBucket(globalAtomIndices[i]));
+                atomsSortedByThread_[atomOffsets[t]++] = i;
+            }
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
+
+#pragma omp parallel for num_threads(numThreads) schedule(static)
+    for (int thread = 0; thread < numThreads; thread++)
+    {
+        try
+        {
+            const int bucketBegin = bucketRangeBegin(thread);
+            const int bucketEnd   = bucketRangeBegin(thread + 1);
+            for (int j = sortedRangeBegin[thread]; j < sortedRangeBegin[thread + 1]; j++)
+            {
+                const int i = atomsSortedByThread_[j];
+                if (map.insertInBucketRange(globalAtomIndices[i], entries[i], bucketBegin,
+                                            bucketEnd, &numNewlyUsedSlots[thread]))
+                {
+                    numInserted[thread]++;
+                }
+                else
+                {
+                    overflow[thread].push_back(i);
+                }
+            }
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
+
+    int numInsertedTotal       = 0;
+    int numNewlyUsedSlotsTotal = 0;
+    for (int t = 0; t < numThreads; t++)
+    {
+        numInsertedTotal += numInserted[t];
+        numNewlyUsedSlotsTotal += numNewlyUsedSlots[t];
+    }
+    map.addInsertedElements(numInsertedTotal, numNewlyUsedSlotsTotal);
+
+    for (const std::vector<int>& overflowIndices : overflow)
+    {
+        for (int i : overflowIndices)
+        {
+            map.insert(globalAtomIndices[i], entries[i]);
+        }
+    }
+}
@@ -49,9 +49,12 @@
 #ifndef GMX_DOMDEC_GA2LA_H
 #define GMX_DOMDEC_GA2LA_H
 
+#include <algorithm>
+#include <array>
 #include <vector>
 
 #include "gromacs/domdec/hashedmap.h"
+#include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/gmxassert.h"
 
 /*! \libinternal \brief Global to local atom mapping
@@ -97,6 +100,16 @@ public:
         }
     }
 
+    /*! \brief Inserts entries for multiple atoms, using multiple threads for large numbers of atoms
+     *
+     * There should not already be entries for the atoms.
+     *
+     * \param[in] globalAtomIndices  The global atom indices
+     * \param[in] entries            The entry for each global atom index
+     * \param[in] numThreads         The maximum number of OpenMP threads to use
+     */
+    void insertBatch(gmx::ArrayRef<const int> globalAtomIndices, gmx::ArrayRef<const Entry> entries, int numThreads);
+
     //! Delete the entry for global atom a_gl
     void erase(int a_gl)
     {
@@ -130,6 +143,48 @@ public:
         return (e && e->cell == 0) ? &(e->la) : nullptr;
     }
 
+    /*! \brief Looks up the entries for multiple global atom indices
+     *
+     * \param[in]  globalAtomIndices  The global atom indices to look up
+     * \param[out] entries            Pointer to the entry for each index, nullptr when not present
+     */
+    void findBatch(gmx::ArrayRef<const int> globalAtomIndices, gmx::ArrayRef<const Entry*> entries) const
+    {
+        if (usingDirect_)
+        {
+            for (gmx::index i = 0; i < globalAtomIndices.ssize(); i++)
+            {
+                const Entry& entry = data_.direct[globalAtomIndices[i]];
+                entries[i]         = (entry.cell == -1) ? nullptr : &entry;
+            }
+        }
+        else
+        {
+            data_.hashed.findBatch(globalAtomIndices, entries);
+        }
+    }
+
+    /*! \brief Looks up the local atom indices for multiple global atom indices
+     *
+     * \param[in]  globalAtomIndices  The global atom indices to look up
+     * \param[out] localAtomIndices   The local index for each home atom, -1 for other atoms
+     */
+    void findHomeBatch(gmx::ArrayRef<const int> globalAtomIndices, gmx::ArrayRef<int> localAtomIndices) const
+    {
+        std::array<const Entry*, c_findHomeBatchSize> entries;
+        for (gmx::index start = 0; start < globalAtomIndices.ssize(); start += c_findHomeBatchSize)
+        {
+            const gmx::index numAtoms = std::min(globalAtomIndices.ssize() - start,
+                                                 static_cast<gmx::index>(c_findHomeBatchSize));
+            findBatch(globalAtomIndices.subArray(start, numAtoms), entries);
+            for (gmx::index i = 0; i < numAtoms; i++)
+            {
+                const Entry* const e        = entries[i];
+                localAtomIndices[start + i] = (e && e->cell == 0) ? e->la : -1;
+            }
+        }
+    }
+
     /*! \brief Returns a reference to the entry for a_gl
      *
      * A non-release assert checks that a_gl is present.
@@ -166,6 +221,9 @@ public:
     }
 
 private:
+    //! The number of atoms findHomeBatch() passes to findBatch() at once
+    static constexpr int c_findHomeBatchSize = 64;
+
     union Data {
         std::vector<Entry>    direct;
         gmx::HashedMap<Entry> hashed;
@@ -174,6 +232,10 @@ private:
         ~Data() {}
     } data_;
     const bool usingDirect_;
+    //! The number of atoms per source and destination thread in insertBatch()
+    std::vector<int> threadAtomCounts_;
+    //! The atom indices sorted on the thread that inserts them in insertBatch()
+    std::vector<int> atomsSortedByThread_;
 };
 
 #endif
@@ -35,7 +35,7 @@
 /*! \libinternal \file
  * \brief
  * Defines structures and functions for mapping from keys to entries
- * indices using a hash table.
+ * indices using an open-addressing hash table.
  * The functions are performance critical and should be inlined.
  *
  * \inlibraryapi
@@ -48,13 +48,18 @@
 #define GMX_DOMDEC_HASHEDMAP_H
 
 #include <climits>
+#include <cstdint>
 
 #include <algorithm>
+#include <array>
 #include <utility>
 #include <vector>
 
+#include "gromacs/utility/alignedallocator.h"
+#include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/basedefinitions.h"
 #include "gromacs/utility/exceptions.h"
+#include "gromacs/utility/gmxassert.h"
 
 namespace gmx
 {
@@ -64,18 +69,32 @@ namespace gmx
  * Efficiently manages mapping from integer keys to values.
  * Note that this basically implements a subset of the functionality of
  * std::unordered_map, but is an order of magnitude faster.
+ *
+ * The table uses open addressing with linear probing. The keys are stored
+ * separately from the values, so a bucket of c_bucketSize keys fills one
+ * cache line. Keys with the same value after division by c_bucketSize share
+ * a bucket and the remainder gives the slot in the bucket where the probing
+ * starts, so consecutive keys, such as the global atom indices of a molecule,
+ * end up in the same cache line and are usually found at the first probe.
+ * The bucket is chosen by Fibonacci hashing of the quotient, so regular
+ * strides in the keys do not map many keys to the same bucket.
+ *
+ * The keys INT_MIN and INT_MIN + 1 are reserved for internal use.
  */
 template<class T>
 class HashedMap
 {
+public:
+    //! The number of keys per bucket, a bucket of keys fills a cache line
+    static constexpr int c_bucketSize = 16;
+    //! The number of keys findBatch() prefetches before probing
+    static constexpr int c_findBatchSize = 16;
+
 private:
-    /*! \libinternal \brief Structure for the key/value hash table */
-    struct hashEntry
-    {
-        int key = -1;  /**< The key */
-        T   value;     /**< The value(s) */
-        int next = -1; /**< Index in the list of the next element with the same hash, -1 if none */
-    };
+    //! Key value for an empty slot, the search for a key stops at a bucket with an empty slot
+    static constexpr int c_emptyKey = INT_MIN;
+    //! Key value for an erased slot, can be reused on insertion, but does not stop the search
+    static constexpr int c_erasedKey = INT_MIN + 1;
 
     /*! \brief The table size is set to at least this factor time the nr of keys */
     static constexpr float c_relTableSizeSetMin = 1.5;
@@ -83,6 +102,8 @@ private:
     static constexpr float c_relTableSizeThresholdMin = 1.3;
     /*! \brief Threshold for decreasing the table size */
     static constexpr float c_relTableSizeThresholdMax = 3.5;
+    /*! \brief The table grows when more than this number of sixteenths of the slots are used */
+    static constexpr int c_maxUsedSixteenths = 15;
 
     /*! \brief Resizes the table
      *
@@ -92,12 +113,6 @@ private:
     {
         GMX_RELEASE_ASSERT(numElements_ == 0, "Table needs to be empty for resize");
 
-        /* The fraction of table entries with 0   size lists is e^-f.
-         * The fraction of table entries with >=1 size lists is 1 - e^-f
-         * where f is: the #elements / tableSize
-         * The fraction of elements not in the direct list is: 1 - (1 - e^-f)/f.
-         * Thus the optimal table size is roughly double #elements.
-         */
         /* Make the hash table a power of 2 and at least 1.5 * #elements */
         int tableSize = 64;
         while (tableSize <= INT_MAX / 2
@@ -105,11 +120,139 @@ private:
         {
             tableSize *= 2;
         }
-        table_.resize(tableSize);
+        keys_.assign(tableSize, c_emptyKey);
+        values_.resize(tableSize);
+
+        /* The number of buckets is a power of 2, so a binary mask wraps the probing
+         * and the top log2(#buckets) bits of a 32-bit hash give the home bucket.
+         */
+        bucketMask_  = tableSize / c_bucketSize - 1;
+        bucketShift_ = 32;
+        for (int numBuckets = bucketMask_ + 1; numBuckets > 1; numBuckets /= 2)
+        {
+            bucketShift_--;
+        }
+        numUsedSlots_ = 0;
+    }
+
+    //! Returns whether inserting one more element would make the table too full
+    bool needsToGrow() const
+    {
+        return (static_cast<int64_t>(numUsedSlots_) + 1) * 16
+               > static_cast<int64_t>(bucket_count()) * c_maxUsedSixteenths;
+    }
+
+    //! Doubles the table size and reinserts all elements
+    void grow()
+    {
+        std::vector<int, AlignedAllocator<int>> oldKeys;
+        std::vector<T>                          oldValues;
+        std::swap(oldKeys, keys_);
+        std::swap(oldValues, values_);
+
+        const int numElements = numElements_;
+        numElements_          = 0;
+        /* Make sure we end up with at least double the size, the erased slots are dropped */
+        resize(std::max(numElements, static_cast<int>(oldKeys.size())));
+        for (size_t i = 0; i < oldKeys.size(); i++)
+        {
+            if (oldKeys[i] != c_emptyKey && oldKeys[i] != c_erasedKey)
+            {
+                insertInFreeSlot(oldKeys[i], oldValues[i]);
+            }
+        }
+    }
+
+    //! Returns the slot at which the search for \p key with home bucket \p bucket starts
+    static int homeSlot(int key, int bucket)
+    {
+        return bucket * c_bucketSize + (key & (c_bucketSize - 1));
+    }
+
+    /*! \brief Returns the slot index for \p key with home bucket \p bucket, -1 when not present
+     *
+     * Slots only become empty in clear(), so the search stops at the first empty slot.
+     */
+    int findSlot(int key, int bucket) const
+    {
+        const int slotMask = bucket_count() - 1;
+        int       slot     = homeSlot(key, bucket);
+        while (true)
+        {
+            if (keys_[slot] == key)
+            {
+                return slot;
+            }
+            if (keys_[slot] == c_emptyKey)
+            {
+                return -1;
+            }
+            slot = (slot + 1) & slotMask;
+        }
+    }
+
+    //! Returns the slot index for \p key, -1 when not present
+    int findSlot(int key) const { return findSlot(key, homeBucket(key)); }
+
+    //! Requests the keys of \p bucket to be loaded into the cache
+    void prefetchBucket(int bucket) const
+    {
+#if defined(__GNUC__)
+        __builtin_prefetch(keys_.data() + bucket * c_bucketSize);
+#else
+        GMX_UNUSED_VALUE(bucket);
+#endif
+    }
+
+    /*! \brief Returns the first free slot, empty or erased, in the probe sequence for \p key
+     *
+     * Only searches buckets in the range [\p bucketBegin, \p bucketEnd), wrapping around
+     * the end of the table when the range covers the whole table.
+     * Returns -1 when no free slot is available in the range.
+     */
+    int findFreeSlot(int key, int bucketBegin, int bucketEnd) const
+    {
+        const int slotMask = bucket_count() - 1;
+        int       slot     = homeSlot(key, homeBucket(key));
+        for (int n = 0; n <= slotMask; n++)
+        {
+            const int bucket = slot / c_bucketSize;
+            if (bucket < bucketBegin || bucket >= bucketEnd)
+            {
+                return -1;
+            }
+            if (keys_[slot] == c_emptyKey || keys_[slot] == c_erasedKey)
+            {
+                return slot;
+            }
+            slot = (slot + 1) & slotMask;
+        }
+        return -1;
+    }
+
+    //! Returns the first free slot in the probe sequence for \p key, the table should have space
+    int findFreeSlot(int key) const
+    {
+        const int slotMask = bucket_count() - 1;
+        int       slot     = homeSlot(key, homeBucket(key));
+        while (keys_[slot] != c_emptyKey && keys_[slot] != c_erasedKey)
+        {
+            slot = (slot + 1) & slotMask;
+        }
+        return slot;
+    }
 
-        /* Table size is a power of 2, so a binary mask gives the hash */
-        bitMask_                        = tableSize - 1;
-        startIndexForSpaceForListEntry_ = tableSize;
+    //! Stores \p key and \p value in the first free slot, the table should have space
+    void insertInFreeSlot(int key, const T& value)
+    {
+        const int slot = findFreeSlot(key);
+        if (keys_[slot] == c_emptyKey)
+        {
+            numUsedSlots_++;
+        }
+        keys_[slot]   = key;
+        values_[slot] = value;
+        numElements_++;
     }
 
 public:
@@ -126,8 +269,8 @@ public:
     /*! \brief Returns the number of elements */
     int size() const { return numElements_; }
 
-    /*! \brief Returns the number of buckets, i.e. the number of possible hashes */
-    int bucket_count() const { return bitMask_ + 1; }
+    /*! \brief Returns the number of slots in the table */
+    int bucket_count() const { return keys_.size(); }
 
 private:
     /*! \brief Inserts or assigns a key and value
@@ -135,73 +278,39 @@ private:
      * \tparam    allowAssign  Sets whether assignment of a key that is present is allowed
      * \param[in] key          The key for the entry
      * \param[in] value        The value for the entry
-     * \throws InvalidInputError from a debug build when attempting to insert a duplicate key with \p allowAssign=true
+     * \throws InvalidInputError from a debug build when attempting to insert a duplicate key with \p allowAssign=false
      */
     // cppcheck-suppress unusedPrivateFunction
     template<bool allowAssign>
     void insert_assign(int key, const T& value)
     {
-        size_t ind = (key & bitMask_);
+        GMX_ASSERT(key != c_emptyKey && key != c_erasedKey, "The key should not be a reserved value");
 
-        if (table_[ind].key >= 0)
+        // Note: This is performance critical, so we only check for duplicates in debug mode
+#ifdef NDEBUG
+        if (allowAssign)
+#endif
         {
-            /* Loop over the entries for this hash.
-             * If we find the matching key, return the value.
-             */
-            int ind_prev = ind;
-            if (table_[ind_prev].key == key)
+            const int slot = findSlot(key);
+            if (slot >= 0)
             {
                 if (allowAssign)
                 {
-                    table_[ind].value = value;
+                    values_[slot] = value;
                     return;
                 }
                 else
                 {
-// Note: This is performance critical, so we only throw in debug mode
-#ifndef NDEBUG
                     GMX_THROW(InvalidInputError("Attempt to insert duplicate key"));
-#endif
-                }
-            }
-            while (table_[ind_prev].next >= 0)
-            {
-                ind_prev = table_[ind_prev].next;
-                if (table_[ind_prev].key == key)
-                {
-                    if (allowAssign)
-                    {
-                        table_[ind_prev].value = value;
-                        return;
-                    }
-                    else
-                    {
-#ifndef NDEBUG
-                        GMX_THROW(InvalidInputError("Attempt to insert duplicate key"));
-#endif
-                    }
                 }
             }
-            /* Search for space in table_ */
-            ind = startIndexForSpaceForListEntry_;
-            while (ind < table_.size() && table_[ind].key >= 0)
-            {
-                ind++;
-            }
-            /* If we are at the end of the list we need to increase the size */
-            if (ind == table_.size())
-            {
-                table_.resize(table_.size() + 1);
-            }
-            table_[ind_prev].next = ind;
-
-            startIndexForSpaceForListEntry_ = ind + 1;
         }
 
-        table_[ind].key   = key;
-        table_[ind].value = value;
-
-        numElements_ += 1;
+        if (needsToGrow())
+        {
+            grow();
+        }
+        insertInFreeSlot(key, value);
     }
 
 public:
@@ -209,7 +318,8 @@ public:
      *
      * \param[in] key    The key for the entry
      * \param[in] value  The value for the entry
-     * \throws InvalidInputError from a debug build when attempting to inser         */
+     * \throws InvalidInputError from a debug build when attempting to insert a duplicate key
+     */
     void insert(int key, const T& value) { insert_assign<false>(key, value); }
 
     /*! \brief Inserts an entry when the key is not present, otherwise sets the value
@@ -225,34 +335,14 @@ public:
      */
     void erase(int key)
     {
-        int ind_prev = -1;
-        int ind      = (key & bitMask_);
-        do
+        const int slot = findSlot(key);
+        if (slot >= 0)
         {
-            if (table_[ind].key == key)
-            {
-                if (ind_prev >= 0)
-                {
-                    table_[ind_prev].next = table_[ind].next;
-
-                    /* This index is a linked entry, so we free an entry.
-                     * Check if we are creating the first empty space.
-                     */
-                    if (ind < startIndexForSpaceForListEntry_)
-                    {
-                        startIndexForSpaceForListEntry_ = ind;
-                    }
-                }
-                table_[ind].key  = -1;
-                table_[ind].next = -1;
+            /* Keep the slot occupied for the search of keys further along the probe sequence */
+            keys_[slot] = c_erasedKey;
 
-                numElements_ -= 1;
-
-                return;
-            }
-            ind_prev = ind;
-            ind      = table_[ind].next;
-        } while (ind >= 0);
+            numElements_ -= 1;
+        }
     }
 
     /*! \brief Returns a pointer to the value for the given key or nullptr when not present
@@ -269,17 +359,42 @@ public:
      */
     const T* find(int key) const
     {
-        int ind = (key & bitMask_);
-        do
+        const int slot = findSlot(key);
+
+        return (slot >= 0) ? &values_[slot] : nullptr;
+    }
+
+    /*! \brief Looks up multiple keys
+     *
+     * The keys are processed in groups of c_findBatchSize: the home buckets
+     * of a whole group are prefetched before any of them is probed, so
+     * the cache misses of different keys overlap instead of being
+     * paid one after the other as with a loop over find().
+     *
+     * \param[in]  keys    The keys to look up
+     * \param[out] values  Pointer to the value for each key, nullptr when not present
+     */
+    void findBatch(ArrayRef<const int> keys, ArrayRef<const T*> values) const
+    {
+        GMX_ASSERT(values.size() >= keys.size(), "The output should have space for all keys");
+
+        std::array<int, c_findBatchSize> buckets;
+        for (index start = 0; start < keys.ssize(); start += c_findBatchSize)
         {
-            if (table_[ind].key == key)
+            const int numKeys = std::min(keys.ssize() - start, static_cast<index>(c_findBatchSize));
+
+            /* Request all buckets of the group first, so their cache misses overlap */
+            for (int i = 0; i < numKeys; i++)
             {
-                return &table_[ind].value;
+                buckets[i] = homeBucket(keys[start + i]);
+                prefetchBucket(buckets[i]);
             }
-            ind = table_[ind].next;
-        } while (ind >= 0);
-
-        return nullptr;
+            for (int i = 0; i < numKeys; i++)
+            {
+                const int slot    = findSlot(keys[start + i], buckets[i]);
+                values[start + i] = (slot >= 0) ? &values_[slot] : nullptr;
+            }
+        }
     }
 
     /*! \brief Clear all the entries in the list
@@ -291,13 +406,9 @@ public:
     {
         const int oldNumElements = numElements_;
 
-        for (hashEntry& entry : table_)
-        {
-            entry.key  = -1;
-            entry.next = -1;
-        }
-        startIndexForSpaceForListEntry_ = bucket_count();
-        numElements_                    = 0;
+        std::fill(keys_.begin(), keys_.end(), c_emptyKey);
+        numElements_  = 0;
+        numUsedSlots_ = 0;
 
         /* Resize the hash table when the occupation is far from optimal.
          * Do not resize with 0 elements to avoid minimal size when clear()
@@ -311,15 +422,92 @@ public:
         }
     }
 
+    /*! \brief Makes sure \p numElementsToInsert more elements can be inserted without growing the table
+     *
+     * This is required before calling insertInBucketRange().
+     */
+    void reserve(int numElementsToInsert)
+    {
+        while ((static_cast<int64_t>(numUsedSlots_) + numElementsToInsert) * 16
+               > static_cast<int64_t>(bucket_count()) * c_maxUsedSixteenths)
+        {
+            grow();
+        }
+    }
+
+    //! Returns the number of buckets
+    int numBuckets() const { return bucketMask_ + 1; }
+
+    /*! \brief Inserts an entry when it can be stored in buckets [\p bucketBegin, \p bucketEnd)
+     *
+     * This allows threads to insert concurrently into disjoint bucket ranges.
+     * The key should not be present and reserve() should have been called
+     * for all keys to insert. The element count is not updated,
+     * the caller should call addInsertedElements() after all insertions.
+     *
+     * \param[in] key          The key for the entry
+     * \param[in] value        The value for the entry
+     * \param[in] bucketBegin  The first bucket this call may store in
+     * \param[in] bucketEnd    One past the last bucket this call may store in
+     * \param[in,out] numNewlyUsedSlots  Incremented when the entry is stored in an empty slot
+     * \returns whether the entry was inserted, false when it should be stored outside the range
+     */
+    bool insertInBucketRange(int key, const T& value, int bucketBegin, int bucketEnd,
+                             int* numNewlyUsedSlots)
+    {
+        const int slot = findFreeSlot(key, bucketBegin, bucketEnd);
+        if (slot < 0)
+        {
+            return false;
+        }
+        if (keys_[slot] == c_emptyKey)
+        {
+            (*numNewlyUsedSlots)++;
+        }
+        keys_[slot]   = key;
+        values_[slot] = value;
+
+        return true;
+    }
+
+    /*! \brief Updates the counts after insertions with insertInBucketRange()
+     *
+     * \param[in] numInserted        The number of elements inserted
+     * \param[in] numNewlyUsedSlots  The number of empty slots the elements were stored in
+     */
+    void addInsertedElements(int numInserted, int numNewlyUsedSlots)
+    {
+        numElements_ += numInserted;
+        numUsedSlots_ += numNewlyUsedSlots;
+    }
+
+    /*! \brief Returns the bucket at which the search for \p key starts
+     *
+     * Threads that use insertInBucketRange() should only process keys with
+     * the home bucket in their range.
+     */
+    int homeBucket(int key) const
+    {
+        /* Multiplication by 2^32 divided by the golden ratio mixes the bits
+         * of the quotient into the high bits, which select the bucket.
+         */
+        const uint32_t quotient = static_cast<uint32_t>(key) / c_bucketSize;
+        return static_cast<int>((quotient * 2654435769U) >> bucketShift_);
+    }
+
 private:
-    /*! \brief The hash table list */
-    std::vector<hashEntry> table_;
-    /*! \brief The bit mask for computing the hash of a key */
-    int bitMask_ = 0;
-    /*! \brief Index in table_ at which to start looking for empty space for a new linked list entry */
-    int startIndexForSpaceForListEntry_ = 0;
+    /*! \brief The keys, c_emptyKey for empty slots, c_erasedKey for erased slots */
+    std::vector<int, AlignedAllocator<int>> keys_;
+    /*! \brief The values, the value in slot i belongs to the key in slot i */
+    std::vector<T> values_;
+    /*! \brief The bit mask for wrapping the bucket index when probing */
+    int bucketMask_ = 0;
+    /*! \brief The right shift that turns the 32-bit hash into the home bucket */
+    int bucketShift_ = 32;
     /*! \brief The number of elements currently stored in the table */
     int numElements_ = 0;
+    /*! \brief The number of slots that are not empty, i.e. that store an element or are erased */
+    int numUsedSlots_ = 0;
 };
 
 } // namespace gmx
@@ -93,6 +93,7 @@
 #include "gromacs/utility/stringutil.h"
 #include "gromacs/utility/textwriter.h"
 
+#include "atomordering.h"
 #include "box.h"
 #include "cellsizes.h"
 #include "distribute.h"
@@ -481,8 +482,9 @@ static void make_dd_indices(gmx_domdec_t* dd, const int atomStart)
     const int*               zone_ncg1              = dd->comm->zone_ncg1;
     gmx::ArrayRef<const int> globalAtomGroupIndices = dd->globalAtomGroupIndices;
 
-    std::vector<int>& globalAtomIndices = dd->globalAtomIndices;
-    gmx_ga2la_t&      ga2la             = *dd->ga2la;
+    std::vector<int>&                globalAtomIndices = dd->globalAtomIndices;
+    gmx_ga2la_t&                     ga2la             = *dd->ga2la;
+    std::vector<gmx_ga2la_t::Entry>& ga2laEntries      = dd->comm->ga2laEntryBuffer;
 
     if (zone2cg[1] != dd->ncg_home)
     {
@@ -492,6 +494,7 @@ static void make_dd_indices(gmx_domdec_t* dd, const int atomStart)
     /* Make the local to global and global to local atom index */
     int a = atomStart;
     globalAtomIndices.resize(a);
+    ga2laEntries.clear();
     for (int zone = 0; zone < numZones; zone++)
     {
         int cg0;
@@ -516,10 +519,14 @@ static void make_dd_indices(gmx_domdec_t* dd, const int atomStart)
             }
             int cg_gl = globalAtomGroupIndices[cg];
             globalAtomIndices.push_back(cg_gl);
-            ga2la.insert(cg_gl, { a, zone1 });
+            ga2laEntries.push_back({ a, zone1 });
             a++;
         }
     }
+
+    ga2la.insertBatch(gmx::constArrayRefFromArray(globalAtomIndices.data() + atomStart,
+                                                  ga2laEntries.size()),
+                      ga2laEntries, gmx_omp_nthreads_get(emntDomdec));
 }
 
 //! Checks whether global and local atom indices are consistent.
@@ -2505,7 +2512,17 @@ static void dd_sort_state(gmx_domdec_t* dd, t_forcerec* fr, t_state* state)
 
     dd_sort_order_nbnxn(fr, &sort->sorted);
 
+    const DDAtomOrdering atomOrdering = dd->comm->ddSettings.atomOrdering;
+    if (atomOrdering != DDAtomOrdering::Grid)
+    {
+        dd_sort_order_locality(atomOrdering, dd->globalAtomGroupIndices, state->x,
+                               dd->comm->systemInfo.useUpdateGroups ? dd->comm->updateGroupsCog.get()
+                                                                    : nullptr,
+                               &sort->sorted);
+    }
+
     /* We alloc with the old size, since cgindex is still old */
+    const int                 numOldHomeAtoms = dd->ncg_home;
     DDBufferAccess<gmx::RVec> rvecBuffer(dd->comm->rvecBuffer, dd->ncg_home);
 
     /* Set the new home atom/charge group count */
@@ -2539,8 +2556,22 @@ static void dd_sort_state(gmx_domdec_t* dd, t_forcerec* fr, t_state* state)
     /* Set the home atom number */
     dd->comm->atomRanges.setEnd(DDAtomRanges::Type::Home, dd->ncg_home);
 
-    /* The atoms are now exactly in grid order, update the grid order */
-    fr->nbv->setLocalAtomOrder();
+    if (atomOrdering == DDAtomOrdering::Grid)
+    {
+        /* The atoms are now exactly in grid order, update the grid order */
+        fr->nbv->setLocalAtomOrder();
+    }
+    else
+    {
+        /* Renumber the atoms on the grid to their new local indices */
+        std::vector<int>& newAtomIndex = sort->intBuffer;
+        newAtomIndex.resize(numOldHomeAtoms);
+        for (int i = 0; i < cgsort.ssize(); i++)
+        {
+            newAtomIndex[cgsort[i].ind] = i;
+        }
+        fr->nbv->setLocalAtomOrder(newAtomIndex);
+    }
 }
 
 //! Accumulates load statistics.
@@ -0,0 +1,197 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for ordering the home atoms for locality with GMX_DD_ATOM_ORDER.
+ *
+ * \ingroup module_domdec
+ */
+#include "gmxpre.h"
+
+#include "gromacs/domdec/atomordering.h"
+
+#include <cstdlib>
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/random/threefry.h"
+#include "gromacs/random/uniformintdistribution.h"
+#include "gromacs/random/uniformrealdistribution.h"
+#include "gromacs/utility/arrayref.h"
+
+#include "testutils/testasserts.h"
+
+namespace
+{
+
+//! Returns unsorted entries for the local atoms 0 to \p numAtoms-1
+std::vector<gmx_cgsort_t> unsortedEntries(int numAtoms)
+{
+    std::vector<gmx_cgsort_t> sort(numAtoms);
+    for (int a = 0; a < numAtoms; a++)
+    {
+        sort[a].ind = a;
+    }
+    return sort;
+}
+
+//! Returns the global indices 0 to \p numAtoms-1 in random order
+std::vector<int> shuffledGlobalIndices(int numAtoms)
+{
+    std::vector<int> globalIndices(numAtoms);
+    std::iota(globalIndices.begin(), globalIndices.end(), 0);
+    gmx::DefaultRandomEngine rng(1);
+    for (int i = numAtoms - 1; i > 0; i--)
+    {
+        gmx::UniformIntDistribution<int> dist(0, i);
+        std::swap(globalIndices[i], globalIndices[dist(rng)]);
+    }
+    return globalIndices;
+}
+
+TEST(HilbertCurveTest, ConsecutiveIndicesAreNeighbors)
+{
+    /* The first (2^n)^3 points along the curve fill the cube with edge 2^n at the origin */
+    const int gridSize  = 16;
+    const int numPoints = gridSize * gridSize * gridSize;
+
+    std::vector<gmx::IVec> pointOfIndex(numPoints, { -1, -1, -1 });
+    for (int x = 0; x < gridSize; x++)
+    {
+        for (int y = 0; y < gridSize; y++)
+        {
+            for (int z = 0; z < gridSize; z++)
+            {
+                const ivec point = { x, y, z };
+                const int  index = hilbertCurveIndex(point);
+                ASSERT_GE(index, 0);
+                ASSERT_LT(index, numPoints) << "for point " << x << " " << y << " " << z;
+                EXPECT_EQ(pointOfIndex[index][XX], -1) << "index " << index << " occurs twice";
+                pointOfIndex[index] = { x, y, z };
+            }
+        }
+    }
+
+    for (int index = 1; index < numPoints; index++)
+    {
+        int distance = 0;
+        for (int d = 0; d < DIM; d++)
+        {
+            distance += std::abs(pointOfIndex[index][d] - pointOfIndex[index - 1][d]);
+        }
+        EXPECT_EQ(distance, 1) << "between the points with index " << index - 1 << " and " << index;
+    }
+}
+
+TEST(HilbertCurveTest, StartsAtOriginAndStaysInRange)
+{
+    const int  maxGridIndex = (1 << c_hilbertCurveBitsPerDim) - 1;
+    const ivec origin       = { 0, 0, 0 };
+    const ivec corner       = { maxGridIndex, maxGridIndex, maxGridIndex };
+
+    EXPECT_EQ(hilbertCurveIndex(origin), 0);
+    EXPECT_GE(hilbertCurveIndex(corner), 0);
+    EXPECT_LT(hilbertCurveIndex(corner), 1 << (DIM * c_hilbertCurveBitsPerDim));
+}
+
+TEST(DDAtomOrderingTest, MoleculeOrderSortsOnGlobalIndex)
+{
+    const int                    numAtoms      = 100;
+    const std::vector<int>       globalIndices = shuffledGlobalIndices(numAtoms);
+    const std::vector<gmx::RVec> x(numAtoms, { 0, 0, 0 });
+
+    std::vector<gmx_cgsort_t> sort = unsortedEntries(numAtoms);
+    dd_sort_order_locality(DDAtomOrdering::Molecule, globalIndices, x, nullptr, &sort);
+
+    ASSERT_EQ(sort.size(), static_cast<size_t>(numAtoms));
+    for (int i = 0; i < numAtoms; i++)
+    {
+        EXPECT_EQ(sort[i].ind_gl, i);
+        EXPECT_EQ(globalIndices[sort[i].ind], i);
+    }
+}
+
+TEST(DDAtomOrderingTest, HilbertCurveOrderFollowsCurve)
+{
+    const int              numAtoms      = 500;
+    const std::vector<int> globalIndices = shuffledGlobalIndices(numAtoms);
+
+    gmx::DefaultRandomEngine           rng(2);
+    gmx::UniformRealDistribution<real> dist(0, 3);
+    std::vector<gmx::RVec>             x(numAtoms);
+    for (gmx::RVec& xi : x)
+    {
+        xi = { dist(rng), dist(rng), dist(rng) };
+    }
+    /* Atoms at the same position should be ordered on global index */
+    for (int a = 0; a < 10; a++)
+    {
+        x[numAtoms - 1 - a] = x[a];
+    }
+
+    std::vector<gmx_cgsort_t> sort = unsortedEntries(numAtoms);
+    dd_sort_order_locality(DDAtomOrdering::HilbertCurve, globalIndices, x, nullptr, &sort);
+
+    ASSERT_EQ(sort.size(), static_cast<size_t>(numAtoms));
+    std::vector<int> numTimesSorted(numAtoms, 0);
+    for (int i = 0; i < numAtoms; i++)
+    {
+        numTimesSorted[sort[i].ind]++;
+        EXPECT_EQ(sort[i].ind_gl, globalIndices[sort[i].ind]);
+        if (i > 0)
+        {
+            EXPECT_TRUE(sort[i - 1].nsc < sort[i].nsc
+                        || (sort[i - 1].nsc == sort[i].nsc && sort[i - 1].ind_gl < sort[i].ind_gl))
+                    << "Entries " << i - 1 << " and " << i << " are not sorted";
+        }
+    }
+    EXPECT_TRUE(std::all_of(numTimesSorted.begin(), numTimesSorted.end(),
+                            [](int count) { return count == 1; }));
+    for (int a = 0; a < 10; a++)
+    {
+        const auto first = std::find_if(sort.begin(), sort.end(),
+                                        [a](const gmx_cgsort_t& entry) { return entry.ind == a; });
+        const auto second = std::find_if(sort.begin(), sort.end(), [a](const gmx_cgsort_t& entry) {
+            return entry.ind == numAtoms - 1 - a;
+        });
+        EXPECT_EQ(first->nsc, second->nsc);
+    }
+}
+
+} // namespace
@@ -0,0 +1,207 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for the global to local atom index mapping.
+ *
+ * \ingroup module_domdec
+ */
+#include "gmxpre.h"
+
+#include "gromacs/domdec/ga2la.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/utility/arrayref.h"
+
+#include "testutils/testasserts.h"
+
+namespace
+{
+
+/*! \brief The total number of atoms
+ *
+ * This is much larger than the number of local atoms, so gmx_ga2la_t
+ * uses the hash table and not the direct list.
+ */
+constexpr int c_numAtomsTotal = 1 << 28;
+//! The number of local atoms, enough to use 4 threads in insertBatch()
+constexpr int c_numAtomsLocal = 10000;
+
+/*! \brief Returns \p count sets of c_bucketSize consecutive keys that all have the last
+ * home bucket in a table sized for c_numAtomsLocal elements
+ *
+ * The keys are beyond the range used by globalAtomIndices() for the other atoms.
+ */
+std::vector<int> keysInLastBucket(int count)
+{
+    constexpr int c_bucketSize = gmx::HashedMap<gmx_ga2la_t::Entry>::c_bucketSize;
+
+    const gmx::HashedMap<gmx_ga2la_t::Entry> probe(c_numAtomsLocal);
+    std::vector<int>                         keys;
+    for (int quotient = 7 * c_numAtomsLocal / c_bucketSize + 1;
+         static_cast<int>(keys.size()) < count * c_bucketSize;
+         quotient++)
+    {
+        if (probe.homeBucket(quotient * c_bucketSize) == probe.numBuckets() - 1)
+        {
+            for (int j = 0; j < c_bucketSize; j++)
+            {
+                keys.push_back(quotient * c_bucketSize + j);
+            }
+        }
+    }
+    return keys;
+}
+
+/*! \brief Returns the global indices of the local atoms
+ *
+ * The last 64 atoms all have the same home bucket, which is the last bucket
+ * of the table. A bucket holds only 16 keys, so the other atoms have to be
+ * stored beyond the bucket range of the last thread and end up in the overflow
+ * path of insertBatch().
+ */
+std::vector<int> globalAtomIndices()
+{
+    std::vector<int> indices;
+    for (int i = 0; i < c_numAtomsLocal - 64; i++)
+    {
+        indices.push_back(7 * i);
+    }
+    for (int key : keysInLastBucket(4))
+    {
+        indices.push_back(key);
+    }
+    return indices;
+}
+
+//! Returns the entry to store for local atom \p a
+gmx_ga2la_t::Entry entryForAtom(int a)
+{
+    return { a, a % 3 };
+}
+
+//! Checks that all atoms in \p indices are found with the correct entries
+void checkFindsAll(const gmx_ga2la_t& ga2la, const std::vector<int>& indices)
+{
+    for (int a = 0; a < static_cast<int>(indices.size()); a++)
+    {
+        const gmx_ga2la_t::Entry* entry = ga2la.find(indices[a]);
+        ASSERT_NE(entry, nullptr) << "global atom " << indices[a];
+        EXPECT_EQ(entry->la, entryForAtom(a).la);
+        EXPECT_EQ(entry->cell, entryForAtom(a).cell);
+    }
+}
+
+TEST(GlobalToLocalAtoms, InsertBatchWithThreadsFindsAll)
+{
+    const std::vector<int>          indices = globalAtomIndices();
+    std::vector<gmx_ga2la_t::Entry> entries;
+    for (int a = 0; a < static_cast<int>(indices.size()); a++)
+    {
+        entries.push_back(entryForAtom(a));
+    }
+
+    for (int numThreads : { 1, 2, 4 })
+    {
+        gmx_ga2la_t ga2la(c_numAtomsTotal, c_numAtomsLocal);
+        ga2la.insertBatch(indices, entries, numThreads);
+        checkFindsAll(ga2la, indices);
+
+        // Atoms in between the inserted ones, and with the same home bucket
+        // as the full bucket, are not present
+        EXPECT_EQ(ga2la.find(1), nullptr);
+        EXPECT_EQ(ga2la.find(keysInLastBucket(5).back()), nullptr);
+    }
+}
+
+TEST(GlobalToLocalAtoms, InsertBatchWithThreadsReusesErasedSlots)
+{
+    const std::vector<int>          indices = globalAtomIndices();
+    std::vector<gmx_ga2la_t::Entry> entries;
+    for (int a = 0; a < static_cast<int>(indices.size()); a++)
+    {
+        entries.push_back(entryForAtom(a));
+    }
+
+    gmx_ga2la_t ga2la(c_numAtomsTotal, c_numAtomsLocal);
+    ga2la.insertBatch(indices, entries, 4);
+
+    // Erasing and reinserting, as for atoms moving between zones,
+    // stores atoms in erased slots, which should not count as new slots
+    for (int repeat = 0; repeat < 3; repeat++)
+    {
+        for (int index : indices)
+        {
+            ga2la.erase(index);
+        }
+        EXPECT_EQ(ga2la.find(indices[0]), nullptr);
+        ga2la.insertBatch(indices, entries, 4);
+        checkFindsAll(ga2la, indices);
+    }
+}
+
+TEST(GlobalToLocalAtoms, FindHomeBatchMatchesFindHome)
+{
+    const std::vector<int>          indices = globalAtomIndices();
+    std::vector<gmx_ga2la_t::Entry> entries;
+    for (int a = 0; a < static_cast<int>(indices.size()); a++)
+    {
+        entries.push_back(entryForAtom(a));
+    }
+
+    gmx_ga2la_t ga2la(c_numAtomsTotal, c_numAtomsLocal);
+    ga2la.insertBatch(indices, entries, 4);
+
+    // Look up a mix of home, non-home and absent atoms, more than fit in one batch
+    std::vector<int> lookups;
+    for (int i = 0; i < 1000; i++)
+    {
+        lookups.push_back(i);
+    }
+    lookups.insert(lookups.end(), indices.end() - 64, indices.end());
+
+    std::vector<int> localIndices(lookups.size());
+    ga2la.findHomeBatch(lookups, localIndices);
+    for (size_t i = 0; i < lookups.size(); i++)
+    {
+        const int* homeIndex = ga2la.findHome(lookups[i]);
+        EXPECT_EQ(localIndices[i], homeIndex ? *homeIndex : -1) << "global atom " << lookups[i];
+    }
+}
+
+} // namespace
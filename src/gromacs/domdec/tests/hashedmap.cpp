@@ -43,6 +43,8 @@
 
 #include "gromacs/domdec/hashedmap.h"
 
+#include <vector>
+
 #include <gtest/gtest.h>
 
 #include "testutils/testasserts.h"
@@ -207,4 +209,44 @@ TEST(HashedMap, ResizesTable)
     EXPECT_LT(map.bucket_count(), 128);
 }
 
+// Check that erased keys can be reinserted and found with findBatch()
+TEST(HashedMap, FindBatchWorks)
+{
+    gmx::HashedMap<int> map(20);
+
+    for (int i = 0; i < 20; i++)
+    {
+        map.insert(3 * i - 7, i);
+    }
+    map.erase(5);
+    map.erase(-7);
+    map.insert(5, 100);
+
+    const std::vector<int> keys = { -7, 5, 2, 50, 1000 };
+    std::vector<const int*> values(keys.size());
+    map.findBatch(keys, values);
+
+    EXPECT_EQ(values[0], nullptr);
+    ASSERT_NE(values[1], nullptr);
+    EXPECT_EQ(*values[1], 100);
+    ASSERT_NE(values[2], nullptr);
+    EXPECT_EQ(*values[2], 3);
+    ASSERT_NE(values[3], nullptr);
+    EXPECT_EQ(*values[3], 19);
+    EXPECT_EQ(values[4], nullptr);
+
+    // More keys than are processed in one group
+    std::vector<int> manyKeys;
+    for (int key = -10; key < 60; key++)
+    {
+        manyKeys.push_back(key);
+    }
+    std::vector<const int*> manyValues(manyKeys.size());
+    map.findBatch(manyKeys, manyValues);
+    for (size_t i = 0; i < manyKeys.size(); i++)
+    {
+        EXPECT_EQ(manyValues[i], map.find(manyKeys[i])) << "key " << manyKeys[i];
+    }
+}
+
 } // namespace
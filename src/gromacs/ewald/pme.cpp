@@ -833,6 +833,12 @@ gmx_pme_t* gmx_pme_init(const t_commrec*     cr,
     snew(pme->cfftgrid, pme->ngrids);
     snew(pme->pfft_setup, pme->ngrids);
 
+    /* Overlapping the FFT transposes with the FFTs costs extra buffers, only do this on request */
+    const FftTransposeMode fftTransposeMode =
+            (pme->nnodes > 1 && getenv("GMX_PME_PIPELINED_FFT") != nullptr)
+                    ? FftTransposeMode::Pipelined
+                    : FftTransposeMode::Blocking;
+
     for (i = 0; i < pme->ngrids; ++i)
     {
         if ((i < DO_Q && pme->doCoulomb && (i == 0 || bFreeEnergy_q))
@@ -850,7 +856,8 @@ gmx_pme_t* gmx_pme_init(const t_commrec*     cr,
                                                         ? gmx::PinningPolicy::PinnedIfSupported
                                                         : gmx::PinningPolicy::CannotBePinned;
             gmx_parallel_3dfft_init(&pme->pfft_setup[i], ndata, &pme->fftgrid[i], &pme->cfftgrid[i],
-                                    pme->mpi_comm_d, bReproducible, pme->nthread, allocateRealGridForGpu);
+                                    pme->mpi_comm_d, bReproducible, pme->nthread, fftTransposeMode,
+                                    allocateRealGridForGpu);
         }
     }
 
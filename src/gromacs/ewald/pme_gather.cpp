@@ -67,13 +67,14 @@ using namespace gmx; // TODO: Remove when this file is moved into gmx namespace
    the function the order argument can be used as regular int because
    integral_constant has a proper conversion.
 
-   SIMD do_fspline() template funtions will be used for PME order 4 and 5
+   SIMD do_fspline() template funtions will be used for PME order 4, 5 and 6
    when the SIMD module has support for SIMD4 for the architecture used.
    For SIMD4 without unaligned load/store support:
      order 4 and 5 use the order 4+5 aligned SIMD template
    For SIMD4 with unaligned load/store support:
      order 4 uses the order 4 unaligned SIMD template
      order 5 uses the order 4+5 aligned SIMD template
+   For all SIMD4 architectures order 6 uses the order 6 aligned SIMD template.
  */
 struct do_fspline
 {
@@ -211,6 +212,32 @@ struct do_fspline
         }
         *S0 = load4(buf_aligned);
         *S1 = load4(buf_aligned + 4);
+#    endif
+    }
+
+    /* Load order elements from unaligned memory into three 4-wide SIMD */
+    template<int order>
+    static inline void loadOrderU(const real* data,
+                                  std::integral_constant<int, order> /*unused*/,
+                                  int        offset,
+                                  Simd4Real* S0,
+                                  Simd4Real* S1,
+                                  Simd4Real* S2)
+    {
+#    ifdef PME_SIMD4_UNALIGNED
+        *S0 = load4U(data - offset);
+        *S1 = load4U(data - offset + 4);
+        *S2 = load4U(data - offset + 8);
+#    else
+        alignas(GMX_SIMD_ALIGNMENT) real buf_aligned[GMX_SIMD4_WIDTH * 3];
+        /* Copy data to an aligned buffer */
+        for (int i = 0; i < order; i++)
+        {
+            buf_aligned[offset + i] = data[i];
+        }
+        *S0 = load4(buf_aligned);
+        *S1 = load4(buf_aligned + 4);
+        *S2 = load4(buf_aligned + 8);
 #    endif
     }
 #endif
@@ -283,6 +310,73 @@ struct do_fspline
 
         return { reduce(fx_S), reduce(fy_S), reduce(fz_S) };
     }
+
+    /* This code assumes that the grid is allocated 4-real aligned,
+     * that pme->pmegrid_nz is a multiple of 4 and that the grid
+     * has 4 elements padding at the end.
+     * This code supports pme_order = 6 using three SIMD4 registers along z.
+     */
+    template<int Order>
+    std::enable_if_t<Order == 6, RVec> operator()(std::integral_constant<int, Order> order) const
+    {
+        const int norder = nn * order;
+        GMX_ASSERT(gridNZ % 4 == 0,
+                   "For aligned SIMD4 operations the grid size has to be padded up to a multiple "
+                   "of 4");
+        /* Pointer arithmetic alert, next six statements */
+        const real* const gmx_restrict thx  = spline->theta.coefficients[XX] + norder;
+        const real* const gmx_restrict thy  = spline->theta.coefficients[YY] + norder;
+        const real* const gmx_restrict thz  = spline->theta.coefficients[ZZ] + norder;
+        const real* const gmx_restrict dthx = spline->dtheta.coefficients[XX] + norder;
+        const real* const gmx_restrict dthy = spline->dtheta.coefficients[YY] + norder;
+        const real* const gmx_restrict dthz = spline->dtheta.coefficients[ZZ] + norder;
+
+        struct pme_spline_work* const work = pme->spline_work;
+
+        const int offset = idxZ & 3;
+
+        Simd4Real fx_S = setZero();
+        Simd4Real fy_S = setZero();
+        Simd4Real fz_S = setZero();
+
+        Simd4Real tz_S0, tz_S1, tz_S2, dz_S0, dz_S1, dz_S2;
+        loadOrderU(thz, order, offset, &tz_S0, &tz_S1, &tz_S2);
+        loadOrderU(dthz, order, offset, &dz_S0, &dz_S1, &dz_S2);
+
+        tz_S0 = selectByMask(tz_S0, work->mask_S0[offset]);
+        dz_S0 = selectByMask(dz_S0, work->mask_S0[offset]);
+        tz_S1 = selectByMask(tz_S1, work->mask_S1[offset]);
+        dz_S1 = selectByMask(dz_S1, work->mask_S1[offset]);
+        tz_S2 = selectByMask(tz_S2, work->mask_S2[offset]);
+        dz_S2 = selectByMask(dz_S2, work->mask_S2[offset]);
+
+        for (int ithx = 0; (ithx < order); ithx++)
+        {
+            const int       index_x = (idxX + ithx) * gridNY * gridNZ;
+            const Simd4Real tx_S    = Simd4Real(thx[ithx]);
+            const Simd4Real dx_S    = Simd4Real(dthx[ithx]);
+
+            for (int ithy = 0; (ithy < order); ithy++)
+            {
+                const real* const gridRow = grid + index_x + (idxY + ithy) * gridNZ + idxZ - offset;
+                const Simd4Real   ty_S    = Simd4Real(thy[ithy]);
+                const Simd4Real   dy_S    = Simd4Real(dthy[ithy]);
+
+                const Simd4Real gval_S0 = load4(gridRow);
+                const Simd4Real gval_S1 = load4(gridRow + 4);
+                const Simd4Real gval_S2 = load4(gridRow + 8);
+
+                const Simd4Real fxy1_S = fma(tz_S2, gval_S2, fma(tz_S1, gval_S1, tz_S0 * gval_S0));
+                const Simd4Real fz1_S  = fma(dz_S2, gval_S2, fma(dz_S1, gval_S1, dz_S0 * gval_S0));
+
+                fx_S = fma(dx_S * ty_S, fxy1_S, fx_S);
+                fy_S = fma(tx_S * dy_S, fxy1_S, fy_S);
+                fz_S = fma(tx_S * ty_S, fz1_S, fz_S);
+            }
+        }
+
+        return { reduce(fx_S), reduce(fy_S), reduce(fz_S) };
+    }
 #endif
 private:
     const gmx_pme_t* const pme;
@@ -348,6 +442,7 @@ void gather_f_bsplines(const gmx_pme_t*    pme,
             {
                 case 4: f = spline_func(std::integral_constant<int, 4>()); break;
                 case 5: f = spline_func(std::integral_constant<int, 5>()); break;
+                case 6: f = spline_func(std::integral_constant<int, 6>()); break;
                 default: f = spline_func(order); break;
             }
 
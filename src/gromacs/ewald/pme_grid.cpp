@@ -497,7 +497,7 @@ void unwrap_periodic_pmegrid(struct gmx_pme_t* pme, real* pmegrid)
 void set_grid_alignment(int gmx_unused* pmegrid_nz, int gmx_unused pme_order)
 {
 #ifdef PME_SIMD4_SPREAD_GATHER
-    if (pme_order == 5
+    if (pme_order == 5 || pme_order == 6
 #    if !PME_4NSIMD_GATHER
         || pme_order == 4
 #    endif
@@ -523,6 +523,13 @@ static void set_gridsize_alignment(int gmx_unused* gridsize, int gmx_unused pme_
         *gridsize += 4;
     }
 #    endif
+    if (pme_order == 6)
+    {
+        /* With pme_order=6 we operate on 3 SIMD4 registers along z,
+         * the last of which can extend 4 elements beyond the z-size.
+         */
+        *gridsize += 4;
+    }
 #endif
 }
 
@@ -181,6 +181,10 @@ struct splinedata_t
     SplineCoefficients theta;
     SplineCoefficients dtheta;
     int                nalloc = 0;
+    //! Scratch buffer for sorting \p ind by grid tile
+    std::vector<int> sortBuffer;
+    //! Scratch buffer with the atom count per grid tile
+    std::vector<int> tileCount;
 };
 
 /*! \brief PME slab MPI communication setup */
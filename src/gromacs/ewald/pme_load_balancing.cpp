@@ -186,6 +186,11 @@ struct pme_load_balancing_t
 
     int stage; /**< the current stage */
 
+    int     numPpRanks;           /**< the number of PP ranks */
+    int     numPmeRanks;          /**< the number of separate PME ranks */
+    float   pmeForceRatio;        /**< the PME/PP force time ratio with the chosen setup, -1 when not measured */
+    int64_t stepRelBalancingDone; /**< the relative step at which the balancing finished */
+
     int    cycles_n;  /**< step cycle counter cumulative count */
     double cycles_c;  /**< step cycle counter cumulative cycles */
     double startTime; /**< time stamp when the balancing was started on the master rank (relative to the UNIX epoch start).*/
@@ -226,6 +231,11 @@ void pme_loadbal_init(pme_load_balancing_t**     pme_lb_p,
 
     pme_lb->bSepPMERanks = !thisRankHasDuty(cr, DUTY_PME);
 
+    pme_lb->numPpRanks           = cr->nnodes - cr->npmenodes;
+    pme_lb->numPmeRanks          = cr->npmenodes;
+    pme_lb->pmeForceRatio        = -1;
+    pme_lb->stepRelBalancingDone = 0;
+
     /* Initially we turn on balancing directly on based on PP/PME imbalance */
     pme_lb->bTriggerOnDLB = FALSE;
 
@@ -920,6 +930,16 @@ void pme_loadbal_do(pme_load_balancing_t*          pme_lb,
 
     if (!pme_lb->bActive)
     {
+        /* Keep track of the PP/PME balance of the chosen setup for suggesting
+         * a PME rank count at the end. As dd_pme_f_ratio returns the ratio over
+         * the nstlist steps before the last nstlist steps, we need to wait two
+         * intervals after the balancing finished.
+         */
+        if (pme_lb->bSepPMERanks && !useGpuPmePpCommunication
+            && step_rel >= pme_lb->stepRelBalancingDone + 2 * ir.nstlist && DDMASTER(cr->dd))
+        {
+            pme_lb->pmeForceRatio = dd_pme_f_ratio(cr->dd);
+        }
         return;
     }
 
@@ -1066,6 +1086,11 @@ void pme_loadbal_do(pme_load_balancing_t*          pme_lb,
                 .appendText("NOTE: DLB can now turn on, when beneficial");
     }
 
+    if (!pme_lb->bActive)
+    {
+        pme_lb->stepRelBalancingDone = step_rel;
+    }
+
     *bPrinting = pme_lb->bBalance;
 }
 
@@ -1137,12 +1162,51 @@ static void print_pme_loadbal_settings(pme_load_balancing_t* pme_lb,
     }
 }
 
+/*! \brief Returns the number of PME ranks that would balance the measured PP and PME load
+ *
+ * Assumes that both the PP and the PME work scale linearly with the number of ranks
+ * and keeps the total number of ranks and at least half of them as PP ranks.
+ */
+static int balancedNumPmeRanks(const pme_load_balancing_t& pme_lb)
+{
+    const int    numRanks = pme_lb.numPpRanks + pme_lb.numPmeRanks;
+    const double pmeWork  = pme_lb.pmeForceRatio * pme_lb.numPmeRanks;
+    const double ppWork   = pme_lb.numPpRanks;
+    const int numPmeRanks = static_cast<int>(std::lround(numRanks * pmeWork / (pmeWork + ppWork)));
+
+    return std::max(1, std::min(numPmeRanks, numRanks / 2));
+}
+
+/*! \brief Print a suggestion for the number of PME ranks, when the measured balance is off */
+static void print_pme_rank_suggestion(const pme_load_balancing_t& pme_lb, const gmx::MDLogger& mdlog)
+{
+    if (!pme_lb.bSepPMERanks || pme_lb.pmeForceRatio <= 0)
+    {
+        return;
+    }
+
+    const int numPmeRanks = balancedNumPmeRanks(pme_lb);
+    if (numPmeRanks != pme_lb.numPmeRanks)
+    {
+        GMX_LOG(mdlog.info)
+                .asParagraph()
+                .appendTextFormatted(
+                        "With the tuned cut-off and PME grid the PME ranks took %.2f times the PP "
+                        "force time.\n"
+                        "For the next run, mdrun -npme %d (instead of %d) with %d total ranks "
+                        "is expected to give a better PP/PME balance.",
+                        pme_lb.pmeForceRatio, numPmeRanks, pme_lb.numPmeRanks,
+                        pme_lb.numPpRanks + pme_lb.numPmeRanks);
+    }
+}
+
 void pme_loadbal_done(pme_load_balancing_t* pme_lb, FILE* fplog, const gmx::MDLogger& mdlog, gmx_bool bNonBondedOnGPU)
 {
     if (fplog != nullptr && (pme_lb->cur > 0 || pme_lb->elimited != epmelblimNO))
     {
         print_pme_loadbal_settings(pme_lb, fplog, mdlog, bNonBondedOnGPU);
     }
+    print_pme_rank_suggestion(*pme_lb, mdlog);
 
     delete pme_lb;
 }
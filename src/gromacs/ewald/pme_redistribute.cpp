@@ -155,7 +155,8 @@ static void pme_calc_pidx_wrapper(gmx::ArrayRef<const gmx::RVec> x, const matrix
 
 void SplineCoefficients::realloc(const int nalloc)
 {
-    const int padding = 4;
+    /* With pme_order=6 the unaligned SIMD4 loads read up to 6 elements beyond the end */
+    const int padding = 8;
 
     bufferX_.resize(nalloc);
     coefficients[XX] = bufferX_.data();
@@ -41,7 +41,7 @@
 /* Check if we have 4-wide SIMD macro support */
 #if GMX_SIMD4_HAVE_REAL
 /* Do PME spread and gather with 4-wide SIMD.
- * NOTE: SIMD is only used with PME order 4 and 5 (which are the most common).
+ * NOTE: SIMD is only used with PME order 4, 5 and 6.
  */
 #    define PME_SIMD4_SPREAD_GATHER
 
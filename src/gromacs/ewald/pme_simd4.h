@@ -198,3 +198,66 @@
 #    undef PME_ORDER
 #    undef PME_SPREAD_SIMD4_ALIGNED
 #endif
+
+
+#ifdef PME_SPREAD_SIMD4_ORDER6
+/* Spread one charge with pme_order=6 using three aligned SIMD4 registers along z.
+ * This code assumes that the grid is allocated 4-real aligned,
+ * that pnz is a multiple of 4 and that the grid has 4 elements padding at the end.
+ */
+{
+    using namespace gmx;
+    Simd4Real ty_S[6];
+    Simd4Real tz_S0;
+    Simd4Real tz_S1;
+    Simd4Real tz_S2;
+
+    for (ithy = 0; ithy < 6; ithy++)
+    {
+        ty_S[ithy] = Simd4Real(thy[ithy]);
+    }
+
+    const int offset = k0 & 3;
+
+#    ifdef PME_SIMD4_UNALIGNED
+    tz_S0 = load4U(thz - offset);
+    tz_S1 = load4U(thz - offset + 4);
+    tz_S2 = load4U(thz - offset + 8);
+#    else
+    {
+        /* Copy thz to an aligned buffer (unused buffer parts are masked) */
+        for (int i = 0; i < 6; i++)
+        {
+            thz_aligned[offset + i] = thz[i];
+        }
+        tz_S0 = load4(thz_aligned);
+        tz_S1 = load4(thz_aligned + 4);
+        tz_S2 = load4(thz_aligned + 8);
+    }
+#    endif
+    tz_S0 = selectByMask(tz_S0, work->mask_S0[offset]);
+    tz_S1 = selectByMask(tz_S1, work->mask_S1[offset]);
+    tz_S2 = selectByMask(tz_S2, work->mask_S2[offset]);
+
+    for (ithx = 0; (ithx < 6); ithx++)
+    {
+        const int index = (i0 + ithx) * pny * pnz + j0 * pnz + k0 - offset;
+        valx            = coefficient * thx[ithx];
+
+        const Simd4Real vx_S     = Simd4Real(valx);
+        const Simd4Real vx_tz_S0 = vx_S * tz_S0;
+        const Simd4Real vx_tz_S1 = vx_S * tz_S1;
+        const Simd4Real vx_tz_S2 = vx_S * tz_S2;
+
+        for (ithy = 0; ithy < 6; ithy++)
+        {
+            real* gridRow = grid + index + ithy * pnz;
+
+            store4(gridRow, fma(vx_tz_S0, ty_S[ithy], load4(gridRow)));
+            store4(gridRow + 4, fma(vx_tz_S1, ty_S[ithy], load4(gridRow + 4)));
+            store4(gridRow + 8, fma(vx_tz_S2, ty_S[ithy], load4(gridRow + 8)));
+        }
+    }
+}
+#    undef PME_SPREAD_SIMD4_ORDER6
+#endif
@@ -55,9 +55,9 @@ pme_spline_work* make_pme_spline_work(int gmx_unused order)
     pme_spline_work* work;
 
 #ifdef PME_SIMD4_SPREAD_GATHER
-    alignas(GMX_SIMD_ALIGNMENT) real tmp[GMX_SIMD4_WIDTH * 2];
+    alignas(GMX_SIMD_ALIGNMENT) real tmp[GMX_SIMD4_WIDTH * 3];
     Simd4Real                        zero_S;
-    Simd4Real                        real_mask_S0, real_mask_S1;
+    Simd4Real                        real_mask_S0, real_mask_S1, real_mask_S2;
     int                              of, i;
 
     work = new (gmx::AlignedAllocationPolicy::malloc(sizeof(pme_spline_work))) pme_spline_work;
@@ -65,19 +65,21 @@ pme_spline_work* make_pme_spline_work(int gmx_unused order)
     zero_S = setZero();
 
     /* Generate bit masks to mask out the unused grid entries,
-     * as we only operate on order of the 8 grid entries that are
-     * load into 2 SIMD registers.
+     * as we only operate on order of the 8 (12 for order 6) grid entries
+     * that are loaded into 2 (3) SIMD registers.
      */
-    for (of = 0; of < 2 * GMX_SIMD4_WIDTH - (order - 1); of++)
+    for (of = 0; of < GMX_SIMD4_WIDTH; of++)
     {
-        for (i = 0; i < 2 * GMX_SIMD4_WIDTH; i++)
+        for (i = 0; i < 3 * GMX_SIMD4_WIDTH; i++)
         {
             tmp[i] = (i >= of && i < of + order ? -1.0 : 1.0);
         }
         real_mask_S0      = load4(tmp);
         real_mask_S1      = load4(tmp + GMX_SIMD4_WIDTH);
+        real_mask_S2      = load4(tmp + 2 * GMX_SIMD4_WIDTH);
         work->mask_S0[of] = (real_mask_S0 < zero_S);
         work->mask_S1[of] = (real_mask_S1 < zero_S);
+        work->mask_S2[of] = (real_mask_S2 < zero_S);
     }
 #else
     work = nullptr;
@@ -42,8 +42,11 @@
 struct pme_spline_work
 {
 #ifdef PME_SIMD4_SPREAD_GATHER
-    /* Masks for 4-wide SIMD aligned spreading and gathering */
-    gmx::Simd4Bool mask_S0[6], mask_S1[6];
+    /* Masks for 4-wide SIMD aligned spreading and gathering,
+     * indexed by the z-offset within a SIMD4 register.
+     * mask_S2 is only used with pme_order=6.
+     */
+    gmx::Simd4Bool mask_S0[GMX_SIMD4_WIDTH], mask_S1[GMX_SIMD4_WIDTH], mask_S2[GMX_SIMD4_WIDTH];
 #else
     int dummy; /* C89 requires that struct has at least one member */
 #endif
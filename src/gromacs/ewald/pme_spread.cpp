@@ -42,8 +42,10 @@
 #include "config.h"
 
 #include <cassert>
+#include <climits>
 
 #include <algorithm>
+#include <vector>
 
 #include "gromacs/ewald/pme.h"
 #include "gromacs/fft/parallel_3dfft.h"
@@ -207,6 +209,70 @@ static void make_thread_local_ind(const PmeAtomComm* atc, int thread, splinedata
     spline->n = n;
 }
 
+/*! \brief Sorts the atom indices of \p spline by x/y grid tile
+ *
+ * The spreading and gathering of consecutive atoms then accesses
+ * overlapping parts of the grid, which improves cache reuse.
+ * A stable counting sort is used, which is linear in the number of atoms.
+ * Must be called before the splines are computed, as the spline
+ * coefficients are stored in the order of \p spline->ind.
+ */
+static void sortThreadLocalIndByTile(const PmeAtomComm* atc, splinedata_t* spline)
+{
+    const int numAtoms = spline->n;
+    if (numAtoms <= 1)
+    {
+        return;
+    }
+
+    int* gmx_restrict ind = spline->ind.data();
+
+    /* Determine the tile ranges of our atoms */
+    int tileXMin = INT_MAX;
+    int tileXMax = 0;
+    int tileYMin = INT_MAX;
+    int tileYMax = 0;
+    for (int i = 0; i < numAtoms; i++)
+    {
+        const gmx::IVec& idx = atc->idx[ind[i]];
+        tileXMin             = std::min(tileXMin, idx[XX] / c_pmeSpreadTileSize);
+        tileXMax             = std::max(tileXMax, idx[XX] / c_pmeSpreadTileSize);
+        tileYMin             = std::min(tileYMin, idx[YY] / c_pmeSpreadTileSize);
+        tileYMax             = std::max(tileYMax, idx[YY] / c_pmeSpreadTileSize);
+    }
+    const int numTilesY = tileYMax - tileYMin + 1;
+    const int numTiles  = (tileXMax - tileXMin + 1) * numTilesY;
+    if (numTiles == 1)
+    {
+        return;
+    }
+
+    auto tileIndex = [&](int atomIndex) {
+        const gmx::IVec& idx = atc->idx[atomIndex];
+        return (idx[XX] / c_pmeSpreadTileSize - tileXMin) * numTilesY
+               + idx[YY] / c_pmeSpreadTileSize - tileYMin;
+    };
+
+    std::vector<int>& tileCount = spline->tileCount;
+    tileCount.assign(numTiles + 1, 0);
+    for (int i = 0; i < numAtoms; i++)
+    {
+        tileCount[tileIndex(ind[i]) + 1]++;
+    }
+    for (int t = 0; t < numTiles; t++)
+    {
+        tileCount[t + 1] += tileCount[t];
+    }
+
+    std::vector<int>& sortBuffer = spline->sortBuffer;
+    sortBuffer.resize(numAtoms);
+    for (int i = 0; i < numAtoms; i++)
+    {
+        sortBuffer[tileCount[tileIndex(ind[i])]++] = ind[i];
+    }
+    std::copy(sortBuffer.begin(), sortBuffer.end(), ind);
+}
+
 // At run time, the values of order used and asserted upon mean that
 // indexing out of bounds does not occur. However compilers don't
 // always understand that, so we suppress this warning for this code
@@ -339,7 +405,7 @@ static void spread_coefficients_bsplines_thread(const pmegrid_t*       pmegrid,
     int        offx, offy, offz;
 
 #if defined PME_SIMD4_SPREAD_GATHER && !defined PME_SIMD4_UNALIGNED
-    alignas(GMX_SIMD_ALIGNMENT) real thz_aligned[GMX_SIMD4_WIDTH * 2];
+    alignas(GMX_SIMD_ALIGNMENT) real thz_aligned[GMX_SIMD4_WIDTH * 3];
 #endif
 
     pnx = pmegrid->s[XX];
@@ -399,6 +465,14 @@ static void spread_coefficients_bsplines_thread(const pmegrid_t*       pmegrid,
 #    include "pme_simd4.h"
 #else
                     DO_BSPLINE(5)
+#endif
+                    break;
+                case 6:
+#ifdef PME_SIMD4_SPREAD_GATHER
+#    define PME_SPREAD_SIMD4_ORDER6
+#    include "pme_simd4.h"
+#else
+                    DO_BSPLINE(6)
 #endif
                     break;
                 default: DO_BSPLINE(order) break;
@@ -920,6 +994,7 @@ void spread_on_grid(const gmx_pme_t*  pme,
                 {
                     /* Get the indices our thread should operate on */
                     make_thread_local_ind(atc, thread, spline);
+                    sortThreadLocalIndByTile(atc, spline);
                 }
             }
 
@@ -41,6 +41,14 @@
 
 #include "pme_internal.h"
 
+/*! \brief The size in grid lines along x and y of the tiles we sort atoms into
+ *
+ * With multiple threads, the atoms of each thread are sorted by tile before
+ * spreading. A tile of 4x4 grid lines with the spreading footprint of order 4-6
+ * touches a part of the grid that, for typical grid sizes along z, fits in L1 cache.
+ */
+static constexpr int c_pmeSpreadTileSize = 4;
+
 void spread_on_grid(const gmx_pme_t*  pme,
                     PmeAtomComm*      atc,
                     const pmegrids_t* grids,
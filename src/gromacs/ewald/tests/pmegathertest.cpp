@@ -178,7 +178,7 @@ std::vector<RVec> const c_sampleForcesFull{
 };
 
 //! PME orders to test
-std::vector<int> const pmeOrders{ 3, 4, 5 };
+std::vector<int> const pmeOrders{ 3, 4, 5, 6 };
 //! Atom counts to test
 std::vector<size_t> const atomCounts{ 1, 2, 13 };
 
@@ -42,11 +42,19 @@
 
 #include "gmxpre.h"
 
+#include <cmath>
+
+#include <algorithm>
 #include <string>
+#include <vector>
 
 #include <gmock/gmock.h>
 
+#include "gromacs/ewald/pme_internal.h"
+#include "gromacs/ewald/pme_spread.h"
 #include "gromacs/mdtypes/inputrec.h"
+#include "gromacs/random/threefry.h"
+#include "gromacs/random/uniformrealdistribution.h"
 #include "gromacs/utility/stringutil.h"
 
 #include "testutils/refdata.h"
@@ -338,7 +346,7 @@ CoordinatesVector const c_sampleCoordinates13(c_sampleCoordinatesFull.begin() +
 //! moved out from instantiantions for readability
 auto c_inputBoxes = ::testing::ValuesIn(c_sampleBoxes);
 //! moved out from instantiantions for readability
-auto c_inputPmeOrders = ::testing::Range(3, 5 + 1);
+auto c_inputPmeOrders = ::testing::Range(3, 6 + 1);
 //! moved out from instantiantions for readability
 auto c_inputGridSizes = ::testing::ValuesIn(c_sampleGridSizes);
 
@@ -367,6 +375,141 @@ INSTANTIATE_TEST_CASE_P(SaneInput13,
                                            c_inputGridSizes,
                                            ::testing::Values(c_sampleCoordinates13),
                                            ::testing::Values(c_sampleCharges13)));
+
+/*! \brief Convenience typedef of input parameters for the multi-threaded spreading test
+ * - unit cell box, PME interpolation order, grid dimensions
+ */
+typedef std::tuple<Matrix3x3, int, IVec> SpreadThreadsInputParameters;
+
+/*! \brief Test fixture for charge spreading with multiple PME threads on the CPU
+ *
+ * With multiple threads, each thread sorts its atoms by grid tile and
+ * spreads them on a thread-local grid, after which the grids are reduced.
+ * The result should match spreading with a single thread.
+ */
+class PmeSplineAndSpreadThreadsTest : public ::testing::TestWithParam<SpreadThreadsInputParameters>
+{
+public:
+    //! The number of PME threads to compare with a single thread
+    static constexpr int c_numThreads = 4;
+    //! The number of atoms, enough to put several atoms in each tile of each thread
+    static constexpr int c_numAtoms = 500;
+
+    //! The test
+    void runTest()
+    {
+        Matrix3x3 box;
+        int       pmeOrder;
+        IVec      gridSize;
+        std::tie(box, pmeOrder, gridSize) = GetParam();
+
+        t_inputrec inputRec;
+        inputRec.nkx         = gridSize[XX];
+        inputRec.nky         = gridSize[YY];
+        inputRec.nkz         = gridSize[ZZ];
+        inputRec.pme_order   = pmeOrder;
+        inputRec.coulombtype = eelPME;
+        inputRec.epsilon_r   = 1.0;
+
+        /* Random atoms in the unit cell, with positive charges to avoid cancellation */
+        DefaultRandomEngine           rng(pmeOrder);
+        UniformRealDistribution<real> fractionDist(0, 1);
+        UniformRealDistribution<real> chargeDist(0.1, 1);
+        CoordinatesVector             coordinates(c_numAtoms, RVec{ 0, 0, 0 });
+        std::vector<real>             charges(c_numAtoms);
+        for (int i = 0; i < c_numAtoms; i++)
+        {
+            for (int d = 0; d < DIM; d++)
+            {
+                const real fraction = fractionDist(rng);
+                for (int m = 0; m < DIM; m++)
+                {
+                    coordinates[i][m] += fraction * box[d * DIM + m];
+                }
+            }
+            charges[i] = chargeDist(rng);
+        }
+
+        SCOPED_TRACE(formatString("Testing spreading with %d threads for PME grid size %d %d %d"
+                                  ", order %d, %d atoms",
+                                  c_numThreads, gridSize[XX], gridSize[YY], gridSize[ZZ],
+                                  pmeOrder, c_numAtoms));
+
+        std::vector<SparseRealGridValuesOutput> gridValues;
+        for (int numThreads : { 1, c_numThreads })
+        {
+            PmeSafePointer pmeSafe = pmeInitWrapper(&inputRec, CodePath::CPU, nullptr, nullptr,
+                                                    nullptr, box, 1.0F, 1.0F, numThreads);
+            pmeInitAtoms(pmeSafe.get(), nullptr, CodePath::CPU, coordinates, charges);
+            pmePerformSplineAndSpread(pmeSafe.get(), CodePath::CPU, true, true);
+            if (numThreads > 1)
+            {
+                checkThreadLocalAtomsAreSortedByTile(*pmeSafe);
+            }
+            gridValues.push_back(pmeGetRealGrid(pmeSafe.get(), CodePath::CPU));
+        }
+
+        /* The reduction over thread-local grids changes the summation order */
+        real maxAbsValue = 0;
+        for (const auto& point : gridValues[0])
+        {
+            maxAbsValue = std::max(maxAbsValue, std::abs(point.second));
+        }
+        const auto tolerance = relativeToleranceAsUlp(maxAbsValue, 64);
+        EXPECT_EQ(gridValues[0].size(), gridValues[1].size());
+        for (const auto& point : gridValues[0])
+        {
+            const auto threadedPoint = gridValues[1].find(point.first);
+            if (threadedPoint == gridValues[1].end())
+            {
+                ADD_FAILURE() << point.first << " is missing with " << c_numThreads << " threads";
+                continue;
+            }
+            EXPECT_REAL_EQ_TOL(point.second, threadedPoint->second, tolerance) << point.first;
+        }
+    }
+
+private:
+    //! Checks that each thread spreads its atoms ordered by tile and that all atoms are spread once
+    static void checkThreadLocalAtomsAreSortedByTile(const gmx_pme_t& pme)
+    {
+        const PmeAtomComm& atc = pme.atc[0];
+        std::vector<int>   numTimesSpread(c_numAtoms, 0);
+        for (int thread = 0; thread < pme.nthread; thread++)
+        {
+            const splinedata_t& spline = atc.spline[thread];
+            for (int i = 0; i < spline.n; i++)
+            {
+                numTimesSpread[spline.ind[i]]++;
+                if (i > 0)
+                {
+                    const IVec& previous = atc.idx[spline.ind[i - 1]];
+                    const IVec& current  = atc.idx[spline.ind[i]];
+                    const int   previousTileX = previous[XX] / c_pmeSpreadTileSize;
+                    const int   currentTileX  = current[XX] / c_pmeSpreadTileSize;
+                    EXPECT_TRUE(previousTileX < currentTileX
+                                || (previousTileX == currentTileX
+                                    && previous[YY] / c_pmeSpreadTileSize
+                                               <= current[YY] / c_pmeSpreadTileSize))
+                            << "Atoms " << i - 1 << " and " << i << " of thread " << thread
+                            << " are not sorted by tile";
+                }
+            }
+        }
+        EXPECT_THAT(numTimesSpread, ::testing::Each(1));
+    }
+};
+
+/*! \brief Test for charge spreading with multiple threads. */
+TEST_P(PmeSplineAndSpreadThreadsTest, MatchesSingleThread)
+{
+    EXPECT_NO_THROW_GMX(runTest());
+}
+
+/*! \brief Instantiation of the multi-threaded test with many atoms */
+INSTANTIATE_TEST_CASE_P(SaneInput,
+                        PmeSplineAndSpreadThreadsTest,
+                        ::testing::Combine(c_inputBoxes, c_inputPmeOrders, c_inputGridSizes));
 } // namespace
 } // namespace test
 } // namespace gmx
@@ -0,0 +1,199 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020,2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief Microbenchmark for the CPU PME spline, spread and gather kernels.
+ *
+ * Times the spline computation plus charge spreading, including the
+ * reduction of the thread-local grids, and the force gathering
+ * for a water-like system with PME orders 4, 5 and 6.
+ *
+ * Usage: pme-spread-benchmark [natoms [threads [steps]]]
+ *
+ * \ingroup module_ewald
+ */
+#include "gmxpre.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include <vector>
+
+#include "gromacs/domdec/domdec.h"
+#include "gromacs/ewald/pme.h"
+#include "gromacs/ewald/pme_gather.h"
+#include "gromacs/ewald/pme_grid.h"
+#include "gromacs/ewald/pme_internal.h"
+#include "gromacs/ewald/pme_spread.h"
+#include "gromacs/fft/calcgrid.h"
+#include "gromacs/math/invertmatrix.h"
+#include "gromacs/mdtypes/commrec.h"
+#include "gromacs/mdtypes/inputrec.h"
+#include "gromacs/mdtypes/md_enums.h"
+#include "gromacs/random/threefry.h"
+#include "gromacs/random/uniformrealdistribution.h"
+#include "gromacs/utility/exceptions.h"
+#include "gromacs/utility/logger.h"
+
+namespace
+{
+
+//! Times \p nsteps spread and gather steps with PME order \p pmeOrder and prints the rates.
+void runBenchmark(int                           pmeOrder,
+                  const std::vector<gmx::RVec>& x,
+                  const std::vector<real>&      q,
+                  real                          boxSize,
+                  int                           nthreads,
+                  int                           nsteps)
+{
+    using Clock = std::chrono::steady_clock;
+
+    matrix box = { { boxSize, 0, 0 }, { 0, boxSize, 0 }, { 0, 0, boxSize } };
+
+    t_inputrec ir;
+    ir.coulombtype = eelPME;
+    ir.pme_order   = pmeOrder;
+    ir.ewald_rtol  = 1e-5;
+    ir.nkx         = 0;
+    ir.nky         = 0;
+    ir.nkz         = 0;
+    calcFftGrid(nullptr, box, 0.125, minimalPmeGridSize(pmeOrder), &ir.nkx, &ir.nky, &ir.nkz);
+
+    /* The Ewald coefficient for a cut-off of 1 nm, its value does not affect the timings */
+    const real          ewaldCoeff = 3.12;
+    const gmx::MDLogger dummyLogger;
+    t_commrec           dummyCommrec  = { 0 };
+    NumPmeDomains       numPmeDomains = { 1, 1 };
+    gmx_pme_t* pme = gmx_pme_init(&dummyCommrec, numPmeDomains, &ir, false, false, true, ewaldCoeff,
+                                  0, nthreads, PmeRunMode::CPU, nullptr, nullptr, nullptr, nullptr,
+                                  dummyLogger);
+    gmx::invertBoxMatrix(box, pme->recipbox);
+
+    const int              natoms = x.size();
+    std::vector<gmx::RVec> f(natoms);
+    PmeAtomComm*           atc = &pme->atc[0];
+    atc->x                     = x;
+    atc->coefficient           = q;
+    gmx_pme_reinit_atoms(pme, natoms, q.data());
+    atc->f = f;
+
+    pmegrids_t* pmegrid = &pme->pmegrid[0];
+    real*       fftgrid = pme->fftgrid[0];
+    real*       grid    = pmegrid->grid.grid;
+
+    std::chrono::duration<double> spreadTime(0);
+    std::chrono::duration<double> gatherTime(0);
+    for (int step = 0; step < nsteps; step++)
+    {
+        const auto spreadStart = Clock::now();
+        spread_on_grid(pme, atc, pmegrid, TRUE, TRUE, fftgrid, TRUE, 0);
+        if (!pme->bUseThreads)
+        {
+            wrap_periodic_pmegrid(pme, grid);
+            copy_pmegrid_to_fftgrid(pme, grid, fftgrid, 0);
+        }
+        spreadTime += Clock::now() - spreadStart;
+
+        const auto gatherStart = Clock::now();
+#pragma omp parallel for num_threads(pme->nthread) schedule(static)
+        for (int thread = 0; thread < pme->nthread; thread++)
+        {
+            try
+            {
+                copy_fftgrid_to_pmegrid(pme, fftgrid, grid, 0, pme->nthread, thread);
+            }
+            GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+        }
+        unwrap_periodic_pmegrid(pme, grid);
+#pragma omp parallel for num_threads(pme->nthread) schedule(static)
+        for (int thread = 0; thread < pme->nthread; thread++)
+        {
+            try
+            {
+                gather_f_bsplines(pme, grid, TRUE, atc, &atc->spline[thread], 1.0);
+            }
+            GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+        }
+        gatherTime += Clock::now() - gatherStart;
+    }
+
+    const double atoms = static_cast<double>(natoms) * nsteps;
+    std::printf("order %d  grid %3d x %3d x %3d   spread %8.2f Matoms/s   gather %8.2f Matoms/s\n",
+                pmeOrder, ir.nkx, ir.nky, ir.nkz, 1e-6 * atoms / spreadTime.count(),
+                1e-6 * atoms / gatherTime.count());
+
+    gmx_pme_destroy(pme);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const int natoms   = (argc > 1) ? std::atoi(argv[1]) : 30000;
+    const int nthreads = (argc > 2) ? std::atoi(argv[2]) : 1;
+    const int nsteps   = (argc > 3) ? std::atoi(argv[3]) : 20;
+    if (natoms < 3 || nthreads < 1 || nsteps < 1)
+    {
+        std::fprintf(stderr, "Usage: %s [natoms [threads [steps]]]\n", argv[0]);
+        return 1;
+    }
+
+    /* Neutral groups of three atoms close to each other in a cubic box */
+    const real                         boxSize = std::cbrt(natoms / 100.0);
+    gmx::ThreeFry2x64<64>              rng(123456, gmx::RandomDomain::Other);
+    gmx::UniformRealDistribution<real> position(0, boxSize);
+    gmx::UniformRealDistribution<real> bond(-0.1, 0.1);
+    std::vector<gmx::RVec>             x(natoms);
+    std::vector<real>                  q(natoms);
+    for (int i = 0; i < natoms; i++)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            x[i][d] = (i % 3 == 0) ? position(rng) : x[i - 1][d] + bond(rng);
+            /* Put the atoms back in the unit cell */
+            x[i][d] = x[i][d] - boxSize * std::floor(x[i][d] / boxSize);
+        }
+        q[i] = (i % 3 == 0) ? -0.8 : 0.4;
+    }
+
+    std::printf("%d atoms, %d threads, %d steps\n", natoms, nthreads, nsteps);
+    for (int pmeOrder : { 4, 5, 6 })
+    {
+        runBenchmark(pmeOrder, x, q, boxSize, nthreads, nsteps);
+    }
+
+    return 0;
+}
@@ -121,7 +121,7 @@ uint64_t getSplineModuliDoublePrecisionUlps(int splineOrder);
 
 // PME stages
 
-//! PME initialization
+//! PME initialization, \p numThreads > 1 is only supported on the CPU
 PmeSafePointer pmeInitWrapper(const t_inputrec*    inputRec,
                               CodePath             mode,
                               const DeviceContext* deviceContext,
@@ -129,7 +129,8 @@ PmeSafePointer pmeInitWrapper(const t_inputrec*    inputRec,
                               const PmeGpuProgram* pmeGpuProgram,
                               const Matrix3x3&     box,
                               real                 ewaldCoeff_q  = 1.0F,
-                              real                 ewaldCoeff_lj = 1.0F);
+                              real                 ewaldCoeff_lj = 1.0F,
+                              int                  numThreads    = 1);
 //! Simple PME initialization (no atom data)
 PmeSafePointer pmeInitEmpty(const t_inputrec*    inputRec,
                             CodePath             mode,
@@ -155,6 +155,30 @@ static int vmax(const int* a, int s)
  * lin is allocated by fft5d because size of array is only known after planning phase
  * rlout2 is only used as intermediate buffer - only returned after allocation to reuse for back transform - should not be used by caller
  */
+/* The maximum number of chunks each transpose is split into with FFT5D_PIPELINED */
+static const int c_fft5dMaxPipelineChunks = 4;
+
+/* Returns whether transpose s exchanges the major axis (joined with joinAxesTrans13) */
+static bool fft5d_isTrans13(int flags, int s)
+{
+    return (s == 0 && !(flags & FFT5D_ORDER_YZ)) || (s == 1 && (flags & FFT5D_ORDER_YZ));
+}
+
+/* Returns the number of major-axis planes in each transpose block of step s,
+   this is identical on all ranks in the communicator of step s */
+static int fft5d_transposeNumPlanes(int flags, int s, const int K[], const int pK[])
+{
+    return fft5d_isTrans13(flags, s) ? K[s] : pK[s];
+}
+
+/* Returns the range of local lines, ordered major-axis first, of chunk c in step s */
+static void fft5d_chunkLines(int numPlanes, int numChunks, int c, int pM, int pK, int* lineStart, int* lineEnd)
+{
+    /* Only planes below pK contain local data */
+    *lineStart = std::min(c * numPlanes / numChunks, pK) * pM;
+    *lineEnd   = std::min((c + 1) * numPlanes / numChunks, pK) * pM;
+}
+
 fft5d_plan fft5d_plan_3d(int                NG,
                          int                MG,
                          int                KG,
@@ -442,9 +466,10 @@ fft5d_plan fft5d_plan_3d(int                NG,
             snew_aligned(lin, lsize, 32);
         }
         snew_aligned(lout, lsize, 32);
-        if (nthreads > 1)
+        if (nthreads > 1 || (flags & FFT5D_PIPELINED))
         {
-            /* We need extra transpose buffers to avoid OpenMP barriers */
+            /* We need extra transpose buffers to avoid OpenMP barriers
+               and, with pipelining, to overlap communication with the FFTs */
             snew_aligned(lout2, lsize, 32);
             snew_aligned(lout3, lsize, 32);
         }
@@ -459,7 +484,7 @@ fft5d_plan fft5d_plan_3d(int                NG,
     {
         lin  = *rlin;
         lout = *rlout;
-        if (nthreads > 1)
+        if (nthreads > 1 || (flags & FFT5D_PIPELINED))
         {
             lout2 = *rlout2;
             lout3 = *rlout3;
@@ -667,6 +692,48 @@ fft5d_plan fft5d_plan_3d(int                NG,
         plan->cart[1] = comm[0];
         plan->cart[0] = comm[1];
     }
+
+    /* For pipelined transposes, make 1D plans for the local lines of each chunk and thread */
+    int maxRequests = 0;
+    for (s = 0; s < 2; s++)
+    {
+        plan->numChunks[s] = 0;
+        plan->p1dChunk[s]  = nullptr;
+        if (!(flags & FFT5D_PIPELINED) || nP[s] <= 1)
+        {
+            continue;
+        }
+        const int numPlanes = fft5d_transposeNumPlanes(flags, s, K, pK);
+        const int numChunks = std::min(c_fft5dMaxPipelineChunks, numPlanes);
+        plan->numChunks[s]  = numChunks;
+        plan->p1dChunk[s] = static_cast<gmx_fft_t*>(calloc(numChunks * nthreads, sizeof(gmx_fft_t)));
+        for (int c = 0; c < numChunks; c++)
+        {
+            int lineStart, lineEnd;
+            fft5d_chunkLines(numPlanes, numChunks, c, pM[s], pK[s], &lineStart, &lineEnd);
+            const int numLines = lineEnd - lineStart;
+            for (int t = 0; t < nthreads; t++)
+            {
+                const int tsize = ((t + 1) * numLines / nthreads) - (t * numLines / nthreads);
+                if (tsize == 0)
+                {
+                    continue;
+                }
+                if ((flags & FFT5D_REALCOMPLEX) && !(flags & FFT5D_BACKWARD) && s == 0)
+                {
+                    gmx_fft_init_many_1d_real(&plan->p1dChunk[s][c * nthreads + t], rC[s], tsize,
+                                              (flags & FFT5D_NOMEASURE) ? GMX_FFT_FLAG_CONSERVATIVE : 0);
+                }
+                else
+                {
+                    gmx_fft_init_many_1d(&plan->p1dChunk[s][c * nthreads + t], C[s], tsize,
+                                         (flags & FFT5D_NOMEASURE) ? GMX_FFT_FLAG_CONSERVATIVE : 0);
+                }
+            }
+        }
+        maxRequests = std::max(maxRequests, 2 * nP[s] * numChunks);
+    }
+    plan->requests = static_cast<MPI_Request*>(malloc(std::max(maxRequests, 1) * sizeof(MPI_Request)));
 #ifdef FFT5D_MPI_TRANSPOSE
     FFTW_LOCK;
     for (s = 0; s < 2; s++)
@@ -1096,6 +1163,107 @@ static void print_localdata(const t_complex* lin, const char* txt, int s, fft5d_
     }
 }
 
+/*FFT, split and transpose of step s in chunks along the major axis.
+   After the FFT and split of a chunk, the master thread starts non-blocking sends and receives
+   for the chunk, which then overlap with the FFTs of the following chunks.
+   Has to be called by all threads, returns after all communication has completed on the
+   master thread, the caller needs to synchronize the threads before the join.*/
+static void fft5d_fft_transpose_pipelined(fft5d_plan plan, int s, int thread, fft5d_time times)
+{
+    int *N = plan->N, *M = plan->M, *K = plan->K, *pM = plan->pM, *pK = plan->pK, *C = plan->C,
+        *P = plan->P;
+    const int numChunks = plan->numChunks[s];
+    const int numPlanes = fft5d_transposeNumPlanes(plan->flags, s, K, pK);
+    /* The plane and block sizes match the counts of the blocking MPI_Alltoall */
+    const int planeSize = N[s] * (fft5d_isTrans13(plan->flags, s) ? pM[s] : M[s]);
+    const int blockSize = numPlanes * planeSize;
+
+    /* The chunks distribute the lines differently over the threads than the join
+       of the previous step, so all threads have to finish that join first */
+#pragma omp barrier
+
+    for (int c = 0; c < numChunks; c++)
+    {
+        int lineStart, lineEnd;
+        fft5d_chunkLines(numPlanes, numChunks, c, pM[s], pK[s], &lineStart, &lineEnd);
+        const int numLines = lineEnd - lineStart;
+        const int tstart   = lineStart + thread * numLines / plan->nthreads;
+        const int tend     = lineStart + (thread + 1) * numLines / plan->nthreads;
+
+#if GMX_MPI
+        if (thread == 0 && c > 0)
+        {
+            /* Let MPI progress the messages of the previous chunk */
+            for (int r = 0; r < 2 * P[s]; r++)
+            {
+                int flag;
+                MPI_Test(&plan->requests[2 * P[s] * (c - 1) + r], &flag, MPI_STATUS_IGNORE);
+            }
+        }
+#endif
+
+        if (tend > tstart)
+        {
+            gmx_fft_t p1d = plan->p1dChunk[s][c * plan->nthreads + thread];
+            if ((plan->flags & FFT5D_REALCOMPLEX) && !(plan->flags & FFT5D_BACKWARD) && s == 0)
+            {
+                gmx_fft_many_1d_real(p1d, GMX_FFT_REAL_TO_COMPLEX, plan->lin + tstart * C[s],
+                                     plan->lout + tstart * C[s]);
+            }
+            else
+            {
+                gmx_fft_many_1d(p1d, (plan->flags & FFT5D_BACKWARD) ? GMX_FFT_BACKWARD : GMX_FFT_FORWARD,
+                                plan->lin + tstart * C[s], plan->lout + tstart * C[s]);
+            }
+            splitaxes(plan->lout2, plan->lout, N[s], M[s], K[s], pM[s], P[s], C[s], plan->iNout[s],
+                      plan->oNout[s], tstart % pM[s], tstart / pM[s], tend % pM[s], tend / pM[s]);
+        }
+#pragma omp barrier /*all data of this chunk has to be split before sending*/
+
+        if (thread == 0)
+        {
+#if GMX_MPI
+#    ifndef NOGMX
+            wallcycle_start(times, ewcPME_FFTCOMM);
+#    endif
+            const int          offset = (c * numPlanes / numChunks) * planeSize;
+            const int          count  = ((c + 1) * numPlanes / numChunks) * planeSize - offset;
+            MPI_Request* const req    = plan->requests + 2 * P[s] * c;
+            for (int i = 0; i < P[s]; i++)
+            {
+                MPI_Irecv(reinterpret_cast<real*>(plan->lout3 + i * blockSize + offset),
+                          count * sizeof(t_complex) / sizeof(real), GMX_MPI_REAL, i, c,
+                          plan->cart[s], &req[i]);
+            }
+            for (int i = 0; i < P[s]; i++)
+            {
+                MPI_Isend(reinterpret_cast<real*>(plan->lout2 + i * blockSize + offset),
+                          count * sizeof(t_complex) / sizeof(real), GMX_MPI_REAL, i, c,
+                          plan->cart[s], &req[P[s] + i]);
+            }
+#    ifndef NOGMX
+            wallcycle_stop(times, ewcPME_FFTCOMM);
+#    endif
+#else
+            GMX_RELEASE_ASSERT(false, "Invalid call to fft5d_execute");
+#endif
+        }
+    }
+
+#if GMX_MPI
+    if (thread == 0)
+    {
+#    ifndef NOGMX
+        wallcycle_start(times, ewcPME_FFTCOMM);
+#    endif
+        MPI_Waitall(2 * P[s] * numChunks, plan->requests, MPI_STATUSES_IGNORE);
+#    ifndef NOGMX
+        wallcycle_stop(times, ewcPME_FFTCOMM);
+#    endif
+    }
+#endif
+}
+
 void fft5d_execute(fft5d_plan plan, int thread, fft5d_time times)
 {
     t_complex* lin   = plan->lin;
@@ -1173,6 +1341,8 @@ void fft5d_execute(fft5d_plan plan, int thread, fft5d_time times)
         }
 #endif
 
+        const bool bPipelined = bParallelDim && plan->numChunks[s] > 0;
+
         if (bParallelDim || plan->nthreads == 1)
         {
             fftout = lout;
@@ -1190,7 +1360,12 @@ void fft5d_execute(fft5d_plan plan, int thread, fft5d_time times)
         }
 
         tstart = (thread * pM[s] * pK[s] / plan->nthreads) * C[s];
-        if ((plan->flags & FFT5D_REALCOMPLEX) && !(plan->flags & FFT5D_BACKWARD) && s == 0)
+        if (bPipelined)
+        {
+            /* FFT, split and transpose in chunks, overlapping communication with the FFTs */
+            fft5d_fft_transpose_pipelined(plan, s, thread, times);
+        }
+        else if ((plan->flags & FFT5D_REALCOMPLEX) && !(plan->flags & FFT5D_BACKWARD) && s == 0)
         {
             gmx_fft_many_1d_real(p1d[s][thread],
                                  (plan->flags & FFT5D_BACKWARD) ? GMX_FFT_COMPLEX_TO_REAL
@@ -1217,7 +1392,7 @@ void fft5d_execute(fft5d_plan plan, int thread, fft5d_time times)
         /* ---------- END FFT ------------ */
 
         /* ---------- START SPLIT + TRANSPOSE------------ (if parallel in in this dimension)*/
-        if (bParallelDim)
+        if (bParallelDim && !bPipelined)
         {
 #ifdef NOGMX
             if (times != NULL && thread == 0)
@@ -1430,6 +1605,18 @@ void fft5d_destroy(fft5d_plan plan)
             plan->oNout[s] = nullptr;
         }
     }
+    for (s = 0; s < 2; s++)
+    {
+        if (plan->p1dChunk[s])
+        {
+            for (t = 0; t < plan->numChunks[s] * plan->nthreads; t++)
+            {
+                gmx_many_fft_destroy(plan->p1dChunk[s][t]);
+            }
+            free(plan->p1dChunk[s]);
+        }
+    }
+    free(plan->requests);
 #if GMX_FFT_FFTW3
     FFTW_LOCK
 #    ifdef FFT5D_MPI_TRANSPOS
@@ -1454,7 +1641,7 @@ void fft5d_destroy(fft5d_plan plan)
         }
         sfree_aligned(plan->lin);
         sfree_aligned(plan->lout);
-        if (plan->nthreads > 1)
+        if (plan->nthreads > 1 || (plan->flags & FFT5D_PIPELINED))
         {
             sfree_aligned(plan->lout2);
             sfree_aligned(plan->lout3);
@@ -89,7 +89,8 @@ typedef enum fft5d_flags_t
     FFT5D_DEBUG       = 8,
     FFT5D_NOMEASURE   = 16,
     FFT5D_INPLACE     = 32,
-    FFT5D_NOMALLOC    = 64
+    FFT5D_NOMALLOC    = 64,
+    FFT5D_PIPELINED   = 128
 } fft5d_flags;
 
 struct fft5d_plan_t
@@ -104,6 +105,12 @@ struct fft5d_plan_t
 #endif
     MPI_Comm cart[2];
 
+    /* With FFT5D_PIPELINED, the parallel FFT steps are split into chunks along the major axis,
+       the transposes of finished chunks overlap with the FFTs of later chunks */
+    int          numChunks[2]; /*number of chunks for each transpose, 0: blocking transpose*/
+    gmx_fft_t*   p1dChunk[2];  /*1D plans for each chunk and thread*/
+    MPI_Request* requests;     /*send and receive requests for all chunks of one transpose*/
+
     int  N[3], M[3], K[3]; /*local length in transposed coordinate system (if not divisisable max)*/
     int  pN[3], pM[3], pK[3]; /*local length - not max but length for this processor*/
     int  oM[3], oK[3];        /*offset for current processor*/
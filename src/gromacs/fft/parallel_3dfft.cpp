@@ -60,6 +60,7 @@ int gmx_parallel_3dfft_init(gmx_parallel_3dfft_t* pfft_setup,
                             MPI_Comm              comm[2],
                             gmx_bool              bReproducible,
                             int                   nthreads,
+                            FftTransposeMode      transposeMode,
                             gmx::PinningPolicy    realGridAllocation)
 {
     int        rN = ndata[2], M = ndata[1], K = ndata[0];
@@ -73,6 +74,10 @@ int gmx_parallel_3dfft_init(gmx_parallel_3dfft_t* pfft_setup,
     {
         flags |= FFT5D_NOMEASURE;
     }
+    if (transposeMode == FftTransposeMode::Pipelined)
+    {
+        flags |= FFT5D_PIPELINED;
+    }
 
     if (!(flags & FFT5D_ORDER_YZ))
     {
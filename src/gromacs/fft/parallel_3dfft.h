@@ -47,6 +47,15 @@
 
 typedef struct gmx_parallel_3dfft* gmx_parallel_3dfft_t;
 
+/*! \brief How data is transposed between the 1D FFT steps of a parallel 3D-FFT */
+enum class FftTransposeMode : int
+{
+    //! Blocking all-to-all communication after each complete 1D FFT step
+    Blocking,
+    //! Each 1D FFT step is split into chunks, the non-blocking communication of finished chunks overlaps with the FFTs of later chunks
+    Pipelined
+};
+
 
 /*! \brief Initialize parallel MPI-based 3D-FFT.
  *
@@ -69,6 +78,8 @@ typedef struct gmx_parallel_3dfft* gmx_parallel_3dfft_t;
  *                        that could make results differ for two runs with
  *                        identical input (reproducibility for debugging).
  *  \param nthreads       Run in parallel using n threads
+ *  \param transposeMode  Whether to use blocking or pipelined transposes, only
+ *                        affects runs with more than one rank.
  *  \param realGridAllocation  Whether to make real grid use allocation pinned for GPU transfers.
  *                             Only used in PME mixed CPU+GPU mode.
  *
@@ -81,6 +92,7 @@ int gmx_parallel_3dfft_init(gmx_parallel_3dfft_t* pfft_setup,
                             MPI_Comm              comm[2],
                             gmx_bool              bReproducible,
                             int                   nthreads,
+                            FftTransposeMode      transposeMode = FftTransposeMode::Blocking,
                             gmx::PinningPolicy realGridAllocation = gmx::PinningPolicy::CannotBePinned);
 
 
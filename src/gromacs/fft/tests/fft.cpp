@@ -276,7 +276,7 @@ TEST_F(FFTTest, Real2DLength18_15Test)
     //    _checker.checkSequenceArray(rx*ny, out, "backward");
 }
 
-// TODO: test with threads and more than 1 MPI ranks
+// Tests with threads and more than 1 MPI rank are in fft_mpi.cpp
 TEST_F(FFFTest3D, Real5_6_9)
 {
     int        ndata[] = { 5, 6, 9 };
@@ -0,0 +1,239 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests the parallel 3D-FFT with multiple ranks.
+ *
+ * The pipelined transposes split each 1D FFT step into chunks and overlap
+ * the communication of finished chunks with the FFTs of later chunks.
+ * This should give the same result as the blocking transposes.
+ *
+ * \ingroup module_fft
+ */
+#include "gmxpre.h"
+
+#include <cmath>
+
+#include <algorithm>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/fft/parallel_3dfft.h"
+#include "gromacs/math/vectypes.h"
+#include "gromacs/utility/exceptions.h"
+#include "gromacs/utility/gmxmpi.h"
+#include "gromacs/utility/gmxomp.h"
+
+#include "testutils/mpitest.h"
+#include "testutils/testasserts.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! The number of ranks this test runs with
+constexpr int c_numRanks = 4;
+
+//! The local output of a forward and a backward 3D-FFT on one rank
+struct FftResult
+{
+    //! The local complex grid after the real-to-complex transform, as real and imaginary parts
+    std::vector<real> forward;
+    //! The local real grid after transforming the complex grid back
+    std::vector<real> backward;
+};
+
+//! Returns the input value for the grid point with global indices \p x, \p y and \p z
+real inputValue(int x, int y, int z)
+{
+    return std::sin(0.3 * x + 0.7 * y + 1.1 * z) + 0.1 * x - 0.05 * z;
+}
+
+//! Runs a forward and backward 3D-FFT of \p gridSize over communicators \p comm
+FftResult runFft(const IVec& gridSize, MPI_Comm comm[2], int numThreads, FftTransposeMode transposeMode)
+{
+    gmx_parallel_3dfft_t fft;
+    real*                realData;
+    t_complex*           complexData;
+    ivec                 ndata = { gridSize[XX], gridSize[YY], gridSize[ZZ] };
+    gmx_parallel_3dfft_init(&fft, ndata, &realData, &complexData, comm, TRUE, numThreads, transposeMode);
+
+    ivec realNData, realOffset, realSize;
+    gmx_parallel_3dfft_real_limits(fft, realNData, realOffset, realSize);
+    ivec complexOrder, complexNData, complexOffset, complexSize;
+    gmx_parallel_3dfft_complex_limits(fft, complexOrder, complexNData, complexOffset, complexSize);
+
+    std::fill(realData, realData + realSize[XX] * realSize[YY] * realSize[ZZ], 0);
+    for (int x = 0; x < realNData[XX]; x++)
+    {
+        for (int y = 0; y < realNData[YY]; y++)
+        {
+            for (int z = 0; z < realNData[ZZ]; z++)
+            {
+                realData[(x * realSize[YY] + y) * realSize[ZZ] + z] = inputValue(
+                        realOffset[XX] + x, realOffset[YY] + y, realOffset[ZZ] + z);
+            }
+        }
+    }
+
+    FftResult result;
+    for (gmx_fft_direction direction : { GMX_FFT_REAL_TO_COMPLEX, GMX_FFT_COMPLEX_TO_REAL })
+    {
+#pragma omp parallel num_threads(numThreads)
+        {
+            try
+            {
+                gmx_parallel_3dfft_execute(fft, direction, gmx_omp_get_thread_num(), nullptr);
+            }
+            GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+        }
+
+        if (direction == GMX_FFT_REAL_TO_COMPLEX)
+        {
+            /* The complex grid is stored transposed, in complexOrder, skip the padding */
+            const int* n    = complexNData;
+            const int* size = complexSize;
+            const int* o    = complexOrder;
+            for (int i0 = 0; i0 < n[o[0]]; i0++)
+            {
+                for (int i1 = 0; i1 < n[o[1]]; i1++)
+                {
+                    for (int i2 = 0; i2 < n[o[2]]; i2++)
+                    {
+                        const t_complex& value = complexData[(i0 * size[o[1]] + i1) * size[o[2]] + i2];
+                        result.forward.push_back(value.re);
+                        result.forward.push_back(value.im);
+                    }
+                }
+            }
+        }
+        else
+        {
+            for (int x = 0; x < realNData[XX]; x++)
+            {
+                for (int y = 0; y < realNData[YY]; y++)
+                {
+                    for (int z = 0; z < realNData[ZZ]; z++)
+                    {
+                        result.backward.push_back(realData[(x * realSize[YY] + y) * realSize[ZZ] + z]);
+                    }
+                }
+            }
+        }
+    }
+
+    gmx_parallel_3dfft_destroy(fft);
+
+    return result;
+}
+
+/*! \brief Parameters: grid size, number of ranks along the major decomposition axis,
+ * number of OpenMP threads per rank
+ */
+typedef std::tuple<IVec, int, int> ParallelFftParameters;
+
+//! Test fixture for the parallel 3D-FFT with multiple ranks
+class ParallelFftTest : public ::testing::TestWithParam<ParallelFftParameters>
+{
+};
+
+TEST_P(ParallelFftTest, PipelinedTransposesMatchBlockingTransposes)
+{
+    GMX_MPI_TEST(c_numRanks);
+
+    IVec gridSize;
+    int  numRanksMajor;
+    int  numThreads;
+    std::tie(gridSize, numRanksMajor, numThreads) = GetParam();
+
+    /* Set up the decomposition in the same way as PME does */
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm comm[2];
+    if (numRanksMajor == 1)
+    {
+        comm[0] = MPI_COMM_NULL;
+        comm[1] = MPI_COMM_WORLD;
+    }
+    else
+    {
+        const int numRanksMinor = c_numRanks / numRanksMajor;
+        MPI_Comm_split(MPI_COMM_WORLD, rank % numRanksMinor, rank, &comm[0]);
+        MPI_Comm_split(MPI_COMM_WORLD, rank / numRanksMinor, rank, &comm[1]);
+    }
+
+    const FftResult blocking  = runFft(gridSize, comm, numThreads, FftTransposeMode::Blocking);
+    const FftResult pipelined = runFft(gridSize, comm, numThreads, FftTransposeMode::Pipelined);
+
+    if (numRanksMajor > 1)
+    {
+        MPI_Comm_free(&comm[0]);
+        MPI_Comm_free(&comm[1]);
+    }
+
+    /* Both modes perform the same 1D FFTs, only the communication differs */
+    const real magnitude = gridSize[XX] * gridSize[YY] * gridSize[ZZ];
+    const auto tolerance = relativeToleranceAsUlp(magnitude, 16);
+    ASSERT_EQ(blocking.forward.size(), pipelined.forward.size());
+    for (size_t i = 0; i < blocking.forward.size(); i++)
+    {
+        EXPECT_REAL_EQ_TOL(blocking.forward[i], pipelined.forward[i], tolerance)
+                << "forward element " << i << " on rank " << rank;
+    }
+    ASSERT_EQ(blocking.backward.size(), pipelined.backward.size());
+    for (size_t i = 0; i < blocking.backward.size(); i++)
+    {
+        EXPECT_REAL_EQ_TOL(blocking.backward[i], pipelined.backward[i], tolerance)
+                << "backward element " << i << " on rank " << rank;
+    }
+}
+
+//! Grid sizes that divide evenly and unevenly over the ranks
+const std::vector<IVec> c_gridSizes = { IVec{ 12, 16, 10 }, IVec{ 17, 11, 14 } };
+
+INSTANTIATE_TEST_CASE_P(Decompositions,
+                        ParallelFftTest,
+                        ::testing::Combine(::testing::ValuesIn(c_gridSizes),
+                                           ::testing::Values(1, 2),
+                                           ::testing::Values(1, 3)));
+
+} // namespace
+} // namespace test
+} // namespace gmx
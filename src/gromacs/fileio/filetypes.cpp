@@ -49,6 +49,7 @@ enum
     eftASC,
     eftXDR,
     eftTNG,
+    eftBIN,
     eftGEN,
     eftNR
 };
@@ -138,6 +139,7 @@ static const t_deffile deffile[efNR] = {
     { eftASC, ".edi", "sam", nullptr, "ED sampling input" },
     { eftASC, ".cub", "pot", nullptr, "Gaussian cube file" },
     { eftASC, ".xpm", "root", nullptr, "X PixMap compatible matrix file" },
+    { eftBIN, ".gcs", "plot", nullptr, "Compressed binary plot data" },
     { eftASC, "", "rundir", nullptr, "Run directory" }
 };
 
@@ -83,6 +83,7 @@ enum GromacsFileType
     efEDI,
     efCUB,
     efXPM,
+    efGCS,
     efRND,
     efNR
 };
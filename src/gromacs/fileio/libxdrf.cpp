@@ -39,6 +39,7 @@
 
 #include <climits>
 #include <cmath>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -369,6 +370,295 @@ static void receiveints(int buf[], const int num_of_ints, int num_of_bits, const
     nums[0] = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (bytes[3] << 24);
 }
 
+/*____________________________________________________________________________
+ |
+ | Bit streams used by xdr3dfcoord
+ |
+ | The compressed coordinates are a stream of bit fields, written most
+ | significant bit first. The reference streams use sendbits() etc. above,
+ | which keep their state in buf[0-2] and handle (at most) a byte at a time.
+ | The default streams produce the identical stream, but keep up to 64 bits
+ | in a register and pack/unpack the 'small' integers of sendints() and
+ | receiveints() with native 32- or 64-bit arithmetic when they fit, instead
+ | of with the byte-wise multi-precision arithmetic.
+ |
+ */
+
+/* Reverses the byte order of x */
+static inline unsigned int reverseBytes(unsigned int x)
+{
+    return ((x & 0xffU) << 24U) | ((x & 0xff00U) << 8U) | ((x >> 8U) & 0xff00U) | (x >> 24U);
+}
+
+/* Returns a mask with the lowest num_of_bits bits set, num_of_bits <= 32 */
+static inline unsigned int lowBitMask(int num_of_bits)
+{
+    return static_cast<unsigned int>((static_cast<uint64_t>(1) << num_of_bits) - 1);
+}
+
+class ReferenceBitWriter
+{
+public:
+    explicit ReferenceBitWriter(int buf[]) : buf_(buf) {}
+
+    void sendbits(int num_of_bits, int num) { ::sendbits(buf_, num_of_bits, num); }
+    void sendints(int num_of_bits, unsigned int sizes[], unsigned int nums[])
+    {
+        ::sendints(buf_, 3, num_of_bits, sizes, nums);
+    }
+    /* Flushes the last partial byte and stores the byte count in buf[0] */
+    void finish()
+    {
+        if (buf_[1] != 0)
+        {
+            buf_[0]++;
+        }
+    }
+
+private:
+    int* buf_;
+};
+
+class ReferenceBitReader
+{
+public:
+    explicit ReferenceBitReader(int buf[]) : buf_(buf) { buf_[0] = buf_[1] = buf_[2] = 0; }
+
+    int  receivebits(int num_of_bits) { return ::receivebits(buf_, num_of_bits); }
+    void receiveints(int num_of_bits, const unsigned int sizes[], int nums[])
+    {
+        ::receiveints(buf_, 3, num_of_bits, sizes, nums);
+    }
+
+private:
+    int* buf_;
+};
+
+class XtcBitWriter
+{
+public:
+    /* Writes to the bytes following buf[0-2], like sendbits() */
+    explicit XtcBitWriter(int buf[]) :
+        buf_(buf),
+        cbuf_(reinterpret_cast<unsigned char*>(buf) + 3 * sizeof(*buf)),
+        cnt_(0),
+        bits_(0),
+        numBits_(0)
+    {
+    }
+
+    /* Appends the lowest num_of_bits (<= 32) bits of num */
+    void sendbits(int num_of_bits, unsigned int num)
+    {
+        bits_ = (bits_ << num_of_bits) | (num & lowBitMask(num_of_bits));
+        numBits_ += num_of_bits;
+        while (numBits_ >= 8)
+        {
+            numBits_ -= 8;
+            cbuf_[cnt_++] = static_cast<unsigned char>(bits_ >> numBits_);
+        }
+    }
+    /* Same as sendints() for three integers */
+    void sendints(int num_of_bits, const unsigned int sizes[], const unsigned int nums[])
+    {
+        if (num_of_bits > 64)
+        {
+            sendintsMultiPrecision(num_of_bits, sizes, nums);
+            return;
+        }
+        /* The combined number is sent as little-endian bytes, each of
+         * which is sent most significant bit first, followed by the
+         * remaining bits. */
+        uint64_t num = (static_cast<uint64_t>(nums[0]) * sizes[1] + nums[1]) * sizes[2] + nums[2];
+        while (num_of_bits >= 32)
+        {
+            sendbits(32, reverseBytes(static_cast<unsigned int>(num)));
+            num >>= 32U;
+            num_of_bits -= 32;
+        }
+        while (num_of_bits >= 8)
+        {
+            sendbits(8, static_cast<unsigned int>(num) & 0xffU);
+            num >>= 8U;
+            num_of_bits -= 8;
+        }
+        if (num_of_bits > 0)
+        {
+            sendbits(num_of_bits, static_cast<unsigned int>(num) & lowBitMask(num_of_bits));
+        }
+    }
+    /* Flushes the last partial byte and stores the byte count in buf[0] */
+    void finish()
+    {
+        if (numBits_ > 0)
+        {
+            cbuf_[cnt_++] = static_cast<unsigned char>(bits_ << (8 - numBits_));
+        }
+        buf_[0] = cnt_;
+    }
+
+private:
+    /* Packs numbers that do not fit in 64 bits, as in sendints() */
+    void sendintsMultiPrecision(int num_of_bits, const unsigned int sizes[], const unsigned int nums[])
+    {
+        unsigned int bytes[32], tmp;
+        int          num_of_bytes = 0, bytecnt;
+
+        tmp = nums[0];
+        do
+        {
+            bytes[num_of_bytes++] = tmp & 0xffU;
+            tmp >>= 8U;
+        } while (tmp != 0);
+        for (int i = 1; i < 3; i++)
+        {
+            tmp = nums[i];
+            for (bytecnt = 0; bytecnt < num_of_bytes; bytecnt++)
+            {
+                tmp            = bytes[bytecnt] * sizes[i] + tmp;
+                bytes[bytecnt] = tmp & 0xffU;
+                tmp >>= 8U;
+            }
+            while (tmp != 0)
+            {
+                bytes[bytecnt++] = tmp & 0xffU;
+                tmp >>= 8U;
+            }
+            num_of_bytes = bytecnt;
+        }
+        for (int i = 0; num_of_bits > 0; i++)
+        {
+            const int          bits = std::min(num_of_bits, 8);
+            const unsigned int byte = (i < num_of_bytes) ? bytes[i] : 0;
+            sendbits(bits, byte & lowBitMask(bits));
+            num_of_bits -= bits;
+        }
+    }
+
+    int*           buf_;
+    unsigned char* cbuf_;
+    int            cnt_;
+    uint64_t       bits_;
+    int            numBits_;
+};
+
+class XtcBitReader
+{
+public:
+    /* Reads the buf[0] bytes following buf[0-2], as read by xdr3dfcoord */
+    explicit XtcBitReader(const int buf[]) :
+        cbuf_(reinterpret_cast<const unsigned char*>(buf) + 3 * sizeof(*buf)),
+        size_(buf[0]),
+        cnt_(0),
+        bits_(0),
+        numBits_(0)
+    {
+    }
+
+    /* Extracts the next num_of_bits (<= 32) bits */
+    unsigned int receivebits(int num_of_bits)
+    {
+        if (numBits_ < num_of_bits)
+        {
+            refill();
+        }
+        numBits_ -= num_of_bits;
+        return static_cast<unsigned int>(bits_ >> numBits_) & lowBitMask(num_of_bits);
+    }
+    /* Same as receiveints() for three integers */
+    void receiveints(int num_of_bits, const unsigned int sizes[], int nums[])
+    {
+        if (num_of_bits > 64)
+        {
+            receiveintsMultiPrecision(num_of_bits, sizes, nums);
+            return;
+        }
+        /* Bytes are received while more than 8 bits remain, then the
+         * rest, and combined as a little-endian number. */
+        uint64_t num   = 0;
+        int      shift = 0;
+        while (num_of_bits > 32)
+        {
+            num |= static_cast<uint64_t>(reverseBytes(receivebits(32))) << shift;
+            shift += 32;
+            num_of_bits -= 32;
+        }
+        while (num_of_bits > 8)
+        {
+            num |= static_cast<uint64_t>(receivebits(8)) << shift;
+            shift += 8;
+            num_of_bits -= 8;
+        }
+        num |= static_cast<uint64_t>(receivebits(num_of_bits)) << shift;
+        if (num <= UINT_MAX)
+        {
+            unsigned int num32 = static_cast<unsigned int>(num);
+            nums[2]            = num32 % sizes[2];
+            num32 /= sizes[2];
+            nums[1] = num32 % sizes[1];
+            nums[0] = num32 / sizes[1];
+        }
+        else
+        {
+            nums[2] = num % sizes[2];
+            num /= sizes[2];
+            nums[1] = num % sizes[1];
+            nums[0] = static_cast<unsigned int>(num / sizes[1]);
+        }
+    }
+
+private:
+    /* Fills the bit buffer with as many whole bytes as fit; bytes beyond
+     * the end of the data read as zero */
+    void refill()
+    {
+        while (numBits_ <= 56)
+        {
+            bits_ = (bits_ << 8U) | ((cnt_ < size_) ? cbuf_[cnt_] : 0U);
+            cnt_++;
+            numBits_ += 8;
+        }
+    }
+
+    /* Unpacks numbers that do not fit in 64 bits, as in receiveints() */
+    void receiveintsMultiPrecision(int num_of_bits, const unsigned int sizes[], int nums[])
+    {
+        int bytes[32];
+        int i, j, num_of_bytes, p, num;
+
+        bytes[0] = bytes[1] = bytes[2] = bytes[3] = 0;
+        num_of_bytes                              = 0;
+        while (num_of_bits > 8)
+        {
+            bytes[num_of_bytes++] = receivebits(8);
+            num_of_bits -= 8;
+        }
+        if (num_of_bits > 0)
+        {
+            bytes[num_of_bytes++] = receivebits(num_of_bits);
+        }
+        for (i = 2; i > 0; i--)
+        {
+            num = 0;
+            for (j = num_of_bytes - 1; j >= 0; j--)
+            {
+                num      = (num << 8) | bytes[j];
+                p        = num / sizes[i];
+                bytes[j] = p;
+                num      = num - p * sizes[i];
+            }
+            nums[i] = num;
+        }
+        nums[0] = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (bytes[3] << 24);
+    }
+
+    const unsigned char* cbuf_;
+    int                  size_;
+    int                  cnt_;
+    uint64_t             bits_;
+    int                  numBits_;
+};
+
 /*____________________________________________________________________________
  |
  | xdr3dfcoord - read or write compressed 3d coordinates to xdr file.
@@ -396,7 +686,13 @@ static void receiveints(int buf[], const int num_of_ints, int num_of_bits, const
  |
  */
 
-int xdr3dfcoord(XDR* xdrs, float* fp, int* size, float* precision)
+template<typename BitWriter, typename BitReader>
+static int xdr3dfcoordImpl(XDR*            xdrs,
+                           float*          fp,
+                           int*            size,
+                           float*          precision,
+                           const gmx_bool* atomMask         = nullptr,
+                           int             numAtomsToDecode = -1)
 {
     int*     ip  = nullptr;
     int*     buf = nullptr;
@@ -479,6 +775,7 @@ int xdr3dfcoord(XDR* xdrs, float* fp, int* size, float* precision)
         }
         /* buf[0-2] are special and do not contain actual data */
         buf[0] = buf[1] = buf[2] = 0;
+        BitWriter writer(buf);
         minint[0] = minint[1] = minint[2] = INT_MAX;
         maxint[0] = maxint[1] = maxint[2] = INT_MIN;
         prevrun                           = -1;
@@ -674,13 +971,13 @@ int xdr3dfcoord(XDR* xdrs, float* fp, int* size, float* precision)
             tmpcoord[2] = thiscoord[2] - minint[2];
             if (bitsize == 0)
             {
-                sendbits(buf, bitsizeint[0], tmpcoord[0]);
-                sendbits(buf, bitsizeint[1], tmpcoord[1]);
-                sendbits(buf, bitsizeint[2], tmpcoord[2]);
+                writer.sendbits(bitsizeint[0], tmpcoord[0]);
+                writer.sendbits(bitsizeint[1], tmpcoord[1]);
+                writer.sendbits(bitsizeint[2], tmpcoord[2]);
             }
             else
             {
-                sendints(buf, 3, bitsize, sizeint, tmpcoord);
+                writer.sendints(bitsize, sizeint, tmpcoord);
             }
             prevcoord[0] = thiscoord[0];
             prevcoord[1] = thiscoord[1];
@@ -724,16 +1021,16 @@ int xdr3dfcoord(XDR* xdrs, float* fp, int* size, float* precision)
             if (run != prevrun || is_smaller != 0)
             {
                 prevrun = run;
-                sendbits(buf, 1, 1); /* flag the change in run-length */
-                sendbits(buf, 5, run + is_smaller + 1);
+                writer.sendbits(1, 1); /* flag the change in run-length */
+                writer.sendbits(5, run + is_smaller + 1);
             }
             else
             {
-                sendbits(buf, 1, 0); /* flag the fact that runlength did not change */
+                writer.sendbits(1, 0); /* flag the fact that runlength did not change */
             }
             for (k = 0; k < run; k += 3)
             {
-                sendints(buf, 3, smallidx, sizesmall, &tmpcoord[k]);
+                writer.sendints(smallidx, sizesmall, &tmpcoord[k]);
             }
             if (is_smaller != 0)
             {
@@ -751,10 +1048,7 @@ int xdr3dfcoord(XDR* xdrs, float* fp, int* size, float* precision)
                 sizesmall[0] = sizesmall[1] = sizesmall[2] = magicints[smallidx];
             }
         }
-        if (buf[1] != 0)
-        {
-            buf[0]++;
-        }
+        writer.finish();
         /* buf[0] holds the length in bytes */
         if (xdr_int(xdrs, &(buf[0])) == 0)
         {
@@ -794,6 +1088,10 @@ int xdr3dfcoord(XDR* xdrs, float* fp, int* size, float* precision)
         }
         *size = lsize;
         size3 = *size * 3;
+        if (numAtomsToDecode < 0 || numAtomsToDecode > lsize)
+        {
+            numAtomsToDecode = lsize;
+        }
         if (*size <= 9)
         {
             *precision = -1;
@@ -893,26 +1191,41 @@ int xdr3dfcoord(XDR* xdrs, float* fp, int* size, float* precision)
         }
 
 
-        buf[0] = buf[1] = buf[2] = 0;
+        BitReader reader(buf);
 
-        lfp           = fp;
         inv_precision = 1.0 / *precision;
-        run           = 0;
-        i             = 0;
-        lip           = ip;
-        while (i < lsize)
+        /* Converts the next decoded atom to float and stores it, unless
+         * the atom is not needed */
+        int  nextAtom  = 0;
+        auto storeAtom = [&nextAtom, fp, atomMask, numAtomsToDecode,
+                          inv_precision](const int* coord) {
+            if (nextAtom < numAtomsToDecode && (atomMask == nullptr || atomMask[nextAtom]))
+            {
+                fp[3 * nextAtom]     = coord[0] * inv_precision;
+                fp[3 * nextAtom + 1] = coord[1] * inv_precision;
+                fp[3 * nextAtom + 2] = coord[2] * inv_precision;
+            }
+            nextAtom++;
+        };
+        run = 0;
+        i   = 0;
+        lip = ip;
+        /* The stream can only be decoded in order, but decoding can stop
+         * once all needed atoms have been stored. The bytes of the frame
+         * have all been read above, so the stream is at the next frame. */
+        while (i < numAtomsToDecode)
         {
             thiscoord = reinterpret_cast<int*>(lip) + i * 3;
 
             if (bitsize == 0)
             {
-                thiscoord[0] = receivebits(buf, bitsizeint[0]);
-                thiscoord[1] = receivebits(buf, bitsizeint[1]);
-                thiscoord[2] = receivebits(buf, bitsizeint[2]);
+                thiscoord[0] = reader.receivebits(bitsizeint[0]);
+                thiscoord[1] = reader.receivebits(bitsizeint[1]);
+                thiscoord[2] = reader.receivebits(bitsizeint[2]);
             }
             else
             {
-                receiveints(buf, 3, bitsize, sizeint, thiscoord);
+                reader.receiveints(bitsize, sizeint, thiscoord);
             }
 
             i++;
@@ -925,11 +1238,11 @@ int xdr3dfcoord(XDR* xdrs, float* fp, int* size, float* precision)
             prevcoord[2] = thiscoord[2];
 
 
-            flag       = receivebits(buf, 1);
+            flag       = reader.receivebits(1);
             is_smaller = 0;
             if (flag == 1)
             {
-                run        = receivebits(buf, 5);
+                run        = reader.receivebits(5);
                 is_smaller = run % 3;
                 run -= is_smaller;
                 is_smaller--;
@@ -939,7 +1252,7 @@ int xdr3dfcoord(XDR* xdrs, float* fp, int* size, float* precision)
                 thiscoord += 3;
                 for (k = 0; k < run; k += 3)
                 {
-                    receiveints(buf, 3, smallidx, sizesmall, thiscoord);
+                    reader.receiveints(smallidx, sizesmall, thiscoord);
                     i++;
                     thiscoord[0] += prevcoord[0] - smallnum;
                     thiscoord[1] += prevcoord[1] - smallnum;
@@ -958,9 +1271,7 @@ int xdr3dfcoord(XDR* xdrs, float* fp, int* size, float* precision)
                         tmp          = thiscoord[2];
                         thiscoord[2] = prevcoord[2];
                         prevcoord[2] = tmp;
-                        *lfp++       = prevcoord[0] * inv_precision;
-                        *lfp++       = prevcoord[1] * inv_precision;
-                        *lfp++       = prevcoord[2] * inv_precision;
+                        storeAtom(prevcoord);
                     }
                     else
                     {
@@ -968,16 +1279,12 @@ int xdr3dfcoord(XDR* xdrs, float* fp, int* size, float* precision)
                         prevcoord[1] = thiscoord[1];
                         prevcoord[2] = thiscoord[2];
                     }
-                    *lfp++ = thiscoord[0] * inv_precision;
-                    *lfp++ = thiscoord[1] * inv_precision;
-                    *lfp++ = thiscoord[2] * inv_precision;
+                    storeAtom(thiscoord);
                 }
             }
             else
             {
-                *lfp++ = thiscoord[0] * inv_precision;
-                *lfp++ = thiscoord[1] * inv_precision;
-                *lfp++ = thiscoord[2] * inv_precision;
+                storeAtom(thiscoord);
             }
             smallidx += is_smaller;
             if (is_smaller < 0)
@@ -1009,6 +1316,32 @@ int xdr3dfcoord(XDR* xdrs, float* fp, int* size, float* precision)
 }
 
 
+int xdr3dfcoord(XDR* xdrs, float* fp, int* size, float* precision)
+{
+    return xdr3dfcoordImpl<XtcBitWriter, XtcBitReader>(xdrs, fp, size, precision);
+}
+
+int xdr3dfcoord_reference(XDR* xdrs, float* fp, int* size, float* precision)
+{
+    return xdr3dfcoordImpl<ReferenceBitWriter, ReferenceBitReader>(xdrs, fp, size, precision);
+}
+
+int xdr3dfcoord_partial(XDR*            xdrs,
+                        float*          fp,
+                        int*            size,
+                        float*          precision,
+                        const gmx_bool* atomMask,
+                        int             numAtomsToDecode)
+{
+    if (xdrs->x_op != XDR_DECODE)
+    {
+        return 0;
+    }
+    return xdr3dfcoordImpl<XtcBitWriter, XtcBitReader>(xdrs, fp, size, precision, atomMask,
+                                                       numAtomsToDecode);
+}
+
+
 /******************************************************************
 
    XTC files have a relatively simple structure.
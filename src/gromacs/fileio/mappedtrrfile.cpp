@@ -0,0 +1,403 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Implements gmx::MappedTrrFile.
+ *
+ * \ingroup module_fileio
+ */
+#include "gmxpre.h"
+
+#include "mappedtrrfile.h"
+
+#include "config.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include <algorithm>
+#include <vector>
+
+#if !GMX_NATIVE_WINDOWS
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+#include "gromacs/utility/basedefinitions.h"
+#include "gromacs/utility/exceptions.h"
+#include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/stringutil.h"
+
+namespace gmx
+{
+
+namespace
+{
+
+//! Magic number at the start of each TRR frame.
+const int c_trrMagic = 1993;
+
+//! Reads a big-endian (XDR) unsigned 32-bit integer.
+uint32_t readUInt32(const unsigned char* p)
+{
+    return (uint32_t(p[0]) << 24U) | (uint32_t(p[1]) << 16U) | (uint32_t(p[2]) << 8U) | uint32_t(p[3]);
+}
+
+//! Reads a big-endian (XDR) float or double and returns it as real.
+real readReal(const unsigned char* p, bool isDouble)
+{
+    if (isDouble)
+    {
+        const uint64_t i = (uint64_t(readUInt32(p)) << 32U) | readUInt32(p + 4);
+        double         d;
+        std::memcpy(&d, &i, sizeof(d));
+        return d;
+    }
+    else
+    {
+        const uint32_t i = readUInt32(p);
+        float          f;
+        std::memcpy(&f, &i, sizeof(f));
+        return f;
+    }
+}
+
+//! Number of frames following an accessed frame that the kernel is asked to read ahead.
+const int c_numFramesToPrefetch = 2;
+
+//! Location of one frame in the file.
+struct TrrFrameLayout
+{
+    int64_t step;
+    real    time;
+    real    lambda;
+    int     natoms;
+    bool    isDouble;
+    //! Offsets of the box and vectors, zero when not present.
+    size_t boxOffset, xOffset, vOffset, fOffset;
+    //! Offset just past the end of the frame.
+    size_t end;
+};
+
+} // namespace
+
+class MappedTrrFile::Impl
+{
+public:
+    explicit Impl(const std::string& filename);
+    ~Impl();
+
+    //! Finds all complete frames in the file.
+    void scanFrames();
+    //! Asks the kernel to read the frames following frame \p index.
+    void prefetchFrames(int index) const;
+    //! Returns the vectors at \p offset, empty when \p offset is zero.
+    MappedTrrVectors vectors(const TrrFrameLayout& layout, size_t offset) const;
+
+    std::string filename_;
+    //! The contents of the file.
+    unsigned char* data_;
+    size_t         size_;
+    //! Whether data_ is a memory map, otherwise it points into buffer_.
+    bool                       isMapped_;
+    std::vector<unsigned char> buffer_;
+    std::vector<TrrFrameLayout> frames_;
+};
+
+MappedTrrFile::Impl::Impl(const std::string& filename) :
+    filename_(filename),
+    data_(nullptr),
+    size_(0),
+    isMapped_(false)
+{
+#if !GMX_NATIVE_WINDOWS
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        GMX_THROW(FileIOError(formatString("Could not open trajectory file '%s'", filename.c_str())));
+    }
+    struct stat fileStatus;
+    if (fstat(fd, &fileStatus) != 0)
+    {
+        close(fd);
+        GMX_THROW(FileIOError(formatString("Could not determine the size of '%s'", filename.c_str())));
+    }
+    size_ = fileStatus.st_size;
+    if (size_ > 0)
+    {
+        void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED)
+        {
+            close(fd);
+            GMX_THROW(FileIOError(formatString("Could not map trajectory file '%s'", filename.c_str())));
+        }
+        data_     = static_cast<unsigned char*>(data);
+        isMapped_ = true;
+    }
+    close(fd);
+#else
+    std::FILE* fp = std::fopen(filename.c_str(), "rb");
+    if (fp == nullptr)
+    {
+        GMX_THROW(FileIOError(formatString("Could not open trajectory file '%s'", filename.c_str())));
+    }
+    unsigned char chunk[65536];
+    size_t        count;
+    while ((count = std::fread(chunk, 1, sizeof(chunk), fp)) > 0)
+    {
+        buffer_.insert(buffer_.end(), chunk, chunk + count);
+    }
+    std::fclose(fp);
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+#endif
+    try
+    {
+        scanFrames();
+    }
+    catch (...)
+    {
+#if !GMX_NATIVE_WINDOWS
+        if (isMapped_)
+        {
+            munmap(data_, size_);
+        }
+#endif
+        throw;
+    }
+}
+
+MappedTrrFile::Impl::~Impl()
+{
+#if !GMX_NATIVE_WINDOWS
+    if (isMapped_)
+    {
+        munmap(data_, size_);
+    }
+#endif
+}
+
+void MappedTrrFile::Impl::scanFrames()
+{
+    size_t pos = 0;
+    while (pos + 3 * sizeof(int32_t) <= size_)
+    {
+        const size_t frameStart = pos;
+        if (readUInt32(data_ + pos) != static_cast<uint32_t>(c_trrMagic))
+        {
+            GMX_THROW(FileIOError(formatString(
+                    "Failed to find GROMACS magic number in trr frame header at offset %zu of "
+                    "'%s', so this is not a (valid) trr file",
+                    pos, filename_.c_str())));
+        }
+        /* The version string is stored with its length including the
+         * terminating zero, followed by an XDR string */
+        const size_t stringLength = readUInt32(data_ + pos + 2 * sizeof(int32_t));
+        pos += 3 * sizeof(int32_t) + (stringLength + 3) / 4 * 4;
+
+        const int c_numHeaderInts = 13;
+        if (pos + c_numHeaderInts * sizeof(int32_t) > size_)
+        {
+            break;
+        }
+        int32_t header[c_numHeaderInts];
+        for (int i = 0; i < c_numHeaderInts; i++, pos += sizeof(int32_t))
+        {
+            header[i] = readUInt32(data_ + pos);
+        }
+        const int32_t irSize = header[0], eSize = header[1], boxSize = header[2], virSize = header[3],
+                      presSize = header[4], topSize = header[5], symSize = header[6],
+                      xSize = header[7], vSize = header[8], fSize = header[9], natoms = header[10];
+        if (irSize != 0 || eSize != 0 || topSize != 0 || symSize != 0)
+        {
+            GMX_THROW(FileIOError(formatString(
+                    "Frame at offset %zu of '%s' contains data that is no longer supported",
+                    frameStart, filename_.c_str())));
+        }
+        if (natoms < 0 || boxSize < 0 || virSize < 0 || presSize < 0 || xSize < 0 || vSize < 0 || fSize < 0)
+        {
+            GMX_THROW(FileIOError(formatString("Invalid trr frame header at offset %zu of '%s'",
+                                               frameStart, filename_.c_str())));
+        }
+
+        /* Determine the precision as in trrio.cpp */
+        size_t floatSize = 0;
+        if (boxSize > 0)
+        {
+            floatSize = boxSize / (DIM * DIM);
+        }
+        else if (natoms > 0 && (xSize > 0 || vSize > 0 || fSize > 0))
+        {
+            floatSize = std::max({ xSize, vSize, fSize }) / (natoms * DIM);
+        }
+        if (floatSize != sizeof(float) && floatSize != sizeof(double))
+        {
+            GMX_THROW(FileIOError(
+                    formatString("Can not determine precision of trr frame at offset %zu of '%s'",
+                                 frameStart, filename_.c_str())));
+        }
+
+        TrrFrameLayout layout;
+        layout.step      = header[11];
+        layout.natoms    = natoms;
+        layout.isDouble = (floatSize == sizeof(double));
+        if (pos + 2 * floatSize > size_)
+        {
+            break;
+        }
+        layout.time   = readReal(data_ + pos, layout.isDouble);
+        layout.lambda = readReal(data_ + pos + floatSize, layout.isDouble);
+        pos += 2 * floatSize;
+
+        layout.boxOffset = (boxSize > 0) ? pos : 0;
+        pos += boxSize + virSize + presSize;
+        layout.xOffset = (xSize > 0) ? pos : 0;
+        pos += xSize;
+        layout.vOffset = (vSize > 0) ? pos : 0;
+        pos += vSize;
+        layout.fOffset = (fSize > 0) ? pos : 0;
+        pos += fSize;
+        layout.end = pos;
+        if (layout.end > size_)
+        {
+            break;
+        }
+        frames_.push_back(layout);
+    }
+}
+
+void MappedTrrFile::Impl::prefetchFrames(int index) const
+{
+#if !GMX_NATIVE_WINDOWS
+    const int lastFrame = std::min(index + c_numFramesToPrefetch, static_cast<int>(frames_.size()) - 1);
+    if (!isMapped_ || lastFrame <= index)
+    {
+        return;
+    }
+    const size_t pageSize = sysconf(_SC_PAGESIZE);
+    const size_t begin    = frames_[index].end / pageSize * pageSize;
+    const size_t end      = frames_[lastFrame].end;
+    madvise(data_ + begin, end - begin, MADV_WILLNEED);
+#else
+    GMX_UNUSED_VALUE(index);
+#endif
+}
+
+MappedTrrVectors MappedTrrFile::Impl::vectors(const TrrFrameLayout& layout, size_t offset) const
+{
+    if (offset == 0)
+    {
+        return {};
+    }
+    return MappedTrrVectors(data_ + offset, layout.natoms, layout.isDouble);
+}
+
+void MappedTrrVectors::copyTo(ArrayRef<RVec> dest) const
+{
+    GMX_ASSERT(dest.ssize() == natoms_, "The destination should have space for all vectors");
+    real* values = as_rvec_array(dest.data())[0];
+    if (isDouble_ == (sizeof(real) == sizeof(double)) && GMX_INTEGER_BIG_ENDIAN)
+    {
+        std::memcpy(values, data_, natoms_ * sizeof(RVec));
+    }
+    else if (isDouble_)
+    {
+        for (int i = 0; i < natoms_ * DIM; i++)
+        {
+            values[i] = readReal(data_ + i * sizeof(double), true);
+        }
+    }
+    else
+    {
+        /* The common case, written such that the compiler can vectorize
+         * the byte swapping */
+        for (int i = 0; i < natoms_ * DIM; i++)
+        {
+            values[i] = readReal(data_ + i * sizeof(float), false);
+        }
+    }
+}
+
+MappedTrrFile::MappedTrrFile(const std::string& filename) : impl_(new Impl(filename)) {}
+
+MappedTrrFile::~MappedTrrFile() = default;
+
+int MappedTrrFile::frameCount() const
+{
+    return impl_->frames_.size();
+}
+
+int64_t MappedTrrFile::frameEndOffset(int index) const
+{
+    GMX_ASSERT(index >= 0 && index < frameCount(), "Frame index out of range");
+    return impl_->frames_[index].end;
+}
+
+MappedTrrFrame MappedTrrFile::frame(int index) const
+{
+    GMX_ASSERT(index >= 0 && index < frameCount(), "Frame index out of range");
+    const TrrFrameLayout& layout = impl_->frames_[index];
+
+    MappedTrrFrame frame;
+    frame.step     = layout.step;
+    frame.time     = layout.time;
+    frame.lambda   = layout.lambda;
+    frame.natoms   = layout.natoms;
+    frame.isDouble = layout.isDouble;
+    frame.hasBox   = (layout.boxOffset != 0);
+    if (frame.hasBox)
+    {
+        const size_t floatSize = layout.isDouble ? sizeof(double) : sizeof(float);
+        for (int d = 0; d < DIM; d++)
+        {
+            for (int e = 0; e < DIM; e++)
+            {
+                frame.box[d][e] = readReal(impl_->data_ + layout.boxOffset + (d * DIM + e) * floatSize,
+                                           layout.isDouble);
+            }
+        }
+    }
+    frame.x = impl_->vectors(layout, layout.xOffset);
+    frame.v = impl_->vectors(layout, layout.vOffset);
+    frame.f = impl_->vectors(layout, layout.fOffset);
+
+    impl_->prefetchFrames(index);
+
+    return frame;
+}
+
+} // namespace gmx
@@ -0,0 +1,174 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \libinternal \file
+ * \brief
+ * Declares gmx::MappedTrrFile for reading TRR files through a memory map.
+ *
+ * \inlibraryapi
+ * \ingroup module_fileio
+ */
+#ifndef GMX_FILEIO_MAPPEDTRRFILE_H
+#define GMX_FILEIO_MAPPEDTRRFILE_H
+
+#include <cstdint>
+
+#include <string>
+
+#include "gromacs/math/vectypes.h"
+#include "gromacs/utility/arrayref.h"
+#include "gromacs/utility/classhelpers.h"
+#include "gromacs/utility/real.h"
+
+namespace gmx
+{
+
+/*! \libinternal \brief
+ * Positions, velocities or forces of one frame in a MappedTrrFile.
+ *
+ * Refers to the values as they are stored in the file, i.e. in XDR byte
+ * order and possibly with a different precision than the build. They are
+ * converted while copying them out with copyTo().
+ */
+class MappedTrrVectors
+{
+public:
+    //! Creates an empty object, for vectors not present in a frame.
+    MappedTrrVectors() = default;
+    //! Refers to \p natoms vectors stored at \p data.
+    MappedTrrVectors(const unsigned char* data, int natoms, bool isDouble) :
+        data_(data),
+        natoms_(natoms),
+        isDouble_(isDouble)
+    {
+    }
+
+    //! Whether the vectors are not present in the frame.
+    bool empty() const { return data_ == nullptr; }
+    //! Returns the number of vectors.
+    int size() const { return natoms_; }
+    /*! \brief
+     * Converts the vectors and stores them in \p dest.
+     *
+     * \p dest should have size() elements.
+     */
+    void copyTo(ArrayRef<RVec> dest) const;
+
+private:
+    const unsigned char* data_     = nullptr;
+    int                  natoms_   = 0;
+    bool                 isDouble_ = false;
+};
+
+/*! \libinternal \brief
+ * View of one frame in a MappedTrrFile.
+ *
+ * Vectors that are not present in the frame are empty.
+ */
+struct MappedTrrFrame
+{
+    //! The MD step.
+    int64_t step = 0;
+    //! The time.
+    real time = 0;
+    //! The FEP lambda value.
+    real lambda = 0;
+    //! The number of atoms.
+    int natoms = 0;
+    //! Whether the frame has a box.
+    bool hasBox = false;
+    //! The box, if present.
+    matrix box = { { 0 } };
+    //! Whether the file stores double precision values.
+    bool isDouble = false;
+    //! Positions.
+    MappedTrrVectors x;
+    //! Velocities.
+    MappedTrrVectors v;
+    //! Forces.
+    MappedTrrVectors f;
+};
+
+/*! \libinternal \brief
+ * Reads a TRR file through a memory map.
+ *
+ * The whole file is mapped (or, where memory mapping is not available,
+ * read in one go) and the frame headers are scanned when the object is
+ * constructed, so the number of frames is known up front and any frame
+ * can be accessed directly.
+ *
+ * The file is mapped read-only. The vectors of a frame refer to the
+ * mapping, and their byte order and precision are converted when they
+ * are copied out, so the mapping is never modified and its pages can
+ * always be dropped from memory by the operating system. When a frame
+ * is accessed, the kernel is asked to read ahead the following frames.
+ *
+ * An incomplete frame at the end of the file (e.g. from a simulation that
+ * is still running) is not included in the frame count.
+ *
+ * \inlibraryapi
+ * \ingroup module_fileio
+ */
+class MappedTrrFile
+{
+public:
+    /*! \brief
+     * Maps \p filename and scans the frame headers.
+     *
+     * \throws FileIOError if the file cannot be read or is not a TRR file.
+     */
+    explicit MappedTrrFile(const std::string& filename);
+    ~MappedTrrFile();
+
+    //! Returns the number of complete frames in the file.
+    int frameCount() const;
+    /*! \brief
+     * Returns frame \p index.
+     *
+     * The vectors in the returned frame are valid until the object is
+     * destroyed.
+     */
+    MappedTrrFrame frame(int index) const;
+    //! Returns the offset in the file just past frame \p index.
+    int64_t frameEndOffset(int index) const;
+
+private:
+    class Impl;
+
+    PrivateImplPointer<Impl> impl_;
+};
+
+} // namespace gmx
+
+#endif
@@ -0,0 +1,234 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for reading TRR files through a memory map.
+ *
+ * \ingroup module_fileio
+ */
+#include "gmxpre.h"
+
+#include "gromacs/fileio/mappedtrrfile.h"
+
+#include <cstdio>
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/fileio/oenv.h"
+#include "gromacs/fileio/trrio.h"
+#include "gromacs/fileio/trxio.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/trajectory/trajectoryframe.h"
+#include "gromacs/utility/exceptions.h"
+
+#include "testutils/testasserts.h"
+#include "testutils/testfilemanager.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Number of atoms in the test trajectory.
+const int c_numAtoms = 7;
+//! Number of frames in the test trajectory.
+const int c_numFrames = 4;
+
+//! Returns a value that identifies component \p d of \p atom in \p frame and vector \p vec.
+real testValue(int frame, int vec, int atom, int d)
+{
+    return 1000 * frame + 100 * vec + 10 * atom + d + 0.5;
+}
+
+//! Returns test vectors for \p frame and vector \p vec.
+std::vector<RVec> testVectors(int frame, int vec)
+{
+    std::vector<RVec> v(c_numAtoms);
+    for (int i = 0; i < c_numAtoms; i++)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            v[i][d] = testValue(frame, vec, i, d);
+        }
+    }
+    return v;
+}
+
+class MappedTrrFileTest : public ::testing::Test
+{
+public:
+    MappedTrrFileTest() : filename_(fileManager_.getTemporaryFilePath("traj.trr"))
+    {
+        /* All frames have positions and a box, odd frames also have
+         * velocities and every third frame forces */
+        t_fileio* fio = gmx_trr_open(filename_.c_str(), "w");
+        for (int frame = 0; frame < c_numFrames; frame++)
+        {
+            matrix box = { { 1.0F + frame, 0, 0 }, { 0, 2, 0 }, { 0.5, 0.5, 3 } };
+            std::vector<RVec> x = testVectors(frame, 0);
+            std::vector<RVec> v = testVectors(frame, 1);
+            std::vector<RVec> f = testVectors(frame, 2);
+            gmx_trr_write_frame(fio, 10 * frame, 0.5 * frame, 0.25, box, c_numAtoms,
+                                as_rvec_array(x.data()),
+                                frame % 2 == 1 ? as_rvec_array(v.data()) : nullptr,
+                                frame % 3 == 0 ? as_rvec_array(f.data()) : nullptr);
+        }
+        gmx_trr_close(fio);
+    }
+
+    //! Checks that \p vectors are those written for \p frame and \p vec.
+    static void checkVectors(ArrayRef<const RVec> vectors, int frame, int vec, bool present)
+    {
+        if (!present)
+        {
+            EXPECT_TRUE(vectors.empty());
+            return;
+        }
+        ASSERT_EQ(c_numAtoms, vectors.ssize());
+        for (int i = 0; i < c_numAtoms; i++)
+        {
+            for (int d = 0; d < DIM; d++)
+            {
+                EXPECT_EQ(testValue(frame, vec, i, d), vectors[i][d]);
+            }
+        }
+    }
+
+    //! Checks that \p frame is the frame with index \p index.
+    static void checkFrame(const MappedTrrFrame& frame, int index)
+    {
+        EXPECT_EQ(10 * index, frame.step);
+        EXPECT_EQ(0.5 * index, frame.time);
+        EXPECT_EQ(0.25, frame.lambda);
+        EXPECT_EQ(c_numAtoms, frame.natoms);
+        EXPECT_TRUE(frame.hasBox);
+        EXPECT_EQ(1.0F + index, frame.box[XX][XX]);
+        EXPECT_EQ(0.5, frame.box[ZZ][YY]);
+        checkVectors(frame.x, index, 0, true);
+        checkVectors(frame.v, index, 1, index % 2 == 1);
+        checkVectors(frame.f, index, 2, index % 3 == 0);
+    }
+
+    //! Checks that \p vectors are those written for \p frame and \p vec.
+    static void checkVectors(const MappedTrrVectors& vectors, int frame, int vec, bool present)
+    {
+        EXPECT_EQ(!present, vectors.empty());
+        if (present)
+        {
+            std::vector<RVec> converted(vectors.size());
+            vectors.copyTo(converted);
+            checkVectors(converted, frame, vec, present);
+        }
+    }
+
+    TestFileManager   fileManager_;
+    const std::string filename_;
+};
+
+TEST_F(MappedTrrFileTest, ReadsAllFrames)
+{
+    MappedTrrFile file(filename_);
+    ASSERT_EQ(c_numFrames, file.frameCount());
+    for (int frame = 0; frame < c_numFrames; frame++)
+    {
+        checkFrame(file.frame(frame), frame);
+    }
+    // Frames can be accessed repeatedly and in any order
+    checkFrame(file.frame(2), 2);
+    checkFrame(file.frame(0), 0);
+}
+
+TEST_F(MappedTrrFileTest, IgnoresIncompleteLastFrame)
+{
+    // Append the start of the first frame
+    std::FILE* fp = std::fopen(filename_.c_str(), "r+b");
+    ASSERT_NE(fp, nullptr);
+    char header[40];
+    ASSERT_EQ(sizeof(header), std::fread(header, 1, sizeof(header), fp));
+    std::fseek(fp, 0, SEEK_END);
+    std::fwrite(header, 1, sizeof(header), fp);
+    std::fclose(fp);
+
+    MappedTrrFile file(filename_);
+    EXPECT_EQ(c_numFrames, file.frameCount());
+}
+
+TEST_F(MappedTrrFileTest, ThrowsOnInvalidFile)
+{
+    const std::string otherFile = fileManager_.getTemporaryFilePath("other.trr");
+    std::FILE*        fp        = std::fopen(otherFile.c_str(), "wb");
+    ASSERT_NE(fp, nullptr);
+    std::fputs("This is not a trajectory", fp);
+    std::fclose(fp);
+
+    EXPECT_THROW_GMX(MappedTrrFile file(otherFile), FileIOError);
+}
+
+TEST_F(MappedTrrFileTest, IsUsedByTrajectoryReading)
+{
+    gmx_output_env_t* oenv;
+    output_env_init_default(&oenv);
+    t_trxstatus* status;
+    t_trxframe   fr;
+    ASSERT_TRUE(read_first_frame(oenv, &status, filename_.c_str(), &fr, TRX_READ_X | TRX_READ_V));
+    EXPECT_EQ(c_numFrames, trx_get_frame_count(status));
+    int frame = 0;
+    do
+    {
+        EXPECT_EQ(10 * frame, fr.step);
+        checkVectors(constArrayRefFromArray(reinterpret_cast<const RVec*>(fr.x), fr.natoms), frame, 0, true);
+        EXPECT_EQ(frame % 2 == 1, fr.bV);
+        frame++;
+    } while (read_next_frame(oenv, status, &fr));
+    EXPECT_EQ(c_numFrames, frame);
+
+    ASSERT_TRUE(read_frame_at(status, 1, &fr));
+    EXPECT_EQ(10, fr.step);
+    checkVectors(constArrayRefFromArray(reinterpret_cast<const RVec*>(fr.v), fr.natoms), 1, 1, true);
+    EXPECT_FALSE(read_frame_at(status, c_numFrames, &fr));
+
+    close_trx(status);
+    done_frame(&fr);
+    output_env_done(oenv);
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
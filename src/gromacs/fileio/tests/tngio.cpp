@@ -45,12 +45,17 @@
 #include "gromacs/fileio/tngio.h"
 
 #include <string>
+#include <vector>
 
 #include <gtest/gtest.h>
 
+#include "gromacs/fileio/trxio.h"
+#include "gromacs/math/vectypes.h"
+#include "gromacs/trajectory/trajectoryframe.h"
 #include "gromacs/utility/path.h"
 
 #include "testutils/simulationdatabase.h"
+#include "testutils/testasserts.h"
 #include "testutils/testfilemanager.h"
 
 namespace
@@ -76,4 +81,146 @@ TEST_F(TngTest, CloseBeforeOpenIsNotFatal)
     gmx_tng_close(&tng);
 }
 
+//! Contents of a frame read from a TNG file
+struct TngTestFrame
+{
+    //! Step of the frame
+    int64_t step;
+    //! Time of the frame
+    real time;
+    //! Whether the frame had velocities
+    bool bV;
+    //! Box of the frame
+    std::vector<real> box;
+    //! Positions of the frame, empty if none
+    std::vector<gmx::RVec> x;
+};
+
+/*! \brief Writes a trajectory with positions and velocities to \p filename
+ *
+ * Without a topology, each frame is written to its own frame set. */
+void writeTngTrajectory(const std::string& filename, int numFrames)
+{
+    const int              numAtoms = 10;
+    gmx_tng_trajectory_t   tng      = nullptr;
+    std::vector<gmx::RVec> x(numAtoms), v(numAtoms);
+    gmx_prepare_tng_writing(filename.c_str(), 'w', nullptr, &tng, numAtoms, nullptr, {}, nullptr);
+    for (int step = 0; step < numFrames; step++)
+    {
+        for (int a = 0; a < numAtoms; a++)
+        {
+            x[a] = { 0.1F * a + 0.01F * step, 0.2F * a, 0.3F - 0.02F * step };
+            v[a] = { 0.5F, -0.1F * a, 0.01F * step };
+        }
+        t_trxframe fr;
+        clear_trxframe(&fr, TRUE);
+        fr.natoms      = numAtoms;
+        fr.step        = step;
+        fr.time        = 0.5 * step;
+        fr.bBox        = TRUE;
+        fr.box[XX][XX] = 3;
+        fr.box[YY][YY] = 3;
+        fr.box[ZZ][ZZ] = 3;
+        fr.bX          = TRUE;
+        fr.x           = as_rvec_array(x.data());
+        fr.bV          = TRUE;
+        fr.v           = as_rvec_array(v.data());
+        gmx_write_tng_from_trxframe(tng, &fr, numAtoms);
+    }
+    gmx_tng_close(&tng);
+}
+
+/*! \brief Reads all frames from \p filename
+ *
+ * Only positions are read if \p bOnlyPositions, and if \p numThreads is
+ * larger than one, frame sets are read by that many worker threads. */
+std::vector<TngTestFrame> readTngFrames(const std::string& filename,
+                                        bool               bOnlyPositions,
+                                        int                numThreads)
+{
+    gmx_tng_trajectory_t tng;
+    gmx_tng_open(filename.c_str(), 'r', &tng);
+    if (bOnlyPositions)
+    {
+        gmx_tng_set_read_blocks(tng, true, false, false);
+    }
+    if (numThreads > 1)
+    {
+        gmx_tng_start_parallel_reading(tng, numThreads);
+    }
+    std::vector<TngTestFrame> frames;
+    t_trxframe                fr;
+    clear_trxframe(&fr, TRUE);
+    fr.step = -1;
+    while (gmx_read_next_tng_frame(tng, &fr, nullptr, 0))
+    {
+        TngTestFrame frame;
+        frame.step = fr.step;
+        frame.time = fr.time;
+        frame.bV   = fr.bV;
+        for (int d = 0; d < DIM; d++)
+        {
+            frame.box.insert(frame.box.end(), fr.box[d], fr.box[d] + DIM);
+        }
+        if (fr.bX)
+        {
+            frame.x.assign(fr.x, fr.x + fr.natoms);
+        }
+        frames.push_back(frame);
+    }
+    done_frame(&fr);
+    gmx_tng_close(&tng);
+    return frames;
+}
+
+//! Checks that \p actual has the same frames as \p expected
+void compareTngFrames(const std::vector<TngTestFrame>& expected,
+                      const std::vector<TngTestFrame>& actual)
+{
+    ASSERT_EQ(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); i++)
+    {
+        EXPECT_EQ(expected[i].step, actual[i].step);
+        EXPECT_EQ(expected[i].time, actual[i].time);
+        EXPECT_EQ(expected[i].box, actual[i].box);
+        ASSERT_EQ(expected[i].x.size(), actual[i].x.size());
+        for (size_t a = 0; a < expected[i].x.size(); a++)
+        {
+            for (int d = 0; d < DIM; d++)
+            {
+                EXPECT_EQ(expected[i].x[a][d], actual[i].x[a][d]);
+            }
+        }
+    }
+}
+
+TEST_F(TngTest, ReadsOnlyRequestedBlocks)
+{
+    const std::string filename = fileManager_.getTemporaryFilePath("blocks.tng");
+    writeTngTrajectory(filename, 5);
+    const auto        allFrames       = readTngFrames(filename, false, 1);
+    const auto        positionsFrames = readTngFrames(filename, true, 1);
+    ASSERT_EQ(5U, allFrames.size());
+    compareTngFrames(allFrames, positionsFrames);
+    for (size_t i = 0; i < allFrames.size(); i++)
+    {
+        EXPECT_TRUE(allFrames[i].bV);
+        EXPECT_FALSE(positionsFrames[i].bV);
+    }
+}
+
+TEST_F(TngTest, ParallelReadingGivesSameFrames)
+{
+    const std::string filename = fileManager_.getTemporaryFilePath("parallel.tng");
+    writeTngTrajectory(filename, 20);
+    const auto serialFrames = readTngFrames(filename, false, 1);
+    ASSERT_EQ(20U, serialFrames.size());
+    for (int numThreads : { 2, 3 })
+    {
+        SCOPED_TRACE(numThreads);
+        compareTngFrames(serialFrames, readTngFrames(filename, false, numThreads));
+        compareTngFrames(serialFrames, readTngFrames(filename, true, numThreads));
+    }
+}
+
 } // namespace
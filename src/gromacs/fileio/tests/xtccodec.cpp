@@ -0,0 +1,221 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests that the XTC coordinate compression produces the same
+ * stream as the reference implementation.
+ *
+ * \ingroup module_fileio
+ */
+#include "gmxpre.h"
+
+#include <cmath>
+#include <cstdio>
+
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/fileio/xdrf.h"
+#include "gromacs/random/threefry.h"
+#include "gromacs/random/uniformrealdistribution.h"
+#include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/real.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Signature of xdr3dfcoord and xdr3dfcoord_reference.
+using XtcCodecFunction = int (*)(XDR*, float*, int*, float*);
+
+//! Parameters: number of atoms, extent of the coordinates in nm, precision.
+using XtcCodecParameters = std::tuple<int, float, float>;
+
+/*! \brief
+ * Returns water-like coordinates: groups of three atoms close to each
+ * other, scattered over a box of size \p extent.
+ */
+std::vector<float> generateCoordinates(int natoms, float extent)
+{
+    ThreeFry2x64<64>               rng(123456, RandomDomain::Other);
+    UniformRealDistribution<float> position(0, extent);
+    UniformRealDistribution<float> bond(-0.1, 0.1);
+
+    std::vector<float> x(3 * natoms);
+    for (int i = 0; i < natoms; i++)
+    {
+        for (int d = 0; d < 3; d++)
+        {
+            x[3 * i + d] = (i % 3 == 0) ? position(rng) : x[3 * (i - 1) + d] + bond(rng);
+        }
+    }
+    return x;
+}
+
+//! Encodes \p x with \p codec and returns the contents of the stream.
+std::vector<char> encode(XtcCodecFunction codec, std::vector<float> x, float precision)
+{
+    FILE* fp = std::tmpfile();
+    GMX_RELEASE_ASSERT(fp != nullptr, "Could not open temporary file");
+    XDR xdr;
+    xdrstdio_create(&xdr, fp, XDR_ENCODE);
+    int natoms = x.size() / 3;
+    EXPECT_EQ(1, codec(&xdr, x.data(), &natoms, &precision));
+    xdr_destroy(&xdr);
+
+    std::vector<char> stream(std::ftell(fp));
+    std::rewind(fp);
+    EXPECT_EQ(stream.size(), std::fread(stream.data(), 1, stream.size(), fp));
+    std::fclose(fp);
+    return stream;
+}
+
+//! Decodes \p stream with \p codec and returns the coordinates.
+std::vector<float> decode(XtcCodecFunction codec, const std::vector<char>& stream, int natoms)
+{
+    FILE* fp = std::tmpfile();
+    GMX_RELEASE_ASSERT(fp != nullptr, "Could not open temporary file");
+    std::fwrite(stream.data(), 1, stream.size(), fp);
+    std::rewind(fp);
+    XDR xdr;
+    xdrstdio_create(&xdr, fp, XDR_DECODE);
+    std::vector<float> x(3 * natoms);
+    int                size      = natoms;
+    float              precision = 0;
+    EXPECT_EQ(1, codec(&xdr, x.data(), &size, &precision));
+    EXPECT_EQ(natoms, size);
+    xdr_destroy(&xdr);
+    std::fclose(fp);
+    return x;
+}
+
+class XtcCodecTest : public ::testing::TestWithParam<XtcCodecParameters>
+{
+};
+
+TEST_P(XtcCodecTest, MatchesReferenceImplementation)
+{
+    const int   natoms    = std::get<0>(GetParam());
+    const float extent    = std::get<1>(GetParam());
+    const float precision = std::get<2>(GetParam());
+
+    const std::vector<float> x = generateCoordinates(natoms, extent);
+
+    const std::vector<char> stream          = encode(xdr3dfcoord, x, precision);
+    const std::vector<char> referenceStream = encode(xdr3dfcoord_reference, x, precision);
+    ASSERT_EQ(referenceStream, stream);
+
+    const std::vector<float> decoded          = decode(xdr3dfcoord, stream, natoms);
+    const std::vector<float> referenceDecoded = decode(xdr3dfcoord_reference, stream, natoms);
+    EXPECT_EQ(referenceDecoded, decoded);
+    // Besides the rounding to the precision, the conversions between
+    // float and integer coordinates can each be off by one ulp.
+    for (int i = 0; i < 3 * natoms; i++)
+    {
+        EXPECT_NEAR(x[i], decoded[i], 0.5 / precision + 2 * std::abs(x[i]) * GMX_FLOAT_EPS)
+                << "coordinate " << i;
+    }
+}
+
+/* Few atoms are stored uncompressed, small boxes need less than 64 bits
+ * per atom, large ranges with high precision more, and very large ranges
+ * store each coordinate separately. */
+INSTANTIATE_TEST_CASE_P(WithVariousSizes,
+                        XtcCodecTest,
+                        ::testing::Values(XtcCodecParameters{ 3, 5.0, 1000.0 },
+                                          XtcCodecParameters{ 10, 1.0, 10.0 },
+                                          XtcCodecParameters{ 300, 5.0, 1000.0 },
+                                          XtcCodecParameters{ 3000, 50.0, 1000.0 },
+                                          XtcCodecParameters{ 3000, 100.0, 100000.0 },
+                                          XtcCodecParameters{ 3000, 1000.0, 100000.0 }));
+
+TEST(XtcCodecPartialTest, DecodesOnlyMaskedAtoms)
+{
+    const int   natoms    = 300;
+    const float precision = 1000;
+    const int   maskSize  = 150;
+
+    const std::vector<float> x      = generateCoordinates(natoms, 5.0);
+    const std::vector<char>  stream = encode(xdr3dfcoord, x, precision);
+    const std::vector<float> full   = decode(xdr3dfcoord, stream, natoms);
+
+    gmx_bool mask[maskSize] = { FALSE };
+    for (int i = 10; i < 20; i++)
+    {
+        mask[i] = TRUE;
+    }
+    mask[maskSize - 1] = TRUE;
+
+    // Write two frames, to check that the stream is positioned at the
+    // second frame after partially decoding the first one.
+    FILE* fp = std::tmpfile();
+    GMX_RELEASE_ASSERT(fp != nullptr, "Could not open temporary file");
+    std::fwrite(stream.data(), 1, stream.size(), fp);
+    std::fwrite(stream.data(), 1, stream.size(), fp);
+    std::rewind(fp);
+    XDR xdr;
+    xdrstdio_create(&xdr, fp, XDR_DECODE);
+
+    const float        unchanged     = -1;
+    std::vector<float> partial(3 * natoms, unchanged);
+    int                size          = natoms;
+    float              readPrecision = 0;
+    EXPECT_EQ(1, xdr3dfcoord_partial(&xdr, partial.data(), &size, &readPrecision, mask, maskSize));
+    EXPECT_EQ(natoms, size);
+    EXPECT_EQ(precision, readPrecision);
+    for (int i = 0; i < 3 * natoms; i++)
+    {
+        const int atom = i / 3;
+        EXPECT_EQ(atom < maskSize && mask[atom] ? full[i] : unchanged, partial[i])
+                << "coordinate " << i;
+    }
+
+    std::vector<float> next(3 * natoms);
+    size = natoms;
+    EXPECT_EQ(1, xdr3dfcoord(&xdr, next.data(), &size, &readPrecision));
+    EXPECT_EQ(full, next);
+
+    xdr_destroy(&xdr);
+    std::fclose(fp);
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
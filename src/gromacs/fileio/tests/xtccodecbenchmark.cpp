@@ -0,0 +1,137 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief Microbenchmark for the XTC coordinate compression.
+ *
+ * Times encoding and decoding of a water-like system with xdr3dfcoord
+ * and with the reference implementation xdr3dfcoord_reference.
+ *
+ * Usage: xtc-codec-benchmark [natoms [frames]]
+ *
+ * \ingroup module_fileio
+ */
+#include "gmxpre.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include <vector>
+
+#include "gromacs/fileio/xdrf.h"
+#include "gromacs/random/threefry.h"
+#include "gromacs/random/uniformrealdistribution.h"
+
+namespace
+{
+
+//! Signature of xdr3dfcoord and xdr3dfcoord_reference.
+using XtcCodecFunction = int (*)(XDR*, float*, int*, float*);
+
+//! Times writing and reading back \p nframes frames of \p x with \p codec and prints the rates.
+void runBenchmark(const char* name, XtcCodecFunction codec, std::vector<float> x, int nframes)
+{
+    using Clock = std::chrono::steady_clock;
+
+    FILE* fp = std::tmpfile();
+    if (fp == nullptr)
+    {
+        std::fprintf(stderr, "Could not open temporary file\n");
+        std::exit(1);
+    }
+    int   natoms    = x.size() / 3;
+    float precision = 1000;
+    XDR   xdr;
+
+    xdrstdio_create(&xdr, fp, XDR_ENCODE);
+    const auto encodeStart = Clock::now();
+    for (int frame = 0; frame < nframes; frame++)
+    {
+        codec(&xdr, x.data(), &natoms, &precision);
+    }
+    const std::chrono::duration<double> encodeTime = Clock::now() - encodeStart;
+    xdr_destroy(&xdr);
+    const long bytes = std::ftell(fp);
+
+    std::rewind(fp);
+    xdrstdio_create(&xdr, fp, XDR_DECODE);
+    const auto decodeStart = Clock::now();
+    for (int frame = 0; frame < nframes; frame++)
+    {
+        codec(&xdr, x.data(), &natoms, &precision);
+    }
+    const std::chrono::duration<double> decodeTime = Clock::now() - decodeStart;
+    xdr_destroy(&xdr);
+    std::fclose(fp);
+
+    const double atoms = static_cast<double>(natoms) * nframes;
+    std::printf("%-10s %8.2f bytes/atom   encode %8.2f Matoms/s   decode %8.2f Matoms/s\n", name,
+                static_cast<double>(bytes) / atoms, 1e-6 * atoms / encodeTime.count(),
+                1e-6 * atoms / decodeTime.count());
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const int natoms  = (argc > 1) ? std::atoi(argv[1]) : 30000;
+    const int nframes = (argc > 2) ? std::atoi(argv[2]) : 100;
+    if (natoms < 1 || nframes < 1)
+    {
+        std::fprintf(stderr, "Usage: %s [natoms [frames]]\n", argv[0]);
+        return 1;
+    }
+
+    /* Groups of three atoms close to each other in a cubic box */
+    const float                         boxSize = std::cbrt(natoms / 100.0F);
+    gmx::ThreeFry2x64<64>               rng(123456, gmx::RandomDomain::Other);
+    gmx::UniformRealDistribution<float> position(0, boxSize);
+    gmx::UniformRealDistribution<float> bond(-0.1, 0.1);
+    std::vector<float>                  x(3 * natoms);
+    for (int i = 0; i < natoms; i++)
+    {
+        for (int d = 0; d < 3; d++)
+        {
+            x[3 * i + d] = (i % 3 == 0) ? position(rng) : x[3 * (i - 1) + d] + bond(rng);
+        }
+    }
+
+    std::printf("%d atoms, %d frames, precision 1000\n", natoms, nframes);
+    runBenchmark("reference", xdr3dfcoord_reference, x, nframes);
+    runBenchmark("default", xdr3dfcoord, x, nframes);
+
+    return 0;
+}
@@ -0,0 +1,213 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for random access to frames in XTC files.
+ *
+ * \ingroup module_fileio
+ */
+#include "gmxpre.h"
+
+#include "gromacs/fileio/xtcframeindex.h"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/fileio/gmxfio.h"
+#include "gromacs/fileio/oenv.h"
+#include "gromacs/fileio/trxio.h"
+#include "gromacs/fileio/xtcio.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/trajectory/trajectoryframe.h"
+#include "gromacs/utility/futil.h"
+#include "gromacs/utility/smalloc.h"
+
+#include "testutils/testasserts.h"
+#include "testutils/testfilemanager.h"
+
+namespace
+{
+
+//! Test parameter: number of atoms (XTC does not compress up to 9 atoms).
+class XtcFrameIndexTest : public ::testing::TestWithParam<int>
+{
+public:
+    XtcFrameIndexTest() :
+        natoms_(GetParam()),
+        filename_(fileManager_.getTemporaryFilePath("traj.xtc")),
+        // Registered so that the sidecar file is cleaned up after the test.
+        indexFilename_(fileManager_.getTemporaryFilePath("traj.xtc.frameindex"))
+    {
+        output_env_init_default(&oenv_);
+    }
+    ~XtcFrameIndexTest() override { output_env_done(oenv_); }
+
+    //! Coordinates written for \p frame.
+    std::vector<gmx::RVec> coordinates(int frame) const
+    {
+        std::vector<gmx::RVec> x(natoms_);
+        for (int i = 0; i < natoms_; i++)
+        {
+            x[i] = { 0.1F * i, 0.01F * frame, 1.0F };
+        }
+        return x;
+    }
+
+    //! Writes (or appends) frames [\p begin, \p end) with time 2 * frame.
+    void writeFrames(const std::string& filename, int begin, int end, const char* mode)
+    {
+        t_fileio* fio = open_xtc(filename.c_str(), mode);
+        matrix    box = { { 3, 0, 0 }, { 0, 3, 0 }, { 0, 0, 3 } };
+        for (int frame = begin; frame < end; frame++)
+        {
+            std::vector<gmx::RVec> x = coordinates(frame);
+            ASSERT_EQ(1, write_xtc(fio, natoms_, 10 * frame, 2.0 * frame, box, as_rvec_array(x.data()),
+                                   1000));
+        }
+        close_xtc(fio);
+    }
+
+    //! Checks that \p fr contains frame \p frame.
+    void checkFrame(const t_trxframe& fr, int frame) const
+    {
+        EXPECT_EQ(10 * frame, fr.step);
+        EXPECT_EQ(2.0 * frame, fr.time);
+        std::vector<gmx::RVec> x = coordinates(frame);
+        for (int i = 0; i < natoms_; i++)
+        {
+            EXPECT_NEAR(x[i][YY], fr.x[i][YY], 1e-3);
+        }
+    }
+
+    gmx::test::TestFileManager fileManager_;
+    int                        natoms_;
+    std::string                filename_;
+    std::string                indexFilename_;
+    gmx_output_env_t*          oenv_;
+};
+
+TEST_P(XtcFrameIndexTest, ReadsFramesByIndex)
+{
+    writeFrames(filename_, 0, 5, "w");
+
+    t_trxstatus* status;
+    t_trxframe   fr;
+    ASSERT_TRUE(read_first_frame(oenv_, &status, filename_.c_str(), &fr, TRX_NEED_X));
+    EXPECT_EQ(5, trx_get_frame_count(status));
+    // The index is only stored on request.
+    EXPECT_FALSE(gmx_fexist(indexFilename_));
+
+    ASSERT_TRUE(read_frame_at(status, 3, &fr));
+    checkFrame(fr, 3);
+    ASSERT_TRUE(read_frame_at(status, 0, &fr));
+    checkFrame(fr, 0);
+    // Sequential reading continues after the frame read by index.
+    ASSERT_TRUE(read_next_frame(oenv_, status, &fr));
+    checkFrame(fr, 1);
+    EXPECT_FALSE(read_frame_at(status, 5, &fr));
+
+    close_trx(status);
+    sfree(fr.x);
+}
+
+TEST_P(XtcFrameIndexTest, WritesIndexOnRequest)
+{
+    writeFrames(filename_, 0, 5, "w");
+
+    t_trxstatus* status;
+    t_trxframe   fr;
+    ASSERT_TRUE(read_first_frame(oenv_, &status, filename_.c_str(), &fr, TRX_NEED_X));
+    EXPECT_TRUE(write_xtc_frame_index(status));
+    EXPECT_TRUE(gmx_fexist(indexFilename_));
+    // Writing the index does not change the reading position.
+    ASSERT_TRUE(read_next_frame(oenv_, status, &fr));
+    checkFrame(fr, 1);
+    close_trx(status);
+    sfree(fr.x);
+
+    // A new reader uses the stored index.
+    ASSERT_TRUE(read_first_frame(oenv_, &status, filename_.c_str(), &fr, TRX_NEED_X));
+    EXPECT_EQ(5, trx_get_frame_count(status));
+    ASSERT_TRUE(read_frame_at(status, 4, &fr));
+    checkFrame(fr, 4);
+    close_trx(status);
+    sfree(fr.x);
+}
+
+TEST_P(XtcFrameIndexTest, ReusesAndExtendsStoredIndex)
+{
+    writeFrames(filename_, 0, 4, "w");
+    {
+        t_fileio*          fio = open_xtc(filename_.c_str(), "r");
+        gmx::XtcFrameIndex index(natoms_);
+        EXPECT_FALSE(index.readSidecar(indexFilename_, fio));
+        EXPECT_TRUE(index.extend(fio));
+        EXPECT_EQ(4, index.frameCount());
+        EXPECT_EQ(0, index.frame(0).offset);
+        EXPECT_EQ(0, gmx_fio_ftell(fio));
+        EXPECT_TRUE(index.writeSidecar(indexFilename_));
+        close_xtc(fio);
+    }
+
+    writeFrames(filename_, 4, 6, "a");
+    t_fileio*          fio = open_xtc(filename_.c_str(), "r");
+    gmx::XtcFrameIndex index(natoms_);
+    EXPECT_TRUE(index.readSidecar(indexFilename_, fio));
+    EXPECT_EQ(4, index.frameCount());
+    EXPECT_TRUE(index.extend(fio));
+    ASSERT_EQ(6, index.frameCount());
+    for (int frame = 0; frame < index.frameCount(); frame++)
+    {
+        EXPECT_EQ(10 * frame, index.frame(frame).step);
+    }
+    EXPECT_EQ(2, index.findFrameAtTime(3.0));
+    EXPECT_EQ(2, index.findFrameAtTime(4.0));
+    EXPECT_EQ(6, index.findFrameAtTime(100.0));
+
+    // A stored index that does not match the trajectory is rejected.
+    close_xtc(fio);
+    const std::string otherFilename = fileManager_.getTemporaryFilePath("other.xtc");
+    writeFrames(otherFilename, 1, 3, "w");
+    fio = open_xtc(otherFilename.c_str(), "r");
+    EXPECT_FALSE(index.readSidecar(indexFilename_, fio));
+    EXPECT_EQ(0, index.frameCount());
+    close_xtc(fio);
+}
+
+INSTANTIATE_TEST_CASE_P(WithAndWithoutCompression, XtcFrameIndexTest, ::testing::Values(5, 50));
+
+} // namespace
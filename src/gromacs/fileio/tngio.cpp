@@ -41,8 +41,14 @@
 #include <cmath>
 
 #include <algorithm>
+#include <condition_variable>
 #include <iterator>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #if GMX_USE_TNG
@@ -69,6 +75,103 @@
 using tng_trajectory_t = void*;
 #endif
 
+namespace
+{
+
+#if GMX_USE_TNG
+/*! \brief Values of one data block of a TNG frame set
+ *
+ * Holds the values as read from the file, converted only when a frame is
+ * returned. */
+struct TngFrameSetBlock
+{
+    //! TNG block ID
+    int64_t blockId = 0;
+    //! TNG data type of the values
+    char datatype = 0;
+    //! Number of frames between frames with stored values
+    int64_t stride = 1;
+    //! Number of frames with stored values
+    int64_t numStoredFrames = 0;
+    //! Size in bytes of the values of one frame
+    size_t frameSize = 0;
+    //! Values of all stored frames
+    std::vector<char> values;
+    //! Compression codec of the block
+    int64_t codecId = -1;
+    //! Precision of the compression
+    double precision = 0;
+};
+
+//! Data blocks of one TNG frame set
+struct TngFrameSet
+{
+    //! False after the last frame set
+    bool exists = false;
+    //! Number of the first frame in the set
+    int64_t firstFrame = 0;
+    //! Number of frames in the set
+    int64_t numFrames = 0;
+    //! Time of the first frame, negative if not known
+    double firstFrameTime = -1;
+    //! Time between frames
+    double timePerFrame = -1;
+    //! Blocks found in the set
+    std::vector<TngFrameSetBlock> blocks;
+};
+
+/*! \brief Reads and decompresses TNG frame sets in worker threads
+ *
+ * Frame sets are independently compressed, so each worker thread opens
+ * its own handle to the file and reads every numThreads'th frame set,
+ * staying at most a few frame sets ahead of the consumer. Only the
+ * requested data blocks are read.
+ */
+class TngParallelReader
+{
+public:
+    TngParallelReader(const std::string& filename, int numThreads, std::vector<int64_t> blockIds);
+    ~TngParallelReader();
+
+    /*! \brief Finds the next frame with data in any of the blocks
+     *
+     * Returns false after the last frame. Otherwise \p frame is set to
+     * the number of the frame and \p frameSet to the set that contains
+     * it, valid until the next call. */
+    bool nextFrame(const TngFrameSet** frameSet, int64_t* frame);
+
+private:
+    //! Returns the next frame set, waiting for a worker to read it if needed.
+    TngFrameSet takeNextFrameSet();
+    //! Reads frame sets starting from \p first in steps of the number of threads.
+    void readFrameSets(tng_trajectory_t tng, int64_t first);
+    //! Reads frame set \p index using \p tng.
+    TngFrameSet readFrameSet(tng_trajectory_t tng, int64_t index) const;
+
+    std::vector<int64_t>              blockIds_;
+    std::vector<gmx_tng_trajectory_t> handles_;
+    std::vector<std::thread>          threads_;
+    std::mutex                        mutex_;
+    std::condition_variable           cond_;
+    //! Frame sets read, but not yet returned, by index
+    std::map<int64_t, TngFrameSet> ready_;
+    //! Index of the next frame set to return
+    int64_t nextIndex_ = 0;
+    //! Number of frame sets the workers may read ahead
+    int64_t maxAhead_;
+    //! Whether the workers should stop
+    bool bStop_ = false;
+    //! Whether the last frame set has been taken
+    bool bFinished_ = false;
+    //! The frame set frames are returned from
+    TngFrameSet current_;
+    //! Number of the frame after the one last returned
+    int64_t nextFrame_ = 0;
+};
+#endif
+
+} // namespace
+
 /*! \brief Gromacs Wrapper around tng datatype
  *
  * This could in principle hold any GROMACS-specific requirements not yet
@@ -94,6 +197,13 @@ struct gmx_tng_trajectory
     bool             timePerFrameIsSet;    //!< True if we have set the time per frame
     int              boxOutputInterval;    //!< Number of steps between the output of box size
     int              lambdaOutputInterval; //!< Number of steps between the output of lambdas
+    std::string      filename;             //!< Name of the file
+    //! Blocks to read when gmx_read_next_tng_frame() is not given any
+    std::vector<int64_t> defaultReadBlockIds;
+#if GMX_USE_TNG
+    //! Reader for decompressing frame sets in worker threads, can be null
+    std::unique_ptr<TngParallelReader> parallelReader;
+#endif
 };
 
 #if GMX_USE_TNG
@@ -126,6 +236,7 @@ void gmx_tng_open(const char* filename, char mode, gmx_tng_trajectory_t* gmx_tng
     (*gmx_tng)->lastStepDataIsValid = false;
     (*gmx_tng)->lastTimeDataIsValid = false;
     (*gmx_tng)->timePerFrameIsSet   = false;
+    (*gmx_tng)->filename            = filename;
     tng_trajectory_t* tng           = &(*gmx_tng)->tng;
 
     /* tng must not be pointing at already allocated memory.
@@ -202,6 +313,8 @@ void gmx_tng_close(gmx_tng_trajectory_t* gmx_tng)
     }
     tng_trajectory_t* tng = &(*gmx_tng)->tng;
 
+    // Stop the workers before closing the file they read from.
+    (*gmx_tng)->parallelReader.reset();
     if (tng)
     {
         tng_util_trajectory_close(tng);
@@ -1195,6 +1308,266 @@ real getDistanceScaleFactor(gmx_tng_trajectory_t in)
 
     return distanceScaleFactor;
 }
+
+/*! \brief Stores the values of block \p blockId of a frame in \p fr
+ *
+ * \p codecId and \p prec describe the compression of positions and
+ * velocities. */
+void storeTngBlockValues(gmx_tng_trajectory_t gmx_tng_input,
+                         t_trxframe*          fr,
+                         int64_t              blockId,
+                         void*                values,
+                         char                 datatype,
+                         int64_t              codecId,
+                         double               prec)
+{
+    int size;
+
+    switch (blockId)
+    {
+        case TNG_TRAJ_BOX_SHAPE:
+            switch (datatype)
+            {
+                case TNG_INT_DATA: size = sizeof(int64_t); break;
+                case TNG_FLOAT_DATA: size = sizeof(float); break;
+                case TNG_DOUBLE_DATA: size = sizeof(double); break;
+                default: gmx_incons("Illegal datatype of box shape values!");
+            }
+            for (int i = 0; i < DIM; i++)
+            {
+                convert_array_to_real_array(reinterpret_cast<char*>(values) + size * i * DIM,
+                                            reinterpret_cast<real*>(fr->box[i]),
+                                            getDistanceScaleFactor(gmx_tng_input), 1, DIM,
+                                            datatype);
+            }
+            fr->bBox = TRUE;
+            break;
+        case TNG_TRAJ_POSITIONS:
+            srenew(fr->x, fr->natoms);
+            convert_array_to_real_array(values, reinterpret_cast<real*>(fr->x),
+                                        getDistanceScaleFactor(gmx_tng_input), fr->natoms, DIM,
+                                        datatype);
+            fr->bX = TRUE;
+            /* This must be updated if/when more lossy compression methods are added */
+            if (codecId == TNG_TNG_COMPRESSION)
+            {
+                fr->prec  = prec;
+                fr->bPrec = TRUE;
+            }
+            break;
+        case TNG_TRAJ_VELOCITIES:
+            srenew(fr->v, fr->natoms);
+            convert_array_to_real_array(values, reinterpret_cast<real*>(fr->v),
+                                        getDistanceScaleFactor(gmx_tng_input), fr->natoms, DIM,
+                                        datatype);
+            fr->bV = TRUE;
+            /* This must be updated if/when more lossy compression methods are added */
+            if (codecId == TNG_TNG_COMPRESSION)
+            {
+                fr->prec  = prec;
+                fr->bPrec = TRUE;
+            }
+            break;
+        case TNG_TRAJ_FORCES:
+            srenew(fr->f, fr->natoms);
+            convert_array_to_real_array(values, reinterpret_cast<real*>(fr->f),
+                                        getDistanceScaleFactor(gmx_tng_input), fr->natoms, DIM,
+                                        datatype);
+            fr->bF = TRUE;
+            break;
+        case TNG_GMX_LAMBDA:
+            switch (datatype)
+            {
+                case TNG_FLOAT_DATA: fr->lambda = *(reinterpret_cast<float*>(values)); break;
+                case TNG_DOUBLE_DATA: fr->lambda = *(reinterpret_cast<double*>(values)); break;
+                default: gmx_incons("Illegal datatype lambda value!");
+            }
+            fr->bLambda = TRUE;
+            break;
+        default:
+            gmx_warning(
+                    "Illegal block type! Currently GROMACS tools can only handle certain data "
+                    "types. Skipping block.");
+    }
+}
+
+TngParallelReader::TngParallelReader(const std::string&   filename,
+                                     int                  numThreads,
+                                     std::vector<int64_t> blockIds) :
+    blockIds_(std::move(blockIds)),
+    maxAhead_(2 * numThreads)
+{
+    handles_.resize(numThreads);
+    for (auto& handle : handles_)
+    {
+        gmx_tng_open(filename.c_str(), 'r', &handle);
+    }
+    for (int thread = 0; thread < numThreads; thread++)
+    {
+        threads_.emplace_back(&TngParallelReader::readFrameSets, this, handles_[thread]->tng,
+                              thread);
+    }
+}
+
+TngParallelReader::~TngParallelReader()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        bStop_ = true;
+    }
+    cond_.notify_all();
+    for (auto& thread : threads_)
+    {
+        thread.join();
+    }
+    for (auto& handle : handles_)
+    {
+        gmx_tng_close(&handle);
+    }
+}
+
+bool TngParallelReader::nextFrame(const TngFrameSet** frameSet, int64_t* frame)
+{
+    while (true)
+    {
+        if (current_.exists)
+        {
+            const int64_t endFrame = current_.firstFrame + current_.numFrames;
+            for (int64_t i = std::max(nextFrame_, current_.firstFrame); i < endFrame; i++)
+            {
+                const int64_t offset = i - current_.firstFrame;
+                for (const TngFrameSetBlock& block : current_.blocks)
+                {
+                    if (offset % block.stride == 0 && offset / block.stride < block.numStoredFrames)
+                    {
+                        nextFrame_ = i + 1;
+                        *frameSet  = &current_;
+                        *frame     = i;
+                        return true;
+                    }
+                }
+            }
+        }
+        if (bFinished_)
+        {
+            return false;
+        }
+        current_ = takeNextFrameSet();
+    }
+}
+
+TngFrameSet TngParallelReader::takeNextFrameSet()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [this] { return ready_.count(nextIndex_) > 0; });
+    auto        entry    = ready_.find(nextIndex_);
+    TngFrameSet frameSet = std::move(entry->second);
+    ready_.erase(entry);
+    nextIndex_++;
+    bFinished_ = !frameSet.exists;
+    lock.unlock();
+    cond_.notify_all();
+    return frameSet;
+}
+
+void TngParallelReader::readFrameSets(tng_trajectory_t tng, int64_t first)
+{
+    const int64_t numThreads = handles_.size();
+    for (int64_t index = first;; index += numThreads)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cond_.wait(lock, [this, index] { return bStop_ || index < nextIndex_ + maxAhead_; });
+            if (bStop_)
+            {
+                return;
+            }
+        }
+        TngFrameSet frameSet = readFrameSet(tng, index);
+        const bool  bExists  = frameSet.exists;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ready_[index] = std::move(frameSet);
+        }
+        cond_.notify_all();
+        if (!bExists)
+        {
+            return;
+        }
+    }
+}
+
+TngFrameSet TngParallelReader::readFrameSet(tng_trajectory_t tng, int64_t index) const
+{
+    TngFrameSet                frameSet;
+    tng_trajectory_frame_set_t tngFrameSet;
+    int64_t                    lastFrame;
+    if (tng_frame_set_nr_find(tng, index) != TNG_SUCCESS
+        || tng_current_frame_set_get(tng, &tngFrameSet) != TNG_SUCCESS
+        || tng_frame_set_frame_range_get(tng, tngFrameSet, &frameSet.firstFrame, &lastFrame)
+                   != TNG_SUCCESS)
+    {
+        return frameSet;
+    }
+    frameSet.exists    = true;
+    frameSet.numFrames = lastFrame - frameSet.firstFrame + 1;
+    if (tng_time_per_frame_get(tng, &frameSet.timePerFrame) != TNG_SUCCESS
+        || tng_util_time_of_frame_get(tng, frameSet.firstFrame, &frameSet.firstFrameTime)
+                   != TNG_SUCCESS)
+    {
+        frameSet.firstFrameTime = -1;
+    }
+
+    for (int64_t blockId : blockIds_)
+    {
+        int blockDependency;
+        if (tng_data_block_dependency_get(tng, blockId, &blockDependency) != TNG_SUCCESS
+            || tng_frame_set_read_current_only_data_from_block_id(tng, TNG_USE_HASH, blockId)
+                       != TNG_SUCCESS)
+        {
+            continue;
+        }
+        TngFrameSetBlock block;
+        block.blockId = blockId;
+        void*               values = nullptr;
+        int64_t             numFrames, numParticles = 1, numValuesPerFrame;
+        tng_function_status stat;
+        if (blockDependency & TNG_PARTICLE_DEPENDENT)
+        {
+            stat = tng_particle_data_vector_get(tng, blockId, &values, &numFrames, &block.stride,
+                                                &numParticles, &numValuesPerFrame, &block.datatype);
+        }
+        else
+        {
+            stat = tng_data_vector_get(tng, blockId, &values, &numFrames, &block.stride,
+                                       &numValuesPerFrame, &block.datatype);
+        }
+        gmx::unique_cptr<void, gmx::free_wrapper> valuesGuard(values);
+        if (stat != TNG_SUCCESS)
+        {
+            continue;
+        }
+        size_t valueSize;
+        switch (block.datatype)
+        {
+            case TNG_INT_DATA: valueSize = sizeof(int64_t); break;
+            case TNG_FLOAT_DATA: valueSize = sizeof(float); break;
+            case TNG_DOUBLE_DATA: valueSize = sizeof(double); break;
+            default: continue;
+        }
+        block.stride          = std::max<int64_t>(block.stride, 1);
+        block.numStoredFrames = (numFrames + block.stride - 1) / block.stride;
+        block.frameSize       = valueSize * numParticles * numValuesPerFrame;
+        const char* begin     = static_cast<const char*>(values);
+        block.values.assign(begin, begin + block.numStoredFrames * block.frameSize);
+        if (blockId == TNG_TRAJ_POSITIONS || blockId == TNG_TRAJ_VELOCITIES)
+        {
+            tng_util_frame_current_compression_get(tng, blockId, &block.codecId, &block.precision);
+        }
+        frameSet.blocks.push_back(std::move(block));
+    }
+    return frameSet;
+}
 #endif
 
 } // namespace
@@ -1306,7 +1679,7 @@ gmx_bool gmx_read_next_tng_frame(gmx_tng_trajectory_t gmx_tng_input,
     char                datatype  = -1;
     void*               values    = nullptr;
     double              frameTime = -1.0;
-    int                 size, blockDependency;
+    int                 blockDependency;
     double              prec;
     const int           defaultNumIds                  = 5;
     static int64_t fallbackRequestedIds[defaultNumIds] = { TNG_TRAJ_BOX_SHAPE, TNG_TRAJ_POSITIONS,
@@ -1324,12 +1697,20 @@ gmx_bool gmx_read_next_tng_frame(gmx_tng_trajectory_t gmx_tng_input,
     fr->bF      = FALSE;
     fr->bBox    = FALSE;
 
-    /* If no specific IDs were requested read all block types that can
-     * currently be interpreted */
+    /* If no specific IDs were requested read the default blocks, or
+     * otherwise all block types that can currently be interpreted */
     if (!requestedIds || numRequestedIds == 0)
     {
-        numRequestedIds = defaultNumIds;
-        requestedIds    = fallbackRequestedIds;
+        if (!gmx_tng_input->defaultReadBlockIds.empty())
+        {
+            numRequestedIds = gmx_tng_input->defaultReadBlockIds.size();
+            requestedIds    = gmx_tng_input->defaultReadBlockIds.data();
+        }
+        else
+        {
+            numRequestedIds = defaultNumIds;
+            requestedIds    = fallbackRequestedIds;
+        }
     }
 
     stat = tng_num_particles_get(input, &numberOfAtoms);
@@ -1339,111 +1720,83 @@ gmx_bool gmx_read_next_tng_frame(gmx_tng_trajectory_t gmx_tng_input,
     }
     fr->natoms = numberOfAtoms;
 
-    bool nextFrameExists = gmx_get_tng_data_block_types_of_next_frame(
-            gmx_tng_input, fr->step, numRequestedIds, requestedIds, &frameNumber, &nBlocks, &blockIds);
-    gmx::unique_cptr<int64_t, gmx::free_wrapper> blockIdsGuard(blockIds);
-    if (!nextFrameExists)
+    if (gmx_tng_input->parallelReader)
     {
-        return FALSE;
-    }
-
-    if (nBlocks == 0)
-    {
-        return FALSE;
-    }
-
-    for (int64_t i = 0; i < nBlocks; i++)
-    {
-        blockId = blockIds[i];
-        tng_data_block_dependency_get(input, blockId, &blockDependency);
-        if (blockDependency & TNG_PARTICLE_DEPENDENT)
+        GMX_RELEASE_ASSERT(requestedIds == gmx_tng_input->defaultReadBlockIds.data()
+                                   || (requestedIds == fallbackRequestedIds
+                                       && gmx_tng_input->defaultReadBlockIds.empty()),
+                           "Only the default blocks can be read with parallel reading");
+        const TngFrameSet* frameSet = nullptr;
+        if (!gmx_tng_input->parallelReader->nextFrame(&frameSet, &frameNumber))
         {
-            stat = tng_util_particle_data_next_frame_read(input, blockId, &values, &datatype,
-                                                          &frameNumber, &frameTime);
+            return FALSE;
         }
-        else
+        const int64_t offset = frameNumber - frameSet->firstFrame;
+        for (const TngFrameSetBlock& block : frameSet->blocks)
         {
-            stat = tng_util_non_particle_data_next_frame_read(input, blockId, &values, &datatype,
-                                                              &frameNumber, &frameTime);
+            if (offset % block.stride == 0 && offset / block.stride < block.numStoredFrames)
+            {
+                void* frameValues = const_cast<char*>(block.values.data())
+                                    + (offset / block.stride) * block.frameSize;
+                storeTngBlockValues(gmx_tng_input, fr, block.blockId, frameValues, block.datatype,
+                                    block.codecId, block.precision);
+            }
+        }
+        frameTime = 0;
+        if (frameSet->firstFrameTime >= 0 && frameSet->timePerFrame >= 0)
+        {
+            frameTime = frameSet->firstFrameTime + offset * frameSet->timePerFrame;
         }
-        if (stat == TNG_CRITICAL)
+    }
+    else
+    {
+        bool nextFrameExists = gmx_get_tng_data_block_types_of_next_frame(
+                gmx_tng_input, fr->step, numRequestedIds, requestedIds, &frameNumber, &nBlocks,
+                &blockIds);
+        gmx::unique_cptr<int64_t, gmx::free_wrapper> blockIdsGuard(blockIds);
+        if (!nextFrameExists)
         {
-            gmx_file("Cannot read positions from TNG file.");
             return FALSE;
         }
-        else if (stat == TNG_FAILURE)
+
+        if (nBlocks == 0)
         {
-            continue;
+            return FALSE;
         }
-        switch (blockId)
+
+        for (int64_t i = 0; i < nBlocks; i++)
         {
-            case TNG_TRAJ_BOX_SHAPE:
-                switch (datatype)
-                {
-                    case TNG_INT_DATA: size = sizeof(int64_t); break;
-                    case TNG_FLOAT_DATA: size = sizeof(float); break;
-                    case TNG_DOUBLE_DATA: size = sizeof(double); break;
-                    default: gmx_incons("Illegal datatype of box shape values!");
-                }
-                for (int i = 0; i < DIM; i++)
-                {
-                    convert_array_to_real_array(reinterpret_cast<char*>(values) + size * i * DIM,
-                                                reinterpret_cast<real*>(fr->box[i]),
-                                                getDistanceScaleFactor(gmx_tng_input), 1, DIM, datatype);
-                }
-                fr->bBox = TRUE;
-                break;
-            case TNG_TRAJ_POSITIONS:
-                srenew(fr->x, fr->natoms);
-                convert_array_to_real_array(values, reinterpret_cast<real*>(fr->x),
-                                            getDistanceScaleFactor(gmx_tng_input), fr->natoms, DIM,
-                                            datatype);
-                fr->bX = TRUE;
-                tng_util_frame_current_compression_get(input, blockId, &codecId, &prec);
-                /* This must be updated if/when more lossy compression methods are added */
-                if (codecId == TNG_TNG_COMPRESSION)
-                {
-                    fr->prec  = prec;
-                    fr->bPrec = TRUE;
-                }
-                break;
-            case TNG_TRAJ_VELOCITIES:
-                srenew(fr->v, fr->natoms);
-                convert_array_to_real_array(values, reinterpret_cast<real*>(fr->v),
-                                            getDistanceScaleFactor(gmx_tng_input), fr->natoms, DIM,
-                                            datatype);
-                fr->bV = TRUE;
+            blockId = blockIds[i];
+            tng_data_block_dependency_get(input, blockId, &blockDependency);
+            if (blockDependency & TNG_PARTICLE_DEPENDENT)
+            {
+                stat = tng_util_particle_data_next_frame_read(input, blockId, &values, &datatype,
+                                                              &frameNumber, &frameTime);
+            }
+            else
+            {
+                stat = tng_util_non_particle_data_next_frame_read(
+                        input, blockId, &values, &datatype, &frameNumber, &frameTime);
+            }
+            if (stat == TNG_CRITICAL)
+            {
+                gmx_file("Cannot read positions from TNG file.");
+                return FALSE;
+            }
+            else if (stat == TNG_FAILURE)
+            {
+                continue;
+            }
+            codecId = -1;
+            prec    = 0;
+            if (blockId == TNG_TRAJ_POSITIONS || blockId == TNG_TRAJ_VELOCITIES)
+            {
                 tng_util_frame_current_compression_get(input, blockId, &codecId, &prec);
-                /* This must be updated if/when more lossy compression methods are added */
-                if (codecId == TNG_TNG_COMPRESSION)
-                {
-                    fr->prec  = prec;
-                    fr->bPrec = TRUE;
-                }
-                break;
-            case TNG_TRAJ_FORCES:
-                srenew(fr->f, fr->natoms);
-                convert_array_to_real_array(values, reinterpret_cast<real*>(fr->f),
-                                            getDistanceScaleFactor(gmx_tng_input), fr->natoms, DIM,
-                                            datatype);
-                fr->bF = TRUE;
-                break;
-            case TNG_GMX_LAMBDA:
-                switch (datatype)
-                {
-                    case TNG_FLOAT_DATA: fr->lambda = *(reinterpret_cast<float*>(values)); break;
-                    case TNG_DOUBLE_DATA: fr->lambda = *(reinterpret_cast<double*>(values)); break;
-                    default: gmx_incons("Illegal datatype lambda value!");
-                }
-                fr->bLambda = TRUE;
-                break;
-            default:
-                gmx_warning(
-                        "Illegal block type! Currently GROMACS tools can only handle certain data "
-                        "types. Skipping block.");
+            }
+            storeTngBlockValues(gmx_tng_input, fr, blockId, values, datatype, codecId, prec);
+            /* values does not have to be freed before reading next frame. It will
+             * be reallocated if it is not NULL. */
         }
-        /* values does not have to be freed before reading next frame. It will
-         * be reallocated if it is not NULL. */
     }
 
     fr->step  = frameNumber;
@@ -1467,6 +1820,54 @@ gmx_bool gmx_read_next_tng_frame(gmx_tng_trajectory_t gmx_tng_input,
 #endif
 }
 
+void gmx_tng_set_read_blocks(gmx_tng_trajectory_t input, bool readX, bool readV, bool readF)
+{
+#if GMX_USE_TNG
+    input->defaultReadBlockIds.clear();
+    if (!readX && !readV && !readF)
+    {
+        return;
+    }
+    input->defaultReadBlockIds.push_back(TNG_TRAJ_BOX_SHAPE);
+    if (readX)
+    {
+        input->defaultReadBlockIds.push_back(TNG_TRAJ_POSITIONS);
+    }
+    if (readV)
+    {
+        input->defaultReadBlockIds.push_back(TNG_TRAJ_VELOCITIES);
+    }
+    if (readF)
+    {
+        input->defaultReadBlockIds.push_back(TNG_TRAJ_FORCES);
+    }
+    input->defaultReadBlockIds.push_back(TNG_GMX_LAMBDA);
+#else
+    GMX_UNUSED_VALUE(input);
+    GMX_UNUSED_VALUE(readX);
+    GMX_UNUSED_VALUE(readV);
+    GMX_UNUSED_VALUE(readF);
+#endif
+}
+
+void gmx_tng_start_parallel_reading(gmx_tng_trajectory_t input, int numThreads)
+{
+#if GMX_USE_TNG
+    GMX_RELEASE_ASSERT(numThreads > 0, "Need at least one thread for reading");
+    std::vector<int64_t> blockIds = input->defaultReadBlockIds;
+    if (blockIds.empty())
+    {
+        blockIds = { TNG_TRAJ_BOX_SHAPE, TNG_TRAJ_POSITIONS, TNG_TRAJ_VELOCITIES, TNG_TRAJ_FORCES,
+                     TNG_GMX_LAMBDA };
+    }
+    input->parallelReader =
+            std::make_unique<TngParallelReader>(input->filename, numThreads, std::move(blockIds));
+#else
+    GMX_UNUSED_VALUE(input);
+    GMX_UNUSED_VALUE(numThreads);
+#endif
+}
+
 void gmx_print_tng_molecule_system(gmx_tng_trajectory_t gmx_tng_input, FILE* stream)
 {
 #if GMX_USE_TNG
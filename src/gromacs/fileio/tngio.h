@@ -172,6 +172,33 @@ gmx_bool gmx_read_next_tng_frame(gmx_tng_trajectory_t input,
                                  int64_t*             requestedIds,
                                  int                  numRequestedIds);
 
+/*! \brief Sets the data blocks that gmx_read_next_tng_frame() reads by default.
+ *
+ * \param input  Valid handle to a TNG trajectory opened for reading
+ * \param readX  Whether to read positions
+ * \param readV  Whether to read velocities
+ * \param readF  Whether to read forces
+ *
+ * The box and lambda are read in any case. Frame sets are compressed
+ * per block, so blocks that are not read are also not decompressed.
+ * If none of \p readX, \p readV and \p readF is set, all blocks that
+ * GROMACS can interpret are read, which is also the default. */
+void gmx_tng_set_read_blocks(gmx_tng_trajectory_t input, bool readX, bool readV, bool readF);
+
+/*! \brief Reads and decompresses upcoming frame sets in worker threads.
+ *
+ * \param input       Valid handle to a TNG trajectory opened for reading,
+ *                    from which no frames have been read yet
+ * \param numThreads  Number of worker threads
+ *
+ * TNG frame sets are compressed independently, so after this call each
+ * worker opens the file separately and reads and decompresses every
+ * numThreads'th frame set, a few frame sets ahead of the frames that
+ * gmx_read_next_tng_frame() returns. Only the blocks set with
+ * gmx_tng_set_read_blocks() are read, and gmx_read_next_tng_frame()
+ * must then be called without requesting specific blocks. */
+void gmx_tng_start_parallel_reading(gmx_tng_trajectory_t input, int numThreads);
+
 /*! \brief Print the molecule system to stream */
 void gmx_print_tng_molecule_system(gmx_tng_trajectory_t input, FILE* stream);
 
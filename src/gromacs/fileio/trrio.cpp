@@ -41,6 +41,8 @@
 
 #include <cstring>
 
+#include <atomic>
+
 #include "gromacs/fileio/gmxfio.h"
 #include "gromacs/fileio/gmxfio_xdr.h"
 #include "gromacs/mdtypes/md_enums.h"
@@ -93,10 +95,11 @@ static int nFloatSize(gmx_trr_header_t* sh)
    overhaul before we can handle that. */
 static gmx_bool do_trr_frame_header(t_fileio* fio, bool bRead, gmx_trr_header_t* sh, gmx_bool* bOK)
 {
-    const int       magicValue = 1993;
-    int             magic      = magicValue;
-    static gmx_bool bFirst     = TRUE;
-    char            buf[256];
+    const int magicValue = 1993;
+    int       magic      = magicValue;
+    /* Frame headers can be read by multiple threads, e.g. in gmx trjcat */
+    static std::atomic<bool> s_reportedVersion(false);
+    char                     buf[256];
 
     *bOK = TRUE;
 
@@ -119,10 +122,6 @@ static gmx_bool do_trr_frame_header(t_fileio* fio, bool bRead, gmx_trr_header_t*
     if (bRead)
     {
         *bOK = *bOK && gmx_fio_do_string(fio, buf);
-        if (bFirst)
-        {
-            fprintf(stderr, "trr version: %s ", buf);
-        }
     }
     else
     {
@@ -148,10 +147,9 @@ static gmx_bool do_trr_frame_header(t_fileio* fio, bool bRead, gmx_trr_header_t*
     sh->bDouble = (nFloatSize(sh) == sizeof(double));
     gmx_fio_setprecision(fio, sh->bDouble);
 
-    if (bRead && bFirst)
+    if (bRead && !s_reportedVersion.exchange(true))
     {
-        fprintf(stderr, "(%s precision)\n", sh->bDouble ? "double" : "single");
-        bFirst = FALSE;
+        fprintf(stderr, "trr version: %s (%s precision)\n", buf, sh->bDouble ? "double" : "single");
     }
 
     /* Note that TRR wasn't defined to be extensible, so we can't fix
@@ -43,8 +43,13 @@
 
 #include <cassert>
 #include <cmath>
+#include <cstdlib>
 #include <cstring>
 
+#include <algorithm>
+#include <memory>
+#include <string>
+
 #include "gromacs/fileio/checkpoint.h"
 #include "gromacs/fileio/confio.h"
 #include "gromacs/fileio/filetypes.h"
@@ -52,6 +57,7 @@
 #include "gromacs/fileio/gmxfio.h"
 #include "gromacs/fileio/gmxfio_xdr.h"
 #include "gromacs/fileio/groio.h"
+#include "gromacs/fileio/mappedtrrfile.h"
 #include "gromacs/fileio/oenv.h"
 #include "gromacs/fileio/pdbio.h"
 #include "gromacs/fileio/timecontrol.h"
@@ -59,6 +65,7 @@
 #include "gromacs/fileio/tpxio.h"
 #include "gromacs/fileio/trrio.h"
 #include "gromacs/fileio/xdrf.h"
+#include "gromacs/fileio/xtcframeindex.h"
 #include "gromacs/fileio/xtcio.h"
 #include "gromacs/math/vec.h"
 #include "gromacs/mdtypes/md_enums.h"
@@ -66,6 +73,7 @@
 #include "gromacs/topology/symtab.h"
 #include "gromacs/topology/topology.h"
 #include "gromacs/trajectory/trajectoryframe.h"
+#include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/futil.h"
 #include "gromacs/utility/gmxassert.h"
@@ -94,6 +102,9 @@ struct t_trxstatus
     double               DT, BOX[3];
     gmx_bool             bReadBox;
     char*                persistent_line; /* Persistent line for reading g96 trajectories */
+    gmx::XtcFrameIndex*  xtcIndex;        /* Frame index for XTC files, loaded on demand */
+    gmx::MappedTrrFile*  mappedTrr;       /* Memory map of a TRR file being read, can be NULL */
+    int                  mappedTrrFrame;  /* The next frame to read from mappedTrr */
 #if GMX_USE_PLUGINS
     gmx_vmdplugin_t* vmdplugin;
 #endif
@@ -167,6 +178,9 @@ static void status_init(t_trxstatus* status)
     status->tf              = 0;
     status->persistent_line = nullptr;
     status->tng             = nullptr;
+    status->xtcIndex        = nullptr;
+    status->mappedTrr       = nullptr;
+    status->mappedTrrFrame  = 0;
 }
 
 
@@ -604,6 +618,8 @@ void close_trx(t_trxstatus* status)
         gmx_fio_close(status->fio);
     }
     sfree(status->persistent_line);
+    delete status->xtcIndex;
+    delete status->mappedTrr;
 #if GMX_USE_PLUGINS
     sfree(status->vmdplugin);
 #endif
@@ -629,11 +645,84 @@ t_trxstatus* open_trx(const char* outfile, const char* filemode)
     return stat;
 }
 
+/* Converts the mapped vectors to *dest, allocating *dest when needed */
+static void copy_mapped_vectors(const gmx::MappedTrrVectors& vectors, int natoms, rvec** dest)
+{
+    if (*dest == nullptr)
+    {
+        snew(*dest, natoms);
+    }
+    if (!vectors.empty())
+    {
+        vectors.copyTo(gmx::arrayRefFromArray(reinterpret_cast<gmx::RVec*>(*dest), natoms));
+    }
+}
+
+/* Reads the next frame from the memory map of a TRR file, returns FALSE
+ * when all mapped frames have been read */
+static gmx_bool mapped_trr_next_frame(t_trxstatus* status, t_trxframe* fr)
+{
+    const int frameCount = status->mappedTrr->frameCount();
+    if (status->mappedTrrFrame >= frameCount)
+    {
+        if (status->mappedTrrFrame == frameCount)
+        {
+            /* Continue with normal reading after the mapped frames, as
+             * the file may have grown since it was mapped */
+            if (frameCount > 0)
+            {
+                gmx_fio_seek(status->fio, status->mappedTrr->frameEndOffset(frameCount - 1));
+            }
+            status->mappedTrrFrame++;
+        }
+        return FALSE;
+    }
+
+    const gmx::MappedTrrFrame frame = status->mappedTrr->frame(status->mappedTrrFrame++);
+
+    fr->bDouble   = frame.isDouble;
+    fr->natoms    = frame.natoms;
+    fr->bStep     = TRUE;
+    fr->step      = frame.step;
+    fr->bTime     = TRUE;
+    fr->time      = frame.time;
+    fr->bLambda   = TRUE;
+    fr->bFepState = TRUE;
+    fr->lambda    = frame.lambda;
+    fr->bBox      = frame.hasBox;
+    if (frame.hasBox)
+    {
+        copy_mat(frame.box, fr->box);
+    }
+    if (status->flags & (TRX_READ_X | TRX_NEED_X))
+    {
+        copy_mapped_vectors(frame.x, frame.natoms, &fr->x);
+        fr->bX = !frame.x.empty();
+    }
+    if (status->flags & (TRX_READ_V | TRX_NEED_V))
+    {
+        copy_mapped_vectors(frame.v, frame.natoms, &fr->v);
+        fr->bV = !frame.v.empty();
+    }
+    if (status->flags & (TRX_READ_F | TRX_NEED_F))
+    {
+        copy_mapped_vectors(frame.f, frame.natoms, &fr->f);
+        fr->bF = !frame.f.empty();
+    }
+
+    return TRUE;
+}
+
 static gmx_bool gmx_next_frame(t_trxstatus* status, t_trxframe* fr)
 {
     gmx_trr_header_t sh;
     gmx_bool         bOK, bRet;
 
+    if (status->mappedTrr != nullptr && mapped_trr_next_frame(status, fr))
+    {
+        return TRUE;
+    }
+
     bRet = FALSE;
 
     if (gmx_trr_read_frame_header(status->fio, &sh, &bOK))
@@ -689,6 +778,81 @@ static gmx_bool gmx_next_frame(t_trxstatus* status, t_trxframe* fr)
     return bRet;
 }
 
+/* Reads the next XTC frame, decoding only the atoms in atomMask if it is not empty */
+static bool xtc_next_frame(t_trxstatus* status, t_trxframe* fr, gmx::ArrayRef<const gmx_bool> atomMask)
+{
+    gmx_bool bOK;
+    bool     bRet;
+    if (atomMask.empty())
+    {
+        bRet = (read_next_xtc(status->fio, fr->natoms, &fr->step, &fr->time, fr->box, fr->x,
+                              &fr->prec, &bOK)
+                != 0);
+    }
+    else
+    {
+        bRet = (read_next_xtc_partial(status->fio, fr->natoms, &fr->step, &fr->time, fr->box,
+                                      fr->x, &fr->prec, &bOK, atomMask)
+                != 0);
+    }
+    fr->bPrec = (bRet && fr->prec > 0);
+    fr->bStep = bRet;
+    fr->bTime = bRet;
+    fr->bX    = bRet;
+    fr->bBox  = bRet;
+    if (!bOK)
+    {
+        /* Actually the header could also be not ok,
+           but from bOK from read_next_xtc this can't be distinguished */
+        fr->not_ok = DATA_NOT_OK;
+    }
+    return bRet;
+}
+
+/* Returns the frame index of the XTC file in status.
+ * The index is read from its sidecar file if that is present and matches
+ * the trajectory, and then extended in memory with any frames appended
+ * since. The sidecar file is never written here, see
+ * write_xtc_frame_index(). If there is no usable sidecar file, the index
+ * is only built when bCreate is set, otherwise nullptr is returned.
+ */
+static const gmx::XtcFrameIndex* xtc_frame_index(t_trxstatus* status, int natoms, bool bCreate)
+{
+    if (status->xtcIndex == nullptr)
+    {
+        const std::string filename = gmx::xtcFrameIndexFilename(gmx_fio_getname(status->fio));
+        auto              index    = std::make_unique<gmx::XtcFrameIndex>(natoms);
+        if (!index->readSidecar(filename, status->fio) && !bCreate)
+        {
+            return nullptr;
+        }
+        index->extend(status->fio);
+        status->xtcIndex = index.release();
+    }
+    return status->xtcIndex;
+}
+
+/* Positions the XTC file in status such that the next frame read is
+ * the last one before time t, using a stored frame index.
+ * Returns false if no index is available.
+ */
+static bool xtc_seek_time_indexed(t_trxstatus* status, int natoms, real t)
+{
+    const gmx::XtcFrameIndex* index = xtc_frame_index(status, natoms, false);
+    if (index == nullptr || index->frameCount() == 0)
+    {
+        return false;
+    }
+    /* The frame before the target is also read, so that the usual
+     * check_times2() tolerances decide where reading actually starts. */
+    const int frame = std::max(index->findFrameAtTime(t) - 1, 0);
+    if (index->frame(frame).offset > gmx_fio_ftell(status->fio))
+    {
+        gmx_fio_seek(status->fio, index->frame(frame).offset);
+    }
+    return true;
+}
+
 static gmx_bool pdb_next_x(t_trxstatus* status, FILE* fp, t_trxframe* fr)
 {
     t_atoms   atoms;
@@ -768,10 +932,18 @@ static int pdb_first_x(t_trxstatus* status, FILE* fp, t_trxframe* fr)
 }
 
 bool read_next_frame(const gmx_output_env_t* oenv, t_trxstatus* status, t_trxframe* fr)
+{
+    return read_next_frame(oenv, status, fr, {});
+}
+
+bool read_next_frame(const gmx_output_env_t*       oenv,
+                     t_trxstatus*                  status,
+                     t_trxframe*                   fr,
+                     gmx::ArrayRef<const gmx_bool> atomMask)
 {
     real     pt;
     int      ct;
-    gmx_bool bOK, bMissingData = FALSE, bSkip = FALSE;
+    gmx_bool bMissingData = FALSE, bSkip = FALSE;
     bool     bRet = false;
     int      ftp;
 
@@ -807,7 +979,11 @@ bool read_next_frame(const gmx_output_env_t* oenv, t_trxstatus* status, t_trxfra
             case efXTC:
                 if (bTimeSet(TBEGIN) && (status->tf < rTimeValue(TBEGIN)))
                 {
-                    if (xtc_seek_time(status->fio, rTimeValue(TBEGIN), fr->natoms, TRUE))
+                    if (xtc_seek_time_indexed(status, fr->natoms, rTimeValue(TBEGIN)))
+                    {
+                        /* Seeking with the stored index is done */
+                    }
+                    else if (xtc_seek_time(status->fio, rTimeValue(TBEGIN), fr->natoms, TRUE))
                     {
                         gmx_fatal(FARGS,
                                   "Specified frame (time %f) doesn't exist or file "
@@ -816,20 +992,7 @@ bool read_next_frame(const gmx_output_env_t* oenv, t_trxstatus* status, t_trxfra
                     }
                     initcount(status);
                 }
-                bRet = (read_next_xtc(status->fio, fr->natoms, &fr->step, &fr->time, fr->box, fr->x,
-                                      &fr->prec, &bOK)
-                        != 0);
-                fr->bPrec = (bRet && fr->prec > 0);
-                fr->bStep = bRet;
-                fr->bTime = bRet;
-                fr->bX    = bRet;
-                fr->bBox  = bRet;
-                if (!bOK)
-                {
-                    /* Actually the header could also be not ok,
-                       but from bOK from read_next_xtc this can't be distinguished */
-                    fr->not_ok = DATA_NOT_OK;
-                }
+                bRet = xtc_next_frame(status, fr, atomMask);
                 break;
             case efTNG: bRet = gmx_read_next_tng_frame(status->tng, fr, nullptr, 0); break;
             case efPDB: bRet = pdb_next_x(status, gmx_fio_getfp(status->fio), fr); break;
@@ -903,6 +1066,19 @@ bool read_first_frame(const gmx_output_env_t* oenv, t_trxstatus** status, const
     {
         /* Special treatment for TNG files */
         gmx_tng_open(fn, 'r', &(*status)->tng);
+        /* Only read and decompress the data blocks that are needed */
+        gmx_tng_set_read_blocks((*status)->tng, (flags & (TRX_READ_X | TRX_NEED_X)) != 0,
+                                (flags & (TRX_READ_V | TRX_NEED_V)) != 0,
+                                (flags & (TRX_READ_F | TRX_NEED_F)) != 0);
+        const char* readThreadsEnv = getenv("GMX_TNG_READ_THREADS");
+        if (readThreadsEnv != nullptr)
+        {
+            const int numReadThreads = strtol(readThreadsEnv, nullptr, 10);
+            if (numReadThreads > 1)
+            {
+                gmx_tng_start_parallel_reading((*status)->tng, numReadThreads);
+            }
+        }
     }
     else
     {
@@ -910,7 +1086,19 @@ bool read_first_frame(const gmx_output_env_t* oenv, t_trxstatus** status, const
     }
     switch (ftp)
     {
-        case efTRR: break;
+        case efTRR:
+            /* Read through a memory map when possible; this avoids the
+             * per-value XDR calls. Otherwise fall back to normal reading,
+             * which also reports any errors. */
+            try
+            {
+                (*status)->mappedTrr = new gmx::MappedTrrFile(fn);
+            }
+            catch (const gmx::FileIOError&)
+            {
+                (*status)->mappedTrr = nullptr;
+            }
+            break;
         case efCPT:
             read_checkpoint_trxframe(fio, fr);
             bFirst = FALSE;
@@ -1074,10 +1262,67 @@ gmx_bool read_next_x(const gmx_output_env_t* oenv, t_trxstatus* status, real* t,
     return bRet;
 }
 
+bool read_frame_at(t_trxstatus* status, int frameIndex, t_trxframe* fr)
+{
+    if (status->mappedTrr != nullptr)
+    {
+        if (frameIndex < 0 || frameIndex >= status->mappedTrr->frameCount())
+        {
+            return false;
+        }
+        status->mappedTrrFrame = frameIndex;
+        clear_trxframe(fr, FALSE);
+        const bool bRet = mapped_trr_next_frame(status, fr);
+        status->tf      = fr->time;
+        return bRet;
+    }
+    if (status->tng != nullptr || gmx_fio_getftp(status->fio) != efXTC)
+    {
+        gmx_fatal(FARGS, "Reading frames by index is only supported for xtc and trr files");
+    }
+    const gmx::XtcFrameIndex* index = xtc_frame_index(status, status->natoms, true);
+    if (frameIndex < 0 || frameIndex >= index->frameCount())
+    {
+        return false;
+    }
+    gmx_fio_seek(status->fio, index->frame(frameIndex).offset);
+    clear_trxframe(fr, FALSE);
+    const bool bRet = xtc_next_frame(status, fr, {});
+    status->tf      = fr->time;
+    return bRet;
+}
+
+bool write_xtc_frame_index(t_trxstatus* status)
+{
+    if (status->tng != nullptr || gmx_fio_getftp(status->fio) != efXTC)
+    {
+        gmx_fatal(FARGS, "Frame index files can only be written for xtc files");
+    }
+    const gmx::XtcFrameIndex* index = xtc_frame_index(status, status->natoms, true);
+    return index->writeSidecar(gmx::xtcFrameIndexFilename(gmx_fio_getname(status->fio)));
+}
+
+int trx_get_frame_count(t_trxstatus* status)
+{
+    if (status->mappedTrr != nullptr)
+    {
+        return status->mappedTrr->frameCount();
+    }
+    if (status->tng != nullptr || gmx_fio_getftp(status->fio) != efXTC)
+    {
+        gmx_fatal(FARGS, "Counting frames is only supported for xtc and trr files");
+    }
+    return xtc_frame_index(status, status->natoms, true)->frameCount();
+}
+
 void rewind_trj(t_trxstatus* status)
 {
     initcount(status);
 
+    if (status->mappedTrr != nullptr)
+    {
+        status->mappedTrrFrame = 0;
+    }
     gmx_fio_rewind(status->fio);
 }
 
@@ -231,6 +231,44 @@ bool read_next_frame(const gmx_output_env_t* oenv, t_trxstatus* status, struct t
  * Returns true when succeeded, false otherwise.
  */
 
+bool read_next_frame(const gmx_output_env_t*       oenv,
+                     t_trxstatus*                  status,
+                     struct t_trxframe*            fr,
+                     gmx::ArrayRef<const gmx_bool> atomMask);
+/* As read_next_frame above, but only the coordinates of the atoms i with
+ * atomMask[i] set are needed; atoms beyond the size of atomMask are not
+ * needed. An empty mask reads all atoms. For XTC files, the coordinates
+ * are only decoded up to the last needed atom, and the coordinates of
+ * the other atoms in fr->x are left unchanged. Other formats read all
+ * atoms.
+ */
+
+bool read_frame_at(t_trxstatus* status, int frameIndex, struct t_trxframe* fr);
+/* Reads the frame with index frameIndex (counting from zero) in a
+ * trajectory opened with read_first_frame, ignoring the time control
+ * settings. Subsequent calls to read_next_frame continue after this frame.
+ * Supported for XTC and TRR files. TRR files are read through a memory map
+ * of the file when possible. For XTC files, on first use, the frame headers
+ * are scanned to build an index in memory, which is reused by later calls.
+ * An index stored with write_xtc_frame_index() is read instead when it
+ * matches the trajectory, and is then also used for seeking to the start
+ * time set with -b in read_next_frame.
+ * Returns true when succeeded, false if the frame does not exist.
+ */
+
+bool write_xtc_frame_index(t_trxstatus* status);
+/* Stores the frame index of an XTC trajectory opened with
+ * read_first_frame in a sidecar file next to the trajectory, building the
+ * index first if needed. Later reads of the trajectory use the stored
+ * index, so that they do not need to scan the frame headers.
+ * Returns whether the file could be written.
+ */
+
+int trx_get_frame_count(t_trxstatus* status);
+/* Returns the number of frames in an XTC or TRR trajectory opened with
+ * read_first_frame, using the same index or memory map as read_frame_at.
+ */
+
 int read_first_x(const gmx_output_env_t* oenv, t_trxstatus** status, const char* fn, real* t, rvec** x, matrix box);
 /* These routines read first coordinates and box, and allocates
  * memory for the coordinates, for a trajectory file.
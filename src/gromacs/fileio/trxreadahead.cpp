@@ -0,0 +1,248 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Implements gmx::TrxFrameReadAhead.
+ *
+ * \ingroup module_fileio
+ */
+#include "gmxpre.h"
+
+#include "trxreadahead.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <utility>
+
+#include "gromacs/fileio/trxio.h"
+#include "gromacs/trajectory/trajectoryframe.h"
+#include "gromacs/utility/smalloc.h"
+
+namespace gmx
+{
+
+t_trxframe* createTrxFrameBuffer(const t_trxframe& fr)
+{
+    t_trxframe* buffer;
+    snew(buffer, 1);
+    *buffer   = fr;
+    buffer->x = nullptr;
+    buffer->v = nullptr;
+    buffer->f = nullptr;
+    if (fr.x != nullptr)
+    {
+        snew(buffer->x, fr.natoms);
+    }
+    if (fr.v != nullptr)
+    {
+        snew(buffer->v, fr.natoms);
+    }
+    if (fr.f != nullptr)
+    {
+        snew(buffer->f, fr.natoms);
+    }
+    return buffer;
+}
+
+void freeTrxFrameBuffer(t_trxframe* fr)
+{
+    sfree(fr->x);
+    sfree(fr->v);
+    sfree(fr->f);
+    sfree(fr);
+}
+
+class TrxFrameReadAhead::Impl
+{
+public:
+    Impl(const gmx_output_env_t*         oenv,
+         t_trxstatus*                    status,
+         const std::vector<t_trxframe*>& buffers,
+         FrameProcessor                  process,
+         ArrayRef<const gmx_bool>        atomMask);
+    ~Impl();
+
+    t_trxframe* nextFrame(t_trxframe* doneFrame);
+
+private:
+    //! Main function of the reader thread.
+    void readFrames();
+
+    const gmx_output_env_t* oenv_;
+    t_trxstatus*            status_;
+    FrameProcessor          process_;
+    //! Storage for atomMask_ (std::vector<bool> can not be referenced).
+    std::unique_ptr<gmx_bool[]> atomMaskStorage_;
+    //! Atoms whose coordinates are needed, empty for all atoms.
+    ArrayRef<const gmx_bool> atomMask_;
+
+    //! Buffers available for reading into.
+    std::queue<t_trxframe*> freeFrames_;
+    //! Frames that have been read, in trajectory order.
+    std::queue<t_trxframe*> readyFrames_;
+    //! Whether the reader has reached the end of the trajectory.
+    bool bFinished_;
+    //! Whether the reader should stop as soon as possible.
+    bool bStop_;
+    //! Exception thrown in the reader thread, if any.
+    std::exception_ptr      error_;
+    std::mutex              mutex_;
+    std::condition_variable cond_;
+    std::thread             thread_;
+};
+
+TrxFrameReadAhead::Impl::Impl(const gmx_output_env_t*         oenv,
+                              t_trxstatus*                    status,
+                              const std::vector<t_trxframe*>& buffers,
+                              FrameProcessor                  process,
+                              ArrayRef<const gmx_bool>        atomMask) :
+    oenv_(oenv),
+    status_(status),
+    process_(std::move(process)),
+    atomMaskStorage_(new gmx_bool[atomMask.size()]),
+    bFinished_(false),
+    bStop_(false)
+{
+    std::copy(atomMask.begin(), atomMask.end(), atomMaskStorage_.get());
+    atomMask_ = arrayRefFromArray(atomMaskStorage_.get(), atomMask.size());
+    for (t_trxframe* buffer : buffers)
+    {
+        freeFrames_.push(buffer);
+    }
+    thread_ = std::thread([this] { readFrames(); });
+}
+
+TrxFrameReadAhead::Impl::~Impl()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        bStop_ = true;
+    }
+    cond_.notify_all();
+    thread_.join();
+}
+
+t_trxframe* TrxFrameReadAhead::Impl::nextFrame(t_trxframe* doneFrame)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [this] { return !readyFrames_.empty() || bFinished_; });
+    if (readyFrames_.empty())
+    {
+        if (error_)
+        {
+            std::rethrow_exception(error_);
+        }
+        return nullptr;
+    }
+    t_trxframe* frame = readyFrames_.front();
+    readyFrames_.pop();
+    freeFrames_.push(doneFrame);
+    lock.unlock();
+    cond_.notify_all();
+    return frame;
+}
+
+void TrxFrameReadAhead::Impl::readFrames()
+{
+    while (true)
+    {
+        t_trxframe* frame;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cond_.wait(lock, [this] { return !freeFrames_.empty() || bStop_; });
+            if (bStop_)
+            {
+                return;
+            }
+            frame = freeFrames_.front();
+            freeFrames_.pop();
+        }
+        bool bRead = false;
+        try
+        {
+            bRead = read_next_frame(oenv_, status_, frame, atomMask_);
+            if (bRead && process_)
+            {
+                process_(frame);
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            error_ = std::current_exception();
+            bRead  = false;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (bRead)
+            {
+                readyFrames_.push(frame);
+            }
+            else
+            {
+                freeFrames_.push(frame);
+                bFinished_ = true;
+            }
+        }
+        cond_.notify_all();
+        if (!bRead)
+        {
+            return;
+        }
+    }
+}
+
+TrxFrameReadAhead::TrxFrameReadAhead(const gmx_output_env_t*         oenv,
+                                     t_trxstatus*                    status,
+                                     const std::vector<t_trxframe*>& buffers,
+                                     FrameProcessor                  process,
+                                     ArrayRef<const gmx_bool>        atomMask) :
+    impl_(new Impl(oenv, status, buffers, std::move(process), atomMask))
+{
+}
+
+TrxFrameReadAhead::~TrxFrameReadAhead() = default;
+
+t_trxframe* TrxFrameReadAhead::nextFrame(t_trxframe* doneFrame)
+{
+    return impl_->nextFrame(doneFrame);
+}
+
+} // namespace gmx
@@ -0,0 +1,141 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \libinternal \file
+ * \brief
+ * Declares gmx::TrxFrameReadAhead for reading trajectory frames in a
+ * background thread.
+ *
+ * \inlibraryapi
+ * \ingroup module_fileio
+ */
+#ifndef GMX_FILEIO_TRXREADAHEAD_H
+#define GMX_FILEIO_TRXREADAHEAD_H
+
+#include <functional>
+#include <vector>
+
+#include "gromacs/utility/arrayref.h"
+#include "gromacs/utility/basedefinitions.h"
+#include "gromacs/utility/classhelpers.h"
+
+struct gmx_output_env_t;
+struct t_trxframe;
+struct t_trxstatus;
+
+namespace gmx
+{
+
+/*! \brief
+ * Allocates a frame buffer with the same layout as \p fr.
+ *
+ * The coordinate arrays are allocated with the same size as in \p fr,
+ * such that trajectory readers that only allocate missing arrays find
+ * buffers of the correct size.  Other pointers, such as the index and
+ * atoms, are shared with \p fr.
+ *
+ * The returned buffer should be freed with freeTrxFrameBuffer().
+ */
+t_trxframe* createTrxFrameBuffer(const t_trxframe& fr);
+
+/*! \brief
+ * Frees a frame buffer allocated with createTrxFrameBuffer().
+ *
+ * Frees the coordinate arrays currently in \p fr, but not the pointers
+ * shared with other frames.
+ */
+void freeTrxFrameBuffer(t_trxframe* fr);
+
+/*! \libinternal \brief
+ * Reads trajectory frames ahead of the caller in a background thread.
+ *
+ * The thread reads frames into a set of spare frame buffers, and
+ * optionally processes them with a caller-provided function, while the
+ * caller works on the previous frame.  Frames are returned in the order
+ * they were read, so the caller sees exactly the same sequence of frames
+ * as with serial reading.  The caller owns the frame buffers; this class
+ * only cycles them between the reader and the caller.
+ *
+ * After construction, only the reader thread accesses the trajectory
+ * status and any data used by the processing function, until
+ * nextFrame() has returned `nullptr` or the object has been destructed.
+ *
+ * \inlibraryapi
+ * \ingroup module_fileio
+ */
+class TrxFrameReadAhead
+{
+public:
+    //! Function called in the reader thread for each frame read.
+    typedef std::function<void(t_trxframe*)> FrameProcessor;
+
+    /*! \brief
+     * Starts reading frames into \p buffers.
+     *
+     * \param[in] oenv     Output environment for read_next_frame().
+     * \param[in] status   Trajectory to read from.
+     * \param[in] buffers  Spare frame buffers to read into.
+     * \param[in] process  Function to apply to each frame after reading
+     *     (can be empty).
+     * \param[in] atomMask Atoms whose coordinates are needed, passed to
+     *     read_next_frame() (empty for all atoms).
+     */
+    TrxFrameReadAhead(const gmx_output_env_t*         oenv,
+                      t_trxstatus*                    status,
+                      const std::vector<t_trxframe*>& buffers,
+                      FrameProcessor                  process  = FrameProcessor(),
+                      ArrayRef<const gmx_bool>        atomMask = {});
+    //! Stops the reader thread.
+    ~TrxFrameReadAhead();
+
+    /*! \brief
+     * Returns the next frame from the trajectory.
+     *
+     * \param[in] doneFrame  Frame the caller has finished with.
+     * \returns   The next frame, or `nullptr` if there are no more
+     *     frames.  In the latter case, \p doneFrame remains valid.
+     * \throws    any exception thrown while reading or processing the
+     *     frame.
+     */
+    t_trxframe* nextFrame(t_trxframe* doneFrame);
+
+private:
+    class Impl;
+
+    PrivateImplPointer<Impl> impl_;
+};
+
+} // namespace gmx
+
+#endif
@@ -58,6 +58,25 @@
 /* Read or write reduced precision *float* coordinates */
 int xdr3dfcoord(XDR* xdrs, float* fp, int* size, float* precision);
 
+/* Same as xdr3dfcoord, but using the original bit-by-bit implementation
+ * of the compressed stream. The output is identical; this is only
+ * intended for testing and benchmarking xdr3dfcoord. */
+int xdr3dfcoord_reference(XDR* xdrs, float* fp, int* size, float* precision);
+
+/* Read reduced precision *float* coordinates, but only store those of the
+ * atoms i < numAtomsToDecode with atomMask[i] set (atomMask can be NULL
+ * to select all those atoms). Decoding stops after atom numAtomsToDecode-1;
+ * the stream is still positioned after the coordinates. The other elements
+ * of fp are left unchanged, except for frames with at most 9 atoms, which
+ * are stored uncompressed and are always read completely.
+ * Returns 0 for streams that are not open for reading. */
+int xdr3dfcoord_partial(XDR*            xdrs,
+                        float*          fp,
+                        int*            size,
+                        float*          precision,
+                        const gmx_bool* atomMask,
+                        int             numAtomsToDecode);
+
 
 /* Read or write a *real* value (stored as float) */
 int xdr_real(XDR* xdrs, real* r);
@@ -0,0 +1,236 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Implements gmx::XtcFrameIndex.
+ *
+ * \ingroup module_fileio
+ */
+#include "gmxpre.h"
+
+#include "xtcframeindex.h"
+
+#include <cstdio>
+
+#include <algorithm>
+
+#include "gromacs/fileio/gmxfio.h"
+#include "gromacs/fileio/xdrf.h"
+#include "gromacs/fileio/xtcio.h"
+
+namespace gmx
+{
+
+namespace
+{
+
+//! Magic number identifying a sidecar index file ("XTCI").
+const int c_xtcFrameIndexMagic = 0x58544349;
+//! Version of the sidecar index file format.
+const int c_xtcFrameIndexVersion = 1;
+
+/*! \brief
+ * Checks that the frame at \p entry in \p fio matches \p entry.
+ *
+ * Leaves the file positioned after the frame.
+ */
+bool frameMatchesEntry(t_fileio* fio, int natoms, const XtcFrameIndexEntry& entry)
+{
+    int64_t  step;
+    real     time;
+    gmx_bool bOK;
+
+    return gmx_fio_seek(fio, entry.offset) == 0 && skip_next_xtc(fio, natoms, &step, &time, &bOK)
+           && step == entry.step && time == entry.time;
+}
+
+} // namespace
+
+XtcFrameIndex::XtcFrameIndex(int natoms) : natoms_(natoms) {}
+
+bool XtcFrameIndex::readSidecar(const std::string& filename, t_fileio* fio)
+{
+    frames_.clear();
+    FILE* fp = std::fopen(filename.c_str(), "rb");
+    if (fp == nullptr)
+    {
+        return false;
+    }
+
+    XDR xdr;
+    xdrstdio_create(&xdr, fp, XDR_DECODE);
+    int  magic, version, natoms, frameCount;
+    bool bOK = (xdr_int(&xdr, &magic) && magic == c_xtcFrameIndexMagic && xdr_int(&xdr, &version)
+                && version == c_xtcFrameIndexVersion && xdr_int(&xdr, &natoms)
+                && natoms == natoms_ && xdr_int(&xdr, &frameCount) && frameCount >= 0);
+    if (bOK)
+    {
+        frames_.resize(frameCount);
+        for (XtcFrameIndexEntry& entry : frames_)
+        {
+            int64_t offset;
+            float   time;
+            bOK = bOK && xdr_int64(&xdr, &offset) && xdr_int64(&xdr, &entry.step)
+                  && xdr_float(&xdr, &time);
+            entry.offset = offset;
+            entry.time   = time;
+        }
+    }
+    xdr_destroy(&xdr);
+    std::fclose(fp);
+
+    if (bOK && !frames_.empty())
+    {
+        // Spot-check the ends of the index, which catches both a rewritten
+        // and a truncated trajectory.
+        const gmx_off_t position = gmx_fio_ftell(fio);
+        bOK = frameMatchesEntry(fio, natoms_, frames_.front())
+              && frameMatchesEntry(fio, natoms_, frames_.back());
+        gmx_fio_seek(fio, position);
+    }
+    if (!bOK)
+    {
+        frames_.clear();
+    }
+    return bOK;
+}
+
+bool XtcFrameIndex::writeSidecar(const std::string& filename) const
+{
+    // Write to a temporary file that is renamed when complete, so that
+    // concurrent readers never see a partial index.
+    const std::string tempFilename = filename + ".tmp";
+    FILE*             fp           = std::fopen(tempFilename.c_str(), "wb");
+    if (fp == nullptr)
+    {
+        return false;
+    }
+
+    XDR xdr;
+    xdrstdio_create(&xdr, fp, XDR_ENCODE);
+    int  magic      = c_xtcFrameIndexMagic;
+    int  version    = c_xtcFrameIndexVersion;
+    int  natoms     = natoms_;
+    int  frameCount = this->frameCount();
+    bool bOK        = (xdr_int(&xdr, &magic) && xdr_int(&xdr, &version) && xdr_int(&xdr, &natoms)
+                && xdr_int(&xdr, &frameCount));
+    for (const XtcFrameIndexEntry& entry : frames_)
+    {
+        int64_t offset = entry.offset;
+        int64_t step   = entry.step;
+        float   time   = entry.time;
+        bOK = bOK && xdr_int64(&xdr, &offset) && xdr_int64(&xdr, &step) && xdr_float(&xdr, &time);
+    }
+    xdr_destroy(&xdr);
+    bOK = (std::fclose(fp) == 0) && bOK;
+    bOK = bOK && (std::rename(tempFilename.c_str(), filename.c_str()) == 0);
+    if (!bOK)
+    {
+        // Do not leave a partial index behind.
+        std::remove(tempFilename.c_str());
+    }
+    return bOK;
+}
+
+bool XtcFrameIndex::extend(t_fileio* fio)
+{
+    const gmx_off_t position = gmx_fio_ftell(fio);
+    FILE*           fp       = gmx_fio_getfp(fio);
+    gmx_fseek(fp, 0, SEEK_END);
+    const gmx_off_t fileSize = gmx_ftell(fp);
+
+    gmx_off_t offset = 0;
+    if (!frames_.empty())
+    {
+        if (frameMatchesEntry(fio, natoms_, frames_.back()))
+        {
+            offset = gmx_fio_ftell(fio);
+        }
+        else
+        {
+            frames_.clear();
+        }
+    }
+
+    const int oldFrameCount = frameCount();
+    gmx_fio_seek(fio, offset);
+    while (true)
+    {
+        XtcFrameIndexEntry entry;
+        gmx_bool           bOK;
+        entry.offset = offset;
+        if (!skip_next_xtc(fio, natoms_, &entry.step, &entry.time, &bOK))
+        {
+            break;
+        }
+        offset = gmx_fio_ftell(fio);
+        // Seeking past the end of the file succeeds, so incomplete
+        // frames need to be detected here.
+        if (offset > fileSize)
+        {
+            break;
+        }
+        frames_.push_back(entry);
+    }
+    gmx_fio_seek(fio, position);
+
+    return frameCount() != oldFrameCount;
+}
+
+int XtcFrameIndex::findFrameAtTime(real time) const
+{
+    auto timeIsLess = [](const XtcFrameIndexEntry& a, const XtcFrameIndexEntry& b) {
+        return a.time < b.time;
+    };
+    XtcFrameIndexEntry target = { 0, 0, time };
+    auto               found  = frames_.end();
+    if (std::is_sorted(frames_.begin(), frames_.end(), timeIsLess))
+    {
+        found = std::lower_bound(frames_.begin(), frames_.end(), target, timeIsLess);
+    }
+    else
+    {
+        found = std::find_if(frames_.begin(), frames_.end(),
+                             [time](const XtcFrameIndexEntry& entry) { return entry.time >= time; });
+    }
+    return static_cast<int>(found - frames_.begin());
+}
+
+std::string xtcFrameIndexFilename(const std::string& xtcFilename)
+{
+    return xtcFilename + ".frameindex";
+}
+
+} // namespace gmx
@@ -0,0 +1,143 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \libinternal \file
+ * \brief
+ * Declares gmx::XtcFrameIndex for random access to frames in XTC files.
+ *
+ * \inlibraryapi
+ * \ingroup module_fileio
+ */
+#ifndef GMX_FILEIO_XTCFRAMEINDEX_H
+#define GMX_FILEIO_XTCFRAMEINDEX_H
+
+#include <cstdint>
+
+#include <string>
+#include <vector>
+
+#include "gromacs/utility/futil.h"
+#include "gromacs/utility/real.h"
+
+struct t_fileio;
+
+namespace gmx
+{
+
+//! Location and identity of a single frame in an XTC file.
+struct XtcFrameIndexEntry
+{
+    //! Byte offset of the frame header in the file.
+    gmx_off_t offset;
+    //! Step stored in the frame.
+    int64_t step;
+    //! Time stored in the frame.
+    real time;
+};
+
+/*! \libinternal \brief
+ * Maps frame numbers in an XTC file to their byte offsets.
+ *
+ * The XTC format has no index, and seeking to a frame otherwise
+ * requires a binary search over the file that probes for frame headers.
+ * The index is built by reading only the frame headers, skipping the
+ * compressed coordinates, and can be stored in a sidecar file next to
+ * the trajectory (see xtcFrameIndexFilename()) on request, so that later
+ * runs can reuse it.  A stored index is validated against the trajectory when it
+ * is read, and extend() only needs to scan frames appended after the
+ * index was written.
+ *
+ * All methods that take a file restore its position before returning.
+ *
+ * \inlibraryapi
+ * \ingroup module_fileio
+ */
+class XtcFrameIndex
+{
+public:
+    //! Creates an empty index for a trajectory with \p natoms atoms.
+    explicit XtcFrameIndex(int natoms);
+
+    /*! \brief
+     * Reads an index stored by writeSidecar().
+     *
+     * \param[in] filename  Name of the sidecar file.
+     * \param[in] fio       Trajectory the index should describe.
+     * \returns   Whether a valid index was read.  If the file does not
+     *     exist, is corrupt, or its first or last frame do not match
+     *     the trajectory, the index is left empty.
+     */
+    bool readSidecar(const std::string& filename, t_fileio* fio);
+    /*! \brief
+     * Writes the index to a sidecar file.
+     *
+     * The file is written under a temporary name and then renamed, so
+     * concurrent readers see either the old or the complete new index.
+     * The index is only a cache, so failures (e.g. from a read-only
+     * directory) are not fatal.
+     *
+     * \returns Whether the file was written.
+     */
+    bool writeSidecar(const std::string& filename) const;
+    /*! \brief
+     * Adds all frames in \p fio that follow the last indexed frame.
+     *
+     * Stops at the first incomplete or corrupt frame.
+     *
+     * \returns Whether any frames were added.
+     */
+    bool extend(t_fileio* fio);
+
+    //! Returns the number of indexed frames.
+    int frameCount() const { return static_cast<int>(frames_.size()); }
+    //! Returns the entry for frame \p index (counting from zero).
+    const XtcFrameIndexEntry& frame(int index) const { return frames_[index]; }
+    /*! \brief
+     * Returns the first frame with time at or after \p time.
+     *
+     * Returns frameCount() if there is no such frame.
+     */
+    int findFrameAtTime(real time) const;
+
+private:
+    int                             natoms_;
+    std::vector<XtcFrameIndexEntry> frames_;
+};
+
+//! Returns the name of the sidecar index file for \p xtcFilename.
+std::string xtcFrameIndexFilename(const std::string& xtcFilename);
+
+} // namespace gmx
+
+#endif
@@ -41,6 +41,8 @@
 
 #include <cstring>
 
+#include <algorithm>
+
 #include "gromacs/fileio/gmxfio.h"
 #include "gromacs/fileio/gmxfio_xdr.h"
 #include "gromacs/fileio/xdrf.h"
@@ -138,7 +140,17 @@ static int xtc_header(XDR* xd, int* magic, int* natoms, int64_t* step, real* tim
     return result;
 }
 
-static int xtc_coord(XDR* xd, int* natoms, rvec* box, rvec* x, real* prec, gmx_bool bRead)
+/* When reading, only the atoms i < numAtomsToDecode with atomMask[i] set
+ * are stored; atomMask can be nullptr to select all those atoms, and
+ * numAtomsToDecode -1 to decode all atoms */
+static int xtc_coord(XDR*            xd,
+                     int*            natoms,
+                     rvec*           box,
+                     rvec*           x,
+                     real*           prec,
+                     gmx_bool        bRead,
+                     const gmx_bool* atomMask         = nullptr,
+                     int             numAtomsToDecode = -1)
 {
     int i, j, result;
 #if GMX_DOUBLE
@@ -176,13 +188,26 @@ static int xtc_coord(XDR* xd, int* natoms, rvec* box, rvec* x, real* prec, gmx_b
         }
         fprec = *prec;
     }
-    result = XTC_CHECK("x", xdr3dfcoord(xd, ftmp, natoms, &fprec));
+    if (bRead && numAtomsToDecode >= 0)
+    {
+        result = XTC_CHECK("x", xdr3dfcoord_partial(xd, ftmp, natoms, &fprec, atomMask,
+                                                    numAtomsToDecode));
+    }
+    else
+    {
+        result = XTC_CHECK("x", xdr3dfcoord(xd, ftmp, natoms, &fprec));
+    }
 
     /* Copy from temp. array if reading */
     if (bRead)
     {
         for (i = 0; (i < *natoms); i++)
         {
+            if (*natoms > 9 && numAtomsToDecode >= 0
+                && (i >= numAtomsToDecode || (atomMask != nullptr && !atomMask[i])))
+            {
+                continue;
+            }
             x[i][XX] = ftmp[DIM * i + XX];
             x[i][YY] = ftmp[DIM * i + YY];
             x[i][ZZ] = ftmp[DIM * i + ZZ];
@@ -191,7 +216,15 @@ static int xtc_coord(XDR* xd, int* natoms, rvec* box, rvec* x, real* prec, gmx_b
     }
     sfree(ftmp);
 #else
-    result = XTC_CHECK("x", xdr3dfcoord(xd, x[0], natoms, prec));
+    if (bRead && numAtomsToDecode >= 0)
+    {
+        result = XTC_CHECK("x", xdr3dfcoord_partial(xd, x[0], natoms, prec, atomMask,
+                                                    numAtomsToDecode));
+    }
+    else
+    {
+        result = XTC_CHECK("x", xdr3dfcoord(xd, x[0], natoms, prec));
+    }
 #endif
 
     return result;
@@ -285,3 +318,211 @@ int read_next_xtc(t_fileio* fio, int natoms, int64_t* step, real* time, matrix b
 
     return static_cast<int>(*bOK);
 }
+
+int read_next_xtc_partial(t_fileio*                     fio,
+                          int                           natoms,
+                          int64_t*                      step,
+                          real*                         time,
+                          matrix                        box,
+                          rvec*                         x,
+                          real*                         prec,
+                          gmx_bool*                     bOK,
+                          gmx::ArrayRef<const gmx_bool> atomMask)
+{
+    int  magic;
+    int  n;
+    XDR* xd;
+
+    *bOK = TRUE;
+    xd   = gmx_fio_getxdr(fio);
+
+    /* read header */
+    if (!xtc_header(xd, &magic, &n, step, time, TRUE, bOK))
+    {
+        return 0;
+    }
+
+    /* Check magic number */
+    check_xtc_magic(magic);
+
+    if (n > natoms)
+    {
+        gmx_fatal(FARGS, "Frame contains more atoms (%d) than expected (%d)", n, natoms);
+    }
+
+    /* Decoding can stop after the last needed atom */
+    int numAtomsToDecode = std::min(static_cast<int>(atomMask.size()), natoms);
+    while (numAtomsToDecode > 0 && !atomMask[numAtomsToDecode - 1])
+    {
+        numAtomsToDecode--;
+    }
+
+    *bOK = (xtc_coord(xd, &natoms, box, x, prec, TRUE, atomMask.data(), numAtomsToDecode) != 0);
+
+    return static_cast<int>(*bOK);
+}
+
+int skip_next_xtc(t_fileio* fio, int natoms, int64_t* step, real* time, gmx_bool* bOK)
+{
+    /* Size of precision, minint[3], maxint[3] and smallidx in a compressed frame */
+    const gmx_off_t compressedHeaderSize = 8 * sizeof(int32_t);
+
+    int       magic;
+    int       n;
+    int       size;
+    float     boxElement;
+    gmx_off_t skip;
+    XDR*      xd;
+
+    *bOK = TRUE;
+    xd   = gmx_fio_getxdr(fio);
+
+    /* read header */
+    if (!xtc_header(xd, &magic, &n, step, time, TRUE, bOK))
+    {
+        return 0;
+    }
+
+    /* Check magic number */
+    check_xtc_magic(magic);
+
+    *bOK = (n == natoms);
+    for (int i = 0; i < DIM * DIM && *bOK; i++)
+    {
+        *bOK = XTC_CHECK("box", xdr_float(xd, &boxElement));
+    }
+    *bOK = *bOK && XTC_CHECK("natoms", xdr_int(xd, &size)) && size == natoms;
+    if (!*bOK)
+    {
+        return 0;
+    }
+
+    if (size <= 9)
+    {
+        /* Small frames are stored uncompressed */
+        skip = size * DIM * sizeof(float);
+    }
+    else
+    {
+        int byteCount;
+
+        *bOK = (gmx_fseek(gmx_fio_getfp(fio), compressedHeaderSize, SEEK_CUR) == 0
+                && XTC_CHECK("byte count", xdr_int(xd, &byteCount)) && byteCount >= 0);
+        if (!*bOK)
+        {
+            return 0;
+        }
+        /* The compressed data is padded to full XDR units */
+        skip = ((byteCount + sizeof(int32_t) - 1) / sizeof(int32_t)) * sizeof(int32_t);
+    }
+    *bOK = (gmx_fseek(gmx_fio_getfp(fio), skip, SEEK_CUR) == 0);
+
+    return static_cast<int>(*bOK);
+}
+
+/* Returns the big-endian (XDR) integer stored at p */
+static int xdr_data_int(const char* p)
+{
+    const auto* u = reinterpret_cast<const unsigned char*>(p);
+    return static_cast<int>((uint32_t(u[0]) << 24U) | (uint32_t(u[1]) << 16U) | (uint32_t(u[2]) << 8U)
+                            | uint32_t(u[3]));
+}
+
+/* Appends size bytes read from xd to data */
+static int xtc_read_data(XDR* xd, int size, std::vector<char>* data)
+{
+    const size_t offset = data->size();
+    data->resize(offset + size);
+    return XTC_CHECK("data", xdr_opaque(xd, data->data() + offset, size));
+}
+
+int read_next_xtc_data(t_fileio* fio, int* natoms, int64_t* step, real* time, matrix box, std::vector<char>* data, gmx_bool* bOK)
+{
+    /* Size of precision, minint[3], maxint[3], smallidx and the byte count
+     * in a compressed frame */
+    const int compressedHeaderSize = 9 * sizeof(int32_t);
+
+    int  magic;
+    XDR* xd;
+
+    *bOK = TRUE;
+    xd   = gmx_fio_getxdr(fio);
+
+    /* read header */
+    if (!xtc_header(xd, &magic, natoms, step, time, TRUE, bOK))
+    {
+        return 0;
+    }
+
+    /* Check magic number */
+    check_xtc_magic(magic);
+
+    for (int i = 0; i < DIM && *bOK; i++)
+    {
+        for (int j = 0; j < DIM && *bOK; j++)
+        {
+            *bOK = XTC_CHECK("box", xdr_r2f(xd, &(box[i][j]), TRUE));
+        }
+    }
+
+    /* The coordinate data starts with the number of atoms */
+    data->clear();
+    *bOK = *bOK && xtc_read_data(xd, sizeof(int32_t), data);
+    if (!*bOK)
+    {
+        return 0;
+    }
+    const int size = xdr_data_int(data->data());
+    if (size != *natoms)
+    {
+        *bOK = FALSE;
+        return 0;
+    }
+    if (size <= 9)
+    {
+        /* Small frames are stored uncompressed */
+        *bOK = xtc_read_data(xd, size * DIM * sizeof(float), data);
+    }
+    else
+    {
+        *bOK = xtc_read_data(xd, compressedHeaderSize, data);
+        if (*bOK)
+        {
+            const int byteCount = xdr_data_int(data->data() + data->size() - sizeof(int32_t));
+            /* The compressed data is padded to full XDR units */
+            *bOK = (byteCount >= 0
+                    && xtc_read_data(xd, (byteCount + sizeof(int32_t) - 1) / sizeof(int32_t) * sizeof(int32_t),
+                                     data));
+        }
+    }
+
+    return static_cast<int>(*bOK);
+}
+
+int write_xtc_data(t_fileio* fio, int natoms, int64_t step, real time, const rvec* box, gmx::ArrayRef<const char> data)
+{
+    int      magic_number = XTC_MAGIC;
+    XDR*     xd;
+    gmx_bool bDum;
+    int      bOK;
+
+    xd = gmx_fio_getxdr(fio);
+    if (xtc_header(xd, &magic_number, &natoms, &step, &time, FALSE, &bDum) == 0)
+    {
+        return 0;
+    }
+    bOK = 1;
+    for (int i = 0; i < DIM && bOK; i++)
+    {
+        for (int j = 0; j < DIM && bOK; j++)
+        {
+            real boxElement = box[i][j];
+            bOK             = XTC_CHECK("box", xdr_r2f(xd, &boxElement, FALSE));
+        }
+    }
+    bOK = bOK && XTC_CHECK("data", xdr_opaque(xd, const_cast<char*>(data.data()), data.size()));
+
+    /* Unlike write_xtc, this does not flush the file after each frame,
+     * as it is intended for copying many frames quickly */
+    return bOK;
+}
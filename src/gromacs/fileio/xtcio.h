@@ -39,7 +39,10 @@
 #ifndef GMX_FILEIO_XTCIO_H
 #define GMX_FILEIO_XTCIO_H
 
+#include <vector>
+
 #include "gromacs/math/vectypes.h"
+#include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/basedefinitions.h"
 #include "gromacs/utility/real.h"
 
@@ -75,7 +78,39 @@ int read_first_xtc(struct t_fileio* fio,
 int read_next_xtc(struct t_fileio* fio, int natoms, int64_t* step, real* time, matrix box, rvec* x, real* prec, gmx_bool* bOK);
 /* Read subsequent frames */
 
+int read_next_xtc_partial(struct t_fileio*              fio,
+                          int                           natoms,
+                          int64_t*                      step,
+                          real*                         time,
+                          matrix                        box,
+                          rvec*                         x,
+                          real*                         prec,
+                          gmx_bool*                     bOK,
+                          gmx::ArrayRef<const gmx_bool> atomMask);
+/* As read_next_xtc, but only decodes the coordinates up to the last atom
+ * that is set in atomMask, and only stores those of the atoms that are set.
+ * Atoms beyond the size of atomMask are not needed. The coordinates of the
+ * other atoms in x are left unchanged, except for frames with at most
+ * 9 atoms, which are always read completely.
+ */
+
 int write_xtc(struct t_fileio* fio, int natoms, int64_t step, real time, const rvec* box, const rvec* x, real prec);
 /* Write a frame to xtc file */
 
+int skip_next_xtc(struct t_fileio* fio, int natoms, int64_t* step, real* time, gmx_bool* bOK);
+/* Read the header of the next frame and skip over its coordinates without
+ * decompressing them, leaving the file positioned at the following frame.
+ * The file is not checked for being long enough to contain the skipped
+ * coordinates. Returns 0 at end of file or on error (then bOK is FALSE),
+ * also if the frame does not have natoms atoms. */
+
+int read_next_xtc_data(struct t_fileio* fio, int* natoms, int64_t* step, real* time, matrix box, std::vector<char>* data, gmx_bool* bOK);
+/* Read the next frame, but without decompressing the coordinates: data
+ * receives the coordinate data as stored in the file, which can be
+ * written unchanged with write_xtc_data. */
+
+int write_xtc_data(struct t_fileio* fio, int natoms, int64_t step, real time, const rvec* box, gmx::ArrayRef<const char> data);
+/* Write a frame with coordinate data obtained from read_next_xtc_data.
+ * Unlike write_xtc, does not flush the file. */
+
 #endif
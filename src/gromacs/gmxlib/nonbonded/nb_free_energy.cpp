@@ -42,6 +42,7 @@
 #include "config.h"
 
 #include <cmath>
+#include <cstdint>
 
 #include <algorithm>
 
@@ -56,6 +57,7 @@
 #include "gromacs/mdtypes/md_enums.h"
 #include "gromacs/mdtypes/mdatom.h"
 #include "gromacs/simd/simd.h"
+#include "gromacs/simd/simd_math.h"
 #include "gromacs/utility/fatalerror.h"
 
 
@@ -64,6 +66,7 @@ struct ScalarDataTypes
 {
     using RealType                     = real; //!< The data type to use as real.
     using IntType                      = int;  //!< The data type to use as int.
+    using BoolType                     = bool; //!< The data type to use as bool.
     static constexpr int simdRealWidth = 1;    //!< The width of the RealType.
     static constexpr int simdIntWidth  = 1;    //!< The width of the IntType.
 };
@@ -74,17 +77,24 @@ struct SimdDataTypes
 {
     using RealType                     = gmx::SimdReal;         //!< The data type to use as real.
     using IntType                      = gmx::SimdInt32;        //!< The data type to use as int.
+    using BoolType                     = gmx::SimdBool;         //!< The data type to use as bool.
     static constexpr int simdRealWidth = GMX_SIMD_REAL_WIDTH;   //!< The width of the RealType.
     static constexpr int simdIntWidth  = GMX_SIMD_FINT32_WIDTH; //!< The width of the IntType.
 };
 #endif
 
-//! Computes r^(1/p) and 1/r^(1/p) for the standard p=6
-template<class RealType>
-static inline void pthRoot(const RealType r, RealType* pthRoot, RealType* invPthRoot)
+
+//! Computes r^(1/p) and 1/r^(1/p) for the standard p=6, returns zero where mask is false
+template<class RealType, class BoolType>
+static inline void pthRoot(const RealType r,
+                           RealType*      pthRoot,
+                           RealType*      invPthRoot,
+                           const BoolType mask)
 {
-    *invPthRoot = gmx::invsqrt(std::cbrt(r));
-    *pthRoot    = 1 / (*invPthRoot);
+    using std::cbrt;
+
+    *invPthRoot = gmx::maskzInvsqrt(cbrt(r), mask);
+    *pthRoot    = gmx::maskzInv(*invPthRoot, mask);
 }
 
 template<class RealType>
@@ -158,45 +168,47 @@ static inline RealType lennardJonesPotential(const RealType v6,
 }
 
 /* Ewald LJ */
-static inline real ewaldLennardJonesGridSubtract(const real c6grid, const real potentialShift, const real onesixth)
+template<class RealType>
+static inline RealType ewaldLennardJonesGridSubtract(const RealType c6grid,
+                                                     const real     potentialShift,
+                                                     const real     onesixth)
 {
     return (c6grid * potentialShift * onesixth);
 }
 
 /* LJ Potential switch */
-template<class RealType>
+template<class RealType, class BoolType>
 static inline RealType potSwitchScalarForceMod(const RealType fScalarInp,
                                                const RealType potential,
                                                const RealType sw,
                                                const RealType r,
-                                               const RealType rVdw,
                                                const RealType dsw,
-                                               const real     zero)
+                                               const BoolType mask)
 {
-    if (r < rVdw)
-    {
-        real fScalar = fScalarInp * sw - r * potential * dsw;
-        return (fScalar);
-    }
-    return (zero);
+    /* The mask should select on rV < rVdw */
+    const RealType fScalar = fScalarInp * sw - r * potential * dsw;
+    return (gmx::selectByMask(fScalar, mask));
 }
-template<class RealType>
+template<class RealType, class BoolType>
 static inline RealType potSwitchPotentialMod(const RealType potentialInp,
                                              const RealType sw,
-                                             const RealType r,
-                                             const RealType rVdw,
-                                             const real     zero)
+                                             const BoolType mask)
 {
-    if (r < rVdw)
-    {
-        real potential = potentialInp * sw;
-        return (potential);
-    }
-    return (zero);
+    /* The mask should select on rV < rVdw */
+    const RealType potential = potentialInp * sw;
+    return (gmx::selectByMask(potential, mask));
 }
 
 
-//! Templated free-energy non-bonded kernel
+/*! \brief Templated free-energy non-bonded kernel
+ *
+ * With \p DataTypes = SimdDataTypes, the j-particles of each i-entry in
+ * the list are processed in chunks of the SIMD width. Particle parameters
+ * are gathered into aligned buffers first; all conditions in the scalar
+ * kernel are replaced by masks, so padding and out-of-range pairs give
+ * exactly zero contributions. With ScalarDataTypes the chunk size is one
+ * and the masks reduce to the branches of a plain scalar kernel.
+ */
 template<typename DataTypes, bool useSoftCore, bool scLambdasOrAlphasDiffer, bool vdwInteractionTypeIsEwald, bool elecInteractionTypeIsEwald, bool vdwModifierIsPotSwitch>
 static void nb_free_energy_kernel(const t_nblist* gmx_restrict nlist,
                                   rvec* gmx_restrict         xx,
@@ -212,15 +224,16 @@ static void nb_free_energy_kernel(const t_nblist* gmx_restrict nlist,
 
     using RealType = typename DataTypes::RealType;
     using IntType  = typename DataTypes::IntType;
+    using BoolType = typename DataTypes::BoolType;
+
+    constexpr int simdRealWidth = DataTypes::simdRealWidth;
 
-    /* FIXME: How should these be handled with SIMD? */
     constexpr real onetwelfth = 1.0 / 12.0;
     constexpr real onesixth   = 1.0 / 6.0;
     constexpr real zero       = 0.0;
     constexpr real half       = 0.5;
     constexpr real one        = 1.0;
     constexpr real two        = 2.0;
-    constexpr real six        = 6.0;
 
     /* Extract pointer to non-bonded interaction constants */
     const interaction_const_t* ic = fr->ic;
@@ -300,8 +313,7 @@ static void nb_free_energy_kernel(const t_nblist* gmx_restrict nlist,
     real rcutoff_max2 = std::max(ic->rcoulomb, ic->rvdw);
     rcutoff_max2      = rcutoff_max2 * rcutoff_max2;
 
-    const real* tab_ewald_F_lj           = nullptr;
-    const real* tab_ewald_V_lj           = nullptr;
+    const real* tab_ewald_FDV0_lj        = nullptr;
     const real* ewtab                    = nullptr;
     real        coulombTableScale        = 0;
     real        coulombTableScaleInvHalf = 0;
@@ -322,8 +334,7 @@ static void nb_free_energy_kernel(const t_nblist* gmx_restrict nlist,
     if (vdwInteractionTypeIsEwald)
     {
         const auto& vdwTables = *ic->vdwEwaldTables;
-        tab_ewald_F_lj        = vdwTables.tableF.data();
-        tab_ewald_V_lj        = vdwTables.tableV.data();
+        tab_ewald_FDV0_lj     = vdwTables.tableFDV0.data();
         vdwTableScale         = vdwTables.scale;
         vdwTableScaleInvHalf  = half / vdwTableScale;
     }
@@ -343,8 +354,8 @@ static void nb_free_energy_kernel(const t_nblist* gmx_restrict nlist,
     GMX_RELEASE_ASSERT(!(vdwInteractionTypeIsEwald && vdwModifierIsPotSwitch),
                        "Can not apply soft-core to switched Ewald potentials");
 
-    real dvdl_coul = 0;
-    real dvdl_vdw  = 0;
+    RealType dvdl_coul = zero;
+    RealType dvdl_vdw  = zero;
 
     /* Lambda factor for state A, 1-lambda*/
     real LFC[NSTATES], LFV[NSTATES];
@@ -375,83 +386,132 @@ static void nb_free_energy_kernel(const t_nblist* gmx_restrict nlist,
     real* gmx_restrict f      = &(forceWithShiftForces->force()[0][0]);
     real* gmx_restrict fshift = &(forceWithShiftForces->shiftForces()[0][0]);
 
+    /* Buffers for the j-particle data of one chunk of simdRealWidth pairs */
+    alignas(GMX_SIMD_ALIGNMENT) std::int32_t preloadJnr[simdRealWidth];
+    alignas(GMX_SIMD_ALIGNMENT) real         preloadPairIncluded[simdRealWidth];
+    alignas(GMX_SIMD_ALIGNMENT) real         preloadPairExcluded[simdRealWidth];
+    alignas(GMX_SIMD_ALIGNMENT) real         preloadSelfScale[simdRealWidth];
+    alignas(GMX_SIMD_ALIGNMENT) real         preloadQq[NSTATES][simdRealWidth];
+    alignas(GMX_SIMD_ALIGNMENT) real         preloadC6[NSTATES][simdRealWidth];
+    alignas(GMX_SIMD_ALIGNMENT) real         preloadC12[NSTATES][simdRealWidth];
+    alignas(GMX_SIMD_ALIGNMENT) real         preloadC6Grid[NSTATES][simdRealWidth];
+    alignas(GMX_SIMD_ALIGNMENT) std::int32_t tableIndex[simdRealWidth];
+    alignas(GMX_SIMD_ALIGNMENT) real         forceJ[DIM][simdRealWidth];
+
     for (int n = 0; n < nri; n++)
     {
-        int npair_within_cutoff = 0;
-
-        const int  is3   = 3 * shift[n];
-        const real shX   = shiftvec[is3];
-        const real shY   = shiftvec[is3 + 1];
-        const real shZ   = shiftvec[is3 + 2];
-        const int  nj0   = jindex[n];
-        const int  nj1   = jindex[n + 1];
-        const int  ii    = iinr[n];
-        const int  ii3   = 3 * ii;
-        const real ix    = shX + x[ii3 + 0];
-        const real iy    = shY + x[ii3 + 1];
-        const real iz    = shZ + x[ii3 + 2];
-        const real iqA   = facel * chargeA[ii];
-        const real iqB   = facel * chargeB[ii];
-        const int  ntiA  = 2 * ntype * typeA[ii];
-        const int  ntiB  = 2 * ntype * typeB[ii];
-        real       vctot = 0;
-        real       vvtot = 0;
-        real       fix   = 0;
-        real       fiy   = 0;
-        real       fiz   = 0;
-
-        for (int k = nj0; k < nj1; k++)
+        bool havePairsWithinCutoff = false;
+
+        const int      is3   = 3 * shift[n];
+        const real     shX   = shiftvec[is3];
+        const real     shY   = shiftvec[is3 + 1];
+        const real     shZ   = shiftvec[is3 + 2];
+        const int      nj0   = jindex[n];
+        const int      nj1   = jindex[n + 1];
+        const int      ii    = iinr[n];
+        const int      ii3   = 3 * ii;
+        const RealType ix    = shX + x[ii3 + 0];
+        const RealType iy    = shY + x[ii3 + 1];
+        const RealType iz    = shZ + x[ii3 + 2];
+        const real     iqA   = facel * chargeA[ii];
+        const real     iqB   = facel * chargeB[ii];
+        const int      ntiA  = 2 * ntype * typeA[ii];
+        const int      ntiB  = 2 * ntype * typeB[ii];
+        RealType       vctot = zero;
+        RealType       vvtot = zero;
+        RealType       fix   = zero;
+        RealType       fiy   = zero;
+        RealType       fiz   = zero;
+
+        for (int k = nj0; k < nj1; k += simdRealWidth)
         {
-            int            tj[NSTATES];
-            const int      jnr = jjnr[k];
-            const int      j3  = 3 * jnr;
-            RealType       c6[NSTATES], c12[NSTATES], qq[NSTATES], Vcoul[NSTATES], Vvdw[NSTATES];
-            RealType       r, rinv, rp, rpm2;
-            RealType       alpha_vdw_eff, alpha_coul_eff, sigma6[NSTATES];
-            const RealType dx  = ix - x[j3];
-            const RealType dy  = iy - x[j3 + 1];
-            const RealType dz  = iz - x[j3 + 2];
-            const RealType rsq = dx * dx + dy * dy + dz * dz;
-            RealType       FscalC[NSTATES], FscalV[NSTATES];
-            /* Check if this pair on the exlusions list.*/
-            const bool bPairIncluded = nlist->excl_fep == nullptr || nlist->excl_fep[k];
-
-            if (rsq >= rcutoff_max2 && bPairIncluded)
+            /* Gather the j-particle parameters. The chunk is padded with
+             * the first j-particle, with zero parameters and both pair
+             * masks off, so the padding does not contribute.
+             */
+            const int numPairs = std::min(simdRealWidth, nj1 - k);
+            for (int s = 0; s < simdRealWidth; s++)
             {
-                /* We save significant time by skipping all code below.
-                 * Note that with soft-core interactions, the actual cut-off
-                 * check might be different. But since the soft-core distance
-                 * is always larger than r, checking on r here is safe.
-                 * Exclusions outside the cutoff can not be skipped as
-                 * when using Ewald: the reciprocal-space
-                 * Ewald component still needs to be subtracted.
-                 */
-
-                continue;
+                if (s < numPairs)
+                {
+                    const int  jnr = jjnr[k + s];
+                    const int  tjA = ntiA + 2 * typeA[jnr];
+                    const int  tjB = ntiB + 2 * typeB[jnr];
+                    /* Check if this pair on the exlusions list.*/
+                    const bool bPairIncluded = nlist->excl_fep == nullptr || nlist->excl_fep[k + s];
+
+                    preloadJnr[s]           = jnr;
+                    preloadPairIncluded[s]  = bPairIncluded ? one : zero;
+                    preloadPairExcluded[s]  = bPairIncluded ? zero : one;
+                    preloadSelfScale[s]     = (ii == jnr) ? half : one;
+                    preloadQq[STATE_A][s]   = iqA * chargeA[jnr];
+                    preloadQq[STATE_B][s]   = iqB * chargeB[jnr];
+                    preloadC6[STATE_A][s]   = nbfp[tjA];
+                    preloadC6[STATE_B][s]   = nbfp[tjB];
+                    preloadC12[STATE_A][s]  = nbfp[tjA + 1];
+                    preloadC12[STATE_B][s]  = nbfp[tjB + 1];
+                    if (vdwInteractionTypeIsEwald)
+                    {
+                        preloadC6Grid[STATE_A][s] = nbfp_grid[tjA];
+                        preloadC6Grid[STATE_B][s] = nbfp_grid[tjB];
+                    }
+                }
+                else
+                {
+                    preloadJnr[s]          = jjnr[k];
+                    preloadPairIncluded[s] = zero;
+                    preloadPairExcluded[s] = zero;
+                    preloadSelfScale[s]    = one;
+                    for (int i = 0; i < NSTATES; i++)
+                    {
+                        preloadQq[i][s]     = zero;
+                        preloadC6[i][s]     = zero;
+                        preloadC12[i][s]    = zero;
+                        preloadC6Grid[i][s] = zero;
+                    }
+                }
             }
-            npair_within_cutoff++;
 
-            if (rsq > 0)
-            {
-                /* Note that unlike in the nbnxn kernels, we do not need
-                 * to clamp the value of rsq before taking the invsqrt
-                 * to avoid NaN in the LJ calculation, since here we do
-                 * not calculate LJ interactions when C6 and C12 are zero.
-                 */
+            RealType jx, jy, jz;
+            gmx::gatherLoadUTranspose<3>(x, preloadJnr, &jx, &jy, &jz);
 
-                rinv = gmx::invsqrt(rsq);
-                r    = rsq * rinv;
-            }
-            else
+            const RealType dx  = ix - jx;
+            const RealType dy  = iy - jy;
+            const RealType dz  = iz - jz;
+            const RealType rsq = dx * dx + dy * dy + dz * dz;
+
+            const BoolType bPairIncluded = (zero < gmx::load<RealType>(preloadPairIncluded));
+            const BoolType bPairExcluded = (zero < gmx::load<RealType>(preloadPairExcluded));
+
+            /* We save significant time by skipping all code below for pairs
+             * beyond the cut-off. Note that with soft-core interactions, the
+             * actual cut-off check might be different. But since the soft-core
+             * distance is always larger than r, checking on r here is safe.
+             * Exclusions outside the cutoff can not be skipped as
+             * when using Ewald: the reciprocal-space
+             * Ewald component still needs to be subtracted.
+             */
+            const BoolType bIncludedWithinCutoff = (rsq < rcutoff_max2) && bPairIncluded;
+            const BoolType bWithinCutoff         = bIncludedWithinCutoff || bPairExcluded;
+            if (!gmx::anyTrue(bWithinCutoff))
             {
-                /* The force at r=0 is zero, because of symmetry.
-                 * But note that the potential is in general non-zero,
-                 * since the soft-cored r will be non-zero.
-                 */
-                rinv = 0;
-                r    = 0;
+                continue;
             }
-
+            havePairsWithinCutoff = true;
+
+            /* Note that unlike in the nbnxn kernels, we do not need
+             * to clamp the value of rsq before taking the invsqrt
+             * to avoid NaN in the LJ calculation, since here we do
+             * not calculate LJ interactions when C6 and C12 are zero.
+             *
+             * The force at r=0 is zero, because of symmetry.
+             * But note that the potential is in general non-zero,
+             * since the soft-cored r will be non-zero.
+             */
+            const RealType rinv = gmx::maskzInvsqrt(rsq, (zero < rsq) && bWithinCutoff);
+            const RealType r    = rsq * rinv;
+
+            RealType rp, rpm2;
             if (useSoftCore)
             {
                 rpm2 = rsq * rsq;  /* r4 */
@@ -464,79 +524,70 @@ static void nb_free_energy_kernel(const t_nblist* gmx_restrict nlist,
                  * the simplest math and cheapest code.
                  */
                 rpm2 = rinv * rinv;
-                rp   = 1;
+                rp   = one;
             }
 
-            RealType Fscal = 0;
+            RealType Fscal = zero;
 
-            qq[STATE_A] = iqA * chargeA[jnr];
-            qq[STATE_B] = iqB * chargeB[jnr];
+            RealType qq[NSTATES];
+            qq[STATE_A] = gmx::load<RealType>(preloadQq[STATE_A]);
+            qq[STATE_B] = gmx::load<RealType>(preloadQq[STATE_B]);
 
-            tj[STATE_A] = ntiA + 2 * typeA[jnr];
-            tj[STATE_B] = ntiB + 2 * typeB[jnr];
-
-            if (bPairIncluded)
+            if (gmx::anyTrue(bIncludedWithinCutoff))
             {
-                c6[STATE_A] = nbfp[tj[STATE_A]];
-                c6[STATE_B] = nbfp[tj[STATE_B]];
+                RealType c6[NSTATES], c12[NSTATES], sigma6[NSTATES];
+                RealType Vcoul[NSTATES], Vvdw[NSTATES], FscalC[NSTATES], FscalV[NSTATES];
+                RealType alpha_vdw_eff, alpha_coul_eff;
 
                 for (int i = 0; i < NSTATES; i++)
                 {
-                    c12[i] = nbfp[tj[i] + 1];
+                    c6[i]  = gmx::load<RealType>(preloadC6[i]);
+                    c12[i] = gmx::load<RealType>(preloadC12[i]);
                     if (useSoftCore)
                     {
-                        if ((c6[i] > 0) && (c12[i] > 0))
-                        {
-                            /* c12 is stored scaled with 12.0 and c6 is scaled with 6.0 - correct for this */
-                            sigma6[i] = half * c12[i] / c6[i];
-                            if (sigma6[i] < sigma6_min) /* for disappearing coul and vdw with soft core at the same time */
-                            {
-                                sigma6[i] = sigma6_min;
-                            }
-                        }
-                        else
-                        {
-                            sigma6[i] = sigma6_def;
-                        }
+                        /* c12 is stored scaled with 12.0 and c6 is scaled with 6.0 - correct for this */
+                        const BoolType bHaveC6C12 = (zero < c6[i]) && (zero < c12[i]);
+                        sigma6[i] = half * c12[i] * gmx::maskzInv(c6[i], bHaveC6C12);
+                        /* for disappearing coul and vdw with soft core at the same time */
+                        sigma6[i] = gmx::max(sigma6[i], RealType(sigma6_min));
+                        sigma6[i] = gmx::blend(RealType(sigma6_def), sigma6[i], bHaveC6C12);
                     }
                 }
 
                 if (useSoftCore)
                 {
                     /* only use softcore if one of the states has a zero endstate - softcore is for avoiding infinities!*/
-                    if ((c12[STATE_A] > 0) && (c12[STATE_B] > 0))
-                    {
-                        alpha_vdw_eff  = 0;
-                        alpha_coul_eff = 0;
-                    }
-                    else
-                    {
-                        alpha_vdw_eff  = alpha_vdw;
-                        alpha_coul_eff = alpha_coul;
-                    }
+                    const BoolType bBothC12 = (zero < c12[STATE_A]) && (zero < c12[STATE_B]);
+                    alpha_vdw_eff           = gmx::selectByNotMask(RealType(alpha_vdw), bBothC12);
+                    alpha_coul_eff          = gmx::selectByNotMask(RealType(alpha_coul), bBothC12);
                 }
 
                 for (int i = 0; i < NSTATES; i++)
                 {
-                    FscalC[i] = 0;
-                    FscalV[i] = 0;
-                    Vcoul[i]  = 0;
-                    Vvdw[i]   = 0;
-
-                    RealType rinvC, rinvV, rC, rV, rpinvC, rpinvV;
+                    FscalC[i] = zero;
+                    FscalV[i] = zero;
+                    Vcoul[i]  = zero;
+                    Vvdw[i]   = zero;
 
                     /* Only spend time on A or B state if it is non-zero */
-                    if ((qq[i] != 0) || (c6[i] != 0) || (c12[i] != 0))
+                    const BoolType bNonZeroState =
+                            ((qq[i] != zero) || (c6[i] != zero) || (c12[i] != zero))
+                            && bIncludedWithinCutoff;
+                    if (gmx::anyTrue(bNonZeroState))
                     {
+                        RealType rinvC, rinvV, rC, rV, rpinvC, rpinvV;
+
                         /* this section has to be inside the loop because of the dependence on sigma6 */
                         if (useSoftCore)
                         {
-                            rpinvC = one / (alpha_coul_eff * lfac_coul[i] * sigma6[i] + rp);
-                            pthRoot(rpinvC, &rinvC, &rC);
+                            rpinvC = gmx::maskzInv(alpha_coul_eff * lfac_coul[i] * sigma6[i] + rp,
+                                                   bNonZeroState);
+                            pthRoot(rpinvC, &rinvC, &rC, bNonZeroState);
                             if (scLambdasOrAlphasDiffer)
                             {
-                                rpinvV = one / (alpha_vdw_eff * lfac_vdw[i] * sigma6[i] + rp);
-                                pthRoot(rpinvV, &rinvV, &rV);
+                                rpinvV = gmx::maskzInv(alpha_vdw_eff * lfac_vdw[i] * sigma6[i] + rp,
+                                                       bNonZeroState);
+                                pthRoot(rpinvV, &rinvV, &rV, bNonZeroState);
                             }
                             else
                             {
@@ -548,11 +599,11 @@ static void nb_free_energy_kernel(const t_nblist* gmx_restrict nlist,
                         }
                         else
                         {
-                            rpinvC = 1;
+                            rpinvC = one;
                             rinvC  = rinv;
                             rC     = r;
 
-                            rpinvV = 1;
+                            rpinvV = one;
                             rinvV  = rinv;
                             rV     = r;
                         }
@@ -561,10 +612,19 @@ static void nb_free_energy_kernel(const t_nblist* gmx_restrict nlist,
                          * and if we either include all entries in the list (no cutoff
                          * used in the kernel), or if we are within the cutoff.
                          */
-                        bool computeElecInteraction = (elecInteractionTypeIsEwald && r < rcoulomb)
-                                                      || (!elecInteractionTypeIsEwald && rC < rcoulomb);
+                        BoolType computeElecInteraction;
+                        if (elecInteractionTypeIsEwald)
+                        {
+                            computeElecInteraction = (r < rcoulomb);
+                        }
+                        else
+                        {
+                            computeElecInteraction = (rC < rcoulomb);
+                        }
+                        computeElecInteraction =
+                                computeElecInteraction && (qq[i] != zero) && bNonZeroState;
 
-                        if ((qq[i] != 0) && computeElecInteraction)
+                        if (gmx::anyTrue(computeElecInteraction))
                         {
                             if (elecInteractionTypeIsEwald)
                             {
@@ -576,6 +636,9 @@ static void nb_free_energy_kernel(const t_nblist* gmx_restrict nlist,
                                 Vcoul[i]  = reactionFieldPotential(qq[i], rinvC, rC, krf, crf);
                                 FscalC[i] = reactionFieldScalarForce(qq[i], rinvC, rC, krf, two);
                             }
+
+                            Vcoul[i]  = gmx::selectByMask(Vcoul[i], computeElecInteraction);
+                            FscalC[i] = gmx::selectByMask(FscalC[i], computeElecInteraction);
                         }
 
                         /* Only process the VDW interactions if we have
@@ -583,9 +646,20 @@ static void nb_free_energy_kernel(const t_nblist* gmx_restrict nlist,
                          * include all entries in the list (no cutoff used
                          * in the kernel), or if we are within the cutoff.
                          */
-                        bool computeVdwInteraction = (vdwInteractionTypeIsEwald && r < rvdw)
-                                                     || (!vdwInteractionTypeIsEwald && rV < rvdw);
-                        if ((c6[i] != 0 || c12[i] != 0) && computeVdwInteraction)
+                        BoolType computeVdwInteraction;
+                        if (vdwInteractionTypeIsEwald)
+                        {
+                            computeVdwInteraction = (r < rvdw);
+                        }
+                        else
+                        {
+                            computeVdwInteraction = (rV < rvdw);
+                        }
+                        computeVdwInteraction = computeVdwInteraction
+                                                && ((c6[i] != zero) || (c12[i] != zero))
+                                                && bNonZeroState;
+
+                        if (gmx::anyTrue(computeVdwInteraction))
                         {
                             RealType rinv6;
                             if (useSoftCore)
@@ -606,23 +680,29 @@ static void nb_free_energy_kernel(const t_nblist* gmx_restrict nlist,
                             if (vdwInteractionTypeIsEwald)
                             {
                                 /* Subtract the grid potential at the cut-off */
-                                Vvdw[i] += ewaldLennardJonesGridSubtract(nbfp_grid[tj[i]],
-                                                                         sh_lj_ewald, onesixth);
+                                Vvdw[i] = Vvdw[i]
+                                          + ewaldLennardJonesGridSubtract(
+                                                  gmx::load<RealType>(preloadC6Grid[i]),
+                                                  sh_lj_ewald, onesixth);
                             }
 
                             if (vdwModifierIsPotSwitch)
                             {
-                                RealType d        = rV - ic->rvdw_switch;
-                                d                 = (d > zero) ? d : zero;
+                                const RealType d  = gmx::max(rV - ic->rvdw_switch, RealType(zero));
                                 const RealType d2 = d * d;
                                 const RealType sw =
                                         one + d2 * d * (vdw_swV3 + d * (vdw_swV4 + d * vdw_swV5));
                                 const RealType dsw = d2 * (vdw_swF2 + d * (vdw_swF3 + d * vdw_swF4));
 
+                                const BoolType bWithinSwitch = (rV < rvdw);
+
                                 FscalV[i] = potSwitchScalarForceMod(FscalV[i], Vvdw[i], sw, rV,
-                                                                    rvdw, dsw, zero);
-                                Vvdw[i]   = potSwitchPotentialMod(Vvdw[i], sw, rV, rvdw, zero);
+                                                                    dsw, bWithinSwitch);
+                                Vvdw[i]   = potSwitchPotentialMod(Vvdw[i], sw, bWithinSwitch);
                             }
+
+                            Vvdw[i]   = gmx::selectByMask(Vvdw[i], computeVdwInteraction);
+                            FscalV[i] = gmx::selectByMask(FscalV[i], computeVdwInteraction);
                         }
 
                         /* FscalC (and FscalV) now contain: dV/drC * rC
@@ -630,35 +710,36 @@ static void nb_free_energy_kernel(const t_nblist* gmx_restrict nlist,
                          * Further down we first multiply by r^p-2 and then by
                          * the vector r, which in total gives: dV/drC * (r/rC)^1-p
                          */
-                        FscalC[i] *= rpinvC;
-                        FscalV[i] *= rpinvV;
+                        FscalC[i] = FscalC[i] * rpinvC;
+                        FscalV[i] = FscalV[i] * rpinvV;
                     }
                 } // end for (int i = 0; i < NSTATES; i++)
 
                 /* Assemble A and B states */
                 for (int i = 0; i < NSTATES; i++)
                 {
-                    vctot += LFC[i] * Vcoul[i];
-                    vvtot += LFV[i] * Vvdw[i];
+                    vctot = vctot + LFC[i] * Vcoul[i];
+                    vvtot = vvtot + LFV[i] * Vvdw[i];
 
-                    Fscal += LFC[i] * FscalC[i] * rpm2;
-                    Fscal += LFV[i] * FscalV[i] * rpm2;
+                    Fscal = Fscal + LFC[i] * FscalC[i] * rpm2;
+                    Fscal = Fscal + LFV[i] * FscalV[i] * rpm2;
 
                     if (useSoftCore)
                     {
-                        dvdl_coul += Vcoul[i] * DLF[i]
-                                     + LFC[i] * alpha_coul_eff * dlfac_coul[i] * FscalC[i] * sigma6[i];
-                        dvdl_vdw += Vvdw[i] * DLF[i]
-                                    + LFV[i] * alpha_vdw_eff * dlfac_vdw[i] * FscalV[i] * sigma6[i];
+                        dvdl_coul = dvdl_coul + Vcoul[i] * DLF[i]
+                                    + LFC[i] * alpha_coul_eff * dlfac_coul[i] * FscalC[i] * sigma6[i];
+                        dvdl_vdw = dvdl_vdw + Vvdw[i] * DLF[i]
+                                   + LFV[i] * alpha_vdw_eff * dlfac_vdw[i] * FscalV[i] * sigma6[i];
                     }
                     else
                     {
-                        dvdl_coul += Vcoul[i] * DLF[i];
-                        dvdl_vdw += Vvdw[i] * DLF[i];
+                        dvdl_coul = dvdl_coul + Vcoul[i] * DLF[i];
+                        dvdl_vdw  = dvdl_vdw + Vvdw[i] * DLF[i];
                     }
                 }
-            } // end if (bPairIncluded)
-            else if (icoul == GMX_NBKERNEL_ELEC_REACTIONFIELD)
+            } // end if (gmx::anyTrue(bIncludedWithinCutoff))
+
+            if (icoul == GMX_NBKERNEL_ELEC_REACTIONFIELD && gmx::anyTrue(bPairExcluded))
             {
                 /* For excluded pairs, which are only in this pair list when
                  * using the Verlet scheme, we don't use soft-core.
@@ -667,20 +748,22 @@ static void nb_free_energy_kernel(const t_nblist* gmx_restrict nlist,
                 const real FF = -two * krf;
                 RealType   VV = krf * rsq - crf;
 
-                if (ii == jnr)
-                {
-                    VV *= half;
-                }
+                /* Halve the self-interaction, see the Ewald case below */
+                VV = VV * gmx::load<RealType>(preloadSelfScale);
 
                 for (int i = 0; i < NSTATES; i++)
                 {
-                    vctot += LFC[i] * qq[i] * VV;
-                    Fscal += LFC[i] * qq[i] * FF;
-                    dvdl_coul += DLF[i] * qq[i] * VV;
+                    const RealType qqExcluded = gmx::selectByMask(qq[i], bPairExcluded);
+
+                    vctot     = vctot + LFC[i] * qqExcluded * VV;
+                    Fscal     = Fscal + LFC[i] * qqExcluded * FF;
+                    dvdl_coul = dvdl_coul + DLF[i] * qqExcluded * VV;
                 }
             }
 
-            if (elecInteractionTypeIsEwald && (r < rcoulomb || !bPairIncluded))
+            const BoolType computeElecEwaldInteraction =
+                    ((r < rcoulomb) || bPairExcluded) && bWithinCutoff;
+            if (elecInteractionTypeIsEwald && gmx::anyTrue(computeElecEwaldInteraction))
             {
                 /* See comment in the preamble. When using Ewald interactions
                  * (unless we use a switch modifier) we subtract the reciprocal-space
@@ -690,39 +773,44 @@ static void nb_free_energy_kernel(const t_nblist* gmx_restrict nlist,
                  * the softcore to the entire electrostatic interaction,
                  * including the reciprocal-space component.
                  */
-                real v_lr, f_lr;
+                /* Masked-out lanes can be beyond the table, use index 0 for them */
+                const RealType rTable = gmx::selectByMask(r, computeElecEwaldInteraction);
+                const RealType ewrt   = rTable * coulombTableScale;
+                const IntType  ewitab = gmx::cvttR2I(ewrt);
+                const RealType eweps  = ewrt - gmx::trunc(ewrt);
+                gmx::store(tableIndex, ewitab);
+
+                RealType ewtabF, ewtabFDiff, ewtabV, ewtabDummy;
+                gmx::gatherLoadTranspose<4>(ewtab, tableIndex, &ewtabF, &ewtabFDiff, &ewtabV,
+                                            &ewtabDummy);
 
-                const RealType ewrt   = r * coulombTableScale;
-                IntType        ewitab = static_cast<IntType>(ewrt);
-                const RealType eweps  = ewrt - ewitab;
-                ewitab                = 4 * ewitab;
-                f_lr                  = ewtab[ewitab] + eweps * ewtab[ewitab + 1];
-                v_lr = (ewtab[ewitab + 2] - coulombTableScaleInvHalf * eweps * (ewtab[ewitab] + f_lr));
-                f_lr *= rinv;
+                RealType f_lr = ewtabF + eweps * ewtabFDiff;
+                RealType v_lr = (ewtabV - coulombTableScaleInvHalf * eweps * (ewtabF + f_lr));
+                f_lr          = f_lr * rinv;
 
                 /* Note that any possible Ewald shift has already been applied in
                  * the normal interaction part above.
                  */
 
-                if (ii == jnr)
-                {
-                    /* If we get here, the i particle (ii) has itself (jnr)
-                     * in its neighborlist. This can only happen with the Verlet
-                     * scheme, and corresponds to a self-interaction that will
-                     * occur twice. Scale it down by 50% to only include it once.
-                     */
-                    v_lr *= half;
-                }
+                /* If the i particle (ii) has itself (jnr) in its neighborlist,
+                 * which can only happen with the Verlet scheme, this corresponds
+                 * to a self-interaction that will occur twice. The self scale
+                 * factor scales it down by 50% to only include it once.
+                 */
+                v_lr = v_lr * gmx::load<RealType>(preloadSelfScale);
 
                 for (int i = 0; i < NSTATES; i++)
                 {
-                    vctot -= LFC[i] * qq[i] * v_lr;
-                    Fscal -= LFC[i] * qq[i] * f_lr;
-                    dvdl_coul -= (DLF[i] * qq[i]) * v_lr;
+                    const RealType qqEwald = gmx::selectByMask(qq[i], computeElecEwaldInteraction);
+
+                    vctot     = vctot - LFC[i] * qqEwald * v_lr;
+                    Fscal     = Fscal - LFC[i] * qqEwald * f_lr;
+                    dvdl_coul = dvdl_coul - (DLF[i] * qqEwald) * v_lr;
                 }
             }
 
-            if (vdwInteractionTypeIsEwald && r < rvdw)
+            const BoolType computeVdwEwaldInteraction = (r < rvdw) && bWithinCutoff;
+            if (vdwInteractionTypeIsEwald && gmx::anyTrue(computeVdwEwaldInteraction))
             {
                 /* See comment in the preamble. When using LJ-Ewald interactions
                  * (unless we use a switch modifier) we subtract the reciprocal-space
@@ -737,45 +825,52 @@ static void nb_free_energy_kernel(const t_nblist* gmx_restrict nlist,
                  * r close to 0 for non-interacting pairs.
                  */
 
-                const RealType rs   = rsq * rinv * vdwTableScale;
-                const IntType  ri   = static_cast<IntType>(rs);
-                const RealType frac = rs - ri;
-                const RealType f_lr = (1 - frac) * tab_ewald_F_lj[ri] + frac * tab_ewald_F_lj[ri + 1];
+                /* Without a Coulomb table this table only extends to the cut-off,
+                 * so masked-out lanes, e.g. excluded pairs, can be beyond the table.
+                 */
+                const RealType rTable = gmx::selectByMask(r, computeVdwEwaldInteraction);
+                const RealType rs     = rTable * vdwTableScale;
+                const IntType  ri     = gmx::cvttR2I(rs);
+                const RealType frac   = rs - gmx::trunc(rs);
+                gmx::store(tableIndex, ri);
+
+                RealType ljtabF, ljtabFDiff, ljtabV, ljtabDummy;
+                gmx::gatherLoadTranspose<4>(tab_ewald_FDV0_lj, tableIndex, &ljtabF, &ljtabFDiff,
+                                            &ljtabV, &ljtabDummy);
+
+                const RealType f_lr = ljtabF + frac * ljtabFDiff;
                 /* TODO: Currently the Ewald LJ table does not contain
                  * the factor 1/6, we should add this.
                  */
-                const RealType FF = f_lr * rinv / six;
-                RealType       VV =
-                        (tab_ewald_V_lj[ri] - vdwTableScaleInvHalf * frac * (tab_ewald_F_lj[ri] + f_lr))
-                        / six;
+                const RealType FF = f_lr * rinv * onesixth;
+                RealType VV = (ljtabV - vdwTableScaleInvHalf * frac * (ljtabF + f_lr)) * onesixth;
 
-                if (ii == jnr)
-                {
-                    /* If we get here, the i particle (ii) has itself (jnr)
-                     * in its neighborlist. This can only happen with the Verlet
-                     * scheme, and corresponds to a self-interaction that will
-                     * occur twice. Scale it down by 50% to only include it once.
-                     */
-                    VV *= half;
-                }
+                /* Halve the self-interaction, see the Ewald Coulomb case above */
+                VV = VV * gmx::load<RealType>(preloadSelfScale);
 
                 for (int i = 0; i < NSTATES; i++)
                 {
-                    const real c6grid = nbfp_grid[tj[i]];
-                    vvtot += LFV[i] * c6grid * VV;
-                    Fscal += LFV[i] * c6grid * FF;
-                    dvdl_vdw += (DLF[i] * c6grid) * VV;
+                    const RealType c6grid = gmx::selectByMask(gmx::load<RealType>(preloadC6Grid[i]),
+                                                              computeVdwEwaldInteraction);
+                    vvtot                 = vvtot + LFV[i] * c6grid * VV;
+                    Fscal                 = Fscal + LFV[i] * c6grid * FF;
+                    dvdl_vdw              = dvdl_vdw + (DLF[i] * c6grid) * VV;
                 }
             }
 
             if (doForces)
             {
-                const real tx = Fscal * dx;
-                const real ty = Fscal * dy;
-                const real tz = Fscal * dz;
-                fix           = fix + tx;
-                fiy           = fiy + ty;
-                fiz           = fiz + tz;
+                const RealType tx = Fscal * dx;
+                const RealType ty = Fscal * dy;
+                const RealType tz = Fscal * dz;
+                fix               = fix + tx;
+                fiy               = fiy + ty;
+                fiz               = fiz + tz;
+
+                gmx::store(forceJ[XX], tx);
+                gmx::store(forceJ[YY], ty);
+                gmx::store(forceJ[ZZ], tz);
+
                 /* OpenMP atomics are expensive, but this kernels is also
                  * expensive, so we can take this hit, instead of using
                  * thread-local output buffers and extra reduction.
@@ -783,55 +878,70 @@ static void nb_free_energy_kernel(const t_nblist* gmx_restrict nlist,
                  * All the OpenMP regions in this file are trivial and should
                  * not throw, so no need for try/catch.
                  */
+                for (int s = 0; s < numPairs; s++)
+                {
+                    const int j3 = 3 * preloadJnr[s];
 #pragma omp atomic
-                f[j3] -= tx;
+                    f[j3] -= forceJ[XX][s];
 #pragma omp atomic
-                f[j3 + 1] -= ty;
+                    f[j3 + 1] -= forceJ[YY][s];
 #pragma omp atomic
-                f[j3 + 2] -= tz;
+                    f[j3 + 2] -= forceJ[ZZ][s];
+                }
             }
-        } // end for (int k = nj0; k < nj1; k++)
+        } // end for (int k = nj0; k < nj1; k += simdRealWidth)
 
         /* The atomics below are expensive with many OpenMP threads.
          * Here unperturbed i-particles will usually only have a few
          * (perturbed) j-particles in the list. Thus with a buffered list
          * we can skip a significant number of i-reductions with a check.
          */
-        if (npair_within_cutoff > 0)
+        if (havePairsWithinCutoff)
         {
-            if (doForces)
+            if (doForces || doShiftForces)
             {
+                const real fixSum = gmx::reduce(fix);
+                const real fiySum = gmx::reduce(fiy);
+                const real fizSum = gmx::reduce(fiz);
+
+                if (doForces)
+                {
 #pragma omp atomic
-                f[ii3] += fix;
+                    f[ii3] += fixSum;
 #pragma omp atomic
-                f[ii3 + 1] += fiy;
+                    f[ii3 + 1] += fiySum;
 #pragma omp atomic
-                f[ii3 + 2] += fiz;
-            }
-            if (doShiftForces)
-            {
+                    f[ii3 + 2] += fizSum;
+                }
+                if (doShiftForces)
+                {
 #pragma omp atomic
-                fshift[is3] += fix;
+                    fshift[is3] += fixSum;
 #pragma omp atomic
-                fshift[is3 + 1] += fiy;
+                    fshift[is3 + 1] += fiySum;
 #pragma omp atomic
-                fshift[is3 + 2] += fiz;
+                    fshift[is3 + 2] += fizSum;
+                }
             }
             if (doPotential)
             {
-                int ggid = gid[n];
+                const real vctotSum = gmx::reduce(vctot);
+                const real vvtotSum = gmx::reduce(vvtot);
+                int        ggid     = gid[n];
 #pragma omp atomic
-                Vc[ggid] += vctot;
+                Vc[ggid] += vctotSum;
 #pragma omp atomic
-                Vv[ggid] += vvtot;
+                Vv[ggid] += vvtotSum;
             }
         }
     } // end for (int n = 0; n < nri; n++)
 
+    const real dvdl_coulSum = gmx::reduce(dvdl_coul);
+    const real dvdl_vdwSum  = gmx::reduce(dvdl_vdw);
 #pragma omp atomic
-    dvdl[efptCOUL] += dvdl_coul;
+    dvdl[efptCOUL] += dvdl_coulSum;
 #pragma omp atomic
-    dvdl[efptVDW] += dvdl_vdw;
+    dvdl[efptVDW] += dvdl_vdwSum;
 
     /* Estimate flops, average for free energy stuff:
      * 12  flops per outer iteration
@@ -841,6 +951,7 @@ static void nb_free_energy_kernel(const t_nblist* gmx_restrict nlist,
     inc_nrnb(nrnb, eNR_NBKERNEL_FREE_ENERGY, nlist->nri * 12 + nlist->jindex[nri] * 150);
 }
 
+
 typedef void (*KernelFunction)(const t_nblist* gmx_restrict nlist,
                                rvec* gmx_restrict         xx,
                                gmx::ForceWithShiftForces* forceWithShiftForces,
@@ -855,8 +966,7 @@ static KernelFunction dispatchKernelOnUseSimd(const bool useSimd)
     if (useSimd)
     {
 #if GMX_SIMD_HAVE_REAL && GMX_SIMD_HAVE_INT32_ARITHMETICS && GMX_USE_SIMD_KERNELS
-        /* FIXME: Here SimdDataTypes should be used to enable SIMD. So far, the code in nb_free_energy_kernel is not adapted to SIMD */
-        return (nb_free_energy_kernel<ScalarDataTypes, useSoftCore, scLambdasOrAlphasDiffer, vdwInteractionTypeIsEwald,
+        return (nb_free_energy_kernel<SimdDataTypes, useSoftCore, scLambdasOrAlphasDiffer, vdwInteractionTypeIsEwald,
                                       elecInteractionTypeIsEwald, vdwModifierIsPotSwitch>);
 #else
         return (nb_free_energy_kernel<ScalarDataTypes, useSoftCore, scLambdasOrAlphasDiffer, vdwInteractionTypeIsEwald,
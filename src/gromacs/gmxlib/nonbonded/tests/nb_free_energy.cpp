@@ -0,0 +1,476 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests that the SIMD and the scalar free-energy kernel give the same result
+ *
+ * Both are also checked against reference data that was generated with the
+ * scalar kernel as it was before the SIMD rewrite, in double precision.
+ * That catches errors common to both paths, such as in the table reads.
+ */
+#include "gmxpre.h"
+
+#include "gromacs/gmxlib/nonbonded/nb_free_energy.h"
+
+#include <cmath>
+
+#include <algorithm>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/ewald/ewald_utils.h"
+#include "gromacs/gmxlib/nrnb.h"
+#include "gromacs/gmxlib/nonbonded/nonbonded.h"
+#include "gromacs/math/functions.h"
+#include "gromacs/math/paddedvector.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/math/vectypes.h"
+#include "gromacs/mdlib/forcerec.h"
+#include "gromacs/mdtypes/forceoutput.h"
+#include "gromacs/mdtypes/forcerec.h"
+#include "gromacs/mdtypes/inputrec.h"
+#include "gromacs/mdtypes/interaction_const.h"
+#include "gromacs/mdtypes/md_enums.h"
+#include "gromacs/mdtypes/mdatom.h"
+#include "gromacs/mdtypes/nblist.h"
+#include "gromacs/pbcutil/ishift.h"
+#include "gromacs/random/threefry.h"
+#include "gromacs/random/uniformrealdistribution.h"
+#include "gromacs/utility/smalloc.h"
+
+#include "testutils/refdata.h"
+#include "testutils/testasserts.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Number of atoms in the test system
+constexpr int c_numAtoms = 24;
+//! Number of atom types, type 0 has zero LJ parameters
+constexpr int c_numTypes = 3;
+//! Cut-off distance for Coulomb and VdW
+constexpr real c_cutoff = 1.0;
+//! Extension of the Ewald correction table beyond the cut-off, covers excluded pairs
+constexpr real c_tableExtension = 0.5;
+//! Edge of the cubic box the atoms are placed in
+constexpr real c_boxSize = 2.0;
+
+//! The Van der Waals treatments that are tested
+enum class VdwTreatment
+{
+    PotentialShift,
+    PotentialSwitch,
+    LJPme
+};
+
+//! Lambda values for Coulomb and VdW, different values exercise the separate soft-core radii
+struct Lambdas
+{
+    //! Coulomb lambda
+    real coulomb;
+    //! VdW lambda
+    real vdw;
+};
+
+//! Test parameters: soft-core alpha, electrostatics type, VdW treatment, lambdas
+using FepKernelTestParameters = std::tuple<real, int, VdwTreatment, Lambdas>;
+
+//! The output of one kernel call
+struct KernelOutput
+{
+    //! Forces on the atoms
+    std::vector<RVec> forces;
+    //! Shift forces
+    std::vector<RVec> shiftForces;
+    //! Coulomb energy
+    real coulombEnergy = 0;
+    //! VdW energy
+    real vdwEnergy = 0;
+    //! Coulomb dV/dlambda
+    real dvdlCoulomb = 0;
+    //! VdW dV/dlambda
+    real dvdlVdw = 0;
+};
+
+/*! \brief Sets up a perturbed system with a pair list and runs the kernel on it
+ *
+ * The pair list has i-entries with a varying number of j-particles, so
+ * the SIMD kernel gets full chunks as well as chunks that are padded at
+ * the end. It contains a self-pair, excluded pairs within and beyond the
+ * cut-off and an entry with a non-central shift vector.
+ */
+class FreeEnergyKernelSystem
+{
+public:
+    //! Constructor
+    explicit FreeEnergyKernelSystem(const FepKernelTestParameters& parameters)
+    {
+        const real         alpha        = std::get<0>(parameters);
+        const int          eeltype      = std::get<1>(parameters);
+        const VdwTreatment vdwTreatment = std::get<2>(parameters);
+        const Lambdas      lambdas      = std::get<3>(parameters);
+
+        DefaultRandomEngine           rng(1234);
+        UniformRealDistribution<real> dist(0, c_boxSize);
+        x_.resizeWithPadding(c_numAtoms);
+        for (auto& x : x_)
+        {
+            x = { dist(rng), dist(rng), dist(rng) };
+        }
+        for (int a = 0; a < c_numAtoms; a++)
+        {
+            chargeA_.push_back(0.5 * ((a % 5) - 2));
+            chargeB_.push_back(a % 3 == 0 ? 0 : chargeA_[a]);
+            typeA_.push_back(a % c_numTypes);
+            typeB_.push_back(a % 4 == 0 ? 0 : typeA_[a]);
+        }
+
+        // Use the same layout as fr->nbfp: 6*C6 and 12*C12 per type pair
+        const real c6[c_numTypes]  = { 0, 2.5e-3, 6.2e-3 };
+        const real c12[c_numTypes] = { 0, 3.1e-6, 1.1e-5 };
+        for (int i = 0; i < c_numTypes; i++)
+        {
+            for (int j = 0; j < c_numTypes; j++)
+            {
+                const real c6ij = std::sqrt(c6[i] * c6[j]);
+                nbfp_.push_back(6 * c6ij);
+                nbfp_.push_back(12 * std::sqrt(c12[i] * c12[j]));
+                c6Grid_.push_back(6 * c6ij);
+                c6Grid_.push_back(0);
+            }
+        }
+
+        shiftVectors_.resize(SHIFTS, { 0, 0, 0 });
+        shiftVectors_[CENTRAL + 1][XX] = c_boxSize;
+
+        // Entries of 1, 5, 11 and 35 j-particles, with padded SIMD chunks
+        addIEntry(0, CENTRAL, { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18,
+                                19, 20, 21, 22, 23, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 });
+        addIEntry(3, CENTRAL, { 12 });
+        addIEntry(5, CENTRAL + 1, { 6, 7, 8, 9, 10 });
+        addIEntry(13, CENTRAL, { 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23 });
+
+        /* Exclude the self-pairs and every third pair, as long as the pair
+         * is within the range of the Ewald correction table, as in mdrun.
+         * Some of the excluded pairs are beyond the cut-off.
+         */
+        for (size_t n = 0; n < iinr_.size(); n++)
+        {
+            const int ii = iinr_[n];
+            for (int k = jindex_[n]; k < jindex_[n + 1]; k++)
+            {
+                const int jj = jjnr_[k];
+                RVec      dx = x_[ii] + shiftVectors_[shift_[n]] - x_[jj];
+                if ((ii == jj || k % 3 == 1) && norm(dx) < c_cutoff + c_tableExtension)
+                {
+                    exclFep_[k] = 0;
+                }
+            }
+        }
+
+        ic_.rcoulomb = c_cutoff;
+        ic_.rvdw     = c_cutoff;
+        ic_.eeltype  = eeltype;
+        ic_.epsfac   = 138.935458;
+        if (EEL_RF(eeltype))
+        {
+            // Reaction-field with infinite dielectric constant
+            ic_.k_rf = 0.5 / power3(c_cutoff);
+            ic_.c_rf = 1 / c_cutoff + ic_.k_rf * c_cutoff * c_cutoff;
+        }
+        else
+        {
+            ic_.coulomb_modifier = eintmodPOTSHIFT;
+            ic_.ewaldcoeff_q     = calc_ewaldcoeff_q(c_cutoff, 1e-5);
+            ic_.sh_ewald         = std::erfc(ic_.ewaldcoeff_q * c_cutoff) / c_cutoff;
+        }
+        switch (vdwTreatment)
+        {
+            case VdwTreatment::PotentialShift:
+                ic_.vdw_modifier          = eintmodPOTSHIFT;
+                ic_.dispersion_shift.cpot = -1.0 / power6(c_cutoff);
+                ic_.repulsion_shift.cpot  = -1.0 / power12(c_cutoff);
+                break;
+            case VdwTreatment::PotentialSwitch:
+                ic_.vdw_modifier = eintmodPOTSWITCH;
+                ic_.rvdw_switch  = 0.8;
+                break;
+            case VdwTreatment::LJPme:
+            {
+                ic_.vdwtype               = evdwPME;
+                ic_.vdw_modifier          = eintmodPOTSHIFT;
+                ic_.dispersion_shift.cpot = -1.0 / power6(c_cutoff);
+                ic_.repulsion_shift.cpot  = -1.0 / power12(c_cutoff);
+                ic_.ewaldcoeff_lj         = calc_ewaldcoeff_lj(c_cutoff, 1e-3);
+                const real crc2           = square(ic_.ewaldcoeff_lj * c_cutoff);
+                ic_.sh_lj_ewald =
+                        (std::exp(-crc2) * (1 + crc2 + 0.5 * crc2 * crc2) - 1) / power6(c_cutoff);
+                break;
+            }
+        }
+        ic_.coulombEwaldTables = std::make_unique<EwaldCorrectionTables>();
+        ic_.vdwEwaldTables     = std::make_unique<EwaldCorrectionTables>();
+        init_interaction_const_tables(nullptr, &ic_, c_tableExtension);
+
+        t_lambda fepVals{};
+        fepVals.sc_alpha     = alpha;
+        fepVals.sc_power     = 1;
+        fepVals.sc_r_power   = 6;
+        fepVals.sc_sigma     = 0.3;
+        fepVals.sc_sigma_min = 0.3;
+        fepVals.bScCoul      = TRUE;
+        ic_.softCoreParameters = std::make_unique<interaction_const_t::SoftCoreParameters>(fepVals);
+
+        std::fill(std::begin(lambda_), std::end(lambda_), 0);
+        lambda_[efptCOUL] = lambdas.coulomb;
+        lambda_[efptVDW]  = lambdas.vdw;
+    }
+
+    //! Runs the SIMD or the scalar kernel and returns its output
+    KernelOutput run(bool useSimd)
+    {
+        t_forcerec fr;
+        fr.ic               = &ic_;
+        fr.use_simd_kernels = useSimd;
+        fr.ntype            = c_numTypes;
+        fr.nbfp             = nbfp_;
+        fr.ljpme_c6grid     = c6Grid_.data();
+        snew(fr.shift_vec, SHIFTS);
+        for (int s = 0; s < SHIFTS; s++)
+        {
+            copy_rvec(shiftVectors_[s], fr.shift_vec[s]);
+        }
+
+        t_mdatoms mdatoms{};
+        mdatoms.nr      = c_numAtoms;
+        mdatoms.chargeA = chargeA_.data();
+        mdatoms.chargeB = chargeB_.data();
+        mdatoms.typeA   = typeA_.data();
+        mdatoms.typeB   = typeB_.data();
+
+        t_nblist nlist{};
+        nlist.nri      = static_cast<int>(iinr_.size());
+        nlist.nrj      = static_cast<int>(jjnr_.size());
+        nlist.iinr     = iinr_.data();
+        nlist.gid      = gid_.data();
+        nlist.shift    = shift_.data();
+        nlist.jindex   = jindex_.data();
+        nlist.jjnr     = jjnr_.data();
+        nlist.excl_fep = exclFep_.data();
+
+        KernelOutput output;
+
+        real             dvdl[efptNR] = { 0 };
+        nb_kernel_data_t kernelData{};
+        kernelData.flags =
+                GMX_NONBONDED_DO_FORCE | GMX_NONBONDED_DO_SHIFTFORCE | GMX_NONBONDED_DO_POTENTIAL;
+        kernelData.lambda         = lambda_;
+        kernelData.dvdl           = dvdl;
+        kernelData.energygrp_elec = &output.coulombEnergy;
+        kernelData.energygrp_vdw  = &output.vdwEnergy;
+
+        PaddedVector<RVec>   forces(c_numAtoms, { 0, 0, 0 });
+        std::vector<RVec>    shiftForces(SHIFTS, { 0, 0, 0 });
+        ForceWithShiftForces forceWithShiftForces(forces.arrayRefWithPadding(), true, shiftForces);
+
+        t_nrnb nrnb;
+        gmx_nb_free_energy_kernel(&nlist, as_rvec_array(x_.data()), &forceWithShiftForces, &fr,
+                                  &mdatoms, &kernelData, &nrnb);
+
+        output.forces.assign(forces.begin(), forces.end());
+        output.shiftForces = shiftForces;
+        output.dvdlCoulomb = dvdl[efptCOUL];
+        output.dvdlVdw     = dvdl[efptVDW];
+
+        return output;
+    }
+
+private:
+    //! Adds an i-entry with the j-particles \p jAtoms to the pair list
+    void addIEntry(int iAtom, int shift, const std::vector<int>& jAtoms)
+    {
+        if (jindex_.empty())
+        {
+            jindex_.push_back(0);
+        }
+        iinr_.push_back(iAtom);
+        gid_.push_back(0);
+        shift_.push_back(shift);
+        jjnr_.insert(jjnr_.end(), jAtoms.begin(), jAtoms.end());
+        exclFep_.resize(jjnr_.size(), 1);
+        jindex_.push_back(static_cast<int>(jjnr_.size()));
+    }
+
+    //! Coordinates, padded as the SIMD kernel loads beyond the last atom
+    PaddedVector<RVec> x_;
+
+    std::vector<real> chargeA_;
+    std::vector<real> chargeB_;
+    std::vector<int>  typeA_;
+    std::vector<int>  typeB_;
+    std::vector<real> nbfp_;
+    std::vector<real> c6Grid_;
+
+    std::vector<RVec> shiftVectors_;
+    std::vector<int>  iinr_;
+    std::vector<int>  gid_;
+    std::vector<int>  shift_;
+    std::vector<int>  jindex_;
+    std::vector<int>  jjnr_;
+    std::vector<char> exclFep_;
+
+    interaction_const_t ic_;
+    real                lambda_[efptNR];
+};
+
+//! Returns the largest absolute force component, used to scale the force tolerance
+real maxAbsForce(const std::vector<RVec>& forces)
+{
+    real maxForce = 0;
+    for (const RVec& f : forces)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            maxForce = std::max(maxForce, std::abs(f[d]));
+        }
+    }
+    return maxForce;
+}
+
+//! Returns the relative tolerance for comparing kernel outputs
+real kernelTolerance()
+{
+    // The SIMD kernel uses SIMD approximations for 1/sqrt, cbrt and exp
+    return GMX_DOUBLE ? 1e-10 : 5e-5;
+}
+
+/*! \brief Checks \p output against reference data
+ *
+ * The energies and dV/dlambda are sums of terms of both signs, so their
+ * tolerance is relative to the largest energy instead of to the value itself.
+ */
+void checkKernelOutput(TestReferenceChecker* checker, const KernelOutput& output)
+{
+    TestReferenceChecker energyChecker(checker->checkCompound("Energies", "Energies"));
+    const real energyMagnitude = std::max(std::abs(output.coulombEnergy), std::abs(output.vdwEnergy));
+    energyChecker.setDefaultTolerance(
+            relativeToleranceAsFloatingPoint(energyMagnitude, kernelTolerance()));
+    energyChecker.checkReal(output.coulombEnergy, "Coulomb");
+    energyChecker.checkReal(output.vdwEnergy, "VdW");
+    energyChecker.checkReal(output.dvdlCoulomb, "dVdlCoulomb");
+    energyChecker.checkReal(output.dvdlVdw, "dVdlVdW");
+
+    TestReferenceChecker forceChecker(checker->checkCompound("Forces", "Forces"));
+    forceChecker.setDefaultTolerance(
+            relativeToleranceAsFloatingPoint(maxAbsForce(output.forces), kernelTolerance()));
+    forceChecker.checkSequence(output.forces.begin(), output.forces.end(), "Forces");
+    forceChecker.checkSequence(output.shiftForces.begin(), output.shiftForces.end(), "ShiftForces");
+}
+
+class FreeEnergyKernelTest : public ::testing::TestWithParam<FepKernelTestParameters>
+{
+};
+
+TEST_P(FreeEnergyKernelTest, ReproducesReferenceData)
+{
+    FreeEnergyKernelSystem system(GetParam());
+
+    TestReferenceData    refData;
+    TestReferenceChecker checker(refData.rootChecker());
+
+    // Both paths are checked against the same reference values
+    checkKernelOutput(&checker, system.run(false));
+    checkKernelOutput(&checker, system.run(true));
+}
+
+TEST_P(FreeEnergyKernelTest, SimdKernelMatchesScalarKernel)
+{
+    FreeEnergyKernelSystem system(GetParam());
+
+    const KernelOutput scalar = system.run(false);
+    const KernelOutput simd   = system.run(true);
+
+    // The energies and dV/dlambda are sums of terms of both signs, so their
+    // tolerance is relative to the largest energy instead of to the sum itself.
+    const real tolerance       = kernelTolerance();
+    const real energyMagnitude =
+            std::max(std::abs(scalar.coulombEnergy), std::abs(scalar.vdwEnergy));
+    const auto energyTolerance = relativeToleranceAsFloatingPoint(energyMagnitude, tolerance);
+
+    EXPECT_REAL_EQ_TOL(scalar.coulombEnergy, simd.coulombEnergy, energyTolerance);
+    EXPECT_REAL_EQ_TOL(scalar.vdwEnergy, simd.vdwEnergy, energyTolerance);
+    EXPECT_REAL_EQ_TOL(scalar.dvdlCoulomb, simd.dvdlCoulomb, energyTolerance);
+    EXPECT_REAL_EQ_TOL(scalar.dvdlVdw, simd.dvdlVdw, energyTolerance);
+
+    const auto forceTolerance =
+            relativeToleranceAsFloatingPoint(maxAbsForce(scalar.forces), tolerance);
+    for (int a = 0; a < c_numAtoms; a++)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            EXPECT_REAL_EQ_TOL(scalar.forces[a][d], simd.forces[a][d], forceTolerance)
+                    << "Force on atom " << a << " dimension " << d;
+        }
+    }
+    for (int s = 0; s < SHIFTS; s++)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            EXPECT_REAL_EQ_TOL(scalar.shiftForces[s][d], simd.shiftForces[s][d], forceTolerance)
+                    << "Shift force " << s << " dimension " << d;
+        }
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(SoftCoreAndInteractions,
+                        FreeEnergyKernelTest,
+                        ::testing::Combine(::testing::Values(0.0, 0.35),
+                                           ::testing::Values(eelRF, eelPME),
+                                           ::testing::Values(VdwTreatment::PotentialShift,
+                                                             VdwTreatment::PotentialSwitch,
+                                                             VdwTreatment::LJPme),
+                                           ::testing::Values(Lambdas{ 0.4, 0.4 },
+                                                             Lambdas{ 0.2, 0.7 })));
+
+} // namespace
+} // namespace test
+} // namespace gmx
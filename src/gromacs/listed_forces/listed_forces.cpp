@@ -80,9 +80,40 @@
 #include "manage_threading.h"
 #include "utilities.h"
 
+/*! \brief The arguments of calculate() that are needed by the bonded tasks
+ *
+ * All pointers should stay valid until reduceBondedTasks() has been called.
+ */
+struct ListedForces::BondedTaskData
+{
+    //! The coordinates
+    const rvec* x;
+    //! The force record
+    const t_forcerec* fr;
+    //! PBC setup, nullptr when PBC is not needed
+    const t_pbc* pbc;
+    //! The force and shift force output
+    gmx::ForceWithShiftForces* forceWithShiftForces;
+    //! The energy output
+    gmx_enerdata_t* enerd;
+    //! Flop accounting
+    t_nrnb* nrnb;
+    //! The lambda values
+    const real* lambda;
+    //! Atom data
+    const t_mdatoms* md;
+    //! Global atom indices, only used for printing errors
+    int* globalAtomIndex;
+    //! What to compute this step
+    const gmx::StepWorkload* stepWork;
+    //! The dV/dlambda output of task 0
+    real dvdl[efptNR];
+};
+
 ListedForces::ListedForces(const int numEnergyGroups, const int numThreads, FILE* fplog) :
     threading_(std::make_unique<bonded_threading_t>(numThreads, numEnergyGroups, fplog)),
-    fcdata_(std::make_unique<t_fcdata>())
+    fcdata_(std::make_unique<t_fcdata>()),
+    bondedTaskData_(std::make_unique<BondedTaskData>())
 {
 }
 
@@ -408,6 +439,71 @@ real calc_one_bond(int                           thread,
 
 } // namespace
 
+/*! \brief Compute the bonded part of the listed forces for one thread task
+ *
+ * Only the output buffers of task \p thread are written, except for task 0
+ * which writes directly to the main shift force, energy and dV/dlambda buffers.
+ */
+static void calcBondedForcesTask(const int                     thread,
+                                 const InteractionDefinitions& idef,
+                                 bonded_threading_t*           bt,
+                                 const rvec                    x[],
+                                 const t_forcerec*             fr,
+                                 const t_pbc*                  pbc_null,
+                                 rvec*                         fshiftMasterBuffer,
+                                 gmx_enerdata_t*               enerd,
+                                 t_nrnb*                       nrnb,
+                                 const real*                   lambda,
+                                 real*                         dvdl,
+                                 const t_mdatoms*              md,
+                                 t_fcdata*                     fcd,
+                                 const gmx::StepWorkload&      stepWork,
+                                 int*                          global_atom_index)
+{
+    f_thread_t& threadBuffers = *bt->f_t[thread];
+    int         ftype;
+    real *      epot, v;
+    /* thread stuff */
+    rvec*              fshift;
+    real*              dvdlt;
+    gmx_grppairener_t* grpp;
+
+    zero_thread_output(&threadBuffers);
+
+    rvec4* ft = threadBuffers.f;
+
+    /* Thread 0 writes directly to the main output buffers.
+     * We might want to reconsider this.
+     */
+    if (thread == 0)
+    {
+        fshift = fshiftMasterBuffer;
+        epot   = enerd->term;
+        grpp   = &enerd->grpp;
+        dvdlt  = dvdl;
+    }
+    else
+    {
+        fshift = as_rvec_array(threadBuffers.fshift.data());
+        epot   = threadBuffers.ener;
+        grpp   = &threadBuffers.grpp;
+        dvdlt  = threadBuffers.dvdl;
+    }
+    /* Loop over all bonded force types to calculate the bonded forces */
+    for (ftype = 0; (ftype < F_NRE); ftype++)
+    {
+        const InteractionList& ilist = idef.il[ftype];
+        if (!ilist.empty() && ftype_is_bonded_potential(ftype))
+        {
+            ArrayRef<const int> iatoms = gmx::makeConstArrayRef(ilist.iatoms);
+            v = calc_one_bond(thread, ftype, idef, iatoms, idef.numNonperturbedInteractions[ftype],
+                              bt->workDivision, x, ft, fshift, fr, pbc_null, grpp, nrnb, lambda,
+                              dvdlt, md, fcd, stepWork, global_atom_index);
+            epot[ftype] += v;
+        }
+    }
+}
+
 /*! \brief Compute the bonded part of the listed forces, parallelized over threads
  */
 static void calcBondedForces(const InteractionDefinitions& idef,
@@ -430,48 +526,8 @@ static void calcBondedForces(const InteractionDefinitions& idef,
     {
         try
         {
-            f_thread_t& threadBuffers = *bt->f_t[thread];
-            int         ftype;
-            real *      epot, v;
-            /* thread stuff */
-            rvec*              fshift;
-            real*              dvdlt;
-            gmx_grppairener_t* grpp;
-
-            zero_thread_output(&threadBuffers);
-
-            rvec4* ft = threadBuffers.f;
-
-            /* Thread 0 writes directly to the main output buffers.
-             * We might want to reconsider this.
-             */
-            if (thread == 0)
-            {
-                fshift = fshiftMasterBuffer;
-                epot   = enerd->term;
-                grpp   = &enerd->grpp;
-                dvdlt  = dvdl;
-            }
-            else
-            {
-                fshift = as_rvec_array(threadBuffers.fshift.data());
-                epot   = threadBuffers.ener;
-                grpp   = &threadBuffers.grpp;
-                dvdlt  = threadBuffers.dvdl;
-            }
-            /* Loop over all bonded force types to calculate the bonded forces */
-            for (ftype = 0; (ftype < F_NRE); ftype++)
-            {
-                const InteractionList& ilist = idef.il[ftype];
-                if (!ilist.empty() && ftype_is_bonded_potential(ftype))
-                {
-                    ArrayRef<const int> iatoms = gmx::makeConstArrayRef(ilist.iatoms);
-                    v = calc_one_bond(thread, ftype, idef, iatoms, idef.numNonperturbedInteractions[ftype],
-                                      bt->workDivision, x, ft, fshift, fr, pbc_null, grpp, nrnb,
-                                      lambda, dvdlt, md, fcd, stepWork, global_atom_index);
-                    epot[ftype] += v;
-                }
-            }
+            calcBondedForcesTask(thread, idef, bt, x, fr, pbc_null, fshiftMasterBuffer, enerd, nrnb,
+                                 lambda, dvdl, md, fcd, stepWork, global_atom_index);
         }
         GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
     }
@@ -633,7 +689,8 @@ void ListedForces::calculate(struct gmx_wallcycle*          wcycle,
                              const real*                    lambda,
                              const t_mdatoms*               md,
                              int*                           global_atom_index,
-                             const gmx::StepWorkload&       stepWork)
+                             const gmx::StepWorkload&       stepWork,
+                             const BondedExecution          bondedExecution)
 {
     if (!stepWork.computeListedForces)
     {
@@ -686,8 +743,28 @@ void ListedForces::calculate(struct gmx_wallcycle*          wcycle,
         wallcycle_sub_stop(wcycle, ewcsRESTRAINTS);
     }
 
-    calc_listed(wcycle, idef, threading_.get(), x, forceOutputs, fr, pbc, enerd, nrnb, lambda, md,
-                &fcdata, global_atom_index, stepWork);
+    if (bondedExecution == BondedExecution::InCalculate || !threading_->haveBondeds)
+    {
+        calc_listed(wcycle, idef, threading_.get(), x, forceOutputs, fr, pbc, enerd, nrnb, lambda,
+                    md, &fcdata, global_atom_index, stepWork);
+    }
+    else
+    {
+        /* Store the arguments for the bonded tasks, which are computed
+         * by the caller through computeBondedTask() */
+        BondedTaskData& data      = *bondedTaskData_;
+        data.x                    = x;
+        data.fr                   = fr;
+        data.pbc                  = fr->bMolPBC ? pbc : nullptr;
+        data.forceWithShiftForces = &forceOutputs->forceWithShiftForces();
+        data.enerd                = enerd;
+        data.nrnb                 = nrnb;
+        data.lambda               = lambda;
+        data.md                   = md;
+        data.globalAtomIndex      = global_atom_index;
+        data.stepWork             = &stepWork;
+        std::fill(std::begin(data.dvdl), std::end(data.dvdl), 0.0_real);
+    }
 
     /* Check if we have to determine energy differences
      * at foreign lambda's.
@@ -730,3 +807,46 @@ void ListedForces::calculate(struct gmx_wallcycle*          wcycle,
         }
     }
 }
+
+int ListedForces::numBondedTasks() const
+{
+    return threading_->haveBondeds ? threading_->nthreads : 0;
+}
+
+void ListedForces::computeBondedTask(const int task)
+{
+    BondedTaskData& data = *bondedTaskData_;
+
+    calcBondedForcesTask(task, *idef_, threading_.get(), data.x, data.fr, data.pbc,
+                         as_rvec_array(data.forceWithShiftForces->shiftForces().data()), data.enerd,
+                         data.nrnb, data.lambda, data.dvdl, data.md, fcdata_.get(), *data.stepWork,
+                         data.globalAtomIndex);
+}
+
+void ListedForces::reduceBondedTasks(struct gmx_wallcycle* wcycle)
+{
+    if (!threading_->haveBondeds)
+    {
+        return;
+    }
+
+    BondedTaskData&          data     = *bondedTaskData_;
+    const gmx::StepWorkload& stepWork = *data.stepWork;
+
+    wallcycle_sub_start(wcycle, ewcsLISTED_BUF_OPS);
+    reduce_thread_output(data.forceWithShiftForces, data.enerd->term, &data.enerd->grpp, data.dvdl,
+                         threading_.get(), stepWork);
+
+    if (stepWork.computeDhdl)
+    {
+        for (int i = 0; i < efptNR; i++)
+        {
+            data.enerd->dvdl_nonlin[i] += data.dvdl[i];
+        }
+    }
+    wallcycle_sub_stop(wcycle, ewcsLISTED_BUF_OPS);
+
+    /* Copy the sum of violations for the distance restraints from fcd,
+     * this is only complete after all tasks have been computed */
+    data.enerd->term[F_DISRESVIOL] = fcdata_->disres->sumviol;
+}
@@ -124,6 +124,13 @@ BondedFunction bondedFunction(int ftype);
 class ListedForces
 {
 public:
+    //! Whether calculate() computes the bonded interactions or leaves them to bonded tasks
+    enum class BondedExecution
+    {
+        InCalculate, //!< Compute the bonded interactions in calculate()
+        AsTasks      //!< Compute them through computeBondedTask() and reduceBondedTasks()
+    };
+
     /*! \brief Constructor
      *
      * \param[in] numEnergyGroups  The number of energy groups, used for storage of pair energies
@@ -148,6 +155,13 @@ public:
      *
      * xWholeMolecules only needs to contain whole molecules when orientation
      * restraints need to be computed and can be empty otherwise.
+     *
+     * With \p bondedExecution AsTasks, the bonded interactions are not
+     * computed here. Instead the caller should call computeBondedTask()
+     * for all numBondedTasks() tasks, followed by reduceBondedTasks().
+     * This allows for interleaving the bonded work with other tasks.
+     * All pointer arguments then need to stay valid until
+     * reduceBondedTasks() has returned.
      */
     void calculate(struct gmx_wallcycle*          wcycle,
                    const matrix                   box,
@@ -165,7 +179,20 @@ public:
                    const real*                    lambda,
                    const t_mdatoms*               md,
                    int*                           global_atom_index,
-                   const gmx::StepWorkload&       stepWork);
+                   const gmx::StepWorkload&       stepWork,
+                   BondedExecution bondedExecution = BondedExecution::InCalculate);
+
+    //! Returns the number of bonded tasks, zero when there are no CPU bondeds
+    int numBondedTasks() const;
+
+    /*! \brief Computes bonded task \p task
+     *
+     * Different tasks can be computed concurrently by different threads.
+     */
+    void computeBondedTask(int task);
+
+    //! Reduces the output of all bonded tasks
+    void reduceBondedTasks(struct gmx_wallcycle* wcycle);
 
     //! Returns whether bonded interactions are assigned to the CPU
     bool haveCpuBondeds() const;
@@ -187,6 +214,8 @@ public:
     t_fcdata& fcdata() { return *fcdata_; }
 
 private:
+    struct BondedTaskData;
+
     //! The interaction definitions
     InteractionDefinitions const* idef_ = nullptr;
     //! Thread parallelization setup, unique_ptr to avoid declaring bonded_threading_t
@@ -197,6 +226,8 @@ private:
     std::vector<real> forceBufferLambda_;
     //! Shift force buffer for free-energy forces
     std::vector<gmx::RVec> shiftForceBufferLambda_;
+    //! The arguments for the bonded tasks, set by calculate()
+    std::unique_ptr<BondedTaskData> bondedTaskData_;
 
     GMX_DISALLOW_COPY_MOVE_AND_ASSIGN(ListedForces);
 };
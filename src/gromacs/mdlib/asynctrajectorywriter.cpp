@@ -0,0 +1,215 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ *
+ * \brief Implements gmx::AsyncTrajectoryWriter.
+ *
+ * \ingroup module_mdlib
+ */
+#include "gmxpre.h"
+
+#include "asynctrajectorywriter.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+
+#include "gromacs/fileio/gmxfio.h"
+#include "gromacs/fileio/trrio.h"
+#include "gromacs/fileio/xtcio.h"
+#include "gromacs/utility/fatalerror.h"
+#include "gromacs/utility/gmxassert.h"
+
+namespace gmx
+{
+
+class AsyncTrajectoryWriter::Impl
+{
+public:
+    Impl(t_fileio* fpXtc, real xtcPrecision, t_fileio* fpTrr, int numBuffers);
+    ~Impl();
+
+    //! Aborts with a fatal error if writing a frame failed.
+    void checkError();
+    //! Writes \p frame, returns an empty string or an error message.
+    std::string writeFrame(const TrajectoryOutputFrame& frame);
+    //! The body of the writer thread.
+    void run();
+
+    t_fileio* fpXtc_;
+    real      xtcPrecision_;
+    t_fileio* fpTrr_;
+
+    std::vector<TrajectoryOutputFrame>  frames_;
+    std::queue<TrajectoryOutputFrame*>  freeFrames_;
+    std::queue<TrajectoryOutputFrame*>  pendingFrames_;
+    //! Whether the writer thread is writing a frame.
+    bool                                writing_;
+    bool                                finished_;
+    std::string                         error_;
+    std::mutex                          mutex_;
+    std::condition_variable             cond_;
+    std::thread                         thread_;
+};
+
+AsyncTrajectoryWriter::Impl::Impl(t_fileio* fpXtc, real xtcPrecision, t_fileio* fpTrr, int numBuffers) :
+    fpXtc_(fpXtc),
+    xtcPrecision_(xtcPrecision),
+    fpTrr_(fpTrr),
+    frames_(numBuffers),
+    writing_(false),
+    finished_(false)
+{
+    GMX_RELEASE_ASSERT(numBuffers > 0, "Need at least one frame buffer");
+    for (auto& frame : frames_)
+    {
+        freeFrames_.push(&frame);
+    }
+    thread_ = std::thread([this]() { run(); });
+}
+
+AsyncTrajectoryWriter::Impl::~Impl()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        finished_ = true;
+    }
+    cond_.notify_all();
+    thread_.join();
+}
+
+void AsyncTrajectoryWriter::Impl::checkError()
+{
+    // Only called with the mutex held
+    if (!error_.empty())
+    {
+        gmx_fatal(FARGS, "%s", error_.c_str());
+    }
+}
+
+std::string AsyncTrajectoryWriter::Impl::writeFrame(const TrajectoryOutputFrame& frame)
+{
+    if (fpTrr_ != nullptr && (frame.hasX || frame.hasV || frame.hasF))
+    {
+        const int natoms = std::max({ frame.x.size(), frame.v.size(), frame.f.size() });
+        gmx_trr_write_frame(fpTrr_, frame.step, frame.time, frame.lambda, frame.box, natoms,
+                            frame.hasX ? as_rvec_array(frame.x.data()) : nullptr,
+                            frame.hasV ? as_rvec_array(frame.v.data()) : nullptr,
+                            frame.hasF ? as_rvec_array(frame.f.data()) : nullptr);
+        if (gmx_fio_flush(fpTrr_) != 0)
+        {
+            return "Cannot write trajectory; maybe you are out of disk space?";
+        }
+    }
+    if (fpXtc_ != nullptr && frame.hasXCompressed)
+    {
+        if (write_xtc(fpXtc_, frame.xCompressed.size(), frame.step, frame.time, frame.box,
+                      as_rvec_array(frame.xCompressed.data()), xtcPrecision_)
+            == 0)
+        {
+            return "XTC error. This indicates you are out of disk space, or a "
+                   "simulation with major instabilities resulting in coordinates "
+                   "that are NaN or too large to be represented in the XTC format.\n";
+        }
+    }
+    return std::string();
+}
+
+void AsyncTrajectoryWriter::Impl::run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        cond_.wait(lock, [this]() { return finished_ || !pendingFrames_.empty(); });
+        if (pendingFrames_.empty())
+        {
+            // Only finish when all frames have been written
+            return;
+        }
+        TrajectoryOutputFrame* frame = pendingFrames_.front();
+        pendingFrames_.pop();
+        writing_ = true;
+        lock.unlock();
+
+        std::string error = error_.empty() ? writeFrame(*frame) : std::string();
+
+        lock.lock();
+        writing_ = false;
+        if (error_.empty())
+        {
+            error_ = error;
+        }
+        freeFrames_.push(frame);
+        cond_.notify_all();
+    }
+}
+
+AsyncTrajectoryWriter::AsyncTrajectoryWriter(t_fileio* fpXtc, real xtcPrecision, t_fileio* fpTrr, int numBuffers) :
+    impl_(new Impl(fpXtc, xtcPrecision, fpTrr, numBuffers))
+{
+}
+
+AsyncTrajectoryWriter::~AsyncTrajectoryWriter() = default;
+
+TrajectoryOutputFrame* AsyncTrajectoryWriter::acquireFrame()
+{
+    std::unique_lock<std::mutex> lock(impl_->mutex_);
+    impl_->cond_.wait(lock, [this]() { return !impl_->freeFrames_.empty(); });
+    impl_->checkError();
+    TrajectoryOutputFrame* frame = impl_->freeFrames_.front();
+    impl_->freeFrames_.pop();
+    return frame;
+}
+
+void AsyncTrajectoryWriter::submitFrame(TrajectoryOutputFrame* frame)
+{
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex_);
+        impl_->pendingFrames_.push(frame);
+    }
+    impl_->cond_.notify_all();
+}
+
+void AsyncTrajectoryWriter::flush()
+{
+    std::unique_lock<std::mutex> lock(impl_->mutex_);
+    impl_->cond_.wait(lock, [this]() { return impl_->pendingFrames_.empty() && !impl_->writing_; });
+    impl_->checkError();
+}
+
+} // namespace gmx
@@ -0,0 +1,147 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \libinternal \file
+ *
+ * \brief Declares gmx::AsyncTrajectoryWriter, which writes XTC and TRR
+ * frames in a separate thread.
+ *
+ * \inlibraryapi
+ * \ingroup module_mdlib
+ */
+#ifndef GMX_MDLIB_ASYNCTRAJECTORYWRITER_H
+#define GMX_MDLIB_ASYNCTRAJECTORYWRITER_H
+
+#include <cstdint>
+
+#include <vector>
+
+#include "gromacs/math/vectypes.h"
+#include "gromacs/utility/classhelpers.h"
+#include "gromacs/utility/real.h"
+
+struct t_fileio;
+
+namespace gmx
+{
+
+/*! \libinternal \brief
+ * Buffer for one trajectory frame handed to AsyncTrajectoryWriter.
+ *
+ * Only the vectors for which the corresponding \c has flag is set are
+ * written. \c xCompressed holds the positions of the atoms in the
+ * compressed output group.
+ */
+struct TrajectoryOutputFrame
+{
+    //! The MD step of the frame.
+    int64_t step = 0;
+    //! The time of the frame.
+    double time = 0;
+    //! The FEP lambda value.
+    real lambda = 0;
+    //! The simulation box.
+    matrix box = { { 0 } };
+    //! Whether to write \c x to the TRR file.
+    bool hasX = false;
+    //! Whether to write \c v to the TRR file.
+    bool hasV = false;
+    //! Whether to write \c f to the TRR file.
+    bool hasF = false;
+    //! Whether to write \c xCompressed to the XTC file.
+    bool hasXCompressed = false;
+    //! Positions of all atoms.
+    std::vector<RVec> x;
+    //! Velocities of all atoms.
+    std::vector<RVec> v;
+    //! Forces on all atoms.
+    std::vector<RVec> f;
+    //! Positions of the atoms in the compressed output group.
+    std::vector<RVec> xCompressed;
+};
+
+/*! \libinternal \brief
+ * Writes XTC and TRR frames in a separate thread.
+ *
+ * The caller fills a buffer obtained from acquireFrame() and hands it
+ * back with submitFrame(). The XTC compression and the file writes are
+ * then done in the writer thread, while the caller continues. There is
+ * a fixed number of buffers, so at most that many frames can be pending;
+ * acquireFrame() blocks until a buffer is free.
+ *
+ * Errors in the writer thread are reported (as fatal errors) by the next
+ * call to acquireFrame() or flush().
+ *
+ * The files are not owned by this class, but they must not be accessed
+ * by other code between submitting a frame and the next call to
+ * flush(). Call flush() before writing a checkpoint, so the file
+ * positions stored in the checkpoint include all frames.
+ *
+ * \inlibraryapi
+ * \ingroup module_mdlib
+ */
+class AsyncTrajectoryWriter
+{
+public:
+    /*! \brief Starts the writer thread
+     *
+     * \param[in] fpXtc        XTC file to write compressed positions to, can be nullptr.
+     * \param[in] xtcPrecision Precision for the XTC compression.
+     * \param[in] fpTrr        TRR file to write full-precision frames to, can be nullptr.
+     * \param[in] numBuffers   The number of frame buffers, at least 1.
+     */
+    AsyncTrajectoryWriter(t_fileio* fpXtc, real xtcPrecision, t_fileio* fpTrr, int numBuffers = 2);
+    //! Writes all pending frames and stops the writer thread.
+    ~AsyncTrajectoryWriter();
+
+    /*! \brief Returns an unused frame buffer
+     *
+     * Blocks until a buffer is available. The contents are those of
+     * an earlier frame, so all fields should be set.
+     */
+    TrajectoryOutputFrame* acquireFrame();
+    //! Queues \p frame, obtained from acquireFrame(), for writing.
+    void submitFrame(TrajectoryOutputFrame* frame);
+    //! Returns when all submitted frames have been written.
+    void flush();
+
+private:
+    class Impl;
+
+    PrivateImplPointer<Impl> impl_;
+};
+
+} // namespace gmx
+
+#endif
@@ -117,6 +117,7 @@ void do_force_lowlevel(t_forcerec*                          fr,
                        const real*                          lambda,
                        const rvec*                          mu_tot,
                        const gmx::StepWorkload&             stepWork,
+                       const bool                           computeListedForces,
                        const DDBalanceRegionHandler&        ddBalanceRegionHandler)
 {
     // TODO: Replace all uses of x by const coordinates
@@ -139,6 +140,7 @@ void do_force_lowlevel(t_forcerec*                          fr,
         }
     }
 
+    if (computeListedForces)
     {
         t_pbc pbc;
 
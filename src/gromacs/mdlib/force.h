@@ -115,6 +115,8 @@ void do_force(FILE*                               log,
  *
  * xWholeMolecules only needs to contain whole molecules when orientation
  * restraints need to be computed and can be empty otherwise.
+ * The listed forces are skipped when computeListedForces is false,
+ * which is used when they have been computed together with the non-bondeds.
  */
 void do_force_lowlevel(t_forcerec*                               fr,
                        const t_inputrec*                         ir,
@@ -132,6 +134,7 @@ void do_force_lowlevel(t_forcerec*                               fr,
                        const real*                               lambda,
                        const rvec*                               mu_tot,
                        const gmx::StepWorkload&                  stepWork,
+                       bool                                      computeListedForces,
                        const DDBalanceRegionHandler&             ddBalanceRegionHandler);
 /* Call all the force routines */
 
@@ -1016,6 +1016,16 @@ void init_forcerec(FILE*                            fp,
                         "Disabling nonbonded calculations.");
     }
 
+    fr->useCpuForceTasks = (getenv("GMX_CPU_FORCE_TASKS") != nullptr);
+    if (fr->useCpuForceTasks)
+    {
+        GMX_LOG(mdlog.info)
+                .appendText(
+                        "Found environment variable GMX_CPU_FORCE_TASKS.\n"
+                        "Computing the CPU non-bonded and bonded interactions as interleaved "
+                        "tasks.");
+    }
+
     if ((getenv("GMX_DISABLE_SIMD_KERNELS") != nullptr) || (getenv("GMX_NOOPTIMIZEDKERNELS") != nullptr))
     {
         fr->use_simd_kernels = FALSE;
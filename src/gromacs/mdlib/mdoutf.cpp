@@ -47,6 +47,7 @@
 #include "gromacs/fileio/xtcio.h"
 #include "gromacs/fileio/xvgr.h"
 #include "gromacs/math/vec.h"
+#include "gromacs/mdlib/asynctrajectorywriter.h"
 #include "gromacs/mdlib/trajectory_writing.h"
 #include "gromacs/mdrunutility/handlerestart.h"
 #include "gromacs/mdrunutility/multisim.h"
@@ -86,6 +87,7 @@ struct gmx_mdoutf
     const gmx::MdModulesNotifier* mdModulesNotifier;
     bool                          simulationsShareState;
     MPI_Comm                      mpiCommMasters;
+    gmx::AsyncTrajectoryWriter*   asyncWriter; /* only on the master rank, can be nullptr */
 };
 
 
@@ -118,6 +120,7 @@ gmx_mdoutf_t init_mdoutf(FILE*                         fplog,
     of->tng          = nullptr;
     of->tng_low_prec = nullptr;
     of->fp_dhdl      = nullptr;
+    of->asyncWriter  = nullptr;
 
     of->eIntegrator             = ir->eI;
     of->bExpanded               = ir->bExpanded;
@@ -230,6 +233,16 @@ gmx_mdoutf_t init_mdoutf(FILE*                         fplog,
         {
             snew(of->f_global, top_global->natoms);
         }
+
+        if ((of->fp_xtc || of->fp_trn) && getenv("GMX_ASYNC_TRAJECTORY_OUTPUT") != nullptr)
+        {
+            of->asyncWriter = new gmx::AsyncTrajectoryWriter(
+                    of->fp_xtc, of->x_compression_precision, of->fp_trn);
+            if (fplog)
+            {
+                fprintf(fplog, "\nWriting XTC and TRR trajectory frames in a separate thread\n");
+            }
+        }
     }
 
     if (bCiteTng)
@@ -255,6 +268,34 @@ gmx_wallcycle_t mdoutf_get_wcycle(gmx_mdoutf_t of)
     return of->wcycle;
 }
 
+/*! \brief Returns a frame buffer of the asynchronous writer with the
+ * frame data set, but no vectors */
+static gmx::TrajectoryOutputFrame* acquireAsyncFrame(gmx_mdoutf_t of, int64_t step, double t, const t_state* state)
+{
+    gmx::TrajectoryOutputFrame* frame = of->asyncWriter->acquireFrame();
+
+    frame->step   = step;
+    frame->time   = t;
+    frame->lambda = state->lambda[efptFEP];
+    copy_mat(state->box, frame->box);
+    frame->hasX           = false;
+    frame->hasV           = false;
+    frame->hasF           = false;
+    frame->hasXCompressed = false;
+
+    return frame;
+}
+
+//! Copies \p natoms vectors from \p src to \p dest
+static void copyToAsyncFrame(const rvec* src, int natoms, std::vector<gmx::RVec>* dest)
+{
+    dest->resize(natoms);
+    for (int i = 0; i < natoms; i++)
+    {
+        copy_rvec(src[i], (*dest)[i]);
+    }
+}
+
 void mdoutf_write_to_trajectory_files(FILE*                    fplog,
                                       const t_commrec*         cr,
                                       gmx_mdoutf_t             of,
@@ -305,10 +346,19 @@ void mdoutf_write_to_trajectory_files(FILE*                    fplog,
 
     if (MASTER(cr))
     {
+        /* With asynchronous output, the frame to hand to the writer thread */
+        gmx::TrajectoryOutputFrame* asyncFrame = nullptr;
+
         if (mdof_flags & MDOF_CPT)
         {
             fflush_tng(of->tng);
             fflush_tng(of->tng_low_prec);
+            if (of->asyncWriter)
+            {
+                /* The checkpoint stores the output file positions for
+                 * appending, so all frames need to be written first. */
+                of->asyncWriter->flush();
+            }
             /* Write the checkpoint file.
              * When simulations share the state, an MPI barrier is applied before
              * renaming old and new checkpoint files to minimize the risk of
@@ -329,7 +379,17 @@ void mdoutf_write_to_trajectory_files(FILE*                    fplog,
             const rvec* v = (mdof_flags & MDOF_V) ? state_global->v.rvec_array() : nullptr;
             const rvec* f = (mdof_flags & MDOF_F) ? f_global : nullptr;
 
-            if (of->fp_trn)
+            if (of->fp_trn && of->asyncWriter)
+            {
+                asyncFrame       = acquireAsyncFrame(of, step, t, state_local);
+                asyncFrame->hasX = (x != nullptr);
+                asyncFrame->hasV = (v != nullptr);
+                asyncFrame->hasF = (f != nullptr);
+                copyToAsyncFrame(x, x ? natoms : 0, &asyncFrame->x);
+                copyToAsyncFrame(v, v ? natoms : 0, &asyncFrame->v);
+                copyToAsyncFrame(f, f ? natoms : 0, &asyncFrame->f);
+            }
+            else if (of->fp_trn)
             {
                 gmx_trr_write_frame(of->fp_trn, step, t, state_local->lambda[efptFEP],
                                     state_local->box, natoms, x, v, f);
@@ -354,7 +414,31 @@ void mdoutf_write_to_trajectory_files(FILE*                    fplog,
                                state_local->box, natoms, x, v, f);
             }
         }
-        if (mdof_flags & MDOF_X_COMPRESSED)
+        if ((mdof_flags & MDOF_X_COMPRESSED) && of->fp_xtc && of->asyncWriter)
+        {
+            if (asyncFrame == nullptr)
+            {
+                asyncFrame = acquireAsyncFrame(of, step, t, state_local);
+            }
+            asyncFrame->hasXCompressed = true;
+            auto x                     = makeArrayRef(state_global->x);
+            if (of->natoms_x_compressed == of->natoms_global)
+            {
+                copyToAsyncFrame(as_rvec_array(x.data()), of->natoms_global, &asyncFrame->xCompressed);
+            }
+            else
+            {
+                asyncFrame->xCompressed.clear();
+                for (int i = 0; (i < of->natoms_global); i++)
+                {
+                    if (getGroupType(*of->groups, SimulationAtomGroupType::CompressedPositionOutput, i) == 0)
+                    {
+                        asyncFrame->xCompressed.push_back(x[i]);
+                    }
+                }
+            }
+        }
+        else if (mdof_flags & MDOF_X_COMPRESSED)
         {
             rvec* xxtc = nullptr;
 
@@ -433,6 +517,10 @@ void mdoutf_write_to_trajectory_files(FILE*                    fplog,
                                nullptr, nullptr);
             }
         }
+        if (asyncFrame)
+        {
+            of->asyncWriter->submitFrame(asyncFrame);
+        }
     }
 }
 
@@ -449,6 +537,12 @@ void mdoutf_tng_close(gmx_mdoutf_t of)
 
 void done_mdoutf(gmx_mdoutf_t of)
 {
+    if (of->asyncWriter)
+    {
+        /* Write the pending frames before closing the files */
+        of->asyncWriter->flush();
+        delete of->asyncWriter;
+    }
     if (of->fp_ene != nullptr)
     {
         done_ener_file(of->fp_ene);
@@ -433,6 +433,87 @@ static void do_nb_verlet(t_forcerec*                fr,
     nbv->dispatchNonbondedKernel(ilocality, *ic, stepWork, clearF, *fr, enerd, nrnb);
 }
 
+/*! \brief Computes the local non-bonded and the listed interactions on the CPU
+ *
+ * The non-bonded pair lists and the thread blocks of the bonded interactions
+ * are tasks that are distributed dynamically over the threads of a single
+ * OpenMP parallel region. Threads that finish their non-bonded work early
+ * then continue with bonded work, instead of waiting at the end of the
+ * non-bonded region, and only one barrier is needed.
+ */
+static void computeNonbondedAndListedTasks(t_forcerec*                          fr,
+                                           const interaction_const_t*           ic,
+                                           const t_inputrec*                    inputrec,
+                                           const t_commrec*                     cr,
+                                           const gmx_multisim_t*                ms,
+                                           gmx::ArrayRefWithPadding<const RVec> x,
+                                           ArrayRef<const RVec>                 xWholeMolecules,
+                                           history_t*                           hist,
+                                           gmx::ForceOutputs*                   forceOutputs,
+                                           gmx_enerdata_t*                      enerd,
+                                           const matrix                         box,
+                                           const real*                          lambda,
+                                           const t_mdatoms*                     mdatoms,
+                                           const StepWorkload&                  stepWork,
+                                           const int64_t                        step,
+                                           t_nrnb*                              nrnb,
+                                           gmx_wallcycle_t                      wcycle)
+{
+    nonbonded_verlet_t* nbv          = fr->nbv.get();
+    ListedForces&       listedForces = *fr->listedForces;
+
+    if (nbv->isDynamicPruningStepCpu(step))
+    {
+        wallcycle_sub_start(wcycle, ewcsNONBONDED_PRUNING);
+        nbv->dispatchPruneKernelCpu(InteractionLocality::Local, fr->shift_vec);
+        wallcycle_sub_stop(wcycle, ewcsNONBONDED_PRUNING);
+    }
+
+    /* Since all atoms are in the rectangular or triclinic unit-cell,
+     * only single box vector shifts (2 in x) are required.
+     */
+    t_pbc pbc;
+    if (fr->bMolPBC)
+    {
+        set_pbc_dd(&pbc, fr->pbcType, DOMAINDECOMP(cr) ? cr->dd->numCells : nullptr, TRUE, box);
+    }
+
+    /* This computes the restraints and sets up the bonded tasks */
+    listedForces.calculate(wcycle, box, inputrec->fepvals, cr, ms,
+                           as_rvec_array(x.paddedArrayRef().data()), xWholeMolecules, hist,
+                           forceOutputs, fr, &pbc, enerd, nrnb, lambda, mdatoms,
+                           DOMAINDECOMP(cr) ? cr->dd->globalAtomIndices.data() : nullptr, stepWork,
+                           ListedForces::BondedExecution::AsTasks);
+
+    const int numNonbondedTasks = nbv->numCpuKernelTasks(InteractionLocality::Local);
+    const int numTasks          = numNonbondedTasks + listedForces.numBondedTasks();
+
+    /* The non-bonded tasks come first, as these are the largest */
+    const int gmx_unused numThreads = gmx_omp_nthreads_get(emntNonbonded);
+    wallcycle_sub_start(wcycle, ewcsNONBONDED_BONDED);
+#pragma omp parallel for schedule(dynamic) num_threads(numThreads)
+    for (int task = 0; task < numTasks; task++)
+    {
+        try
+        {
+            if (task < numNonbondedTasks)
+            {
+                nbv->computeCpuKernelTask(InteractionLocality::Local, *ic, stepWork, enbvClearFYes,
+                                          *fr, task);
+            }
+            else
+            {
+                listedForces.computeBondedTask(task - numNonbondedTasks);
+            }
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
+    wallcycle_sub_stop(wcycle, ewcsNONBONDED_BONDED);
+
+    nbv->reduceCpuKernelTasks(InteractionLocality::Local, *ic, stepWork, *fr, enerd, nrnb);
+    listedForces.reduceBondedTasks(wcycle);
+}
+
 static inline void clearRVecs(ArrayRef<RVec> v, const bool useOpenmpThreading)
 {
     int nth = gmx_omp_nthreads_get_simple_rvec_task(emntDefault, v.ssize());
@@ -1333,6 +1414,24 @@ void do_force(FILE*                               fplog,
         launchPmeGpuFftAndGather(fr->pmedata, wcycle, stepWork);
     }
 
+    const bool useOrEmulateGpuNb = simulationWork.useGpuNonbonded || fr->nbv->emulateGpu();
+
+    /* With CPU force tasks, the local non-bonded and the bonded interactions
+     * are computed together, so do_force_lowlevel() should skip the listed forces.
+     */
+    const bool useCpuForceTasks = fr->useCpuForceTasks && !useOrEmulateGpuNb
+                                  && stepWork.computeNonbondedForces && stepWork.computeListedForces
+                                  && fr->listedForces->haveCpuBondeds();
+
+    /* With plain CPU non-bonded work, the halo coordinate communication can
+     * overlap with the local non-bonded kernel. All other CPU work that might
+     * access non-local coordinates is done after the communication has finished.
+     */
+    const bool overlapHaloCoordinates =
+            havePPDomainDecomposition(cr) && !stepWork.doNeighborSearch
+            && dd_useOverlappedHaloExchange(*cr->dd) && !ddUsesGpuDirectCommunication
+            && !stepWork.useGpuXBufferOps && !useOrEmulateGpuNb && !useCpuForceTasks;
+
     /* Communicate coordinates and sum dipole if necessary +
        do non-local pair search */
     if (havePPDomainDecomposition(cr))
@@ -1377,7 +1476,14 @@ void do_force(FILE*                               fplog,
                 // a waitCoordinatesReadyOnHost() should be issued if it will be.
                 GMX_ASSERT(!simulationWork.useGpuUpdate,
                            "GPU update is not supported with CPU halo exchange");
-                dd_move_x(cr->dd, box, x.unpaddedArrayRef(), wcycle);
+                if (overlapHaloCoordinates)
+                {
+                    dd_move_x_start(cr->dd, box, x.unpaddedArrayRef(), wcycle);
+                }
+                else
+                {
+                    dd_move_x(cr->dd, box, x.unpaddedArrayRef(), wcycle);
+                }
             }
 
             if (stepWork.useGpuXBufferOps)
@@ -1390,7 +1496,7 @@ void do_force(FILE*                               fplog,
                                            stateGpu->getCoordinatesReadyOnDeviceEvent(
                                                    AtomLocality::NonLocal, simulationWork, stepWork));
             }
-            else
+            else if (!overlapHaloCoordinates)
             {
                 nbv->convertCoordinates(AtomLocality::NonLocal, false, x.unpaddedArrayRef());
             }
@@ -1510,13 +1616,25 @@ void do_force(FILE*                               fplog,
      * decomposition load balancing.
      */
 
-    const bool useOrEmulateGpuNb = simulationWork.useGpuNonbonded || fr->nbv->emulateGpu();
-
-    if (!useOrEmulateGpuNb)
+    if (useCpuForceTasks)
+    {
+        computeNonbondedAndListedTasks(fr, ic, inputrec, cr, ms, x, xWholeMolecules, hist, &forceOut,
+                                       enerd, box, lambda.data(), mdatoms, stepWork, step, nrnb, wcycle);
+    }
+    else if (!useOrEmulateGpuNb)
     {
         do_nb_verlet(fr, ic, enerd, stepWork, InteractionLocality::Local, enbvClearFYes, step, nrnb, wcycle);
     }
 
+    if (overlapHaloCoordinates)
+    {
+        /* The halo coordinates were communicated during the local non-bonded work */
+        wallcycle_stop(wcycle, ewcFORCE);
+        dd_move_x_finish(cr->dd, x.unpaddedArrayRef(), wcycle);
+        nbv->convertCoordinates(AtomLocality::NonLocal, false, x.unpaddedArrayRef());
+        wallcycle_start_nocount(wcycle, ewcFORCE);
+    }
+
     if (fr->efep != efepNO)
     {
         /* Calculate the local and non-local free energy interactions here.
@@ -1574,7 +1692,7 @@ void do_force(FILE*                               fplog,
     /* Compute the bonded and non-bonded energies and optionally forces */
     do_force_lowlevel(fr, inputrec, cr, ms, nrnb, wcycle, mdatoms, x, xWholeMolecules, hist,
                       &forceOut, enerd, box, lambda.data(), as_rvec_array(dipoleData.muStateAB),
-                      stepWork, ddBalanceRegionHandler);
+                      stepWork, !useCpuForceTasks, ddBalanceRegionHandler);
 
     wallcycle_stop(wcycle, ewcFORCE);
 
@@ -0,0 +1,161 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for gmx::AsyncTrajectoryWriter.
+ *
+ * \ingroup module_mdlib
+ */
+#include "gmxpre.h"
+
+#include "gromacs/mdlib/asynctrajectorywriter.h"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/fileio/trrio.h"
+#include "gromacs/fileio/xtcio.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/utility/smalloc.h"
+
+#include "testutils/testasserts.h"
+#include "testutils/testfilemanager.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Returns the position of \p atom in \p frame, with the frame number in x.
+RVec positionInFrame(int frame, int atom)
+{
+    return { 0.1F * frame, 0.01F * atom, 1.0F };
+}
+
+TEST(AsyncTrajectoryWriterTest, WritesAllFramesInOrder)
+{
+    const int   numAtoms  = 10;
+    const int   numFrames = 7;
+    const real  precision = 1000;
+    const float tolerance = 0.5 / precision;
+
+    TestFileManager   fileManager;
+    const std::string xtcName = fileManager.getTemporaryFilePath("traj.xtc");
+    const std::string trrName = fileManager.getTemporaryFilePath("traj.trr");
+
+    t_fileio* fpXtc = open_xtc(xtcName.c_str(), "w");
+    t_fileio* fpTrr = gmx_trr_open(trrName.c_str(), "w");
+    {
+        AsyncTrajectoryWriter writer(fpXtc, precision, fpTrr);
+        for (int frameIndex = 0; frameIndex < numFrames; frameIndex++)
+        {
+            TrajectoryOutputFrame* frame = writer.acquireFrame();
+            frame->step                  = 10 * frameIndex;
+            frame->time                  = 0.5 * frameIndex;
+            frame->lambda                = 0;
+            clear_mat(frame->box);
+            frame->box[XX][XX] = frame->box[YY][YY] = frame->box[ZZ][ZZ] = 3;
+            // Only every other frame has full-precision output
+            frame->hasX           = (frameIndex % 2 == 0);
+            frame->hasV           = false;
+            frame->hasF           = false;
+            frame->hasXCompressed = true;
+            frame->x.resize(numAtoms);
+            for (int i = 0; i < numAtoms; i++)
+            {
+                frame->x[i] = positionInFrame(frameIndex, i);
+            }
+            // Only the first half of the atoms is compressed
+            frame->xCompressed.assign(frame->x.begin(), frame->x.begin() + numAtoms / 2);
+            writer.submitFrame(frame);
+            if (frameIndex == numFrames / 2)
+            {
+                writer.flush();
+            }
+        }
+    }
+    close_xtc(fpXtc);
+    gmx_trr_close(fpTrr);
+
+    fpXtc = open_xtc(xtcName.c_str(), "r");
+    int      natoms;
+    int64_t  step;
+    real     time, prec;
+    matrix   box;
+    rvec*    x;
+    gmx_bool bOK;
+    ASSERT_TRUE(read_first_xtc(fpXtc, &natoms, &step, &time, box, &x, &prec, &bOK));
+    ASSERT_EQ(numAtoms / 2, natoms);
+    for (int frameIndex = 0; frameIndex < numFrames; frameIndex++)
+    {
+        if (frameIndex > 0)
+        {
+            ASSERT_TRUE(read_next_xtc(fpXtc, natoms, &step, &time, box, x, &prec, &bOK));
+        }
+        EXPECT_EQ(10 * frameIndex, step);
+        for (int i = 0; i < natoms; i++)
+        {
+            EXPECT_NEAR(positionInFrame(frameIndex, i)[XX], x[i][XX], tolerance);
+            EXPECT_NEAR(positionInFrame(frameIndex, i)[YY], x[i][YY], tolerance);
+        }
+    }
+    EXPECT_FALSE(read_next_xtc(fpXtc, natoms, &step, &time, box, x, &prec, &bOK));
+    sfree(x);
+    close_xtc(fpXtc);
+
+    fpTrr = gmx_trr_open(trrName.c_str(), "r");
+    std::vector<RVec> trrX(numAtoms);
+    real              lambda;
+    for (int frameIndex = 0; frameIndex < numFrames; frameIndex += 2)
+    {
+        ASSERT_TRUE(gmx_trr_read_frame(fpTrr, &step, &time, &lambda, box, &natoms,
+                                       as_rvec_array(trrX.data()), nullptr, nullptr));
+        EXPECT_EQ(10 * frameIndex, step);
+        ASSERT_EQ(numAtoms, natoms);
+        for (int i = 0; i < natoms; i++)
+        {
+            EXPECT_EQ(positionInFrame(frameIndex, i)[XX], trrX[i][XX]);
+        }
+    }
+    gmx_trr_close(fpTrr);
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -156,7 +156,7 @@ public:
 
     ImdOptions& imdOptions = mdrunOptions.imdOptions;
 
-    t_pargs pa[48] = {
+    t_pargs pa[49] = {
 
         { "-dd", FALSE, etRVEC, { &realddxyz }, "Domain decomposition grid, 0 is optimize" },
         { "-ddorder", FALSE, etENUM, { ddrank_opt_choices }, "DD rank order" },
@@ -273,6 +273,11 @@ public:
           etBOOL,
           { &mdrunOptions.tunePme },
           "Optimize PME load between PP/PME ranks or GPU/CPU" },
+        { "-tunenstlist",
+          FALSE,
+          etBOOL,
+          { &mdrunOptions.tuneNstlist },
+          "Optimize nstlist and the pair-list buffer at runtime (CPU only)" },
         { "-pme", FALSE, etENUM, { pme_opt_choices }, "Perform PME calculations on" },
         { "-pmefft", FALSE, etENUM, { pme_fft_opt_choices }, "Perform PME FFT calculations on" },
         { "-bonded", FALSE, etENUM, { bonded_opt_choices }, "Perform bonded calculations on" },
@@ -125,6 +125,7 @@
 #include "gromacs/modularsimulator/energyelement.h"
 #include "gromacs/nbnxm/gpu_data_mgmt.h"
 #include "gromacs/nbnxm/nbnxm.h"
+#include "gromacs/nbnxm/pairlist_tuning.h"
 #include "gromacs/pbcutil/pbc.h"
 #include "gromacs/pulling/output.h"
 #include "gromacs/pulling/pull.h"
@@ -475,6 +476,28 @@ void gmx::LegacySimulator::do_md()
                          fr->nbv->useGpu());
     }
 
+    /* Tuning nstlist changes the pair-list buffer, so it can not run together
+     * with PME tuning. When both are requested, nstlist is tuned after PME
+     * tuning has finished, starting from the cut-off and grid chosen there.
+     */
+    std::unique_ptr<NstlistTuning> nstlistTuning;
+    const bool                     bNstlistTune =
+            (mdrunOptions.tuneNstlist && !mdrunOptions.reproducible && EI_DYNAMICS(ir->eI));
+    if (mdrunOptions.tuneNstlist && mdrunOptions.reproducible)
+    {
+        GMX_LOG(mdlog.info)
+                .asParagraph()
+                .appendText(
+                        "NOTE: Ignoring -tunenstlist, since the tuning depends on timings "
+                        "and -reprod is set.");
+    }
+    else if (bNstlistTune && bPMETune)
+    {
+        GMX_LOG(mdlog.info)
+                .asParagraph()
+                .appendText("NOTE: nstlist will be tuned after PME tuning has finished.");
+    }
+
     if (!ir->bContinuation)
     {
         if (state->flags & (1U << estV))
@@ -775,6 +798,18 @@ void gmx::LegacySimulator::do_md()
                            &bPMETunePrinting, simulationWork.useGpuPmePpCommunication);
         }
 
+        if (bNstlistTune && !nstlistTuning && bNStList && !pme_loadbal_is_active(pme_loadbal))
+        {
+            nstlistTuning = std::make_unique<NstlistTuning>(mdlog, cr, *ir, *top_global,
+                                                            state->box, *fr->ic, *fr->nbv);
+        }
+
+        if (nstlistTuning && nstlistTuning->isActive() && bNStList)
+        {
+            nstlistTuning->tune((mdrunOptions.verbose && MASTER(cr)) ? stderr : nullptr, mdlog, cr,
+                                ir, fr, state->box, state->x, step, step_rel);
+        }
+
         wallcycle_start(wcycle, ewcSTEP);
 
         bLastStep = (step_rel == ir->nsteps);
@@ -1647,6 +1682,18 @@ void gmx::LegacySimulator::do_md()
             dd_cycles_add(cr->dd, cycles, ddCyclStep);
         }
 
+        if (nstlistTuning && nstlistTuning->isActive())
+        {
+            /* Energy, virial and output steps have costs that do not depend
+             * on the pair-list setup, these are not used for the tuning.
+             */
+            const bool isOutputStep =
+                    (do_per_step(step, ir->nstxout) || do_per_step(step, ir->nstvout)
+                     || do_per_step(step, ir->nstfout) || do_per_step(step, ir->nstxout_compressed)
+                     || checkpointHandler->isCheckpointingStep());
+            nstlistTuning->recordStep(wcycle, cycles, bNS, !bCalcEner && !bCalcVir && !isOutputStep);
+        }
+
         /* increase the MD step number */
         step++;
         step_rel++;
@@ -244,6 +244,9 @@ struct t_forcerec
     int      cutoff_scheme = 0;     /* group- or Verlet-style cutoff */
     gmx_bool bNonbonded    = FALSE; /* true if nonbonded calculations are *not* turned off */
 
+    //! Whether to compute the CPU non-bonded and bonded interactions as interleaved tasks
+    bool useCpuForceTasks = false;
+
     /* The Nbnxm Verlet non-bonded machinery */
     std::unique_ptr<nonbonded_verlet_t> nbv;
 
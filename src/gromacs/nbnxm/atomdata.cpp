@@ -84,10 +84,18 @@ void nbnxn_atomdata_t::resizeForceBuffers()
     const int paddedSize =
             (numAtoms() + NBNXN_BUFFERFLAG_SIZE - 1) / NBNXN_BUFFERFLAG_SIZE * NBNXN_BUFFERFLAG_SIZE;
 
-    /* Should we let each thread allocate it's own data instead? */
-    for (nbnxn_atomdata_output_t& outBuffer : out)
+    /* Each thread resizes the buffer it writes to in the kernel, so the
+     * pages are first touched, and thus placed, on the NUMA node of that thread.
+     */
+    const int numOutputBuffers = gmx::ssize(out);
+#pragma omp parallel for num_threads(numOutputBuffers) schedule(static)
+    for (int th = 0; th < numOutputBuffers; th++)
     {
-        outBuffer.f.resize(paddedSize * fstride);
+        try
+        {
+            out[th].f.resize(paddedSize * fstride);
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
     }
 }
 
@@ -1384,9 +1392,23 @@ static void nbnxn_atomdata_add_nbat_f_to_f_stdreduce(nbnxn_atomdata_t* nbat, int
 
             gmx::ArrayRef<const gmx_bitmask_t> flags = nbat->buffer_flags;
 
-            /* Calculate the cell-block range for our thread */
-            int b0 = (flags.size() * th) / nth;
-            int b1 = (flags.size() * (th + 1)) / nth;
+            /* Calculate the cell-block range for our thread, preferably
+             * the blocks of our own i-clusters, so we mainly read our own
+             * buffer and only the overlap with the j-clusters of others.
+             */
+            gmx::ArrayRef<const int> blockRanges = nbat->reductionBlockRanges;
+            int                      b0;
+            int                      b1;
+            if (blockRanges.ssize() == nth + 1)
+            {
+                b0 = blockRanges[th];
+                b1 = blockRanges[th + 1];
+            }
+            else
+            {
+                b0 = (flags.size() * th) / nth;
+                b1 = (flags.size() * (th + 1)) / nth;
+            }
 
             for (int b = b0; b < b1; b++)
             {
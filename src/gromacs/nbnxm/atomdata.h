@@ -290,6 +290,12 @@ public:
     gmx_bool bUseBufferFlags;
     //! Flags for buffer zeroing+reduc.
     std::vector<gmx_bitmask_t> buffer_flags;
+    /*! \brief Flag block range boundaries per thread for the reduction, size #threads+1
+     *
+     * Each thread owns the blocks of its own i-clusters. When empty,
+     * the blocks are divided equally over the threads.
+     */
+    std::vector<int> reductionBlockRanges;
     //! Use tree for force reduction
     gmx_bool bUseTreeReduce;
     //! Synchronization step for tree reduce
@@ -46,6 +46,9 @@
 #include "bench_setup.h"
 
 #include <optional>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "gromacs/gmxlib/nrnb.h"
 #include "gromacs/mdlib/dispersioncorrection.h"
@@ -70,7 +73,9 @@
 #include "gromacs/timing/cyclecounter.h"
 #include "gromacs/utility/enumerationhelpers.h"
 #include "gromacs/utility/fatalerror.h"
+#include "gromacs/utility/futil.h"
 #include "gromacs/utility/logger.h"
+#include "gromacs/utility/stringutil.h"
 
 #include "bench_system.h"
 
@@ -166,6 +171,42 @@ static interaction_const_t setupInteractionConst(const KernelBenchOptions& optio
     return ic;
 }
 
+//! Returns the atom info for the system, which depends on the half-LJ option
+static gmx::ArrayRef<const int> atomInfoForBench(const KernelBenchOptions&   options,
+                                                 const gmx::BenchmarkSystem& system)
+{
+    if (options.useHalfLJOptimization)
+    {
+        return system.atomInfoOxygenVdw;
+    }
+    else
+    {
+        return system.atomInfoAllVdw;
+    }
+}
+
+//! Puts the atoms on the grid, constructs the pairlist and sets the atom properties, as in MD
+static void putOnGridAndConstructPairlist(nonbonded_verlet_t*         nbv,
+                                          const KernelBenchOptions&   options,
+                                          const gmx::BenchmarkSystem& system,
+                                          t_nrnb*                     nrnb)
+{
+    const rvec lowerCorner = { 0, 0, 0 };
+    const rvec upperCorner = { system.box[XX][XX], system.box[YY][YY], system.box[ZZ][ZZ] };
+
+    gmx::ArrayRef<const int> atomInfo = atomInfoForBench(options, system);
+
+    const real atomDensity = system.coordinates.size() / det(system.box);
+
+    nbnxn_put_on_grid(nbv, system.box, 0, lowerCorner, upperCorner, nullptr,
+                      { 0, int(system.coordinates.size()) }, atomDensity, atomInfo,
+                      system.coordinates, 0, nullptr);
+
+    nbv->constructPairlist(gmx::InteractionLocality::Local, system.excls, 0, nrnb);
+
+    nbv->setAtomProperties(system.atomTypes, system.charges, atomInfo);
+}
+
 //! Sets up and returns a Nbnxm object for the given benchmark options and system
 static std::unique_ptr<nonbonded_verlet_t> setupNbnxmForBenchInstance(const KernelBenchOptions& options,
                                                                       const gmx::BenchmarkSystem& system)
@@ -206,28 +247,8 @@ static std::unique_ptr<nonbonded_verlet_t> setupNbnxmForBenchInstance(const Kern
     t_nrnb nrnb;
 
     GMX_RELEASE_ASSERT(!TRICLINIC(system.box), "Only rectangular unit-cells are supported here");
-    const rvec lowerCorner = { 0, 0, 0 };
-    const rvec upperCorner = { system.box[XX][XX], system.box[YY][YY], system.box[ZZ][ZZ] };
-
-    gmx::ArrayRef<const int> atomInfo;
-    if (options.useHalfLJOptimization)
-    {
-        atomInfo = system.atomInfoOxygenVdw;
-    }
-    else
-    {
-        atomInfo = system.atomInfoAllVdw;
-    }
-
-    const real atomDensity = system.coordinates.size() / det(system.box);
 
-    nbnxn_put_on_grid(nbv.get(), system.box, 0, lowerCorner, upperCorner, nullptr,
-                      { 0, int(system.coordinates.size()) }, atomDensity, atomInfo,
-                      system.coordinates, 0, nullptr);
-
-    nbv->constructPairlist(gmx::InteractionLocality::Local, system.excls, 0, &nrnb);
-
-    nbv->setAtomProperties(system.atomTypes, system.charges, atomInfo);
+    putOnGridAndConstructPairlist(nbv.get(), options, system, &nrnb);
 
     return nbv;
 }
@@ -261,13 +282,105 @@ static void expandSimdOptionAndPushBack(const KernelBenchOptions&        options
     }
 }
 
+//! The pair-list buffer used for benchmarking dynamic pruning
+static constexpr real c_pruneBenchmarkListBuffer = 0.1;
+
+//! The names of the kernel SIMD types
+static const gmx::EnumerationArray<BenchMarkKernels, std::string> c_kernelNames = { "auto", "no",
+                                                                                    "4xM", "2xMM" };
+
+//! The names of the LJ combination rules
+static const gmx::EnumerationArray<BenchMarkCombRule, std::string> c_combruleNames = { "geom.", "LB",
+                                                                                       "none" };
+
+/*! \internal \brief
+ * The results of one benchmark instance
+ *
+ * All timings are in cycles per iteration, negative values mean not measured.
+ */
+struct BenchmarkResult
+{
+    //! The options for this instance
+    KernelBenchOptions options;
+    //! The number of pairs in the pair list
+    gmx::index numPairs = 0;
+    //! The non-bonded kernel
+    double kernelCycles = -1;
+    //! Putting atoms on the grid and constructing the pair list
+    double searchCycles = -1;
+    //! The dynamic pruning kernel
+    double pruneCycles = -1;
+    //! Converting coordinates to the non-bonded atom data layout
+    double xBufferOpsCycles = -1;
+    //! Reducing the non-bonded force buffers
+    double fBufferOpsCycles = -1;
+};
+
+//! Returns the average number of cycles of \p numIterations calls of \p function
+template<typename Function>
+static double averageCycles(const int numIterations, Function&& function)
+{
+    gmx_cycles_t cycles = gmx_cycles_read();
+    for (int iter = 0; iter < numIterations; iter++)
+    {
+        function();
+    }
+    cycles = gmx_cycles_read() - cycles;
+
+    return static_cast<double>(cycles) / numIterations;
+}
+
+/*! \brief Benchmarks the stages of a step with the Nbnxm module, other than the kernel
+ *
+ * Note that dynamic pruning is turned on in \p nbv here.
+ */
+static void benchmarkStages(nonbonded_verlet_t*         nbv,
+                            const gmx::BenchmarkSystem& system,
+                            const KernelBenchOptions&   options,
+                            BenchmarkResult*            result)
+{
+    const int numIterations = options.numIterations;
+
+    t_nrnb nrnb = { 0 };
+
+    result->xBufferOpsCycles = averageCycles(numIterations, [&]() {
+        nbv->convertCoordinates(gmx::AtomLocality::Local, false, system.coordinates);
+    });
+
+    std::vector<gmx::RVec> forces(system.coordinates.size(), { 0.0_real, 0.0_real, 0.0_real });
+    result->fBufferOpsCycles = averageCycles(numIterations, [&]() {
+        nbv->atomdata_add_nbat_f_to_f(gmx::AtomLocality::All, forces);
+    });
+
+    result->searchCycles = averageCycles(
+            numIterations, [&]() { putOnGridAndConstructPairlist(nbv, options, system, &nrnb); });
+
+    // Pruning needs a pair list with a buffer, which fits in the box
+    PairlistParams pruneParams = nbv->pairlistSets().params();
+    pruneParams.rlistOuter     = options.pairlistCutoff + c_pruneBenchmarkListBuffer;
+    pruneParams.rlistInner     = options.pairlistCutoff;
+    real minBoxSize            = std::min(system.box[XX][XX], system.box[YY][YY]);
+    minBoxSize                 = std::min(minBoxSize, system.box[ZZ][ZZ]);
+    if (pruneParams.rlistOuter <= 0.5 * minBoxSize)
+    {
+        pruneParams.useDynamicPruning = true;
+        pruneParams.nstlistPrune      = 1;
+        nbv->changePairlistParams(pruneParams);
+        putOnGridAndConstructPairlist(nbv, options, system, &nrnb);
+
+        result->pruneCycles = averageCycles(numIterations, [&]() {
+            nbv->dispatchPruneKernelCpu(gmx::InteractionLocality::Local, system.forceRec.shift_vec);
+        });
+    }
+}
+
 //! Sets up and runs the requested benchmark instance and prints the results
 //
 // When \p doWarmup is true runs the warmup iterations instead
 // of the normal ones and does not print any results
-static void setupAndRunInstance(const gmx::BenchmarkSystem& system,
-                                const KernelBenchOptions&   options,
-                                const bool                  doWarmup)
+static BenchmarkResult setupAndRunInstance(const gmx::BenchmarkSystem& system,
+                                           const KernelBenchOptions&   options,
+                                           const bool                  doWarmup)
 {
     // Generate an, accurate, estimate of the number of non-zero pair interactions
     const real atomDensity = system.coordinates.size() / det(system.box);
@@ -292,18 +405,13 @@ static void setupAndRunInstance(const gmx::BenchmarkSystem& system,
         stepWork.computeEnergy = true;
     }
 
-    const gmx::EnumerationArray<BenchMarkKernels, std::string> kernelNames = { "auto", "no", "4xM",
-                                                                               "2xMM" };
-
-    const gmx::EnumerationArray<BenchMarkCombRule, std::string> combruleNames = { "geom.", "LB",
-                                                                                  "none" };
-
     if (!doWarmup)
     {
         fprintf(stdout, "%-7s %-4s %-5s %-4s ",
                 options.coulombType == BenchMarkCoulomb::Pme ? "Ewald" : "RF",
                 options.useHalfLJOptimization ? "half" : "all",
-                combruleNames[options.ljCombinationRule].c_str(), kernelNames[options.nbnxmSimd].c_str());
+                c_combruleNames[options.ljCombinationRule].c_str(),
+                c_kernelNames[options.nbnxmSimd].c_str());
     }
 
     // Run pre-iteration to avoid cache misses
@@ -324,6 +432,11 @@ static void setupAndRunInstance(const gmx::BenchmarkSystem& system,
                                      system.forceRec, &enerd, &nrnb);
     }
     cycles = gmx_cycles_read() - cycles;
+
+    BenchmarkResult result;
+    result.options  = options;
+    result.numPairs = numPairs;
+
     if (!doWarmup)
     {
         const double dCycles = static_cast<double>(cycles);
@@ -339,7 +452,133 @@ static void setupAndRunInstance(const gmx::BenchmarkSystem& system,
                     dCycles / options.numIterations * 1e-6, options.numIterations * numPairs / dCycles,
                     options.numIterations * numUsefulPairs / dCycles);
         }
+
+        result.kernelCycles = dCycles / options.numIterations;
+
+        if (options.benchmarkStages)
+        {
+            benchmarkStages(nbv.get(), system, options, &result);
+        }
+    }
+
+    return result;
+}
+
+//! Prints the cycles per atom for the stages other than the kernel
+static void printStageResults(FILE*                              fp,
+                              const gmx::BenchmarkSystem&        system,
+                              gmx::ArrayRef<const BenchmarkResult> results)
+{
+    const double numAtoms = system.coordinates.size();
+
+    fprintf(fp, "\nCycles per atom per iteration for the other stages\n");
+    fprintf(fp, "Coulomb LJ   comb. SIMD     search     prune  x-bufops  f-bufops\n");
+    for (const BenchmarkResult& result : results)
+    {
+        const KernelBenchOptions& options = result.options;
+        fprintf(fp, "%-7s %-4s %-5s %-4s ",
+                options.coulombType == BenchMarkCoulomb::Pme ? "Ewald" : "RF",
+                options.useHalfLJOptimization ? "half" : "all",
+                c_combruleNames[options.ljCombinationRule].c_str(),
+                c_kernelNames[options.nbnxmSimd].c_str());
+        for (double cycles : { result.searchCycles, result.pruneCycles, result.xBufferOpsCycles,
+                               result.fBufferOpsCycles })
+        {
+            if (cycles >= 0)
+            {
+                fprintf(fp, " %9.2f", cycles / numAtoms);
+            }
+            else
+            {
+                fprintf(fp, " %9s", "-");
+            }
+        }
+        fprintf(fp, "\n");
+    }
+}
+
+//! Returns \p str as a JSON string, including quotes
+static std::string jsonString(const std::string& str)
+{
+    std::string quoted = "\"";
+    for (const char c : str)
+    {
+        if (c == '"' || c == '\\')
+        {
+            quoted += '\\';
+            quoted += c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            /* Control characters are not allowed unescaped in JSON strings */
+            quoted += gmx::formatString("\\u%04x", static_cast<unsigned int>(c));
+        }
+        else
+        {
+            quoted += c;
+        }
+    }
+    quoted += '"';
+
+    return quoted;
+}
+
+//! Writes the options and results to \p fileName in JSON format, stages that were not measured are left out
+static void writeJsonResults(const std::string&                   fileName,
+                             const gmx::BenchmarkSystem&          system,
+                             const KernelBenchOptions&            options,
+                             gmx::ArrayRef<const BenchmarkResult> results)
+{
+    const double numAtoms = system.coordinates.size();
+
+    FILE* fp = gmx_ffopen(fileName, "w");
+
+    fprintf(fp, "{\n");
+    fprintf(fp, "  \"system\": %s,\n", jsonString(system.description).c_str());
+    fprintf(fp, "  \"numAtoms\": %zu,\n", system.coordinates.size());
+    fprintf(fp, "  \"cutoff\": %g,\n", options.pairlistCutoff);
+    fprintf(fp, "  \"numThreads\": %d,\n", options.numThreads);
+    fprintf(fp, "  \"numIterations\": %d,\n", options.numIterations);
+    fprintf(fp, "  \"computeEnergies\": %s,\n", options.computeVirialAndEnergy ? "true" : "false");
+#if GMX_SIMD
+    fprintf(fp, "  \"simdWidth\": %d,\n", GMX_SIMD_REAL_WIDTH);
+#endif
+    fprintf(fp, "  \"benchmarks\": [\n");
+    for (gmx::index i = 0; i < results.ssize(); i++)
+    {
+        const BenchmarkResult&    result   = results[i];
+        const KernelBenchOptions& instance = result.options;
+
+        fprintf(fp, "    {\n");
+        fprintf(fp, "      \"coulomb\": \"%s\",\n",
+                instance.coulombType == BenchMarkCoulomb::Pme ? "Ewald" : "RF");
+        fprintf(fp, "      \"lj\": \"%s\",\n", instance.useHalfLJOptimization ? "half" : "all");
+        fprintf(fp, "      \"combRule\": \"%s\",\n", c_combruleNames[instance.ljCombinationRule].c_str());
+        fprintf(fp, "      \"simd\": \"%s\",\n", c_kernelNames[instance.nbnxmSimd].c_str());
+        fprintf(fp, "      \"numPairs\": %ld,\n", static_cast<long>(result.numPairs));
+        fprintf(fp, "      \"cyclesPerAtom\": {\n");
+        const std::pair<const char*, double> stages[] = {
+            { "kernel", result.kernelCycles },         { "search", result.searchCycles },
+            { "prune", result.pruneCycles },           { "xBufferOps", result.xBufferOpsCycles },
+            { "fBufferOps", result.fBufferOpsCycles }
+        };
+        bool isFirst = true;
+        for (const auto& stage : stages)
+        {
+            if (stage.second >= 0)
+            {
+                fprintf(fp, "%s        \"%s\": %.4f", isFirst ? "" : ",\n", stage.first,
+                        stage.second / numAtoms);
+                isFirst = false;
+            }
+        }
+        fprintf(fp, "\n      }\n");
+        fprintf(fp, "    }%s\n", i + 1 < results.ssize() ? "," : "");
     }
+    fprintf(fp, "  ]\n");
+    fprintf(fp, "}\n");
+
+    gmx_ffclose(fp);
 }
 
 void bench(const int sizeFactor, const KernelBenchOptions& options)
@@ -348,7 +587,9 @@ void bench(const int sizeFactor, const KernelBenchOptions& options)
     gmx_omp_nthreads_set(emntPairsearch, options.numThreads);
     gmx_omp_nthreads_set(emntNonbonded, options.numThreads);
 
-    const gmx::BenchmarkSystem system(sizeFactor);
+    const gmx::BenchmarkSystem system = (options.tprFileName.empty()
+                                                 ? gmx::BenchmarkSystem(sizeFactor)
+                                                 : gmx::BenchmarkSystem(options.tprFileName));
 
     real minBoxSize = norm(system.box[XX]);
     for (int dim = YY; dim < DIM; dim++)
@@ -394,6 +635,7 @@ void bench(const int sizeFactor, const KernelBenchOptions& options)
         fprintf(stdout, "SIMD width:           %d\n", GMX_SIMD_REAL_WIDTH);
     }
 #endif
+    fprintf(stdout, "System:               %s\n", system.description.c_str());
     fprintf(stdout, "System size:          %zu atoms\n", system.coordinates.size());
     fprintf(stdout, "Cut-off radius:       %g nm\n", options.pairlistCutoff);
     fprintf(stdout, "Number of threads:    %d\n", options.numThreads);
@@ -417,9 +659,20 @@ void bench(const int sizeFactor, const KernelBenchOptions& options)
             options.cyclesPerPair ? "cycles/pair" : "pairs/cycle");
     fprintf(stdout, "                                                total    useful\n");
 
+    std::vector<BenchmarkResult> results;
     for (const auto& optionsInstance : optionsList)
     {
-        setupAndRunInstance(system, optionsInstance, false);
+        results.push_back(setupAndRunInstance(system, optionsInstance, false));
+    }
+
+    if (options.benchmarkStages)
+    {
+        printStageResults(stdout, system, results);
+    }
+
+    if (!options.jsonFileName.empty())
+    {
+        writeJsonResults(options.jsonFileName, system, options, results);
     }
 }
 
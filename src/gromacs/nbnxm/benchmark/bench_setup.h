@@ -46,6 +46,8 @@
 #ifndef GMX_NBNXN_BENCH_SETUP_H
 #define GMX_NBNXN_BENCH_SETUP_H
 
+#include <string>
+
 #include "gromacs/utility/real.h"
 
 namespace Nbnxm
@@ -113,15 +115,23 @@ struct KernelBenchOptions
     int numWarmupIterations = 0;
     //! Print cycles/pair instead of pairs/cycle
     bool cyclesPerPair = false;
+    //! Whether to also benchmark pair search, pruning and the coordinate and force buffer operations
+    bool benchmarkStages = false;
+    //! When not empty, the system is read from this run input file instead of using water
+    std::string tprFileName;
+    //! When not empty, the results are also written to this file in JSON format
+    std::string jsonFileName;
 };
 
 /*! \brief
  * Sets up and runs one or more Nbnxm kernel benchmarks
  *
  * The simulated system is a box of 1000 SPC/E water molecules scaled
- * by the factor \p sizeFactor, which has to be a power of 2.
+ * by the factor \p sizeFactor, which has to be a power of 2,
+ * or the system in the run input file given in \p options.
  * One or more benchmarks are run, as specified by \p options.
- * Benchmark settings and timings are printed to stdout.
+ * Benchmark settings and timings are printed to stdout and, when requested,
+ * written to a JSON file.
  *
  * \param[in] sizeFactor How much should the system size be increased.
  * \param[in] options How the benchmark will be run.
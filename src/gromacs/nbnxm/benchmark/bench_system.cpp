@@ -48,13 +48,20 @@
 #include <numeric>
 #include <vector>
 
+#include "gromacs/fileio/tpxio.h"
 #include "gromacs/math/vec.h"
 #include "gromacs/mdlib/dispersioncorrection.h"
 #include "gromacs/mdtypes/forcerec.h"
+#include "gromacs/mdtypes/inputrec.h"
+#include "gromacs/mdtypes/state.h"
 #include "gromacs/nbnxm/nbnxm.h"
 #include "gromacs/pbcutil/ishift.h"
 #include "gromacs/pbcutil/pbc.h"
+#include "gromacs/topology/ifunc.h"
+#include "gromacs/topology/mtop_util.h"
+#include "gromacs/topology/topology.h"
 #include "gromacs/utility/fatalerror.h"
+#include "gromacs/utility/stringutil.h"
 
 #include "bench_coords.h"
 
@@ -195,6 +202,85 @@ BenchmarkSystem::BenchmarkSystem(const int multiplicationFactor)
         std::iota(exclusionsForAtom.begin(), exclusionsForAtom.end(), firstAtomInMolecule);
     }
 
+    description = formatString("%d SPC/E water molecules", numAtoms / numAtomsInMolecule);
+
+    forceRec.ntype = numAtomTypes;
+    forceRec.nbfp  = nonbondedParameters;
+    snew(forceRec.shift_vec, SHIFTS);
+    calc_shifts(box, forceRec.shift_vec);
+}
+
+BenchmarkSystem::BenchmarkSystem(const std::string& tprFileName)
+{
+    t_inputrec ir;
+    t_state    state;
+    gmx_mtop_t mtop;
+    read_tpx_state(tprFileName.c_str(), &ir, &state, &mtop);
+
+    if (ir.pbcType != PbcType::Xyz || TRICLINIC(state.box))
+    {
+        gmx_fatal(FARGS,
+                  "Only systems with a rectangular unit-cell with periodicity in x, y and z are "
+                  "supported, %s does not match these requirements",
+                  tprFileName.c_str());
+    }
+    if (mtop.ffparams.functype[0] != F_LJ)
+    {
+        gmx_fatal(FARGS, "Only Lennard-Jones Van der Waals interactions are supported");
+    }
+
+    numAtomTypes = mtop.ffparams.atnr;
+    nonbondedParameters.resize(numAtomTypes * numAtomTypes * 2);
+    std::vector<bool> typeHasVdw(numAtomTypes, false);
+    for (int i = 0; i < numAtomTypes; i++)
+    {
+        for (int j = 0; j < numAtomTypes; j++)
+        {
+            const t_iparams& params = mtop.ffparams.iparams[i * numAtomTypes + j];
+            /* Include the derivative prefactors, as done for the MD setup */
+            nonbondedParameters[(i * numAtomTypes + j) * 2]     = 6.0 * params.lj.c6;
+            nonbondedParameters[(i * numAtomTypes + j) * 2 + 1] = 12.0 * params.lj.c12;
+            if (params.lj.c6 != 0 || params.lj.c12 != 0)
+            {
+                typeHasVdw[i] = true;
+            }
+        }
+    }
+
+    coordinates.assign(state.x.begin(), state.x.end());
+    copy_mat(state.box, box);
+    put_atoms_in_box(PbcType::Xyz, box, coordinates);
+
+    atomTypes.reserve(mtop.natoms);
+    charges.reserve(mtop.natoms);
+    atomInfoAllVdw.reserve(mtop.natoms);
+    for (const AtomProxy atomP : AtomRange(mtop))
+    {
+        const t_atom& local = atomP.atom();
+
+        int atomInfo = 0;
+        if (typeHasVdw[local.type])
+        {
+            SET_CGINFO_HAS_VDW(atomInfo);
+        }
+        if (local.q != 0)
+        {
+            SET_CGINFO_HAS_Q(atomInfo);
+        }
+
+        atomTypes.push_back(local.type);
+        charges.push_back(local.q);
+        atomInfoAllVdw.push_back(atomInfo);
+    }
+    /* For a general system the atom info itself determines where half-LJ is used */
+    atomInfoOxygenVdw = atomInfoAllVdw;
+
+    gmx_localtop_t localTop(mtop.ffparams);
+    gmx_mtop_generate_local_top(mtop, &localTop, false);
+    excls = std::move(localTop.excls);
+
+    description = formatString("%s (%d atoms)", tprFileName.c_str(), mtop.natoms);
+
     forceRec.ntype = numAtomTypes;
     forceRec.nbfp  = nonbondedParameters;
     snew(forceRec.shift_vec, SHIFTS);
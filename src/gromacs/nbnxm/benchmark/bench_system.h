@@ -44,6 +44,7 @@
 #ifndef GMX_NBNXN_BENCH_SYSTEM_H
 #define GMX_NBNXN_BENCH_SYSTEM_H
 
+#include <string>
 #include <vector>
 
 #include "gromacs/math/vectypes.h"
@@ -67,6 +68,20 @@ struct BenchmarkSystem
      */
     BenchmarkSystem(int multiplicationFactor);
 
+    /*! \brief Constructor
+     *
+     * Reads the benchmark system from the run input file \p tprFileName.
+     * Only systems with a rectangular unit-cell with full periodicity
+     * and Lennard-Jones interactions are supported.
+     * Free-energy perturbations are ignored, the A-state is used.
+     *
+     * \param[in] tprFileName  The name of the run input file
+     */
+    explicit BenchmarkSystem(const std::string& tprFileName);
+
+    //! A short description of the system
+    std::string description;
+
     //! Number of different atom types in test system.
     int numAtomTypes;
     //! Storage for parameters for short range interactions.
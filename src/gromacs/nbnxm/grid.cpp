@@ -426,6 +426,47 @@ static void sort_atoms(int      dim,
     }
 }
 
+/*! \brief Maximum average number of element moves per atom for the incremental sort */
+static constexpr int c_maxIncrementalSortMovesPerAtom = 1;
+
+/*! \brief Tries to sort particle index a on increasing coordinates x along dim by insertion
+ *
+ * This is efficient when a is already nearly sorted, as is the case when
+ * the atom order of the previous search is reused. The order produced is
+ * identical to that of sort_atoms() with Backwards=false: increasing
+ * coordinate with ties broken by increasing atom index.
+ * Returns false when more than c_maxIncrementalSortMovesPerAtom*n element
+ * moves would be required. Then a is left as a permutation of the input
+ * and should be sorted with sort_atoms().
+ */
+static bool sortAtomsIncrementally(int dim, int* a, int n, gmx::ArrayRef<const gmx::RVec> x)
+{
+    const int maxNumMoves = c_maxIncrementalSortMovesPerAtom * n;
+    int       numMoves    = 0;
+
+    for (int i = 1; i < n; i++)
+    {
+        const int  atom  = a[i];
+        const real coord = x[atom][dim];
+
+        int j = i;
+        while (j > 0 && (x[a[j - 1]][dim] > coord || (x[a[j - 1]][dim] == coord && a[j - 1] > atom)))
+        {
+            a[j] = a[j - 1];
+            j--;
+            numMoves++;
+        }
+        a[j] = atom;
+
+        if (numMoves > maxNumMoves)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 #if GMX_DOUBLE
 //! Returns double up to one least significant float bit smaller than x
 static double R2F_D(const float x)
@@ -1010,10 +1051,17 @@ void Grid::sortColumnsCpuGeometry(GridSetData*                   gridSetData,
         const int numCellsZ  = cxy_ind_[cxy + 1] - cxy_ind_[cxy];
         const int atomOffset = firstAtomInColumn(cxy);
 
-        /* Sort the atoms within each x,y column on z coordinate */
-        sort_atoms(ZZ, FALSE, dd_zone, relevantAtomsAreWithinGridBounds,
-                   gridSetData->atomIndices.data() + atomOffset, numAtoms, x, dimensions_.lowerCorner[ZZ],
-                   1.0 / dimensions_.gridSize[ZZ], numCellsZ * numAtomsPerCell, sort_work);
+        /* Sort the atoms within each x,y column on z coordinate.
+         * When the atoms are (nearly) in the order of the previous search,
+         * an insertion sort is cheaper than a full sort.
+         */
+        int* columnAtoms = gridSetData->atomIndices.data() + atomOffset;
+        if (!sortAtomsIncrementally(ZZ, columnAtoms, numAtoms, x))
+        {
+            sort_atoms(ZZ, FALSE, dd_zone, relevantAtomsAreWithinGridBounds, columnAtoms, numAtoms,
+                       x, dimensions_.lowerCorner[ZZ], 1.0 / dimensions_.gridSize[ZZ],
+                       numCellsZ * numAtomsPerCell, sort_work);
+        }
 
         /* Fill the ncz cells in this column */
         const int firstCell  = firstCellInColumn(cxy);
@@ -1163,6 +1211,13 @@ void Grid::sortColumnsGpuGeometry(GridSetData*                   gridSetData,
     }
 }
 
+/*! \brief Returns the part of \p range assigned to task \p task out of \p numTasks */
+static gmx::Range<int> taskRange(const gmx::Range<int> range, const int task, const int numTasks)
+{
+    return { *range.begin() + static_cast<int>((task + 0) * range.size()) / numTasks,
+             *range.begin() + static_cast<int>((task + 1) * range.size()) / numTasks };
+}
+
 /*! \brief Sets the cell index in the cell array for atom \p atomIndex and increments the atom count for the grid column */
 static void setCellAndAtomCount(gmx::ArrayRef<int> cell, int cellIndex, gmx::ArrayRef<int> cxy_na, int atomIndex)
 {
@@ -1184,18 +1239,17 @@ void Grid::calcColumnIndices(const Grid::Dimensions&        gridDims,
     const int numColumns = gridDims.numCells[XX] * gridDims.numCells[YY];
 
     /* We add one extra cell for particles which moved during DD */
-    for (int i = 0; i < numColumns; i++)
+    for (int i = 0; i < numColumns + 1; i++)
     {
         cxy_na[i] = 0;
     }
 
-    int taskAtomStart = *atomRange.begin() + static_cast<int>((thread + 0) * atomRange.size()) / nthread;
-    int taskAtomEnd = *atomRange.begin() + static_cast<int>((thread + 1) * atomRange.size()) / nthread;
+    const gmx::Range<int> taskAtomRange = taskRange(atomRange, thread, nthread);
 
     if (dd_zone == 0)
     {
         /* Home zone */
-        for (int i = taskAtomStart; i < taskAtomEnd; i++)
+        for (int i : taskAtomRange)
         {
             if (move == nullptr || move[i] >= 0)
             {
@@ -1243,7 +1297,7 @@ void Grid::calcColumnIndices(const Grid::Dimensions&        gridDims,
     else
     {
         /* Non-home zone */
-        for (int i = taskAtomStart; i < taskAtomEnd; i++)
+        for (int i : taskAtomRange)
         {
             int cx = static_cast<int>((x[i][XX] - gridDims.lowerCorner[XX]) * gridDims.invCellSize[XX]);
             int cy = static_cast<int>((x[i][YY] - gridDims.lowerCorner[YY]) * gridDims.invCellSize[YY]);
@@ -1292,6 +1346,7 @@ void Grid::setCellIndices(int                            ddZone,
                           const int*                     atinfo,
                           gmx::ArrayRef<const gmx::RVec> x,
                           const int                      numAtomsMoved,
+                          gmx::ArrayRef<const int>       previousAtomOrder,
                           nbnxn_atomdata_t*              nbat)
 {
     cellOffset_ = cellOffset;
@@ -1329,8 +1384,6 @@ void Grid::setCellIndices(int                            ddZone,
             ncz = (ncz + 1) & ~1;
         }
         cxy_ind_[i + 1] = cxy_ind_[i] + ncz;
-        /* Clear cxy_na_, so we can reuse the array below */
-        cxy_na_[i] = 0;
     }
     numCellsTotal_     = cxy_ind_[numColumns()] - cxy_ind_[0];
     numCellsColumnMax_ = ncz_max;
@@ -1371,14 +1424,81 @@ void Grid::setCellIndices(int                            ddZone,
 
     /* Now we know the dimensions we can fill the grid.
      * This is the first, unsorted fill. We sort the columns after this.
+     * The fill is a parallel bucket sort on column index: each thread
+     * scatters its own atoms, at offsets given by the column counts
+     * of the preceding threads. When we have the atom order of the previous
+     * search, we fill in that order, so most columns end up nearly sorted.
      */
     gmx::ArrayRef<int> cells       = gridSetData->cells;
     gmx::ArrayRef<int> atomIndices = gridSetData->atomIndices;
-    for (int i : atomRange)
+
+    const bool            usePreviousOrder = !previousAtomOrder.empty();
+    const gmx::Range<int> fillRange =
+            (usePreviousOrder ? gmx::Range<int>(0, previousAtomOrder.ssize()) : atomRange);
+
+    if (usePreviousOrder)
+    {
+        /* The atom counts per thread should match the order we fill in */
+#pragma omp parallel for num_threads(nthread) schedule(static)
+        for (int thread = 0; thread < nthread; thread++)
+        {
+            try
+            {
+                gmx::ArrayRef<int> numAtomsPerColumn = gridWork[thread].numAtomsPerColumn;
+                std::fill(numAtomsPerColumn.begin(), numAtomsPerColumn.end(), 0);
+                for (int ind : taskRange(fillRange, thread, nthread))
+                {
+                    const int i = previousAtomOrder[ind];
+                    if (i >= 0)
+                    {
+                        numAtomsPerColumn[cells[i]] += 1;
+                    }
+                }
+            }
+            GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+        }
+    }
+
+    /* Convert the per-thread column counts into per-thread fill offsets.
+     * Note that the extra column for moved atoms is included.
+     */
+#pragma omp parallel for num_threads(nthread) schedule(static)
+    for (int thread = 0; thread < nthread; thread++)
     {
-        /* At this point nbs->cell contains the local grid x,y indices */
-        const int cxy                                        = cells[i];
-        atomIndices[firstAtomInColumn(cxy) + cxy_na_[cxy]++] = i;
+        try
+        {
+            for (int cxy : taskRange(gmx::Range<int>(0, numColumns() + 1), thread, nthread))
+            {
+                int atomIndex = firstAtomInColumn(cxy);
+                for (int t = 0; t < nthread; t++)
+                {
+                    const int numAtoms                 = gridWork[t].numAtomsPerColumn[cxy];
+                    gridWork[t].numAtomsPerColumn[cxy] = atomIndex;
+                    atomIndex += numAtoms;
+                }
+                cxy_na_[cxy] = atomIndex - firstAtomInColumn(cxy);
+            }
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
+
+#pragma omp parallel for num_threads(nthread) schedule(static)
+    for (int thread = 0; thread < nthread; thread++)
+    {
+        try
+        {
+            /* At this point cells contains the local grid x,y indices */
+            gmx::ArrayRef<int> fillIndex = gridWork[thread].numAtomsPerColumn;
+            for (int ind : taskRange(fillRange, thread, nthread))
+            {
+                const int i = (usePreviousOrder ? previousAtomOrder[ind] : ind);
+                if (i >= 0)
+                {
+                    atomIndices[fillIndex[cells[i]]++] = i;
+                }
+            }
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
     }
 
     if (ddZone == 0)
@@ -345,7 +345,13 @@ public:
                        bool               haveFep,
                        gmx::PinningPolicy pinningPolicy);
 
-    //! Sets the cell indices using indices in \p gridSetData and \p gridWork
+    /*! \brief Sets the cell indices using indices in \p gridSetData and \p gridWork
+     *
+     * When \p previousAtomOrder is not empty, it should contain the atom order
+     * on this grid of the previous call, with -1 for filler particles,
+     * and the atoms are filled into the columns in this order. This only affects
+     * performance, the result is independent of the fill order.
+     */
     void setCellIndices(int                            ddZone,
                         int                            cellOffset,
                         GridSetData*                   gridSetData,
@@ -354,6 +360,7 @@ public:
                         const int*                     atinfo,
                         gmx::ArrayRef<const gmx::RVec> x,
                         int                            numAtomsMoved,
+                        gmx::ArrayRef<const int>       previousAtomOrder,
                         nbnxn_atomdata_t*              nbat);
 
     //! Determine in which grid columns atoms should go, store cells and atom counts in \p cell and \p cxy_na
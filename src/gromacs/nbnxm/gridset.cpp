@@ -132,6 +132,22 @@ void GridSet::setLocalAtomOrder()
     }
 }
 
+void GridSet::setLocalAtomOrder(gmx::ArrayRef<const int> newAtomIndex)
+{
+    /* Renumber the atoms in the home cell (index 0) */
+    const Nbnxm::Grid& grid = grids_[0];
+
+    for (int cellIndex = grid.firstAtomInColumn(0); cellIndex < grid.atomIndexEnd(); cellIndex++)
+    {
+        int& atomIndex = gridSetData_.atomIndices[cellIndex];
+        if (atomIndex >= 0)
+        {
+            atomIndex                     = newAtomIndex[atomIndex];
+            gridSetData_.cells[atomIndex] = cellIndex;
+        }
+    }
+}
+
 void GridSet::putOnGrid(const matrix                   box,
                         const int                      gridIndex,
                         const rvec                     lowerCorner,
@@ -218,9 +234,34 @@ void GridSet::putOnGrid(const matrix                   box,
         GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
     }
 
+    /* Without domain decomposition the local atom order does not change
+     * between searches. Then we can reuse the grid atom order of the previous
+     * search, which makes the sorting within the grid columns cheap.
+     * With domain decomposition the local atom indices change at every
+     * repartitioning, so a stored order would refer to the wrong atoms.
+     * But there dd_sort_state() orders the home atoms on the grid order of
+     * the previous search, so filling the home grid in index order already
+     * gives nearly sorted columns. Only the atoms that moved in are appended.
+     */
+    const bool canReuseLocalAtomOrder = (gridIndex == 0 && !domainSetup_.haveMultipleDomains
+                                         && !domainSetup_.doTestParticleInsertion && numAtomsMoved == 0);
+    if (!canReuseLocalAtomOrder
+        || !(*atomRange.begin() == *previousLocalAtomRange_.begin()
+             && *atomRange.end() == *previousLocalAtomRange_.end()))
+    {
+        previousLocalAtomOrder_.clear();
+    }
+
     /* Copy the already computed cell indices to the grid and sort, when needed */
     grid.setCellIndices(ddZone, cellOffset, &gridSetData_, gridWork_, atomRange, atomInfo.data(), x,
-                        numAtomsMoved, nbat);
+                        numAtomsMoved, previousLocalAtomOrder_, nbat);
+
+    if (canReuseLocalAtomOrder)
+    {
+        previousLocalAtomOrder_.assign(gridSetData_.atomIndices.begin(),
+                                       gridSetData_.atomIndices.begin() + grid.atomIndexEnd());
+        previousLocalAtomRange_ = atomRange;
+    }
 
     if (gridIndex == 0)
     {
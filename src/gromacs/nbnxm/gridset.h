@@ -156,6 +156,12 @@ public:
     //! Sets the order of the local atoms to the order grid atom ordering
     void setLocalAtomOrder();
 
+    /*! \brief Renumbers the local atoms on the home grid
+     *
+     * \param[in] newAtomIndex  The new index for each local atom index on the home grid
+     */
+    void setLocalAtomOrder(gmx::ArrayRef<const int> newAtomIndex);
+
     //! Returns the list of grids
     gmx::ArrayRef<const Grid> grids() const { return grids_; }
 
@@ -195,6 +201,10 @@ private:
     int numRealAtomsTotal_;
     //! Working data for constructing a single grid, one entry per thread
     std::vector<GridWork> gridWork_;
+    //! The atom order on the home grid of the previous search, empty when it can not be reused
+    std::vector<int> previousLocalAtomOrder_;
+    //! The atom range the previous local atom order refers to
+    gmx::Range<int> previousLocalAtomRange_;
     //! Maximum number of columns across all grids
     int numColumnsMax_;
 };
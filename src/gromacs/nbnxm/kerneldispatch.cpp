@@ -133,39 +133,16 @@ static void reduceGroupEnergySimdBuffers(int numGroups, int numGroups_2log, nbnx
     }
 }
 
-/*! \brief Dispatches the non-bonded N versus M atom cluster CPU kernels.
- *
- * OpenMP parallelization is performed within this function.
- * Energy reduction, but not force and shift force reduction, is performed
- * within this function.
+/*! \brief Returns the Coulomb kernel type index for the CPU kernel tables
  *
- * \param[in]     pairlistSet   Pairlists with local or non-local interactions to compute
- * \param[in]     kernelSetup   The non-bonded kernel setup
- * \param[in,out] nbat          The atomdata for the interactions
- * \param[in]     ic            Non-bonded interaction constants
- * \param[in]     shiftVectors  The PBC shift vectors
- * \param[in]     stepWork      Flags that tell what to compute
- * \param[in]     clearF        Enum that tells if to clear the force output buffer
- * \param[out]    vCoulomb      Output buffer for Coulomb energies
- * \param[out]    vVdw          Output buffer for Van der Waals energies
- * \param[in]     wcycle        Pointer to cycle counting data structure.
+ * \param[in] ic           Non-bonded interaction constants
+ * \param[in] kernelSetup  The non-bonded kernel setup
  */
-static void nbnxn_kernel_cpu(const PairlistSet&         pairlistSet,
-                             const Nbnxm::KernelSetup&  kernelSetup,
-                             nbnxn_atomdata_t*          nbat,
-                             const interaction_const_t& ic,
-                             rvec*                      shiftVectors,
-                             const gmx::StepWorkload&   stepWork,
-                             int                        clearF,
-                             real*                      vCoulomb,
-                             real*                      vVdw,
-                             gmx_wallcycle*             wcycle)
+static int getCoulombKernelType(const interaction_const_t& ic, const Nbnxm::KernelSetup& kernelSetup)
 {
-
-    int coulkt;
     if (EEL_RF(ic.eeltype) || ic.eeltype == eelCUT)
     {
-        coulkt = coulktRF;
+        return coulktRF;
     }
     else
     {
@@ -173,28 +150,37 @@ static void nbnxn_kernel_cpu(const PairlistSet&         pairlistSet,
         {
             if (ic.rcoulomb == ic.rvdw)
             {
-                coulkt = coulktTAB;
+                return coulktTAB;
             }
             else
             {
-                coulkt = coulktTAB_TWIN;
+                return coulktTAB_TWIN;
             }
         }
         else
         {
             if (ic.rcoulomb == ic.rvdw)
             {
-                coulkt = coulktEWALD;
+                return coulktEWALD;
             }
             else
             {
-                coulkt = coulktEWALD_TWIN;
+                return coulktEWALD_TWIN;
             }
         }
     }
+}
 
-    const nbnxn_atomdata_t::Params& nbatParams = nbat->params();
-
+/*! \brief Returns the Van der Waals kernel type index for the CPU kernel tables
+ *
+ * \param[in] ic           Non-bonded interaction constants
+ * \param[in] kernelSetup  The non-bonded kernel setup
+ * \param[in] nbatParams   The atomdata parameters
+ */
+static int getVdwKernelType(const interaction_const_t&      ic,
+                            const Nbnxm::KernelSetup&       kernelSetup,
+                            const nbnxn_atomdata_t::Params& nbatParams)
+{
     int vdwkt = 0;
     if (ic.vdwtype == evdwCUT)
     {
@@ -235,123 +221,185 @@ static void nbnxn_kernel_cpu(const PairlistSet&         pairlistSet,
         GMX_RELEASE_ASSERT(false, "Unsupported VdW interaction type");
     }
 
-    gmx::ArrayRef<const NbnxnPairlistCpu> pairlists = pairlistSet.cpuLists();
-
-    int gmx_unused nthreads = gmx_omp_nthreads_get(emntNonbonded);
-    wallcycle_sub_start(wcycle, ewcsNONBONDED_CLEAR);
-#pragma omp parallel for schedule(static) num_threads(nthreads)
-    for (gmx::index nb = 0; nb < pairlists.ssize(); nb++)
-    {
-        // Presently, the kernels do not call C++ code that can throw,
-        // so no need for a try/catch pair in this OpenMP region.
-        nbnxn_atomdata_output_t* out = &nbat->out[nb];
+    return vdwkt;
+}
 
-        if (clearF == enbvClearFYes)
-        {
-            clearForceBuffer(nbat, nb);
+/*! \brief Runs the non-bonded N versus M atom cluster CPU kernel for one pair list
+ *
+ * Only output buffer \p nb of \p nbat is written, so this can be called
+ * concurrently for different lists.
+ *
+ * \param[in]     pairlist      The pair list
+ * \param[in]     nb            The index of the list and of the output buffer
+ * \param[in]     kernelSetup   The non-bonded kernel setup
+ * \param[in]     coulkt        The Coulomb kernel type index
+ * \param[in]     vdwkt         The Van der Waals kernel type index
+ * \param[in,out] nbat          The atomdata for the interactions
+ * \param[in]     ic            Non-bonded interaction constants
+ * \param[in]     shiftVectors  The PBC shift vectors
+ * \param[in]     stepWork      Flags that tell what to compute
+ */
+static void nbnxn_kernel_cpu_list(const NbnxnPairlistCpu&    pairlist,
+                                  const int                  nb,
+                                  const Nbnxm::KernelSetup&  kernelSetup,
+                                  const int                  coulkt,
+                                  const int                  vdwkt,
+                                  nbnxn_atomdata_t*          nbat,
+                                  const interaction_const_t& ic,
+                                  rvec*                      shiftVectors,
+                                  const gmx::StepWorkload&   stepWork)
+{
+    const nbnxn_atomdata_t::Params& nbatParams = nbat->params();
 
-            clear_fshift(out->fshift.data());
-        }
+    nbnxn_atomdata_output_t* out = &nbat->out[nb];
 
-        if (nb == 0)
+    if (!stepWork.computeEnergy)
+    {
+        /* Don't calculate energies */
+        switch (kernelSetup.kernelType)
         {
-            wallcycle_sub_stop(wcycle, ewcsNONBONDED_CLEAR);
-            wallcycle_sub_start(wcycle, ewcsNONBONDED_KERNEL);
+            case Nbnxm::KernelType::Cpu4x4_PlainC:
+                nbnxn_kernel_noener_ref[coulkt][vdwkt](&pairlist, nbat, &ic, shiftVectors, out);
+                break;
+#ifdef GMX_NBNXN_SIMD_2XNN
+            case Nbnxm::KernelType::Cpu4xN_Simd_2xNN:
+                nbnxm_kernel_noener_simd_2xmm[coulkt][vdwkt](&pairlist, nbat, &ic, shiftVectors, out);
+                break;
+#endif
+#ifdef GMX_NBNXN_SIMD_4XN
+            case Nbnxm::KernelType::Cpu4xN_Simd_4xN:
+                nbnxm_kernel_noener_simd_4xm[coulkt][vdwkt](&pairlist, nbat, &ic, shiftVectors, out);
+                break;
+#endif
+            default: GMX_RELEASE_ASSERT(false, "Unsupported kernel architecture");
         }
+    }
+    else if (out->Vvdw.size() == 1)
+    {
+        /* A single energy group (pair) */
+        out->Vvdw[0] = 0;
+        out->Vc[0]   = 0;
 
-        // TODO: Change to reference
-        const NbnxnPairlistCpu* pairlist = &pairlists[nb];
-
-        if (!stepWork.computeEnergy)
+        switch (kernelSetup.kernelType)
         {
-            /* Don't calculate energies */
-            switch (kernelSetup.kernelType)
-            {
-                case Nbnxm::KernelType::Cpu4x4_PlainC:
-                    nbnxn_kernel_noener_ref[coulkt][vdwkt](pairlist, nbat, &ic, shiftVectors, out);
-                    break;
+            case Nbnxm::KernelType::Cpu4x4_PlainC:
+                nbnxn_kernel_ener_ref[coulkt][vdwkt](&pairlist, nbat, &ic, shiftVectors, out);
+                break;
 #ifdef GMX_NBNXN_SIMD_2XNN
-                case Nbnxm::KernelType::Cpu4xN_Simd_2xNN:
-                    nbnxm_kernel_noener_simd_2xmm[coulkt][vdwkt](pairlist, nbat, &ic, shiftVectors, out);
-                    break;
+            case Nbnxm::KernelType::Cpu4xN_Simd_2xNN:
+                nbnxm_kernel_ener_simd_2xmm[coulkt][vdwkt](&pairlist, nbat, &ic, shiftVectors, out);
+                break;
 #endif
 #ifdef GMX_NBNXN_SIMD_4XN
-                case Nbnxm::KernelType::Cpu4xN_Simd_4xN:
-                    nbnxm_kernel_noener_simd_4xm[coulkt][vdwkt](pairlist, nbat, &ic, shiftVectors, out);
-                    break;
+            case Nbnxm::KernelType::Cpu4xN_Simd_4xN:
+                nbnxm_kernel_ener_simd_4xm[coulkt][vdwkt](&pairlist, nbat, &ic, shiftVectors, out);
+                break;
 #endif
-                default: GMX_RELEASE_ASSERT(false, "Unsupported kernel architecture");
-            }
+            default: GMX_RELEASE_ASSERT(false, "Unsupported kernel architecture");
         }
-        else if (out->Vvdw.size() == 1)
-        {
-            /* A single energy group (pair) */
-            out->Vvdw[0] = 0;
-            out->Vc[0]   = 0;
+    }
+    else
+    {
+        /* Calculate energy group contributions */
+        clearGroupEnergies(out);
 
-            switch (kernelSetup.kernelType)
-            {
-                case Nbnxm::KernelType::Cpu4x4_PlainC:
-                    nbnxn_kernel_ener_ref[coulkt][vdwkt](pairlist, nbat, &ic, shiftVectors, out);
-                    break;
+        int unrollj = 0;
+
+        switch (kernelSetup.kernelType)
+        {
+            case Nbnxm::KernelType::Cpu4x4_PlainC:
+                unrollj = c_nbnxnCpuIClusterSize;
+                nbnxn_kernel_energrp_ref[coulkt][vdwkt](&pairlist, nbat, &ic, shiftVectors, out);
+                break;
 #ifdef GMX_NBNXN_SIMD_2XNN
-                case Nbnxm::KernelType::Cpu4xN_Simd_2xNN:
-                    nbnxm_kernel_ener_simd_2xmm[coulkt][vdwkt](pairlist, nbat, &ic, shiftVectors, out);
-                    break;
+            case Nbnxm::KernelType::Cpu4xN_Simd_2xNN:
+                unrollj = GMX_SIMD_REAL_WIDTH / 2;
+                nbnxm_kernel_energrp_simd_2xmm[coulkt][vdwkt](&pairlist, nbat, &ic, shiftVectors, out);
+                break;
 #endif
 #ifdef GMX_NBNXN_SIMD_4XN
-                case Nbnxm::KernelType::Cpu4xN_Simd_4xN:
-                    nbnxm_kernel_ener_simd_4xm[coulkt][vdwkt](pairlist, nbat, &ic, shiftVectors, out);
-                    break;
+            case Nbnxm::KernelType::Cpu4xN_Simd_4xN:
+                unrollj = GMX_SIMD_REAL_WIDTH;
+                nbnxm_kernel_energrp_simd_4xm[coulkt][vdwkt](&pairlist, nbat, &ic, shiftVectors, out);
+                break;
 #endif
-                default: GMX_RELEASE_ASSERT(false, "Unsupported kernel architecture");
-            }
+            default: GMX_RELEASE_ASSERT(false, "Unsupported kernel architecture");
         }
-        else
-        {
-            /* Calculate energy group contributions */
-            clearGroupEnergies(out);
-
-            int unrollj = 0;
 
-            switch (kernelSetup.kernelType)
+        if (kernelSetup.kernelType != Nbnxm::KernelType::Cpu4x4_PlainC)
+        {
+            switch (unrollj)
             {
-                case Nbnxm::KernelType::Cpu4x4_PlainC:
-                    unrollj = c_nbnxnCpuIClusterSize;
-                    nbnxn_kernel_energrp_ref[coulkt][vdwkt](pairlist, nbat, &ic, shiftVectors, out);
+                case 2:
+                    reduceGroupEnergySimdBuffers<2>(nbatParams.nenergrp, nbatParams.neg_2log, out);
                     break;
-#ifdef GMX_NBNXN_SIMD_2XNN
-                case Nbnxm::KernelType::Cpu4xN_Simd_2xNN:
-                    unrollj = GMX_SIMD_REAL_WIDTH / 2;
-                    nbnxm_kernel_energrp_simd_2xmm[coulkt][vdwkt](pairlist, nbat, &ic, shiftVectors, out);
+                case 4:
+                    reduceGroupEnergySimdBuffers<4>(nbatParams.nenergrp, nbatParams.neg_2log, out);
                     break;
-#endif
-#ifdef GMX_NBNXN_SIMD_4XN
-                case Nbnxm::KernelType::Cpu4xN_Simd_4xN:
-                    unrollj = GMX_SIMD_REAL_WIDTH;
-                    nbnxm_kernel_energrp_simd_4xm[coulkt][vdwkt](pairlist, nbat, &ic, shiftVectors, out);
+                case 8:
+                    reduceGroupEnergySimdBuffers<8>(nbatParams.nenergrp, nbatParams.neg_2log, out);
                     break;
-#endif
-                default: GMX_RELEASE_ASSERT(false, "Unsupported kernel architecture");
+                default: GMX_RELEASE_ASSERT(false, "Unsupported j-unroll size");
             }
+        }
+    }
+}
 
-            if (kernelSetup.kernelType != Nbnxm::KernelType::Cpu4x4_PlainC)
-            {
-                switch (unrollj)
-                {
-                    case 2:
-                        reduceGroupEnergySimdBuffers<2>(nbatParams.nenergrp, nbatParams.neg_2log, out);
-                        break;
-                    case 4:
-                        reduceGroupEnergySimdBuffers<4>(nbatParams.nenergrp, nbatParams.neg_2log, out);
-                        break;
-                    case 8:
-                        reduceGroupEnergySimdBuffers<8>(nbatParams.nenergrp, nbatParams.neg_2log, out);
-                        break;
-                    default: GMX_RELEASE_ASSERT(false, "Unsupported j-unroll size");
-                }
-            }
+/*! \brief Dispatches the non-bonded N versus M atom cluster CPU kernels.
+ *
+ * OpenMP parallelization is performed within this function.
+ * Energy reduction, but not force and shift force reduction, is performed
+ * within this function.
+ *
+ * \param[in]     pairlistSet   Pairlists with local or non-local interactions to compute
+ * \param[in]     kernelSetup   The non-bonded kernel setup
+ * \param[in,out] nbat          The atomdata for the interactions
+ * \param[in]     ic            Non-bonded interaction constants
+ * \param[in]     shiftVectors  The PBC shift vectors
+ * \param[in]     stepWork      Flags that tell what to compute
+ * \param[in]     clearF        Enum that tells if to clear the force output buffer
+ * \param[out]    vCoulomb      Output buffer for Coulomb energies
+ * \param[out]    vVdw          Output buffer for Van der Waals energies
+ * \param[in]     wcycle        Pointer to cycle counting data structure.
+ */
+static void nbnxn_kernel_cpu(const PairlistSet&         pairlistSet,
+                             const Nbnxm::KernelSetup&  kernelSetup,
+                             nbnxn_atomdata_t*          nbat,
+                             const interaction_const_t& ic,
+                             rvec*                      shiftVectors,
+                             const gmx::StepWorkload&   stepWork,
+                             int                        clearF,
+                             real*                      vCoulomb,
+                             real*                      vVdw,
+                             gmx_wallcycle*             wcycle)
+{
+    const int coulkt = getCoulombKernelType(ic, kernelSetup);
+    const int vdwkt  = getVdwKernelType(ic, kernelSetup, nbat->params());
+
+    gmx::ArrayRef<const NbnxnPairlistCpu> pairlists = pairlistSet.cpuLists();
+
+    int gmx_unused nthreads = gmx_omp_nthreads_get(emntNonbonded);
+    wallcycle_sub_start(wcycle, ewcsNONBONDED_CLEAR);
+#pragma omp parallel for schedule(static) num_threads(nthreads)
+    for (gmx::index nb = 0; nb < pairlists.ssize(); nb++)
+    {
+        // Presently, the kernels do not call C++ code that can throw,
+        // so no need for a try/catch pair in this OpenMP region.
+        if (clearF == enbvClearFYes)
+        {
+            clearForceBuffer(nbat, nb);
+
+            clear_fshift(nbat->out[nb].fshift.data());
         }
+
+        if (nb == 0)
+        {
+            wallcycle_sub_stop(wcycle, ewcsNONBONDED_CLEAR);
+            wallcycle_sub_start(wcycle, ewcsNONBONDED_KERNEL);
+        }
+
+        nbnxn_kernel_cpu_list(pairlists[nb], nb, kernelSetup, coulkt, vdwkt, nbat, ic, shiftVectors,
+                              stepWork);
     }
     wallcycle_sub_stop(wcycle, ewcsNONBONDED_KERNEL);
 
@@ -454,6 +502,55 @@ void nonbonded_verlet_t::dispatchNonbondedKernel(gmx::InteractionLocality   iLoc
     accountFlops(nrnb, pairlistSet, *this, ic, stepWork);
 }
 
+int nonbonded_verlet_t::numCpuKernelTasks(const gmx::InteractionLocality iLocality) const
+{
+    GMX_ASSERT(!useGpu() && !emulateGpu(), "Kernel tasks are only supported with CPU kernels");
+
+    return pairlistSets().pairlistSet(iLocality).cpuLists().ssize();
+}
+
+void nonbonded_verlet_t::computeCpuKernelTask(const gmx::InteractionLocality iLocality,
+                                              const interaction_const_t&     ic,
+                                              const gmx::StepWorkload&       stepWork,
+                                              const int                      clearF,
+                                              const t_forcerec&              fr,
+                                              const int                      task)
+{
+    gmx::ArrayRef<const NbnxnPairlistCpu> pairlists =
+            pairlistSets().pairlistSet(iLocality).cpuLists();
+
+    if (clearF == enbvClearFYes)
+    {
+        clearForceBuffer(nbat.get(), task);
+
+        clear_fshift(nbat->out[task].fshift.data());
+    }
+
+    nbnxn_kernel_cpu_list(pairlists[task], task, kernelSetup(), getCoulombKernelType(ic, kernelSetup()),
+                          getVdwKernelType(ic, kernelSetup(), nbat->params()), nbat.get(), ic,
+                          fr.shift_vec, stepWork);
+}
+
+void nonbonded_verlet_t::reduceCpuKernelTasks(const gmx::InteractionLocality iLocality,
+                                              const interaction_const_t&     ic,
+                                              const gmx::StepWorkload&       stepWork,
+                                              const t_forcerec&              fr,
+                                              gmx_enerdata_t*                enerd,
+                                              t_nrnb*                        nrnb)
+{
+    const PairlistSet& pairlistSet = pairlistSets().pairlistSet(iLocality);
+
+    if (stepWork.computeEnergy)
+    {
+        reduce_energies_over_lists(
+                nbat.get(), pairlistSet.cpuLists().ssize(),
+                fr.bBHAM ? enerd->grpp.ener[egBHAMSR].data() : enerd->grpp.ener[egLJSR].data(),
+                enerd->grpp.ener[egCOULSR].data());
+    }
+
+    accountFlops(nrnb, pairlistSet, *this, ic, stepWork);
+}
+
 void nonbonded_verlet_t::dispatchFreeEnergyKernel(gmx::InteractionLocality   iLocality,
                                                   const t_forcerec*          fr,
                                                   rvec                       x[],
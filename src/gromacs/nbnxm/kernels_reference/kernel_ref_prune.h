@@ -51,7 +51,7 @@ struct NbnxnPairlistCpu;
 
 /*! \brief Prune a single NbnxnPairlistCpu entry with distance \p rlistInner
  *
- * Reads a cluster pairlist \p nbl->ciOuter, \p nbl->cjOuter and writes
+ * Reads the compact cluster pairlist \p nbl->ciOuter, \p nbl->cjOuterPacked and writes
  * all cluster pairs within \p rlistInner to \p nbl->ci, \p nbl->cj.
  */
 void nbnxn_kernel_prune_ref(NbnxnPairlistCpu*       nbl,
@@ -58,13 +58,16 @@ void nbnxn_kernel_prune_2xnn(NbnxnPairlistCpu*       nbl,
 
     /* We avoid push_back() for efficiency reasons and resize after filling */
     nbl->ci.resize(nbl->ciOuter.size());
-    nbl->cj.resize(nbl->cjOuter.size());
+    /* The compact outer list has at least one word per j-cluster */
+    nbl->cj.resize(nbl->cjOuterPacked.size());
 
     const nbnxn_ci_t* gmx_restrict ciOuter = nbl->ciOuter.data();
     nbnxn_ci_t* gmx_restrict ciInner       = nbl->ci.data();
 
-    const nbnxn_cj_t* gmx_restrict cjOuter = nbl->cjOuter.data();
-    nbnxn_cj_t* gmx_restrict cjInner       = nbl->cj.data();
+    const uint16_t* gmx_restrict cjOuterPacked   = nbl->cjOuterPacked.data();
+    const unsigned int* gmx_restrict cjOuterExcl = nbl->cjOuterExcl.data();
+    const int* gmx_restrict ciOuterExclStart     = nbl->ciOuterExclStart.data();
+    nbnxn_cj_t* gmx_restrict cjInner             = nbl->cj.data();
 
     const real* gmx_restrict shiftvec = shift_vec[0];
     const real* gmx_restrict x        = nbat->x().data();
@@ -109,10 +112,15 @@ void nbnxn_kernel_prune_2xnn(NbnxnPairlistCpu*       nbl,
         SimdReal iz_S0 = loadU1DualHsimd(x + sciz) + shZ_S;
         SimdReal iz_S2 = loadU1DualHsimd(x + sciz + 2) + shZ_S;
 
-        for (int cjind = ciEntry->cj_ind_start; cjind < ciEntry->cj_ind_end; cjind++)
+        /* The j-entries with exclusions come first, their masks are stored in order */
+        const unsigned int* gmx_restrict exclEntry = cjOuterExcl + ciOuterExclStart[i];
+        const int                        numExcl   = ciOuterExclStart[i + 1] - ciOuterExclStart[i];
+
+        int cj = compactCjBase(*nbl, ci);
+        for (int pos = ciEntry->cj_ind_start, j = 0; pos < ciEntry->cj_ind_end; j++)
         {
             /* j-cluster index */
-            int cj = cjOuter[cjind].cj;
+            cj = decodeCompactCj(cjOuterPacked, &pos, cj);
 
             /* Atom indices (of the first atom in the cluster) */
 #    if UNROLLJ == STRIDE
@@ -148,7 +156,8 @@ void nbnxn_kernel_prune_2xnn(NbnxnPairlistCpu*       nbl,
             wco_S0 = wco_S0 || wco_S2;
 
             /* Putting the assignment inside the conditional is slower */
-            cjInner[ncjInner] = cjOuter[cjind];
+            cjInner[ncjInner].cj   = cj;
+            cjInner[ncjInner].excl = (j < numExcl ? exclEntry[j] : NBNXN_INTERACTION_MASK_ALL);
             if (anyTrue(wco_S0))
             {
                 ncjInner++;
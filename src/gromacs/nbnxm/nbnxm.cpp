@@ -119,6 +119,11 @@ void nonbonded_verlet_t::setLocalAtomOrder()
     pairSearch_->setLocalAtomOrder();
 }
 
+void nonbonded_verlet_t::setLocalAtomOrder(gmx::ArrayRef<const int> newAtomIndex)
+{
+    pairSearch_->setLocalAtomOrder(newAtomIndex);
+}
+
 void nonbonded_verlet_t::setAtomProperties(gmx::ArrayRef<const int>  atomTypes,
                                            gmx::ArrayRef<const real> atomCharges,
                                            gmx::ArrayRef<const int>  atomInfo)
@@ -238,6 +243,11 @@ void nonbonded_verlet_t::changePairlistRadii(real rlistOuter, real rlistInner)
     pairlistSets_->changePairlistRadii(rlistOuter, rlistInner);
 }
 
+void nonbonded_verlet_t::changePairlistParams(const PairlistParams& params)
+{
+    pairlistSets_->changePairlistParams(params);
+}
+
 void nonbonded_verlet_t::setupGpuShortRangeWork(const gmx::GpuBonded*          gpuBonded,
                                                 const gmx::InteractionLocality iLocality)
 {
@@ -132,6 +132,7 @@ struct nbnxn_atomdata_t;
 struct nonbonded_verlet_t;
 class PairSearch;
 class PairlistSets;
+struct PairlistParams;
 struct t_commrec;
 struct t_lambda;
 struct t_mdatoms;
@@ -245,6 +246,9 @@ public:
     //! Sets the order of the local atoms to the order grid atom ordering
     void setLocalAtomOrder();
 
+    //! Renumbers the local atoms on the home grid, \p newAtomIndex gives the new index for each local atom
+    void setLocalAtomOrder(gmx::ArrayRef<const int> newAtomIndex);
+
     //! Returns the index position of the atoms on the search grid
     gmx::ArrayRef<const int> getGridIndices() const;
 
@@ -324,6 +328,35 @@ public:
                                  gmx_enerdata_t*            enerd,
                                  t_nrnb*                    nrnb);
 
+    /*! \brief Returns the number of CPU non-bonded kernel tasks, one per pair list
+     *
+     * As an alternative to dispatchNonbondedKernel(), the CPU kernel
+     * can be run as tasks, which can be interleaved with other work.
+     * Call computeCpuKernelTask() for each task and then
+     * reduceCpuKernelTasks().
+     */
+    int numCpuKernelTasks(gmx::InteractionLocality iLocality) const;
+
+    /*! \brief Computes CPU non-bonded kernel task \p task
+     *
+     * Only writes to the output buffer of task, so different tasks can
+     * be computed concurrently by different threads.
+     */
+    void computeCpuKernelTask(gmx::InteractionLocality   iLocality,
+                              const interaction_const_t& ic,
+                              const gmx::StepWorkload&   stepWork,
+                              int                        clearF,
+                              const t_forcerec&          fr,
+                              int                        task);
+
+    //! Reduces the energies and counts the flops of all CPU non-bonded kernel tasks
+    void reduceCpuKernelTasks(gmx::InteractionLocality   iLocality,
+                              const interaction_const_t& ic,
+                              const gmx::StepWorkload&   stepWork,
+                              const t_forcerec&          fr,
+                              gmx_enerdata_t*            enerd,
+                              t_nrnb*                    nrnb);
+
     //! Executes the non-bonded free-energy kernel, always runs on the CPU
     void dispatchFreeEnergyKernel(gmx::InteractionLocality   iLocality,
                                   const t_forcerec*          fr,
@@ -379,6 +412,9 @@ public:
     //! Changes the pair-list outer and inner radius
     void changePairlistRadii(real rlistOuter, real rlistInner);
 
+    //! Changes the pair-list lifetime, radii and dynamic pruning setup
+    void changePairlistParams(const PairlistParams& params);
+
     //! Set up internal flags that indicate what type of short-range work there is.
     void setupGpuShortRangeWork(const gmx::GpuBonded* gpuBonded, gmx::InteractionLocality iLocality);
 
@@ -1477,6 +1477,12 @@ const int max_nrj_fep = 40;
  * singularities for overlapping particles (0/0), since the charges and
  * LJ parameters have been zeroed in the nbnxn data structure.
  * Simultaneously make a group pair list for the perturbed pairs.
+ *
+ * The perturbation masks and energy groups of the j-clusters do not depend
+ * on the i-atom, so we pre-collect, once per i-entry, the j-clusters that
+ * take part in perturbed interactions together with their perturbation mask.
+ * The loop over the i-atoms then only visits these clusters. The output is
+ * still the atom-pair list that the free-energy kernel consumes.
  */
 static void make_fep_list(gmx::ArrayRef<const int> atomIndices,
                           const nbnxn_atomdata_t*  nbat,
@@ -1511,17 +1517,6 @@ static void make_fep_list(gmx::ArrayRef<const int> atomIndices,
     cj_ind_start = nbl_ci->cj_ind_start;
     cj_ind_end   = nbl_ci->cj_ind_end;
 
-    /* In worst case we have alternating energy groups
-     * and create #atom-pair lists, which means we need the size
-     * of a cluster pair (na_ci*na_cj) times the number of cj's.
-     */
-    nri_max = nbl->na_ci * nbl->na_cj * (cj_ind_end - cj_ind_start);
-    if (nlist->nri + nri_max > nlist->maxnri)
-    {
-        nlist->maxnri = over_alloc_large(nlist->nri + nri_max);
-        reallocate_nblist(nlist);
-    }
-
     const int numAtomsJCluster = jGrid.geometry().numAtomsJCluster;
 
     const nbnxn_atomdata_t::Params& nbatParams = nbat->params();
@@ -1542,6 +1537,79 @@ static void make_fep_list(gmx::ArrayRef<const int> atomIndices,
     egp_shift = nbatParams.neg_2log;
     egp_mask  = (1 << egp_shift) - 1;
 
+    /* With perturbed i-atoms we need all j-clusters, otherwise only
+     * the j-clusters that contain perturbed atoms.
+     */
+    const bool haveFepI = (iGrid.fepBits(ci - iGrid.cellOffset()) != 0U);
+
+    std::vector<NbnxnPairlistCpuWork::FepJCluster>& fepJClusters = nbl->work->fepJClusters;
+    fepJClusters.clear();
+    for (int cj_ind = cj_ind_start; cj_ind < cj_ind_end; cj_ind++)
+    {
+        unsigned int fep_cj;
+
+        cja = nbl->cj[cj_ind].cj;
+
+        if (numAtomsJCluster == jGrid.geometry().numAtomsICluster)
+        {
+            cjr    = cja - jGrid.cellOffset();
+            fep_cj = jGrid.fepBits(cjr);
+            if (ngid > 1)
+            {
+                gid_cj = nbatParams.energrp[cja];
+            }
+        }
+        else if (2 * numAtomsJCluster == jGrid.geometry().numAtomsICluster)
+        {
+            cjr = cja - jGrid.cellOffset() * 2;
+            /* Extract half of the ci fep/energrp mask */
+            fep_cj = (jGrid.fepBits(cjr >> 1) >> ((cjr & 1) * numAtomsJCluster))
+                     & ((1 << numAtomsJCluster) - 1);
+            if (ngid > 1)
+            {
+                gid_cj = nbatParams.energrp[cja >> 1] >> ((cja & 1) * numAtomsJCluster * egp_shift)
+                         & ((1 << (numAtomsJCluster * egp_shift)) - 1);
+            }
+        }
+        else
+        {
+            cjr = cja - (jGrid.cellOffset() >> 1);
+            /* Combine two ci fep masks/energrp */
+            fep_cj = jGrid.fepBits(cjr * 2)
+                     + (jGrid.fepBits(cjr * 2 + 1) << jGrid.geometry().numAtomsICluster);
+            if (ngid > 1)
+            {
+                gid_cj = nbatParams.energrp[cja * 2]
+                         + (nbatParams.energrp[cja * 2 + 1]
+                            << (jGrid.geometry().numAtomsICluster * egp_shift));
+            }
+        }
+
+        if (haveFepI || fep_cj != 0)
+        {
+            fepJClusters.push_back({ cj_ind, fep_cj, gid_cj });
+        }
+    }
+
+    if (fepJClusters.empty())
+    {
+        /* No perturbed interactions in this entry */
+        return;
+    }
+
+    const int numFepJClusters = gmx::ssize(fepJClusters);
+
+    /* In worst case we have alternating energy groups
+     * and create #atom-pair lists, which means we need the size
+     * of a cluster pair (na_ci*na_cj) times the number of cj's.
+     */
+    nri_max = nbl->na_ci * nbl->na_cj * numFepJClusters;
+    if (nlist->nri + nri_max > nlist->maxnri)
+    {
+        nlist->maxnri = over_alloc_large(nlist->nri + nri_max);
+        reallocate_nblist(nlist);
+    }
+
     /* Loop over the atoms in the i sub-cell */
     bFEP_i_all = TRUE;
     for (int i = 0; i < nbl->na_ci; i++)
@@ -1561,9 +1629,9 @@ static void make_fep_list(gmx::ArrayRef<const int> atomIndices,
 
             bFEP_i_all = bFEP_i_all && bFEP_i;
 
-            if (nlist->nrj + (cj_ind_end - cj_ind_start) * nbl->na_cj > nlist->maxnrj)
+            if (nlist->nrj + numFepJClusters * nbl->na_cj > nlist->maxnrj)
             {
-                nlist->maxnrj = over_alloc_small(nlist->nrj + (cj_ind_end - cj_ind_start) * nbl->na_cj);
+                nlist->maxnrj = over_alloc_small(nlist->nrj + numFepJClusters * nbl->na_cj);
                 srenew(nlist->jjnr, nlist->maxnrj);
                 srenew(nlist->excl_fep, nlist->maxnrj);
             }
@@ -1573,89 +1641,58 @@ static void make_fep_list(gmx::ArrayRef<const int> atomIndices,
                 gid_i = (nbatParams.energrp[ci] >> (egp_shift * i)) & egp_mask;
             }
 
-            for (int cj_ind = cj_ind_start; cj_ind < cj_ind_end; cj_ind++)
+            for (const NbnxnPairlistCpuWork::FepJCluster& fepJCluster : fepJClusters)
             {
-                unsigned int fep_cj;
-
-                cja = nbl->cj[cj_ind].cj;
+                const unsigned int fep_cj = fepJCluster.fepMask;
 
-                if (numAtomsJCluster == jGrid.geometry().numAtomsICluster)
-                {
-                    cjr    = cja - jGrid.cellOffset();
-                    fep_cj = jGrid.fepBits(cjr);
-                    if (ngid > 1)
-                    {
-                        gid_cj = nbatParams.energrp[cja];
-                    }
-                }
-                else if (2 * numAtomsJCluster == jGrid.geometry().numAtomsICluster)
+                if (!bFEP_i && fep_cj == 0)
                 {
-                    cjr = cja - jGrid.cellOffset() * 2;
-                    /* Extract half of the ci fep/energrp mask */
-                    fep_cj = (jGrid.fepBits(cjr >> 1) >> ((cjr & 1) * numAtomsJCluster))
-                             & ((1 << numAtomsJCluster) - 1);
-                    if (ngid > 1)
-                    {
-                        gid_cj = nbatParams.energrp[cja >> 1] >> ((cja & 1) * numAtomsJCluster * egp_shift)
-                                 & ((1 << (numAtomsJCluster * egp_shift)) - 1);
-                    }
-                }
-                else
-                {
-                    cjr = cja - (jGrid.cellOffset() >> 1);
-                    /* Combine two ci fep masks/energrp */
-                    fep_cj = jGrid.fepBits(cjr * 2)
-                             + (jGrid.fepBits(cjr * 2 + 1) << jGrid.geometry().numAtomsICluster);
-                    if (ngid > 1)
-                    {
-                        gid_cj = nbatParams.energrp[cja * 2]
-                                 + (nbatParams.energrp[cja * 2 + 1]
-                                    << (jGrid.geometry().numAtomsICluster * egp_shift));
-                    }
+                    /* Only present because of other, perturbed, i-atoms */
+                    continue;
                 }
 
-                if (bFEP_i || fep_cj != 0)
+                const int cj_ind = fepJCluster.cjIndex;
+                cja              = nbl->cj[cj_ind].cj;
+                gid_cj           = fepJCluster.energyGroups;
+
+                for (int j = 0; j < nbl->na_cj; j++)
                 {
-                    for (int j = 0; j < nbl->na_cj; j++)
+                    /* Is this interaction perturbed and not excluded? */
+                    ind_j = cja * nbl->na_cj + j;
+                    aj    = atomIndices[ind_j];
+                    if (aj >= 0 && (bFEP_i || (fep_cj & (1 << j))) && (!bDiagRemoved || ind_j >= ind_i))
                     {
-                        /* Is this interaction perturbed and not excluded? */
-                        ind_j = cja * nbl->na_cj + j;
-                        aj    = atomIndices[ind_j];
-                        if (aj >= 0 && (bFEP_i || (fep_cj & (1 << j))) && (!bDiagRemoved || ind_j >= ind_i))
+                        if (ngid > 1)
                         {
-                            if (ngid > 1)
-                            {
-                                gid_j = (gid_cj >> (j * egp_shift)) & egp_mask;
-                                gid   = GID(gid_i, gid_j, ngid);
-
-                                if (nlist->nrj > nlist->jindex[nri] && nlist->gid[nri] != gid)
-                                {
-                                    /* Energy group pair changed: new list */
-                                    fep_list_new_nri_copy(nlist);
-                                    nri = nlist->nri;
-                                }
-                                nlist->gid[nri] = gid;
-                            }
+                            gid_j = (gid_cj >> (j * egp_shift)) & egp_mask;
+                            gid   = GID(gid_i, gid_j, ngid);
 
-                            if (nlist->nrj - nlist->jindex[nri] >= max_nrj_fep)
+                            if (nlist->nrj > nlist->jindex[nri] && nlist->gid[nri] != gid)
                             {
+                                /* Energy group pair changed: new list */
                                 fep_list_new_nri_copy(nlist);
                                 nri = nlist->nri;
                             }
+                            nlist->gid[nri] = gid;
+                        }
 
-                            /* Add it to the FEP list */
-                            nlist->jjnr[nlist->nrj] = aj;
-                            nlist->excl_fep[nlist->nrj] =
-                                    (nbl->cj[cj_ind].excl >> (i * nbl->na_cj + j)) & 1;
-                            nlist->nrj++;
-
-                            /* Exclude it from the normal list.
-                             * Note that the charge has been set to zero,
-                             * but we need to avoid 0/0, as perturbed atoms
-                             * can be on top of each other.
-                             */
-                            nbl->cj[cj_ind].excl &= ~(1U << (i * nbl->na_cj + j));
+                        if (nlist->nrj - nlist->jindex[nri] >= max_nrj_fep)
+                        {
+                            fep_list_new_nri_copy(nlist);
+                            nri = nlist->nri;
                         }
+
+                        /* Add it to the FEP list */
+                        nlist->jjnr[nlist->nrj]     = aj;
+                        nlist->excl_fep[nlist->nrj] = (nbl->cj[cj_ind].excl >> (i * nbl->na_cj + j)) & 1;
+                        nlist->nrj++;
+
+                        /* Exclude it from the normal list.
+                         * Note that the charge has been set to zero,
+                         * but we need to avoid 0/0, as perturbed atoms
+                         * can be on top of each other.
+                         */
+                        nbl->cj[cj_ind].excl &= ~(1U << (i * nbl->na_cj + j));
                     }
                 }
             }
@@ -2210,7 +2247,9 @@ static void clear_pairlist(NbnxnPairlistCpu* nbl)
     nbl->ncjInUse = 0;
     nbl->nci_tot  = 0;
     nbl->ciOuter.clear();
-    nbl->cjOuter.clear();
+    nbl->cjOuterPacked.clear();
+    nbl->cjOuterExcl.clear();
+    nbl->ciOuterExclStart.clear();
 
     nbl->work->ncj_noq = 0;
     nbl->work->ncj_hlj = 0;
@@ -3597,6 +3636,42 @@ static void reduce_buffer_flags(gmx::ArrayRef<PairsearchWork> searchWork,
     }
 }
 
+/*! \brief Sets the flag block ranges each thread reduces to the blocks of its own i-clusters
+ *
+ * This is only possible when each list has a contiguous range of i-clusters,
+ * ordered along with the list index, as is the case without domain decomposition.
+ * Otherwise the ranges are cleared, which gives an equal division of the blocks.
+ */
+static void setReductionBlockRanges(gmx::ArrayRef<const NbnxnPairlistCpu> lists,
+                                    const bool                            haveMultipleDomains,
+                                    nbnxn_atomdata_t*                     nbat)
+{
+    std::vector<int>& blockRanges = nbat->reductionBlockRanges;
+
+    if (haveMultipleDomains || lists.size() != nbat->out.size())
+    {
+        blockRanges.clear();
+        return;
+    }
+
+    const int numBlocks = gmx::ssize(nbat->buffer_flags);
+    const int numLists  = gmx::ssize(lists);
+
+    blockRanges.resize(numLists + 1);
+    blockRanges[0] = 0;
+    for (int t = 1; t < numLists; t++)
+    {
+        int blockStart = blockRanges[t - 1];
+        if (!lists[t].ci.empty())
+        {
+            blockStart = (lists[t].ci.front().ci * lists[t].na_ci) / NBNXN_BUFFERFLAG_SIZE;
+        }
+        /* Ensure a valid partitioning, also for lists with overlapping ranges */
+        blockRanges[t] = std::min(std::max(blockStart, blockRanges[t - 1]), numBlocks);
+    }
+    blockRanges[numLists] = numBlocks;
+}
+
 static void print_reduction_cost(gmx::ArrayRef<const gmx_bitmask_t> flags, int nout)
 {
     int           nelem, nkeep, ncopy, nred, out;
@@ -4133,6 +4208,11 @@ void PairlistSet::constructPairlists(const Nbnxm::GridSet&         gridSet,
     if (nbat->bUseBufferFlags)
     {
         reduce_buffer_flags(searchWork, numLists, nbat->buffer_flags);
+
+        if (isCpuType_ && locality_ == InteractionLocality::Local)
+        {
+            setReductionBlockRanges(cpuLists_, gridSet.domainSetup().haveMultipleDomains, nbat);
+        }
     }
 
     if (gridSet.haveFep())
@@ -4259,6 +4339,66 @@ void nonbonded_verlet_t::constructPairlist(const InteractionLocality iLocality,
     }
 }
 
+/* Moves the j-list in cj produced by the search to the compact outer list
+ * cjOuterPacked, cjOuterExcl, see c_compactCjEscape, and sets the j-ranges
+ * of the i-entries in ciOuter to index the compact list.
+ */
+static void packOuterList(NbnxnPairlistCpu* nbl)
+{
+    const nbnxn_cj_t* cj = nbl->cj.data();
+
+    /* Each j-entry takes at most 3 words */
+    nbl->cjOuterPacked.resize(3 * nbl->cj.size());
+    uint16_t* packed = nbl->cjOuterPacked.data();
+
+    nbl->cjOuterExcl.clear();
+    nbl->ciOuterExclStart.resize(nbl->ciOuter.size() + 1);
+
+    int pos = 0;
+    for (size_t i = 0; i < nbl->ciOuter.size(); i++)
+    {
+        nbnxn_ci_t& ciEntry = nbl->ciOuter[i];
+
+        /* Entries with exclusions are sorted to the start of the i-entry */
+        nbl->ciOuterExclStart[i] = nbl->cjOuterExcl.size();
+        int cjind                = ciEntry.cj_ind_start;
+        while (cjind < ciEntry.cj_ind_end && cj[cjind].excl != NBNXN_INTERACTION_MASK_ALL)
+        {
+            nbl->cjOuterExcl.push_back(cj[cjind].excl);
+            cjind++;
+        }
+
+        const int gmx_unused cjIndExclEnd = cjind;
+
+        int       cjPrev     = compactCjBase(*nbl, ciEntry.ci);
+        const int cjIndStart = pos;
+        for (cjind = ciEntry.cj_ind_start; cjind < ciEntry.cj_ind_end; cjind++)
+        {
+            GMX_ASSERT(cjind < cjIndExclEnd || cj[cjind].excl == NBNXN_INTERACTION_MASK_ALL,
+                       "j-entries with exclusions should come first");
+
+            const int delta = cj[cjind].cj - cjPrev;
+            if (delta > INT16_MIN && delta <= INT16_MAX)
+            {
+                packed[pos++] = static_cast<uint16_t>(delta);
+            }
+            else
+            {
+                packed[pos++] = c_compactCjEscape;
+                packed[pos++] = static_cast<uint16_t>(cj[cjind].cj & 0xffff);
+                packed[pos++] = static_cast<uint16_t>(cj[cjind].cj >> 16);
+            }
+            cjPrev = cj[cjind].cj;
+        }
+        ciEntry.cj_ind_start = cjIndStart;
+        ciEntry.cj_ind_end   = pos;
+    }
+    nbl->ciOuterExclStart[nbl->ciOuter.size()] = nbl->cjOuterExcl.size();
+
+    nbl->cjOuterPacked.resize(pos);
+    nbl->cj.clear();
+}
+
 static void prepareListsForDynamicPruning(gmx::ArrayRef<NbnxnPairlistCpu> lists)
 {
     /* TODO: Restructure the lists so we have actual outer and inner
@@ -4266,16 +4406,24 @@ static void prepareListsForDynamicPruning(gmx::ArrayRef<NbnxnPairlistCpu> lists)
      *       swapping several pointers.
      */
 
-    for (auto& list : lists)
+    const int numLists = lists.ssize();
+#pragma omp parallel for schedule(static) num_threads(numLists)
+    for (int th = 0; th < numLists; th++)
     {
-        /* The search produced a list in ci/cj.
-         * Swap the list pointers so we get the outer list is ciOuter,cjOuter
-         * and we can prune that to get an inner list in ci/cj.
-         */
-        GMX_RELEASE_ASSERT(list.ciOuter.empty() && list.cjOuter.empty(),
-                           "The outer lists should be empty before preparation");
+        try
+        {
+            NbnxnPairlistCpu& list = lists[th];
 
-        std::swap(list.ci, list.ciOuter);
-        std::swap(list.cj, list.cjOuter);
+            /* The search produced a list in ci/cj.
+             * Move it to the compact outer list in ciOuter,cjOuterPacked
+             * so we can prune that to get an inner list in ci/cj.
+             */
+            GMX_RELEASE_ASSERT(list.ciOuter.empty() && list.cjOuterPacked.empty(),
+                               "The outer lists should be empty before preparation");
+
+            std::swap(list.ci, list.ciOuter);
+            packOuterList(&list);
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
     }
 }
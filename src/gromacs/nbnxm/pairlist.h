@@ -38,6 +38,7 @@
 #define GMX_NBNXM_PAIRLIST_H
 
 #include <cstddef>
+#include <cstdint>
 
 #include "gromacs/gpu_utils/hostallocator.h"
 #include "gromacs/math/vectypes.h"
@@ -238,13 +239,17 @@ struct NbnxnPairlistCpu
     real rlist;
     //! The i-cluster list
     FastVector<nbnxn_ci_t> ci;
-    //! The outer, unpruned i-cluster list
+    //! The outer, unpruned i-cluster list, cj_ind_start/end index cjOuterPacked
     FastVector<nbnxn_ci_t> ciOuter;
 
     //! The j-cluster list, size ncj
     FastVector<nbnxn_cj_t> cj;
-    //! The outer, unpruned j-cluster list
-    FastVector<nbnxn_cj_t> cjOuter;
+    //! The outer, unpruned j-cluster list in compact form, decode with decodeCompactCj()
+    FastVector<uint16_t> cjOuterPacked;
+    //! The exclusion masks of the leading j-entries with exclusions in the outer i-entries
+    FastVector<unsigned int> cjOuterExcl;
+    //! Start index into cjOuterExcl for each outer i-entry, size ciOuter.size() + 1
+    FastVector<int> ciOuterExclStart;
     //! The number of j-clusters that are used by ci entries in this list, will be <= cj.size()
     int ncjInUse;
 
@@ -258,6 +263,38 @@ struct NbnxnPairlistCpu
     gmx_cache_protect_t cp1;
 };
 
+/*! \brief Escape value in the compact outer j-cluster list of NbnxnPairlistCpu
+ *
+ * With dynamic pruning the outer list is only read by the prune kernels.
+ * To reduce its size, a j-cluster index is stored as a 16-bit signed
+ * difference with the previous j-cluster of the same i-entry, or with
+ * compactCjBase() for the first one. Differences that do not fit are
+ * stored as this escape value, followed by the index in two 16-bit words.
+ * Only the exclusion masks of the leading j-entries with exclusions
+ * are stored, see nbnxn_cj_t.
+ */
+constexpr uint16_t c_compactCjEscape = 0x8000U;
+
+//! Returns the j-cluster that the first difference in the outer i-entry of \p ci is relative to
+static inline int compactCjBase(const NbnxnPairlistCpu& nbl, int ci)
+{
+    return (ci * nbl.na_ci) / nbl.na_cj;
+}
+
+//! Returns the j-cluster at \p *pos in \p packed, following \p cjPrev, and advances \p *pos
+static inline int decodeCompactCj(const uint16_t* packed, int* pos, int cjPrev)
+{
+    const uint16_t word = packed[(*pos)++];
+    if (word != c_compactCjEscape)
+    {
+        return cjPrev + static_cast<int16_t>(word);
+    }
+    const int cj =
+            static_cast<int>(packed[*pos] | (static_cast<uint32_t>(packed[*pos + 1]) << 16));
+    *pos += 2;
+    return cj;
+}
+
 /* Cluster pairlist type, with extra hierarchies, for on the GPU
  *
  * NOTE: for better performance when combining lists over threads,
@@ -50,18 +50,25 @@
 #include <cstdlib>
 
 #include <algorithm>
+#include <limits>
 #include <string>
+#include <vector>
 
 #include "gromacs/domdec/domdec.h"
+#include "gromacs/gmxlib/network.h"
 #include "gromacs/hardware/cpuinfo.h"
 #include "gromacs/math/vec.h"
 #include "gromacs/mdlib/calc_verletbuf.h"
 #include "gromacs/mdtypes/commrec.h"
+#include "gromacs/mdtypes/forcerec.h"
 #include "gromacs/mdtypes/inputrec.h"
 #include "gromacs/mdtypes/interaction_const.h"
 #include "gromacs/mdtypes/state.h"
+#include "gromacs/nbnxm/nbnxm.h"
 #include "gromacs/pbcutil/pbc.h"
+#include "gromacs/timing/wallcycle.h"
 #include "gromacs/topology/topology.h"
+#include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/cstringutil.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/gmxassert.h"
@@ -377,6 +384,7 @@ static const int c_nbnxnDynamicListPruningMinLifetime = 4;
 /*! \brief Set the dynamic pairlist pruning parameters in \p ic
  *
  * \param[in]     ir          The input parameter record
+ * \param[in]     nstlist     The pair-list update interval in steps
  * \param[in]     mtop        The global topology
  * \param[in]     box         The unit cell
  * \param[in]     useGpuList  Tells if we are using a GPU type pairlist
@@ -386,6 +394,7 @@ static const int c_nbnxnDynamicListPruningMinLifetime = 4;
  * \param[in,out] listParams  The list setup parameters
  */
 static void setDynamicPairlistPruningParameters(const t_inputrec*          ir,
+                                                const int                  nstlist,
                                                 const gmx_mtop_t*          mtop,
                                                 const matrix               box,
                                                 const bool                 useGpuList,
@@ -394,7 +403,7 @@ static void setDynamicPairlistPruningParameters(const t_inputrec*          ir,
                                                 const interaction_const_t* ic,
                                                 PairlistParams*            listParams)
 {
-    listParams->lifetime = ir->nstlist - 1;
+    listParams->lifetime = nstlist - 1;
 
     /* When nstlistPrune was set by the user, we need to execute one loop
      * iteration to determine rlistInner.
@@ -402,6 +411,8 @@ static void setDynamicPairlistPruningParameters(const t_inputrec*          ir,
      * we have a pairlist buffer of length 0 (i.e. rlistInner == cutoff).
      */
     const real interactionCutoff = std::max(ic->rcoulomb, ic->rvdw);
+    /* The buffer is computed for the cut-offs in ir, PME tuning can increase the cut-off */
+    const real cutoffIncrease    = interactionCutoff - std::max(ir->rcoulomb, ir->rvdw);
     int        tunedNstlistPrune = listParams->nstlistPrune;
     do
     {
@@ -412,14 +423,15 @@ static void setDynamicPairlistPruningParameters(const t_inputrec*          ir,
         int listLifetime         = tunedNstlistPrune - (useGpuList ? 0 : 1);
         listParams->nstlistPrune = tunedNstlistPrune;
         listParams->rlistInner   = calcVerletBufferSize(*mtop, det(box), *ir, tunedNstlistPrune,
-                                                      listLifetime, -1, listSetup);
+                                                      listLifetime, -1, listSetup)
+                                 + cutoffIncrease;
 
         /* On the GPU we apply the dynamic pruning in a rolling fashion
          * every c_nbnxnGpuRollingListPruningInterval steps,
          * so keep nstlistPrune a multiple of the interval.
          */
         tunedNstlistPrune += useGpuList ? c_nbnxnGpuRollingListPruningInterval : 1;
-    } while (!userSetNstlistPrune && tunedNstlistPrune < ir->nstlist
+    } while (!userSetNstlistPrune && tunedNstlistPrune < nstlist
              && listParams->rlistInner == interactionCutoff);
 
     if (userSetNstlistPrune)
@@ -534,8 +546,8 @@ void setupDynamicPairlistPruning(const gmx::MDLogger&       mdlog,
             listParams->nstlistPrune = c_nbnxnDynamicListPruningMinLifetime;
         }
 
-        setDynamicPairlistPruningParameters(ir, mtop, box, useGpuList, ls, userSetNstlistPrune, ic,
-                                            listParams);
+        setDynamicPairlistPruningParameters(ir, ir->nstlist, mtop, box, useGpuList, ls,
+                                            userSetNstlistPrune, ic, listParams);
 
         if (listParams->useDynamicPruning && useGpuList)
         {
@@ -603,3 +615,451 @@ void setupDynamicPairlistPruning(const gmx::MDLogger&       mdlog,
 
     GMX_LOG(mdlog.info).asParagraph().appendText(mesg);
 }
+
+namespace
+{
+
+//! Number of list periods to skip at the start of the run, while performance stabilizes
+const int c_numFirstTuningPeriodSkip = 5;
+//! Number of list periods to skip after switching setup, these include allocation overhead
+const int c_numPostSwitchTuningPeriodSkip = 1;
+//! Number of list periods to measure for each setup
+const int c_numTuningPeriodsPerSetup = 3;
+//! The nstlist values to try during tuning, in addition to the initial value
+const int c_nstlistTuningTry[] = { 10, 20, 25, 40, 50, 80, 100 };
+
+//! A pair-list setup to try during nstlist tuning
+struct NstlistSetup
+{
+    //! The pair-list update interval
+    int nstlist;
+    //! The pair-list radii and pruning setup for this interval
+    PairlistParams params;
+    //! The estimated cost per step, in cycles summed over ranks, the maximum value when not measured
+    double cyclesPerStep = std::numeric_limits<double>::max();
+    //! The number of list periods measured
+    int numPeriodsMeasured = 0;
+    //! The summed cycles of the measured steps without search, energies or output
+    double plainStepCycles = 0;
+    //! The number of measured steps without search, energies or output
+    int numPlainSteps = 0;
+    //! The summed search and domain decomposition cycles of the measured search steps
+    double searchCycles = 0;
+    //! The number of measured search steps
+    int numSearchSteps = 0;
+};
+
+} // namespace
+
+class NstlistTuning::Impl
+{
+public:
+    //! Constructor, see NstlistTuning
+    Impl(const gmx::MDLogger&       mdlog,
+         const t_commrec*           cr,
+         const t_inputrec&          ir,
+         const gmx_mtop_t&          mtop,
+         const matrix               box,
+         const interaction_const_t& ic,
+         const nonbonded_verlet_t&  nbv);
+
+    //! Adds the setup for \p nstlist with pruning parameters \p params and a variant with less frequent pruning
+    void addSetups(const t_inputrec&          ir,
+                   int                        nstlist,
+                   const gmx_mtop_t&          mtop,
+                   const matrix               box,
+                   const VerletbufListSetup&  listSetup,
+                   const interaction_const_t& ic,
+                   const PairlistParams&      params);
+
+    //! Tries to switch to setup \p setupIndex, returns false when the setup is not compatible with DD
+    bool switchSetup(int                            setupIndex,
+                     t_commrec*                     cr,
+                     t_inputrec*                    ir,
+                     t_forcerec*                    fr,
+                     const matrix                   box,
+                     gmx::ArrayRef<const gmx::RVec> x);
+
+    //! Switches to the fastest setup and prints the tuning results
+    void finish(FILE*                          fp_err,
+                const gmx::MDLogger&           mdlog,
+                t_commrec*                     cr,
+                t_inputrec*                    ir,
+                t_forcerec*                    fr,
+                const matrix                   box,
+                gmx::ArrayRef<const gmx::RVec> x,
+                int64_t                        step);
+
+    //! The setups to try, the first is the initial setup
+    std::vector<NstlistSetup> setups_;
+    //! The index of the setup currently in use
+    int currentSetup_ = 0;
+    //! The number of completed list periods with the current setup
+    int numPeriodsWithCurrentSetup_ = 0;
+    //! Whether we are still tuning
+    bool isActive_ = false;
+    //! Whether the steps of the current list period are recorded
+    bool isMeasuring_ = false;
+    //! The number of steps counted by the step cycle counter at the previous recordStep() call
+    int numStepsCounted_ = 0;
+    //! The search and domain decomposition cycle count at the previous recordStep() call
+    double searchCyclesCounted_ = 0;
+};
+
+void NstlistTuning::Impl::addSetups(const t_inputrec&          ir,
+                                    const int                  nstlist,
+                                    const gmx_mtop_t&          mtop,
+                                    const matrix               box,
+                                    const VerletbufListSetup&  listSetup,
+                                    const interaction_const_t& ic,
+                                    const PairlistParams&      params)
+{
+    setups_.push_back({ nstlist, params });
+
+    /* Also try pruning half as often, which gives a larger inner list */
+    const int nstlistPruneLessFrequent = 2 * params.nstlistPrune;
+    if (params.useDynamicPruning && nstlistPruneLessFrequent < nstlist - 1)
+    {
+        PairlistParams paramsLessFrequentPruning = params;
+        paramsLessFrequentPruning.nstlistPrune   = nstlistPruneLessFrequent;
+        setDynamicPairlistPruningParameters(&ir, nstlist, &mtop, box, false, listSetup, true, &ic,
+                                            &paramsLessFrequentPruning);
+        setups_.push_back({ nstlist, paramsLessFrequentPruning });
+    }
+}
+
+NstlistTuning::Impl::Impl(const gmx::MDLogger&       mdlog,
+                          const t_commrec*           cr,
+                          const t_inputrec&          ir,
+                          const gmx_mtop_t&          mtop,
+                          const matrix               box,
+                          const interaction_const_t& ic,
+                          const nonbonded_verlet_t&  nbv)
+{
+    const char* disabledMessage = nullptr;
+    if (!nbv.pairlistIsSimple())
+    {
+        disabledMessage = "it is only supported with CPU pair lists";
+    }
+    else if (!supportsDynamicPairlistGenerationInterval(ir) || ir.nstlist <= 1)
+    {
+        disabledMessage = "nstlist can not be changed with this simulation setup";
+    }
+    else if (getenv("GMX_DISABLE_DYNAMICPRUNING") != nullptr
+             || getenv("GMX_NSTLIST_DYNAMICPRUNING") != nullptr)
+    {
+        disabledMessage = "the dynamic pruning setup is set by an environment variable";
+    }
+    if (disabledMessage != nullptr)
+    {
+        GMX_LOG(mdlog.info)
+                .asParagraph()
+                .appendTextFormatted("NOTE: Not tuning nstlist, since %s.", disabledMessage);
+        return;
+    }
+
+    const PairlistParams& initialParams = nbv.pairlistSets().params();
+
+    /* The outer list buffer is set in the same way as at startup,
+     * the inner list buffer as in setupDynamicPairlistPruning().
+     */
+    const VerletbufListSetup listSetupOuter =
+            verletbufGetSafeListSetup(ListSetupType::CpuSimdWhenSupported);
+    const VerletbufListSetup listSetupInner = {
+        IClusterSizePerListType[initialParams.pairlistType],
+        JClusterSizePerListType[initialParams.pairlistType]
+    };
+
+    addSetups(ir, ir.nstlist, mtop, box, listSetupInner, ic, initialParams);
+
+    /* When PME tuning ran before, the cut-off can be larger than in ir.
+     * As in PME tuning, we then keep the buffer size computed for the cut-off in ir.
+     */
+    const real cutoffIncrease = std::max(ic.rcoulomb, ic.rvdw) - std::max(ir.rcoulomb, ir.rvdw);
+
+    for (const int nstlist : nstlistTuningCandidates(ir.nstlist, DOMAINDECOMP(cr)))
+    {
+        /* The initial setup was added above */
+        if (nstlist == ir.nstlist)
+        {
+            continue;
+        }
+
+        const real rlistOuter =
+                calcVerletBufferSize(mtop, det(box), ir, nstlist, nstlist - 1, -1, listSetupOuter)
+                + cutoffIncrease;
+        if (gmx::square(rlistOuter) >= max_cutoff2(ir.pbcType, box))
+        {
+            continue;
+        }
+
+        PairlistParams params    = initialParams;
+        params.rlistOuter        = rlistOuter;
+        params.useDynamicPruning = false;
+        params.nstlistPrune      = c_nbnxnDynamicListPruningMinLifetime;
+        setDynamicPairlistPruningParameters(&ir, nstlist, &mtop, box, false, listSetupInner, false,
+                                            &ic, &params);
+        if (!params.useDynamicPruning)
+        {
+            params.nstlistPrune = -1;
+            params.rlistInner   = params.rlistOuter;
+        }
+
+        addSetups(ir, nstlist, mtop, box, listSetupInner, ic, params);
+    }
+
+    isActive_ = (setups_.size() > 1);
+
+    if (isActive_)
+    {
+        GMX_LOG(mdlog.info)
+                .asParagraph()
+                .appendTextFormatted(
+                        "Will tune nstlist and the pruning interval at runtime, trying %zu setups",
+                        setups_.size());
+    }
+}
+
+bool NstlistTuning::Impl::switchSetup(const int                      setupIndex,
+                                      t_commrec*                     cr,
+                                      t_inputrec*                    ir,
+                                      t_forcerec*                    fr,
+                                      const matrix                   box,
+                                      gmx::ArrayRef<const gmx::RVec> x)
+{
+    const NstlistSetup& setup = setups_[setupIndex];
+
+    if (DOMAINDECOMP(cr) && !change_dd_cutoff(cr, box, x, setup.params.rlistOuter))
+    {
+        return false;
+    }
+
+    ir->nstlist = setup.nstlist;
+    fr->nbv->changePairlistParams(setup.params);
+    /* Update deprecated rlist in forcerec to stay in sync with fr->nbv */
+    fr->rlist = fr->nbv->pairlistOuterRadius();
+
+    currentSetup_               = setupIndex;
+    numPeriodsWithCurrentSetup_ = 0;
+    isMeasuring_                = false;
+
+    return true;
+}
+
+void NstlistTuning::Impl::finish(FILE*                          fp_err,
+                                 const gmx::MDLogger&           mdlog,
+                                 t_commrec*                     cr,
+                                 t_inputrec*                    ir,
+                                 t_forcerec*                    fr,
+                                 const matrix                   box,
+                                 gmx::ArrayRef<const gmx::RVec> x,
+                                 const int64_t                  step)
+{
+    isActive_    = false;
+    isMeasuring_ = false;
+
+    std::vector<double> costPerStep;
+    for (const NstlistSetup& setup : setups_)
+    {
+        costPerStep.push_back(setup.cyclesPerStep);
+    }
+    int fastest = fastestNstlistSetup(costPerStep);
+    if (!switchSetup(fastest, cr, ir, fr, box, x))
+    {
+        /* The initial setup is always compatible with DD */
+        fastest = 0;
+        switchSetup(fastest, cr, ir, fr, box, x);
+    }
+
+    const real  interactionCutoff = std::max(fr->ic->rcoulomb, fr->ic->rvdw);
+    const auto& initial           = setups_[0];
+    std::string mesg              = "Runtime tuning of nstlist and the dynamic pruning interval:\n";
+    mesg += "  nstlist  nstlistPrune  rlistOuter  rlistInner  relative cost\n";
+    for (const NstlistSetup& setup : setups_)
+    {
+        if (setup.numPeriodsMeasured > 0)
+        {
+            mesg += gmx::formatString("  %7d  %12d  %10.3f  %10.3f  %13.3f\n", setup.nstlist,
+                                      setup.params.nstlistPrune, setup.params.rlistOuter,
+                                      setup.params.rlistInner,
+                                      setup.cyclesPerStep / initial.cyclesPerStep);
+        }
+    }
+    const NstlistSetup& chosen = setups_[fastest];
+    mesg += gmx::formatString("Using nstlist %d with rlist %.3f nm (buffer %.3f nm)", chosen.nstlist,
+                              chosen.params.rlistOuter, chosen.params.rlistOuter - interactionCutoff);
+    if (chosen.params.useDynamicPruning)
+    {
+        mesg += gmx::formatString(", pruning every %d steps with rlist %.3f nm",
+                                  chosen.params.nstlistPrune, chosen.params.rlistInner);
+    }
+    GMX_LOG(mdlog.info).asParagraph().appendText(mesg);
+
+    if (fp_err != nullptr)
+    {
+        char sbuf[STEPSTRSIZE];
+        fprintf(fp_err, "\rstep %s: tuned nstlist to %d, rlist %.3f nm\n", gmx_step_str(step, sbuf),
+                chosen.nstlist, chosen.params.rlistOuter);
+    }
+}
+
+NstlistTuning::NstlistTuning(const gmx::MDLogger&       mdlog,
+                             const t_commrec*           cr,
+                             const t_inputrec&          ir,
+                             const gmx_mtop_t&          mtop,
+                             const matrix               box,
+                             const interaction_const_t& ic,
+                             const nonbonded_verlet_t&  nbv) :
+    impl_(new Impl(mdlog, cr, ir, mtop, box, ic, nbv))
+{
+}
+
+NstlistTuning::~NstlistTuning() = default;
+
+bool NstlistTuning::isActive() const
+{
+    return impl_->isActive_;
+}
+
+void NstlistTuning::tune(FILE*                          fp_err,
+                         const gmx::MDLogger&           mdlog,
+                         t_commrec*                     cr,
+                         t_inputrec*                    ir,
+                         t_forcerec*                    fr,
+                         const matrix                   box,
+                         gmx::ArrayRef<const gmx::RVec> x,
+                         const int64_t                  step,
+                         const int64_t                  step_rel)
+{
+    Impl& impl = *impl_;
+
+    /* Skip the start of the run, while performance stabilizes */
+    if (!impl.isActive_ || step_rel < c_numFirstTuningPeriodSkip * impl.setups_[0].nstlist)
+    {
+        return;
+    }
+
+    NstlistSetup& setup = impl.setups_[impl.currentSetup_];
+    impl.numPeriodsWithCurrentSetup_++;
+    if (impl.isMeasuring_)
+    {
+        setup.numPeriodsMeasured++;
+    }
+    if (setup.numPeriodsMeasured < c_numTuningPeriodsPerSetup)
+    {
+        /* The first periods after a switch include allocation overhead */
+        impl.isMeasuring_ = (impl.numPeriodsWithCurrentSetup_ >= c_numPostSwitchTuningPeriodSkip);
+        return;
+    }
+    impl.isMeasuring_ = false;
+
+    /* The step flags are the same on all ranks, so all ranks take this branch */
+    if (setup.numPlainSteps == 0 || setup.numSearchSteps == 0)
+    {
+        GMX_LOG(mdlog.info)
+                .asParagraph()
+                .appendText(
+                        "NOTE: Stopped tuning nstlist, since all steps compute energies, "
+                        "the virial or write output.");
+        impl.isActive_ = false;
+        if (impl.currentSetup_ != 0)
+        {
+            /* The initial setup is always compatible with DD */
+            impl.switchSetup(0, cr, ir, fr, box, x);
+        }
+        return;
+    }
+
+    double cycles[2] = { setup.plainStepCycles / setup.numPlainSteps,
+                         setup.searchCycles / setup.numSearchSteps };
+    if (PAR(cr))
+    {
+        gmx_sumd(2, cycles, cr);
+    }
+    setup.cyclesPerStep = nstlistSetupCostPerStep(setup.nstlist, cycles[0], cycles[1]);
+
+    /* Continue with the next setup which has not been measured yet */
+    for (int i = 0; i < gmx::ssize(impl.setups_); i++)
+    {
+        if (impl.setups_[i].numPeriodsMeasured == 0 && impl.switchSetup(i, cr, ir, fr, box, x))
+        {
+            return;
+        }
+    }
+
+    impl.finish(fp_err, mdlog, cr, ir, fr, box, x, step);
+}
+
+void NstlistTuning::recordStep(gmx_wallcycle* wcycle,
+                               const double   stepCycles,
+                               const bool     isSearchStep,
+                               const bool     isPlainStep)
+{
+    Impl& impl = *impl_;
+
+    if (!impl.isActive_)
+    {
+        return;
+    }
+
+    /* Search and DD repartitioning only happen at search steps, so the change
+     * in their counters since the previous call is the cost of this step.
+     */
+    int    numSteps;
+    int    numCalls;
+    double cycles;
+    wallcycle_get(wcycle, ewcSTEP, &numSteps, &cycles);
+    double searchCycles = 0;
+    for (const int ewc : { ewcNS, ewcDOMDEC })
+    {
+        wallcycle_get(wcycle, ewc, &numCalls, &cycles);
+        searchCycles += cycles;
+    }
+    const bool countersWereReset = (numSteps != impl.numStepsCounted_ + 1);
+    const double searchCyclesStep = searchCycles - impl.searchCyclesCounted_;
+    impl.numStepsCounted_         = numSteps;
+    impl.searchCyclesCounted_     = searchCycles;
+
+    if (!impl.isMeasuring_ || countersWereReset)
+    {
+        return;
+    }
+
+    NstlistSetup& setup = impl.setups_[impl.currentSetup_];
+    if (isSearchStep)
+    {
+        setup.searchCycles += searchCyclesStep;
+        setup.numSearchSteps++;
+    }
+    else if (isPlainStep)
+    {
+        setup.plainStepCycles += stepCycles;
+        setup.numPlainSteps++;
+    }
+}
+
+std::vector<int> nstlistTuningCandidates(const int initialNstlist, const bool haveDomainDecomposition)
+{
+    std::vector<int> nstlists = { initialNstlist };
+    for (const int nstlist : c_nstlistTuningTry)
+    {
+        if (nstlist != initialNstlist && !(haveDomainDecomposition && nstlist > initialNstlist))
+        {
+            nstlists.push_back(nstlist);
+        }
+    }
+
+    return nstlists;
+}
+
+double nstlistSetupCostPerStep(const int nstlist, const double plainStepCycles, const double searchCycles)
+{
+    /* Apart from the search, a search step costs the same as a plain step */
+    return plainStepCycles + searchCycles / nstlist;
+}
+
+int fastestNstlistSetup(gmx::ArrayRef<const double> costPerStep)
+{
+    return static_cast<int>(std::min_element(costPerStep.begin(), costPerStep.end())
+                            - costPerStep.begin());
+}
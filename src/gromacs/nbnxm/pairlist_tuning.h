@@ -48,18 +48,28 @@
 
 #include <stdio.h>
 
+#include <cstdint>
+
+#include <vector>
+
 #include "gromacs/math/vectypes.h"
+#include "gromacs/utility/classhelpers.h"
 
 namespace gmx
 {
+template<typename T>
+class ArrayRef;
 class CpuInfo;
 class MDLogger;
 } // namespace gmx
 
 struct gmx_mtop_t;
+struct gmx_wallcycle;
 struct interaction_const_t;
+struct nonbonded_verlet_t;
 struct PairlistParams;
 struct t_commrec;
+struct t_forcerec;
 struct t_inputrec;
 
 /*! \brief Try to increase nstlist when using the Verlet cut-off scheme
@@ -98,4 +108,104 @@ void setupDynamicPairlistPruning(const gmx::MDLogger&       mdlog,
                                  const interaction_const_t* ic,
                                  PairlistParams*            listParams);
 
+/*! \libinternal
+ * \brief Tunes nstlist and the dynamic pruning interval during the run
+ *
+ * At startup nstlist and the pruning interval are chosen by increaseNstlist()
+ * and setupDynamicPairlistPruning() based on a static cost model.
+ * This class instead measures the cost of MD steps for a set of nstlist
+ * and nstlistPrune combinations, with list buffers that all correspond to
+ * the same Verlet buffer tolerance, and settles on the fastest combination.
+ *
+ * Steps that compute energies or the virial, or that write output, have
+ * extra costs that do not depend on the pair-list setup and are not timed.
+ * The cost of a setup is estimated as the cost of the remaining non-search
+ * steps plus the search and domain decomposition cost divided by nstlist.
+ *
+ * Only CPU pair lists are supported. With domain decomposition only nstlist
+ * values up to the initial value are tried, since the decomposition was
+ * set up for the initial pair-list buffer.
+ *
+ * Can be constructed after PME tuning has finished, the cut-off chosen
+ * by PME tuning is then kept and the buffers are shifted accordingly.
+ */
+class NstlistTuning
+{
+public:
+    /*! \brief Constructor, sets up the combinations to try
+     *
+     * \param[in] mdlog  MD logger
+     * \param[in] cr     The communication record
+     * \param[in] ir     The input parameter record
+     * \param[in] mtop   The global topology
+     * \param[in] box    The unit cell
+     * \param[in] ic     The nonbonded interactions constants
+     * \param[in] nbv    The nonbonded setup, provides the initial pair-list setup
+     */
+    NstlistTuning(const gmx::MDLogger&       mdlog,
+                  const t_commrec*           cr,
+                  const t_inputrec&          ir,
+                  const gmx_mtop_t&          mtop,
+                  const matrix               box,
+                  const interaction_const_t& ic,
+                  const nonbonded_verlet_t&  nbv);
+    ~NstlistTuning();
+
+    //! Returns whether the tuning is still in progress
+    bool isActive() const;
+
+    /*! \brief Switches setup when the current setup has been measured long enough
+     *
+     * Should be called at search steps, before the ewcSTEP cycle counter is started.
+     * Changes ir->nstlist and the pair-list setup in fr->nbv when switching.
+     */
+    void tune(FILE*                          fp_err,
+              const gmx::MDLogger&           mdlog,
+              t_commrec*                     cr,
+              t_inputrec*                    ir,
+              t_forcerec*                    fr,
+              const matrix                   box,
+              gmx::ArrayRef<const gmx::RVec> x,
+              int64_t                        step,
+              int64_t                        step_rel);
+
+    /*! \brief Records the cost of the step that just finished
+     *
+     * Should be called every step after the ewcSTEP cycle counter is stopped.
+     *
+     * \param[in] wcycle        The wallcycle counters, provide the search and DD cycles
+     * \param[in] stepCycles    The cycles of the step, as returned by the ewcSTEP counter
+     * \param[in] isSearchStep  Whether the pair list was constructed this step
+     * \param[in] isPlainStep   Whether this step computed no energies or virial and wrote no output
+     */
+    void recordStep(gmx_wallcycle* wcycle, double stepCycles, bool isSearchStep, bool isPlainStep);
+
+private:
+    class Impl;
+
+    gmx::PrivateImplPointer<Impl> impl_;
+};
+
+/*! \brief Returns the nstlist values to try during tuning, the initial value first
+ *
+ * With domain decomposition only values up to \p initialNstlist are returned,
+ * since the decomposition was set up for the initial pair-list buffer.
+ */
+std::vector<int> nstlistTuningCandidates(int initialNstlist, bool haveDomainDecomposition);
+
+/*! \brief Returns the estimated cost per MD step of a pair-list setup
+ *
+ * \param[in] nstlist          The pair-list update interval
+ * \param[in] plainStepCycles  The average cost of steps without search, energies or output
+ * \param[in] searchCycles     The average search and domain decomposition cost per search step
+ */
+double nstlistSetupCostPerStep(int nstlist, double plainStepCycles, double searchCycles);
+
+/*! \brief Returns the index of the setup with the lowest cost per step
+ *
+ * Setups that were not measured should have the maximum double value as cost.
+ * On ties the setup with the lowest index is chosen.
+ */
+int fastestNstlistSetup(gmx::ArrayRef<const double> costPerStep);
+
 #endif /* NBNXM_PAIRLIST_TUNING_H */
@@ -51,6 +51,7 @@
 #include <memory>
 
 #include "gromacs/mdtypes/locality.h"
+#include "gromacs/utility/gmxassert.h"
 
 #include "pairlistparams.h"
 
@@ -119,6 +120,19 @@ public:
         params_.rlistInner = rlistInner;
     }
 
+    /*! \brief Changes the pair-list lifetime, radii and dynamic pruning setup
+     *
+     * The pair-list type and the FEP and domain decomposition setup should not change.
+     */
+    void changePairlistParams(const PairlistParams& params)
+    {
+        GMX_RELEASE_ASSERT(params.pairlistType == params_.pairlistType
+                                   && params.haveFep == params_.haveFep
+                                   && params.haveMultipleDomains == params_.haveMultipleDomains,
+                           "Only the list lifetime, radii and pruning setup can be changed");
+        params_ = params;
+    }
+
     //! Returns the pair-list set for the given locality
     const PairlistSet& pairlistSet(gmx::InteractionLocality iLocality) const
     {
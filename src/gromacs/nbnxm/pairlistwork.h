@@ -85,6 +85,19 @@ struct NbnxnPairlistCpuWork
     //! Temporary j-cluster list, used for sorting on exclusions
     std::vector<nbnxn_cj_t> cj;
 
+    //! A j-cluster of the current i-entry that takes part in perturbed interactions \internal
+    struct FepJCluster
+    {
+        //! Index of the j-cluster in the cj list
+        int cjIndex;
+        //! Bit mask of the perturbed atoms in the j-cluster
+        unsigned int fepMask;
+        //! Energy-group indices of the atoms in the j-cluster, packed as in nbnxn_atomdata_t
+        int energyGroups;
+    };
+    //! The j-clusters of the current i-entry with perturbed interactions, used for the FEP list
+    std::vector<FepJCluster> fepJClusters;
+
     //! Nr. of cluster pairs without Coulomb for flop counting
     int ncj_noq;
     //! Nr. of cluster pairs with 1/2 LJ for flop count
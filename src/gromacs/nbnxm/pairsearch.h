@@ -223,6 +223,12 @@ public:
     //! Sets the order of the local atoms to the order grid atom ordering
     void setLocalAtomOrder() { gridSet_.setLocalAtomOrder(); }
 
+    //! Renumbers the local atoms on the home grid, see GridSet::setLocalAtomOrder()
+    void setLocalAtomOrder(gmx::ArrayRef<const int> newAtomIndex)
+    {
+        gridSet_.setLocalAtomOrder(newAtomIndex);
+    }
+
     //! Returns the set of search grids
     const Nbnxm::GridSet& gridSet() const { return gridSet_; }
 
@@ -0,0 +1,249 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for putting atoms on the pair-search grid
+ *
+ * The columns are filled in parallel and, without domain decomposition,
+ * in the atom order of the previous search, after which the columns are
+ * sorted incrementally or, when that needs too many moves, with a full
+ * sort. All these paths should give the same grid order.
+ *
+ * \ingroup module_nbnxm
+ */
+#include "gmxpre.h"
+
+#include "gromacs/nbnxm/gridset.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/math/functions.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/math/vectypes.h"
+#include "gromacs/mdlib/gmx_omp_nthreads.h"
+#include "gromacs/nbnxm/atomdata.h"
+#include "gromacs/nbnxm/nbnxm.h"
+#include "gromacs/nbnxm/pairlistparams.h"
+#include "gromacs/pbcutil/pbc.h"
+#include "gromacs/random/threefry.h"
+#include "gromacs/random/uniformrealdistribution.h"
+#include "gromacs/utility/arrayref.h"
+#include "gromacs/utility/logger.h"
+
+namespace Nbnxm
+{
+namespace test
+{
+namespace
+{
+
+//! The number of atoms in the test system
+constexpr int c_numAtoms = 3000;
+//! The edge of the cubic box
+constexpr real c_boxSize = 3.0;
+//! Distance of the atoms to the box edges, so displaced atoms stay inside
+constexpr real c_margin = 0.1;
+
+//! Returns random coordinates in the box, with some pairs of atoms at the same position
+std::vector<gmx::RVec> randomCoordinates(int seed)
+{
+    gmx::DefaultRandomEngine           rng(seed);
+    gmx::UniformRealDistribution<real> dist(c_margin, c_boxSize - c_margin);
+
+    std::vector<gmx::RVec> x(c_numAtoms);
+    for (gmx::RVec& xi : x)
+    {
+        xi = { dist(rng), dist(rng), dist(rng) };
+    }
+    // Identical coordinates test that ties in z are sorted on atom index
+    for (int i = 0; i < 20; i++)
+    {
+        x[c_numAtoms - 1 - 3 * i] = x[i];
+    }
+
+    return x;
+}
+
+//! Returns \p x with all atoms displaced by at most \p maxDisplacement along each dimension
+std::vector<gmx::RVec> displacedCoordinates(const std::vector<gmx::RVec>& x, real maxDisplacement)
+{
+    gmx::DefaultRandomEngine           rng(7);
+    gmx::UniformRealDistribution<real> dist(-maxDisplacement, maxDisplacement);
+
+    std::vector<gmx::RVec> xDisplaced(x);
+    for (gmx::RVec& xi : xDisplaced)
+    {
+        xi += gmx::RVec{ dist(rng), dist(rng), dist(rng) };
+    }
+
+    return xDisplaced;
+}
+
+/*! \brief Puts atoms on the home grid of a grid set without domain decomposition
+ *
+ * Consecutive calls use the same grid set, so they reuse the atom order
+ * of the previous call.
+ */
+class GridFiller
+{
+public:
+    //! Constructor, uses \p numThreads OpenMP threads for the search
+    explicit GridFiller(int numThreads) :
+        numThreads_(numThreads),
+        gridSet_(PbcType::Xyz, false, nullptr, nullptr, PairlistType::Simple4x4, false, numThreads,
+                 gmx::PinningPolicy::CannotBePinned),
+        nbat_(gmx::PinningPolicy::CannotBePinned)
+    {
+        const std::vector<real> nbfp = { 0, 0 };
+        nbnxn_atomdata_init(gmx::MDLogger(), &nbat_, KernelType::Cpu4x4_PlainC,
+                            enbnxninitcombruleNONE, 1, nbfp, 1, numThreads);
+    }
+
+    //! Puts the atoms with coordinates \p x on the grid
+    void putOnGrid(const std::vector<gmx::RVec>& x)
+    {
+        const int numThreadsSaved = gmx_omp_nthreads_get(emntPairsearch);
+        gmx_omp_nthreads_set(emntPairsearch, numThreads_);
+
+        matrix box = { { c_boxSize, 0, 0 }, { 0, c_boxSize, 0 }, { 0, 0, c_boxSize } };
+        const rvec             lowerCorner = { 0, 0, 0 };
+        const rvec             upperCorner = { c_boxSize, c_boxSize, c_boxSize };
+        const std::vector<int> atomInfo(c_numAtoms, 0);
+        gridSet_.putOnGrid(box, 0, lowerCorner, upperCorner, nullptr, { 0, c_numAtoms },
+                           c_numAtoms / gmx::power3(c_boxSize), atomInfo, x, 0, nullptr, &nbat_);
+
+        gmx_omp_nthreads_set(emntPairsearch, numThreadsSaved);
+    }
+
+    //! Returns the atom order on the grid, -1 entries are fillers
+    std::vector<int> atomOrder() const
+    {
+        const Grid& grid = gridSet_.grids()[0];
+        return std::vector<int>(gridSet_.atomIndices().begin(),
+                                gridSet_.atomIndices().begin() + grid.atomIndexEnd());
+    }
+
+    //! Checks that the atoms in each column are sorted on z, and on index for equal z
+    void checkColumnsAreSorted(const std::vector<gmx::RVec>& x) const
+    {
+        const Grid& grid        = gridSet_.grids()[0];
+        auto        atomIndices = gridSet_.atomIndices();
+        int         numAtoms    = 0;
+        for (int cxy = 0; cxy < grid.numColumns(); cxy++)
+        {
+            const int firstAtom = grid.firstAtomInColumn(cxy);
+            for (int i = firstAtom + 1; i < firstAtom + grid.numAtomsInColumn(cxy); i++)
+            {
+                const int a = atomIndices[i - 1];
+                const int b = atomIndices[i];
+                EXPECT_TRUE(x[a][ZZ] < x[b][ZZ] || (x[a][ZZ] == x[b][ZZ] && a < b))
+                        << "Atoms " << a << " and " << b << " in column " << cxy << " are not sorted";
+            }
+            numAtoms += grid.numAtomsInColumn(cxy);
+        }
+        EXPECT_EQ(numAtoms, c_numAtoms);
+    }
+
+private:
+    int              numThreads_;
+    GridSet          gridSet_;
+    nbnxn_atomdata_t nbat_;
+};
+
+TEST(GridSetTest, ParallelColumnFillMatchesSerialFill)
+{
+    const std::vector<gmx::RVec> x = randomCoordinates(1);
+
+    GridFiller serialFiller(1);
+    serialFiller.putOnGrid(x);
+    serialFiller.checkColumnsAreSorted(x);
+
+    for (int numThreads : { 2, 3, 4 })
+    {
+        GridFiller parallelFiller(numThreads);
+        parallelFiller.putOnGrid(x);
+        EXPECT_EQ(serialFiller.atomOrder(), parallelFiller.atomOrder())
+                << "with " << numThreads << " threads";
+    }
+}
+
+TEST(GridSetTest, IncrementalSortMatchesFullSort)
+{
+    const std::vector<gmx::RVec> x0 = randomCoordinates(1);
+    // Small displacements, as between searches, keep the columns nearly sorted
+    const std::vector<gmx::RVec> x1 = displacedCoordinates(x0, 0.02);
+
+    for (int numThreads : { 1, 3 })
+    {
+        GridFiller reusingFiller(numThreads);
+        reusingFiller.putOnGrid(x0);
+        reusingFiller.putOnGrid(x1);
+        reusingFiller.checkColumnsAreSorted(x1);
+
+        GridFiller freshFiller(numThreads);
+        freshFiller.putOnGrid(x1);
+
+        EXPECT_EQ(freshFiller.atomOrder(), reusingFiller.atomOrder())
+                << "with " << numThreads << " threads";
+    }
+}
+
+TEST(GridSetTest, FallbackToFullSortMatchesFullSort)
+{
+    const std::vector<gmx::RVec> x0 = randomCoordinates(1);
+    // Uncorrelated coordinates exceed the move budget of the incremental sort
+    const std::vector<gmx::RVec> x1 = randomCoordinates(2);
+
+    for (int numThreads : { 1, 3 })
+    {
+        GridFiller reusingFiller(numThreads);
+        reusingFiller.putOnGrid(x0);
+        reusingFiller.putOnGrid(x1);
+        reusingFiller.checkColumnsAreSorted(x1);
+
+        GridFiller freshFiller(numThreads);
+        freshFiller.putOnGrid(x1);
+
+        EXPECT_EQ(freshFiller.atomOrder(), reusingFiller.atomOrder())
+                << "with " << numThreads << " threads";
+    }
+}
+
+} // namespace
+} // namespace test
+} // namespace Nbnxm
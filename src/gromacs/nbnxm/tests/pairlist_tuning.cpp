@@ -0,0 +1,101 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for the setup list and the setup selection of the runtime nstlist tuning
+ *
+ * \ingroup module_nbnxm
+ */
+#include "gmxpre.h"
+
+#include "gromacs/nbnxm/pairlist_tuning.h"
+
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/utility/arrayref.h"
+
+namespace Nbnxm
+{
+namespace test
+{
+namespace
+{
+
+TEST(NstlistTuningTest, CandidatesStartWithInitialNstlist)
+{
+    const std::vector<int> candidates = nstlistTuningCandidates(25, false);
+
+    ASSERT_FALSE(candidates.empty());
+    EXPECT_EQ(candidates[0], 25);
+    EXPECT_EQ(candidates, std::vector<int>({ 25, 10, 20, 40, 50, 80, 100 }));
+}
+
+TEST(NstlistTuningTest, CandidatesWithInitialNstlistNotInTryList)
+{
+    EXPECT_EQ(nstlistTuningCandidates(30, false),
+              std::vector<int>({ 30, 10, 20, 25, 40, 50, 80, 100 }));
+}
+
+TEST(NstlistTuningTest, CandidatesWithDomainDecompositionDoNotExceedInitialNstlist)
+{
+    EXPECT_EQ(nstlistTuningCandidates(40, true), std::vector<int>({ 40, 10, 20, 25 }));
+    EXPECT_EQ(nstlistTuningCandidates(10, true), std::vector<int>({ 10 }));
+}
+
+TEST(NstlistTuningTest, SearchCostIsAmortizedOverNstlist)
+{
+    EXPECT_DOUBLE_EQ(nstlistSetupCostPerStep(10, 100, 500), 150);
+    EXPECT_DOUBLE_EQ(nstlistSetupCostPerStep(50, 100, 500), 110);
+    // A longer interval with a larger buffer can still be slower
+    EXPECT_GT(nstlistSetupCostPerStep(50, 145, 500), nstlistSetupCostPerStep(10, 100, 500));
+}
+
+TEST(NstlistTuningTest, SelectsFastestMeasuredSetup)
+{
+    const double notMeasured = std::numeric_limits<double>::max();
+
+    EXPECT_EQ(fastestNstlistSetup(std::vector<double>({ 120, 110, notMeasured, 115 })), 1);
+    EXPECT_EQ(fastestNstlistSetup(std::vector<double>({ 120, notMeasured, notMeasured })), 0);
+    // On ties the earlier setup, which includes the initial one, is chosen
+    EXPECT_EQ(fastestNstlistSetup(std::vector<double>({ 100, 100, 100 })), 0);
+    EXPECT_EQ(fastestNstlistSetup(std::vector<double>({ 120, 100, 100 })), 1);
+}
+
+} // namespace
+} // namespace test
+} // namespace Nbnxm
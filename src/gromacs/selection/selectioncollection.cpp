@@ -685,6 +685,12 @@ bool SelectionCollection::requiresIndexGroups() const
 }
 
 
+ArrayRef<const int> SelectionCollection::requiredAtoms() const
+{
+    return constArrayRefFromArray(impl_->requiredAtoms_.index, impl_->requiredAtoms_.isize);
+}
+
+
 SelectionList SelectionCollection::parseFromStdin(int count, bool bInteractive, const std::string& context)
 {
     StandardInputStream inputStream;
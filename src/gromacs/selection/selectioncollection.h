@@ -50,6 +50,7 @@
 #include <vector>
 
 #include "gromacs/selection/selection.h" // For gmx::SelectionList
+#include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/classhelpers.h"
 
 struct gmx_ana_indexgrps_t;
@@ -230,6 +231,18 @@ public:
      * Does not throw.
      */
     bool requiresIndexGroups() const;
+    /*! \brief
+     * Returns the atoms whose coordinates are needed to evaluate the
+     * selections.
+     *
+     * The atoms are determined by compile(), and the return value is
+     * only meaningful after it has been called.  Coordinates of other
+     * atoms are not accessed by evaluate(), so a trajectory reader only
+     * needs to provide these.
+     *
+     * Does not throw.
+     */
+    ArrayRef<const int> requiredAtoms() const;
     /*! \brief
      * Sets the topology for the collection.
      *
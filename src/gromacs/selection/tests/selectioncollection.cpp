@@ -44,6 +44,10 @@
 
 #include "gromacs/selection/selectioncollection.h"
 
+#include <algorithm>
+#include <vector>
+
+#include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
 #include "gromacs/options/basicoptions.h"
@@ -633,6 +637,27 @@ TEST_F(SelectionCollectionTest, HandlesFramesWithTooSmallAtomSubsets4)
     EXPECT_THROW_GMX(sc_.evaluate(topManager_.frame(), nullptr), gmx::InconsistentInputError);
 }
 
+TEST_F(SelectionCollectionTest, ReportsRequiredAtoms)
+{
+    // Evaluating the positions will require atoms 1-3, 7-12.
+    ASSERT_NO_THROW_GMX(sc_.parseFromString("whole_res_cog of atomnr 2 7 11"));
+    ASSERT_NO_FATAL_FAILURE(loadTopology("simple.gro"));
+    ASSERT_NO_THROW_GMX(sc_.compile());
+    std::vector<int> atoms(sc_.requiredAtoms().begin(), sc_.requiredAtoms().end());
+    std::sort(atoms.begin(), atoms.end());
+    EXPECT_THAT(atoms, ::testing::ElementsAre(0, 1, 2, 6, 7, 8, 9, 10, 11));
+}
+
+TEST_F(SelectionCollectionTest, ReportsRequiredAtomsForDynamicSelections)
+{
+    ASSERT_NO_THROW_GMX(sc_.parseFromString("atomnr 1 to 5 and x < 2"));
+    ASSERT_NO_FATAL_FAILURE(loadTopology("simple.gro"));
+    ASSERT_NO_THROW_GMX(sc_.compile());
+    std::vector<int> atoms(sc_.requiredAtoms().begin(), sc_.requiredAtoms().end());
+    std::sort(atoms.begin(), atoms.end());
+    EXPECT_THAT(atoms, ::testing::ElementsAre(0, 1, 2, 3, 4));
+}
+
 // TODO: Tests for more evaluation errors
 
 /********************************************************************
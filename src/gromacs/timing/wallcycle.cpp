@@ -167,6 +167,7 @@ static const char* wcsn[ewcsNR] = {
     "Nonbonded F kernel",
     "Nonbonded F clear",
     "Nonbonded FEP",
+    "Nonbonded+bonded F",
     "Launch NB GPU tasks",
     "Launch Bonded GPU tasks",
     "Launch PME GPU tasks",
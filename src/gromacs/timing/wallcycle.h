@@ -119,6 +119,7 @@ enum
     ewcsNONBONDED_KERNEL,
     ewcsNONBONDED_CLEAR,
     ewcsNONBONDED_FEP,
+    ewcsNONBONDED_BONDED,
     ewcsLAUNCH_GPU_NONBONDED,
     ewcsLAUNCH_GPU_BONDED,
     ewcsLAUNCH_GPU_PME,
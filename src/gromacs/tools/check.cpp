@@ -46,9 +46,11 @@
 #include "gromacs/commandline/pargs.h"
 #include "gromacs/fileio/confio.h"
 #include "gromacs/fileio/enxio.h"
+#include "gromacs/fileio/filetypes.h"
 #include "gromacs/fileio/gmxfio.h"
 #include "gromacs/fileio/tpxio.h"
 #include "gromacs/fileio/trxio.h"
+#include "gromacs/fileio/xtcframeindex.h"
 #include "gromacs/fileio/xtcio.h"
 #include "gromacs/math/functions.h"
 #include "gromacs/math/units.h"
@@ -280,7 +282,11 @@ static void chk_bonds(const InteractionDefinitions* idef, PbcType pbcType, rvec*
     }
 }
 
-static void chk_trj(const gmx_output_env_t* oenv, const char* fn, const char* tpr, real tol)
+static void chk_trj(const gmx_output_env_t* oenv,
+                    const char*             fn,
+                    const char*             tpr,
+                    real                    tol,
+                    gmx_bool                bFrameIndex)
 {
     t_trxframe   fr;
     t_count      count;
@@ -405,6 +411,23 @@ static void chk_trj(const gmx_output_env_t* oenv, const char* fn, const char* tp
 
     fprintf(stderr, "\n");
 
+    if (bFrameIndex)
+    {
+        if (fn2ftp(fn) != efXTC)
+        {
+            fprintf(stderr, "\nFrame index files can only be written for xtc files\n");
+        }
+        else if (write_xtc_frame_index(status))
+        {
+            fprintf(stderr, "\nWrote the frame index to %s\n",
+                    gmx::xtcFrameIndexFilename(fn).c_str());
+        }
+        else
+        {
+            fprintf(stderr, "\nCould not write the frame index for %s\n", fn);
+        }
+    }
+
     close_trx(status);
 
     fprintf(stderr, "\nItem        #frames");
@@ -742,7 +765,12 @@ int gmx_check(int argc, char* argv[])
         "Similarly a pair of trajectory files can be compared (using the [TT]-f2[tt]",
         "option), or a pair of energy files (using the [TT]-e2[tt] option).[PAR]",
         "For free energy simulations the A and B state topology from one",
-        "run input file can be compared with options [TT]-s1[tt] and [TT]-ab[tt].[PAR]"
+        "run input file can be compared with options [TT]-s1[tt] and [TT]-ab[tt].[PAR]",
+        "With [TT]-frameindex[tt], the frame offsets of an [REF].xtc[ref] trajectory",
+        "are stored in a [TT].frameindex[tt] file next to it. Tools that read",
+        "the trajectory later use it for reading frames by index and for",
+        "seeking to the start time set with [TT]-b[tt], instead of scanning",
+        "the file."
     };
     t_filenm fnm[] = { { efTRX, "-f", nullptr, ffOPTRD },  { efTRX, "-f2", nullptr, ffOPTRD },
                        { efTPR, "-s1", "top1", ffOPTRD },  { efTPR, "-s2", "top2", ffOPTRD },
@@ -753,15 +781,16 @@ int gmx_check(int argc, char* argv[])
     const char *fn1 = nullptr, *fn2 = nullptr, *tex = nullptr;
 
     gmx_output_env_t* oenv;
-    static real       vdw_fac  = 0.8;
-    static real       bon_lo   = 0.4;
-    static real       bon_hi   = 0.7;
-    static gmx_bool   bRMSD    = FALSE;
-    static real       ftol     = 0.001;
-    static real       abstol   = 0.001;
-    static gmx_bool   bCompAB  = FALSE;
-    static char*      lastener = nullptr;
-    static t_pargs    pa[]     = {
+    static real       vdw_fac     = 0.8;
+    static real       bon_lo      = 0.4;
+    static real       bon_hi      = 0.7;
+    static gmx_bool   bRMSD       = FALSE;
+    static real       ftol        = 0.001;
+    static real       abstol      = 0.001;
+    static gmx_bool   bCompAB     = FALSE;
+    static gmx_bool   bFrameIndex = FALSE;
+    static char*      lastener    = nullptr;
+    static t_pargs    pa[]        = {
         { "-vdwfac",
           FALSE,
           etREAL,
@@ -782,6 +811,11 @@ int gmx_check(int argc, char* argv[])
           { &abstol },
           "Absolute tolerance, useful when sums are close to zero." },
         { "-ab", FALSE, etBOOL, { &bCompAB }, "Compare the A and B topology from one file" },
+        { "-frameindex",
+          FALSE,
+          etBOOL,
+          { &bFrameIndex },
+          "Write a frame index file for the xtc trajectory given with -f" },
         { "-lastener",
           FALSE,
           etSTR,
@@ -811,7 +845,7 @@ int gmx_check(int argc, char* argv[])
     }
     else if (fn1)
     {
-        chk_trj(oenv, fn1, opt2fn_null("-s1", NFILE, fnm), ftol);
+        chk_trj(oenv, fn1, opt2fn_null("-s1", NFILE, fnm), ftol, bFrameIndex);
     }
     else if (fn2)
     {
@@ -0,0 +1,116 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+#include "gmxpre.h"
+
+#include "colstore2xvg.h"
+
+#include <string>
+#include <vector>
+
+#include "gromacs/analysisdata/modules/columnstore.h"
+#include "gromacs/commandline/cmdlineoptionsmodule.h"
+#include "gromacs/fileio/filetypes.h"
+#include "gromacs/options/basicoptions.h"
+#include "gromacs/options/filenameoption.h"
+#include "gromacs/options/ioptionscontainer.h"
+
+namespace gmx
+{
+
+namespace
+{
+
+class ColumnStoreToXvg : public ICommandLineOptionsModule
+{
+public:
+    ColumnStoreToXvg() {}
+
+    // From ICommandLineOptionsModule
+    void init(CommandLineModuleSettings* /*settings*/) override {}
+    void initOptions(IOptionsContainer* options, ICommandLineOptionsModuleSettings* settings) override;
+    void optionsFinished() override {}
+    int  run() override;
+
+private:
+    //! Name of input column-store file.
+    std::string inputFileName_;
+    //! Name of output xvg file.
+    std::string outputFileName_;
+};
+
+void ColumnStoreToXvg::initOptions(IOptionsContainer* options, ICommandLineOptionsModuleSettings* settings)
+{
+    std::vector<const char*> desc = {
+        "[THISMODULE] converts a binary column-store file ([TT].gcs[tt]), written",
+        "by analysis tools when [TT]-colstore[tt] is given, to the [REF].xvg[ref]",
+        "file that the tool would otherwise have written. The headers and the",
+        "number formatting are stored in the input file, so the output is",
+        "identical to direct text output."
+    };
+
+    settings->setHelpText(desc);
+
+    options->addOption(FileNameOption("f")
+                               .legacyType(efGCS)
+                               .inputFile()
+                               .required()
+                               .store(&inputFileName_)
+                               .defaultBasename("plot")
+                               .description("Column-store file to convert"));
+    options->addOption(FileNameOption("o")
+                               .filetype(eftPlot)
+                               .outputFile()
+                               .required()
+                               .store(&outputFileName_)
+                               .defaultBasename("plot")
+                               .description("Converted plot"));
+}
+
+int ColumnStoreToXvg::run()
+{
+    convertColumnStoreToXvg(inputFileName_, outputFileName_);
+    return 0;
+}
+
+} // namespace
+
+const char ColumnStoreToXvgInfo::name[]             = "colstore2xvg";
+const char ColumnStoreToXvgInfo::shortDescription[] = "Convert binary analysis output to xvg";
+ICommandLineOptionsModulePointer ColumnStoreToXvgInfo::create()
+{
+    return ICommandLineOptionsModulePointer(std::make_unique<ColumnStoreToXvg>());
+}
+
+} // namespace gmx
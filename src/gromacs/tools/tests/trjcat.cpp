@@ -0,0 +1,119 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for gmx trjcat.
+ *
+ * \ingroup module_tools
+ */
+#include "gmxpre.h"
+
+#include "gromacs/tools/trjcat.h"
+
+#include <string>
+#include <vector>
+
+#include "gromacs/fileio/xtcio.h"
+#include "gromacs/math/vectypes.h"
+#include "gromacs/utility/smalloc.h"
+
+#include "testutils/cmdlinetest.h"
+#include "testutils/testfilemanager.h"
+#include "testutils/textblockmatchers.h"
+
+namespace
+{
+
+//! Positions of one frame of an XTC file.
+using XtcFrame = std::vector<gmx::RVec>;
+
+//! Reads all frames of the XTC file \p filename.
+std::vector<XtcFrame> readXtcFrames(const std::string& filename)
+{
+    std::vector<XtcFrame> frames;
+    t_fileio*             fio = open_xtc(filename.c_str(), "r");
+    int                   natoms;
+    int64_t               step;
+    real                  time, prec;
+    matrix                box;
+    rvec*                 x;
+    gmx_bool              bOK;
+    if (read_first_xtc(fio, &natoms, &step, &time, box, &x, &prec, &bOK))
+    {
+        do
+        {
+            frames.emplace_back(x, x + natoms);
+        } while (read_next_xtc(fio, natoms, &step, &time, box, x, &prec, &bOK));
+        sfree(x);
+    }
+    close_xtc(fio);
+    return frames;
+}
+
+class TrjcatTest : public gmx::test::CommandLineTestBase
+{
+};
+
+TEST_F(TrjcatTest, CopiesXtcFramesUnchanged)
+{
+    const std::string input = gmx::test::TestFileManager::getInputFilePath("spc2-traj.xtc");
+    const std::string output = fileManager().getTemporaryFilePath("cat.xtc");
+
+    auto& cmdline = commandLine();
+    cmdline.addOption("-f");
+    cmdline.append(input);
+    cmdline.append(input);
+    cmdline.addOption("-o", output);
+    cmdline.addOption("-cat");
+
+    ASSERT_EQ(0, gmx_trjcat(cmdline.argc(), cmdline.argv()));
+
+    const std::vector<XtcFrame> inputFrames  = readXtcFrames(input);
+    const std::vector<XtcFrame> outputFrames = readXtcFrames(output);
+    ASSERT_EQ(2 * inputFrames.size(), outputFrames.size());
+    for (size_t i = 0; i < outputFrames.size(); i++)
+    {
+        const XtcFrame& inputFrame = inputFrames[i % inputFrames.size()];
+        ASSERT_EQ(inputFrame.size(), outputFrames[i].size());
+        for (size_t j = 0; j < inputFrame.size(); j++)
+        {
+            EXPECT_EQ(inputFrame[j][XX], outputFrames[i][j][XX]);
+            EXPECT_EQ(inputFrame[j][YY], outputFrames[i][j][YY]);
+            EXPECT_EQ(inputFrame[j][ZZ], outputFrames[i][j][ZZ]);
+        }
+    }
+}
+
+} // namespace
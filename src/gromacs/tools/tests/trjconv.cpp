@@ -43,11 +43,18 @@
 
 #include "gromacs/tools/trjconv.h"
 
+#include <fstream>
+#include <iterator>
+#include <string>
+
 #include "config.h"
 
+#include "gromacs/utility/stringutil.h"
+
 #include "testutils/cmdlinetest.h"
 #include "testutils/simulationdatabase.h"
 #include "testutils/stdiohelper.h"
+#include "testutils/testfilemanager.h"
 #include "testutils/textblockmatchers.h"
 
 namespace
@@ -134,4 +141,49 @@ TEST_P(TrjconvWithoutTopologyFile, WithDifferentInputFormats)
 INSTANTIATE_TEST_CASE_P(NoFatalErrorWhenWritingFrom,
                         TrjconvWithoutTopologyFile,
                         ::testing::ValuesIn(trajectoryFileNames));
+
+//! Returns the contents of the binary file \p filename.
+std::string readBinaryFile(const std::string& filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+class TrjconvWithThreads :
+    public gmx::test::CommandLineTestBase,
+    public ::testing::WithParamInterface<const char*>
+{
+public:
+    //! Converts spc2-traj.trr to \p extension, optionally with I/O threads, and returns the output.
+    std::string convert(const char* extension, bool useIoThreads)
+    {
+        const std::string output = fileManager().getTemporaryFilePath(
+                gmx::formatString("%s.%s", useIoThreads ? "threads" : "serial", extension));
+
+        gmx::test::CommandLine cmdline;
+        cmdline.append("trjconv");
+        cmdline.addOption("-f", gmx::test::TestFileManager::getInputFilePath("spc2-traj.trr"));
+        cmdline.addOption("-o", output);
+        if (useIoThreads)
+        {
+            cmdline.append("-iothreads");
+        }
+        cmdline.addOption("-shift");
+        cmdline.append("0.1");
+        cmdline.append("0.2");
+        cmdline.append("0.3");
+        EXPECT_EQ(0, gmx_trjconv(cmdline.argc(), cmdline.argv()));
+        return readBinaryFile(output);
+    }
+};
+
+TEST_P(TrjconvWithThreads, WritesSameOutputAsSerial)
+{
+    const std::string serial = convert(GetParam(), false);
+    ASSERT_FALSE(serial.empty());
+    EXPECT_EQ(serial, convert(GetParam(), true));
+}
+
+INSTANTIATE_TEST_CASE_P(ToDifferentFormats, TrjconvWithThreads, ::testing::Values("xtc", "trr"));
+
 } // namespace
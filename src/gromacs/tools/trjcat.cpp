@@ -39,12 +39,15 @@
 
 #include "trjcat.h"
 
+#include "config.h"
+
 #include <cmath>
 #include <cstdlib>
 #include <cstring>
 
 #include <algorithm>
 #include <string>
+#include <vector>
 
 #include "gromacs/commandline/pargs.h"
 #include "gromacs/fileio/confio.h"
@@ -60,8 +63,10 @@
 #include "gromacs/trajectory/trajectoryframe.h"
 #include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/arraysize.h"
+#include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/futil.h"
+#include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/smalloc.h"
 #include "gromacs/utility/stringutil.h"
 
@@ -73,79 +78,96 @@
 #endif
 #define FLAGS (TRX_READ_X | TRX_READ_V | TRX_READ_F)
 
+/* Reads the start time, time step and number of atoms of a trajectory file */
+static void scan_trj_file(const std::string& file, real* readtime, real* timestep, int* natoms, const gmx_output_env_t* oenv)
+{
+    t_trxstatus* status;
+    t_trxframe   fr;
+    bool         ok;
+
+    ok = read_first_frame(oenv, &status, file.c_str(), &fr, FLAGS);
+
+    if (!ok)
+    {
+        gmx_fatal(FARGS, "\nCouldn't read frame from file.");
+    }
+    if (fr.bTime)
+    {
+        *readtime = fr.time;
+    }
+    else
+    {
+        *readtime = 0;
+        fprintf(stderr, "\nWARNING: Couldn't find a time in the frame.\n");
+    }
+    *natoms = fr.natoms;
+
+    ok = read_next_frame(oenv, status, &fr);
+    if (ok && fr.bTime)
+    {
+        *timestep = fr.time - *readtime;
+    }
+    else
+    {
+        *timestep = 0;
+    }
+
+    close_trx(status);
+    if (fr.bX)
+    {
+        sfree(fr.x);
+    }
+    if (fr.bV)
+    {
+        sfree(fr.v);
+    }
+    if (fr.bF)
+    {
+        sfree(fr.f);
+    }
+}
+
 static void scan_trj_files(gmx::ArrayRef<const std::string> files,
                            real*                            readtime,
                            real*                            timestep,
                            int                              imax,
+                           int                              nthreads,
                            const gmx_output_env_t*          oenv)
 {
-    /* Check start time of all files */
-    int          natoms = 0;
-    t_trxstatus* status;
-    t_trxframe   fr;
-    bool         ok;
+    /* Check start time of all files. The files are independent, so they
+     * are scanned in parallel, except for TNG files, as the TNG library
+     * is not known to be thread safe. */
+    std::vector<int> natoms(files.size());
+    if (fn2ftp(files[0].c_str()) == efTNG)
+    {
+        nthreads = 1;
+    }
 
+#pragma omp parallel for num_threads(nthreads) schedule(dynamic)
     for (gmx::index i = 0; i < files.ssize(); i++)
     {
-        ok = read_first_frame(oenv, &status, files[i].c_str(), &fr, FLAGS);
-
-        if (!ok)
-        {
-            gmx_fatal(FARGS, "\nCouldn't read frame from file.");
-        }
-        if (fr.bTime)
+        try
         {
-            readtime[i] = fr.time;
-        }
-        else
-        {
-            readtime[i] = 0;
-            fprintf(stderr, "\nWARNING: Couldn't find a time in the frame.\n");
+            scan_trj_file(files[i], &readtime[i], &timestep[i], &natoms[i], oenv);
         }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
 
-        if (i == 0)
-        {
-            natoms = fr.natoms;
-        }
-        else
+    for (gmx::index i = 1; i < files.ssize(); i++)
+    {
+        if (imax == -1)
         {
-            if (imax == -1)
-            {
-                if (natoms != fr.natoms)
-                {
-                    gmx_fatal(FARGS, "\nDifferent numbers of atoms (%d/%d) in files", natoms, fr.natoms);
-                }
-            }
-            else
+            if (natoms[0] != natoms[i])
             {
-                if (fr.natoms <= imax)
-                {
-                    gmx_fatal(FARGS, "\nNot enough atoms (%d) for index group (%d)", fr.natoms, imax);
-                }
+                gmx_fatal(FARGS, "\nDifferent numbers of atoms (%d/%d) in files", natoms[0], natoms[i]);
             }
         }
-        ok = read_next_frame(oenv, status, &fr);
-        if (ok && fr.bTime)
-        {
-            timestep[i] = fr.time - readtime[i];
-        }
         else
         {
-            timestep[i] = 0;
-        }
-
-        close_trx(status);
-        if (fr.bX)
-        {
-            sfree(fr.x);
-        }
-        if (fr.bV)
-        {
-            sfree(fr.v);
-        }
-        if (fr.bF)
-        {
-            sfree(fr.f);
+            if (natoms[i] <= imax)
+            {
+                gmx_fatal(FARGS, "\nNot enough atoms (%d) for index group (%d)", natoms[i], imax);
+            }
         }
     }
     fprintf(stderr, "\n");
@@ -440,7 +462,12 @@ int gmx_trjcat(int argc, char* argv[])
         "The frames corresponding to the numbers present at the first line",
         "are collected into the output trajectory. If the number of frames in",
         "the trajectory does not match that in the [REF].xvg[ref] file then the program",
-        "tries to be smart. Beware."
+        "tries to be smart. Beware.[PAR]",
+        "When both the input and output files are [REF].xtc[ref] files and no index group",
+        "is used, the compressed coordinates of the frames are copied unchanged, without",
+        "decompressing and compressing them again; only the time in the frame",
+        "headers is changed. The start times of the input files are determined",
+        "in parallel, with the number of threads set with [TT]-nt[tt]."
     };
     static gmx_bool bCat            = FALSE;
     static gmx_bool bSort           = TRUE;
@@ -452,6 +479,7 @@ int gmx_trjcat(int argc, char* argv[])
     static real     begin = -1;
     static real     end   = -1;
     static real     dt    = 0;
+    static int      nthreads = 1;
 
     t_pargs pa[] = {
         { "-b", FALSE, etTIME, { &begin }, "First time to use (%t)" },
@@ -469,7 +497,10 @@ int gmx_trjcat(int argc, char* argv[])
           etBOOL,
           { &bOverwrite },
           "Overwrite overlapping frames during appending" },
-        { "-cat", FALSE, etBOOL, { &bCat }, "Do not discard double time frames" }
+        { "-cat", FALSE, etBOOL, { &bCat }, "Do not discard double time frames" },
+#if GMX_OPENMP
+        { "-nt", FALSE, etINT, { &nthreads }, "Number of threads for scanning the input files" },
+#endif
     };
 #define npargs asize(pa)
     int               ftpin, i, frame, frame_out;
@@ -497,6 +528,8 @@ int gmx_trjcat(int argc, char* argv[])
 
 #define NFILE asize(fnm)
 
+    nthreads = gmx_omp_get_max_threads();
+
     if (!parse_common_args(&argc, argv, PCA_TIME_UNIT, NFILE, fnm, asize(pa), pa, asize(desc), desc,
                            0, nullptr, &oenv))
     {
@@ -606,7 +639,11 @@ int gmx_trjcat(int argc, char* argv[])
     {
         snew(readtime, inFiles.size() + 1);
         snew(timest, inFiles.size() + 1);
-        scan_trj_files(inFiles, readtime, timest, imax, oenv);
+        if (nthreads < 1)
+        {
+            gmx_fatal(FARGS, "The number of threads should be at least 1, not %d", nthreads);
+        }
+        scan_trj_files(inFiles, readtime, timest, imax, nthreads, oenv);
 
         snew(settime, inFiles.size() + 1);
         snew(cont_type, inFiles.size() + 1);
@@ -755,6 +792,13 @@ int gmx_trjcat(int argc, char* argv[])
             }
             frout = fr;
         }
+        /* XTC frames can be copied without decompressing the coordinates
+         * when all atoms are written */
+        const bool        bCopyXtcData = (ftpin == efXTC && ftpout == efXTC && !bIndex);
+        t_fileio*         xtcIn        = nullptr;
+        std::vector<char> xtcData;
+        gmx_bool          bOK;
+
         /* Lets stitch up some files */
         timestep = timest[0];
         for (size_t i = n_append + 1; i < inFilesEdited.size(); i++)
@@ -813,7 +857,19 @@ int gmx_trjcat(int argc, char* argv[])
             {
                 timestep = timest[i];
             }
-            read_first_frame(oenv, &status, inFilesEdited[i].c_str(), &fr, FLAGS);
+            if (bCopyXtcData)
+            {
+                xtcIn = open_xtc(inFilesEdited[i].c_str(), "r");
+                clear_trxframe(&fr, TRUE);
+                fr.bTime = read_next_xtc_data(xtcIn, &fr.natoms, &fr.step, &fr.time, fr.box,
+                                              &xtcData, &bOK);
+                fr.bStep = fr.bTime;
+                fr.bBox  = fr.bTime;
+            }
+            else
+            {
+                read_first_frame(oenv, &status, inFilesEdited[i].c_str(), &fr, FLAGS);
+            }
             if (!fr.bTime)
             {
                 fr.time = 0;
@@ -899,7 +955,15 @@ int gmx_trjcat(int argc, char* argv[])
                             bNewFile = FALSE;
                         }
 
-                        if (bIndex)
+                        if (bCopyXtcData)
+                        {
+                            if (!write_xtc_data(trx_get_fileio(trxout), frout.natoms, frout.step,
+                                                frout.time, frout.box, xtcData))
+                            {
+                                gmx_fatal(FARGS, "Error writing frame to %s", out_file);
+                            }
+                        }
+                        else if (bIndex)
                         {
                             write_trxframe_indexed(trxout, &frout, isize, index, nullptr);
                         }
@@ -915,9 +979,18 @@ int gmx_trjcat(int argc, char* argv[])
                         }
                     }
                 }
-            } while (read_next_frame(oenv, status, &fr));
+            } while (bCopyXtcData ? read_next_xtc_data(xtcIn, &fr.natoms, &fr.step, &fr.time,
+                                                       fr.box, &xtcData, &bOK)
+                                  : read_next_frame(oenv, status, &fr));
 
-            close_trx(status);
+            if (bCopyXtcData)
+            {
+                close_xtc(xtcIn);
+            }
+            else
+            {
+                close_trx(status);
+            }
         }
         if (trxout)
         {
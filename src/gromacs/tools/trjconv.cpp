@@ -45,6 +45,8 @@
 
 #include <algorithm>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "gromacs/commandline/pargs.h"
 #include "gromacs/commandline/viewit.h"
@@ -57,11 +59,13 @@
 #include "gromacs/fileio/tpxio.h"
 #include "gromacs/fileio/trrio.h"
 #include "gromacs/fileio/trxio.h"
+#include "gromacs/fileio/trxreadahead.h"
 #include "gromacs/fileio/xtcio.h"
 #include "gromacs/fileio/xvgr.h"
 #include "gromacs/math/do_fit.h"
 #include "gromacs/math/functions.h"
 #include "gromacs/math/vec.h"
+#include "gromacs/mdlib/asynctrajectorywriter.h"
 #include "gromacs/mdtypes/md_enums.h"
 #include "gromacs/pbcutil/pbc.h"
 #include "gromacs/pbcutil/pbcmethods.h"
@@ -215,6 +219,46 @@ static std::unique_ptr<gmx_mtop_t> read_mtop_for_tng(const char* tps_file,
     return mtop;
 }
 
+/*! \brief Copies \p fr to a buffer of \p writer for writing in the writer thread
+ *
+ * (Re)creates the writer for \p status when needed, which is the case
+ * when the XTC precision changes.
+ */
+static void writeTrxFrameAsync(std::unique_ptr<gmx::AsyncTrajectoryWriter>* writer,
+                               real*                                        writerPrecision,
+                               t_trxstatus*                                 status,
+                               int                                          ftp,
+                               const t_trxframe&                            fr)
+{
+    const real prec = fr.bPrec ? fr.prec : 1000.0;
+    if (*writer != nullptr && ftp == efXTC && prec != *writerPrecision)
+    {
+        writer->reset();
+    }
+    if (*writer == nullptr)
+    {
+        t_fileio* fio    = trx_get_fileio(status);
+        *writer          = std::make_unique<gmx::AsyncTrajectoryWriter>(
+                ftp == efXTC ? fio : nullptr, prec, ftp == efTRR ? fio : nullptr);
+        *writerPrecision = prec;
+    }
+
+    gmx::TrajectoryOutputFrame* frame = (*writer)->acquireFrame();
+    frame->step                       = fr.step;
+    frame->time                       = fr.time;
+    frame->lambda                     = fr.lambda;
+    copy_mat(fr.box, frame->box);
+    frame->hasX           = (ftp == efTRR && fr.bX);
+    frame->hasV           = (ftp == efTRR && fr.bV);
+    frame->hasF           = (ftp == efTRR && fr.bF);
+    frame->hasXCompressed = (ftp == efXTC);
+    frame->x.assign(fr.x, fr.x + (frame->hasX ? fr.natoms : 0));
+    frame->v.assign(fr.v, fr.v + (frame->hasV ? fr.natoms : 0));
+    frame->f.assign(fr.f, fr.f + (frame->hasF ? fr.natoms : 0));
+    frame->xCompressed.assign(fr.x, fr.x + (frame->hasXCompressed ? fr.natoms : 0));
+    (*writer)->submitFrame(frame);
+}
+
 int gmx_trjconv(int argc, char* argv[])
 {
     const char* desc[] = {
@@ -351,7 +395,16 @@ int gmx_trjconv(int argc, char* argv[])
         "Option [TT]-drop[tt] reads an [REF].xvg[ref] file with times and values.",
         "When options [TT]-dropunder[tt] and/or [TT]-dropover[tt] are set,",
         "frames with a value below and above the value of the respective options",
-        "will not be written."
+        "will not be written.[PAR]",
+
+        "With [TT]-iothreads[tt], the following input frames are read",
+        "in a separate thread while the current frame is processed, and",
+        "[REF].xtc[ref] and [REF].trr[ref] output is written in another thread.",
+        "This only overlaps the file input and output with the processing;",
+        "frames are still processed one at a time and in order, as several",
+        "operations, e.g. [TT]-pbc nojump[tt] and [TT]-fit progressive[tt],",
+        "depend on the previous frame. The output is identical to that",
+        "without [TT]-iothreads[tt]."
     };
 
     int pbc_enum;
@@ -400,7 +453,7 @@ int gmx_trjconv(int argc, char* argv[])
                                   "translation", "transxy", "progressive", nullptr };
 
     static gmx_bool bSeparate = FALSE, bVels = TRUE, bForce = FALSE, bCONECT = FALSE;
-    static gmx_bool bCenter = FALSE;
+    static gmx_bool bCenter = FALSE, bIoThreads = FALSE;
     static int      skip_nr = 1, ndec = 3, nzero = 0;
     static real     tzero = 0, delta_t = 0, timestep = 0, ttrunc = -1, tdump = -1, split_t = 0;
     static rvec     newbox = { 0, 0, 0 }, shift = { 0, 0, 0 }, trans = { 0, 0, 0 };
@@ -469,7 +522,13 @@ int gmx_trjconv(int argc, char* argv[])
           { &bCONECT },
           "Add conect records when writing [REF].pdb[ref] files. Useful "
           "for visualization of non-standard molecules, e.g. "
-          "coarse grained ones" }
+          "coarse grained ones" },
+        { "-iothreads",
+          FALSE,
+          etBOOL,
+          { &bIoThreads },
+          "Read and write frames in two separate threads, while the frames "
+          "are processed in order in the main thread" }
     };
 #define NPA asize(pa)
 
@@ -490,6 +549,7 @@ int gmx_trjconv(int argc, char* argv[])
     t_atoms *   atoms   = nullptr, useatoms;
     matrix      top_box;
     int *       index = nullptr, *cindex = nullptr;
+    gmx_bool*   bAtomUsed = nullptr;
     char*       grpnm = nullptr;
     int *       frindex, nrfri;
     char*       frname;
@@ -969,6 +1029,59 @@ int gmx_trjconv(int argc, char* argv[])
                 }
             }
 
+            /* When only a subset of the atoms is written and none of the
+             * requested operations uses the other atoms, the XTC reader
+             * only needs to decode the coordinates up to the last used atom */
+            gmx::ArrayRef<const gmx_bool> atomMask;
+            if (bIndex && !bRmPBC && !bCluster)
+            {
+                snew(bAtomUsed, natoms);
+                for (i = 0; i < nout; i++)
+                {
+                    bAtomUsed[index[i]] = TRUE;
+                }
+                if (bReset || bPFit)
+                {
+                    for (i = 0; i < ifit; i++)
+                    {
+                        bAtomUsed[ind_fit[i]] = TRUE;
+                    }
+                }
+                if (bCenter)
+                {
+                    for (i = 0; i < ncent; i++)
+                    {
+                        bAtomUsed[cindex[i]] = TRUE;
+                    }
+                }
+                atomMask = gmx::arrayRefFromArray(bAtomUsed, natoms);
+            }
+
+            /* With I/O threads, read the following frames and
+             * write XTC/TRR output concurrently with processing the
+             * current frame. The read-ahead buffers are swapped with fr,
+             * so all buffers have the same layout as the first frame.
+             */
+            const int                                   c_numReadAheadFrames = 2;
+            std::vector<t_trxframe*>                    readBuffers;
+            std::unique_ptr<gmx::TrxFrameReadAhead>     readAhead;
+            t_trxframe*                                 doneFrame = nullptr;
+            std::unique_ptr<gmx::AsyncTrajectoryWriter> asyncWriter;
+            real                                        asyncWriterPrecision = 0;
+            /* -exec may read the output file, so it should be complete */
+            const bool bAsyncWrite = (bIoThreads && (ftp == efXTC || ftp == efTRR) && !bExec);
+            if (bIoThreads)
+            {
+                for (int b = 0; b < c_numReadAheadFrames + 1; b++)
+                {
+                    readBuffers.push_back(gmx::createTrxFrameBuffer(fr));
+                }
+                doneFrame = readBuffers[0];
+                readAhead = std::make_unique<gmx::TrxFrameReadAhead>(
+                        oenv, trxin, std::vector<t_trxframe*>(readBuffers.begin() + 1, readBuffers.end()),
+                        gmx::TrxFrameReadAhead::FrameProcessor(), atomMask);
+            }
+
             /* Start the big loop over frames */
             file_nr  = 0;
             frame    = 0;
@@ -1334,11 +1447,20 @@ int gmx_trjconv(int argc, char* argv[])
                                 {
                                     if (trxout)
                                     {
+                                        asyncWriter.reset();
                                         close_trx(trxout);
                                     }
                                     trxout = open_trx(out_file2, filemode);
                                 }
-                                write_trxframe(trxout, &frout, gc);
+                                if (bAsyncWrite && (ftp == efTRR || frout.bX))
+                                {
+                                    writeTrxFrameAsync(&asyncWriter, &asyncWriterPrecision,
+                                                       trxout, ftp, frout);
+                                }
+                                else
+                                {
+                                    write_trxframe(trxout, &frout, gc);
+                                }
                                 break;
                             case efGRO:
                             case efG96:
@@ -1445,8 +1567,30 @@ int gmx_trjconv(int argc, char* argv[])
                     }
                 }
                 frame++;
-                bHaveNextFrame = read_next_frame(oenv, trxin, &fr);
+                if (readAhead)
+                {
+                    t_trxframe* nextFrame = readAhead->nextFrame(doneFrame);
+                    bHaveNextFrame        = (nextFrame != nullptr);
+                    if (bHaveNextFrame)
+                    {
+                        std::swap(fr, *nextFrame);
+                        doneFrame = nextFrame;
+                    }
+                }
+                else
+                {
+                    bHaveNextFrame = read_next_frame(oenv, trxin, &fr, atomMask);
+                }
             } while (!(bTDump && bDumpFrame) && bHaveNextFrame);
+
+            /* Stop the reader before closing the input, and write all
+             * pending frames before closing the output */
+            readAhead.reset();
+            for (t_trxframe* buffer : readBuffers)
+            {
+                gmx::freeTrxFrameBuffer(buffer);
+            }
+            asyncWriter.reset();
         }
 
         if (!bHaveFirstFrame || (bTDump && !bDumpFrame))
@@ -1488,6 +1632,7 @@ int gmx_trjconv(int argc, char* argv[])
     sfree(grpnm);
     sfree(index);
     sfree(cindex);
+    sfree(bAtomUsed);
     done_frame(&fr);
 
     do_view(oenv, out_file, nullptr);
@@ -2085,6 +2085,10 @@ int gmx_tune_pme(int argc, char* argv[])
         "part of the Ewald sum. ",
         "Simply pass your [REF].tpr[ref] file to [THISMODULE] together with other options",
         "for [gmx-mdrun] as needed.[PAR]",
+        "Within a single run, [TT]gmx mdrun -tunepme -tunenstlist[tt] tunes the cut-off,",
+        "PME grid and [TT]nstlist[tt] without starting new processes, and with",
+        "separate PME ranks it reports a number of PME ranks for the next run.",
+        "[THISMODULE] is still needed to time different domain decompositions.[PAR]",
         "[THISMODULE] needs to call [gmx-mdrun] and so requires that you",
         "specify how to call mdrun with the argument to the [TT]-mdrun[tt]",
         "parameter. Depending how you have built GROMACS, values such as",
@@ -128,6 +128,18 @@ public:
          * \see setRmPBC()
          */
         efNoUserRmPBC = 1 << 5,
+        /*! \brief
+         * Declares that the module only accesses coordinates through
+         * its selections.
+         *
+         * If this flag is specified, the coordinates of atoms that are
+         * not needed for evaluating the selections (or for making their
+         * molecules whole) may not be read from the trajectory, and
+         * the corresponding values in the frame passed to
+         * TrajectoryAnalysisModule::analyzeFrame() are then undefined.
+         * For XTC input, this avoids decoding those coordinates.
+         */
+        efUseSelectedAtomsOnly = 1 << 6,
     };
 
     //! Initializes default settings.
@@ -124,6 +124,10 @@ int RunnerModule::run()
     // Load first frame.
     common_.initFirstFrame();
     common_.initFrameIndexGroup();
+    if (settings_.hasFlag(TrajectoryAnalysisSettings::efUseSelectedAtomsOnly))
+    {
+        common_.setRequiredAtoms(selections_.requiredAtoms());
+    }
     module_->initAfterFirstFrame(settings_, common_.frame());
 
     t_pbc  pbc;
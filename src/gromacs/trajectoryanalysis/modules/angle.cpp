@@ -379,6 +379,7 @@ void Angle::initOptions(IOptionsContainer* options, TrajectoryAnalysisSettings*
     };
 
     settings->setHelpText(desc);
+    settings->setFlag(TrajectoryAnalysisSettings::efUseSelectedAtomsOnly);
 
     options->addOption(FileNameOption("oav")
                                .filetype(eftPlot)
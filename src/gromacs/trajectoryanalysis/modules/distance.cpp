@@ -156,6 +156,7 @@ void Distance::initOptions(IOptionsContainer* options, TrajectoryAnalysisSetting
     };
 
     settings->setHelpText(desc);
+    settings->setFlag(TrajectoryAnalysisSettings::efUseSelectedAtomsOnly);
 
     options->addOption(FileNameOption("oav")
                                .filetype(eftPlot)
@@ -200,7 +200,8 @@ void FreeVolume::initOptions(IOptionsContainer* options, TrajectoryAnalysisSetti
             "Number of probe insertions per cubic nm to try for each frame in the trajectory."));
 
     // Control input settings
-    settings->setFlags(TrajectoryAnalysisSettings::efRequireTop | TrajectoryAnalysisSettings::efNoUserPBC);
+    settings->setFlags(TrajectoryAnalysisSettings::efRequireTop | TrajectoryAnalysisSettings::efNoUserPBC
+                       | TrajectoryAnalysisSettings::efUseSelectedAtomsOnly);
     settings->setPBC(true);
 }
 
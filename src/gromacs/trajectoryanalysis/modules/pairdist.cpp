@@ -218,6 +218,7 @@ void PairDistance::initOptions(IOptionsContainer* options, TrajectoryAnalysisSet
     };
 
     settings->setHelpText(desc);
+    settings->setFlag(TrajectoryAnalysisSettings::efUseSelectedAtomsOnly);
 
     options->addOption(FileNameOption("o")
                                .filetype(eftPlot)
@@ -284,6 +284,7 @@ void Rdf::initOptions(IOptionsContainer* options, TrajectoryAnalysisSettings* se
     };
 
     settings->setHelpText(desc);
+    settings->setFlag(TrajectoryAnalysisSettings::efUseSelectedAtomsOnly);
 
     options->addOption(FileNameOption("o")
                                .filetype(eftPlot)
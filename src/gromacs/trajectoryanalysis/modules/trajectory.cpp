@@ -118,6 +118,7 @@ void Trajectory::initOptions(IOptionsContainer* options, TrajectoryAnalysisSetti
     };
 
     settings->setHelpText(desc);
+    settings->setFlag(TrajectoryAnalysisSettings::efUseSelectedAtomsOnly);
 
     options->addOption(FileNameOption("ox")
                                .filetype(eftPlot)
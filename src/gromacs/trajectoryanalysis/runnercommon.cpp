@@ -47,11 +47,14 @@
 #include <cstring>
 
 #include <algorithm>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "gromacs/fileio/oenv.h"
 #include "gromacs/fileio/timecontrol.h"
 #include "gromacs/fileio/trxio.h"
+#include "gromacs/fileio/trxreadahead.h"
 #include "gromacs/math/vec.h"
 #include "gromacs/options/basicoptions.h"
 #include "gromacs/options/filenameoption.h"
@@ -61,6 +64,8 @@
 #include "gromacs/selection/selectioncollection.h"
 #include "gromacs/selection/selectionoption.h"
 #include "gromacs/selection/selectionoptionbehavior.h"
+#include "gromacs/topology/block.h"
+#include "gromacs/topology/mtop_util.h"
 #include "gromacs/topology/topology.h"
 #include "gromacs/trajectory/trajectoryframe.h"
 #include "gromacs/trajectoryanalysis/analysissettings.h"
@@ -77,6 +82,31 @@
 namespace gmx
 {
 
+namespace
+{
+
+/*! \brief
+ * Frees a frame allocated by the runner.
+ *
+ * \param[in] fr         Frame to free.
+ * \param[in] freeIndex  Whether to free \p fr->index as well; the index
+ *     array is shared between all frame buffers of the runner.
+ */
+void freeRunnerFrame(t_trxframe* fr, bool freeIndex)
+{
+    // There doesn't seem to be a function for freeing frame data
+    sfree(fr->x);
+    sfree(fr->v);
+    sfree(fr->f);
+    if (freeIndex)
+    {
+        sfree(fr->index);
+    }
+    sfree(fr);
+}
+
+} // namespace
+
 class TrajectoryAnalysisRunnerCommon::Impl : public ITopologyProvider
 {
 public:
@@ -88,6 +118,8 @@ public:
     void initTopology(bool required);
     void initFirstFrame();
     void initFrameIndexGroup();
+    void setRequiredAtoms(ArrayRef<const int> atoms);
+    void startReadAhead();
     void finishTrajectory();
 
     // From ITopologyProvider
@@ -127,6 +159,8 @@ public:
     bool        bStartTimeSet_;
     bool        bEndTimeSet_;
     bool        bDeltaTimeSet_;
+    //! Number of frames to read ahead in a separate thread (0: none).
+    int numReadAheadFrames_;
 
     bool bTrajOpen_;
     //! The current frame, or \p NULL if no frame loaded yet.
@@ -135,6 +169,19 @@ public:
     //! Used to store the status variable from read_first_frame().
     t_trxstatus*      status_;
     gmx_output_env_t* oenv_;
+    /*! \brief
+     * Atoms whose coordinates are read from the trajectory.
+     *
+     * Empty if all atoms are read, otherwise atoms beyond its size are
+     * not needed.
+     */
+    ArrayRef<const gmx_bool> atomMask_;
+    //! Storage for atomMask_.
+    std::unique_ptr<gmx_bool[]> atomMaskStorage_;
+    //! Spare frame buffers used for reading ahead.
+    std::vector<t_trxframe*> frameBuffers_;
+    //! Background reader, or \p NULL if frames are read serially.
+    std::unique_ptr<TrxFrameReadAhead> readAhead_;
 };
 
 
@@ -146,6 +193,7 @@ TrajectoryAnalysisRunnerCommon::Impl::Impl(TrajectoryAnalysisSettings* settings)
     bStartTimeSet_(false),
     bEndTimeSet_(false),
     bDeltaTimeSet_(false),
+    numReadAheadFrames_(0),
     bTrajOpen_(false),
     fr(nullptr),
     gpbc_(nullptr),
@@ -158,14 +206,16 @@ TrajectoryAnalysisRunnerCommon::Impl::Impl(TrajectoryAnalysisSettings* settings)
 TrajectoryAnalysisRunnerCommon::Impl::~Impl()
 {
     finishTrajectory();
+    for (t_trxframe* buffer : frameBuffers_)
+    {
+        if (buffer != fr)
+        {
+            freeRunnerFrame(buffer, false);
+        }
+    }
     if (fr != nullptr)
     {
-        // There doesn't seem to be a function for freeing frame data
-        sfree(fr->x);
-        sfree(fr->v);
-        sfree(fr->f);
-        sfree(fr->index);
-        sfree(fr);
+        freeRunnerFrame(fr, true);
     }
     if (oenv_ != nullptr)
     {
@@ -288,8 +338,77 @@ void TrajectoryAnalysisRunnerCommon::Impl::initFrameIndexGroup()
     std::copy(trajectoryGroup_.atomIndices().begin(), trajectoryGroup_.atomIndices().end(), fr->index);
 }
 
+void TrajectoryAnalysisRunnerCommon::Impl::setRequiredAtoms(ArrayRef<const int> atoms)
+{
+    // The mask is indexed by the atoms in the file, so it would need to
+    // be mapped through the trajectory group.
+    if (!bTrajOpen_ || trajectoryGroup_.isValid())
+    {
+        return;
+    }
+    std::vector<bool> mask;
+    for (const int atom : atoms)
+    {
+        if (atom >= static_cast<int>(mask.size()))
+        {
+            mask.resize(atom + 1, false);
+        }
+        mask[atom] = true;
+    }
+    if (gpbc_ != nullptr)
+    {
+        // Making a molecule whole uses the coordinates of all its atoms.
+        const RangePartitioning molecules = gmx_mtop_molecules(*topInfo_.mtop());
+        for (int mol = 0; mol < molecules.numBlocks(); mol++)
+        {
+            const int begin = *molecules.block(mol).begin();
+            const int end   = *molecules.block(mol).end();
+            if (begin >= static_cast<int>(mask.size()))
+            {
+                break;
+            }
+            const int checkEnd = std::min(end, static_cast<int>(mask.size()));
+            if (std::find(mask.begin() + begin, mask.begin() + checkEnd, true) != mask.begin() + checkEnd)
+            {
+                mask.resize(std::max(static_cast<int>(mask.size()), end), false);
+                std::fill(mask.begin() + begin, mask.begin() + end, true);
+            }
+        }
+    }
+    if (mask.size() < static_cast<size_t>(fr->natoms) || std::find(mask.begin(), mask.end(), false) != mask.end())
+    {
+        atomMaskStorage_ = std::make_unique<gmx_bool[]>(mask.size());
+        std::copy(mask.begin(), mask.end(), atomMaskStorage_.get());
+        atomMask_ = constArrayRefFromArray(atomMaskStorage_.get(), mask.size());
+    }
+}
+
+void TrajectoryAnalysisRunnerCommon::Impl::startReadAhead()
+{
+    GMX_RELEASE_ASSERT(bTrajOpen_, "Reading ahead only makes sense with a real trajectory");
+    // The reader thread writes into all buffers except the one being
+    // analyzed, so one buffer per frame read ahead is needed in addition
+    // to the current frame.
+    frameBuffers_.push_back(fr);
+    for (int i = 0; i < numReadAheadFrames_; ++i)
+    {
+        frameBuffers_.push_back(createTrxFrameBuffer(*fr));
+    }
+    std::vector<t_trxframe*> spareBuffers(frameBuffers_.begin() + 1, frameBuffers_.end());
+    TrxFrameReadAhead::FrameProcessor makeWhole;
+    if (gpbc_ != nullptr)
+    {
+        gmx_rmpbc_t gpbc = gpbc_;
+        makeWhole        = [gpbc](t_trxframe* frame) { gmx_rmpbc_trxfr(gpbc, frame); };
+    }
+    readAhead_ = std::make_unique<TrxFrameReadAhead>(oenv_, status_, spareBuffers, makeWhole, atomMask_);
+}
+
 void TrajectoryAnalysisRunnerCommon::Impl::finishTrajectory()
 {
+    // The reader thread needs to be stopped before the trajectory it reads
+    // from is closed.
+    readAhead_.reset();
     if (bTrajOpen_)
     {
         close_trx(status_);
@@ -384,6 +503,12 @@ void TrajectoryAnalysisRunnerCommon::initOptions(IOptionsContainer* options, Tim
                         .store(&settings.impl_->bPBC)
                         .description("Use periodic boundary conditions for distance calculation"));
     }
+
+    options->addOption(IntegerOption("readahead")
+                               .store(&impl_->numReadAheadFrames_)
+                               .description("Number of frames to read (and make whole) in a "
+                                            "separate thread ahead of the analysis (0: read "
+                                            "frames serially)"));
 }
 
 
@@ -400,6 +525,12 @@ void TrajectoryAnalysisRunnerCommon::optionsFinished()
                 InconsistentInputError("-fgroup only makes sense together with a trajectory (-f)"));
     }
 
+    if (impl_->numReadAheadFrames_ < 0)
+    {
+        GMX_THROW(InvalidInputError(
+                "Number of frames to read ahead (-readahead) must not be negative"));
+    }
+
     impl_->settings_.impl_->plotSettings.setTimeUnit(impl_->settings_.timeUnit());
 
     if (impl_->bStartTimeSet_)
@@ -436,12 +567,27 @@ void TrajectoryAnalysisRunnerCommon::initFrameIndexGroup()
 }
 
 
+void TrajectoryAnalysisRunnerCommon::setRequiredAtoms(ArrayRef<const int> atoms)
+{
+    impl_->setRequiredAtoms(atoms);
+}
+
+
 bool TrajectoryAnalysisRunnerCommon::readNextFrame()
 {
     bool bContinue = false;
-    if (hasTrajectory())
+    if (impl_->readAhead_ != nullptr)
     {
-        bContinue = read_next_frame(impl_->oenv_, impl_->status_, impl_->fr);
+        t_trxframe* frame = impl_->readAhead_->nextFrame(impl_->fr);
+        if (frame != nullptr)
+        {
+            impl_->fr = frame;
+            bContinue = true;
+        }
+    }
+    else if (hasTrajectory())
+    {
+        bContinue = read_next_frame(impl_->oenv_, impl_->status_, impl_->fr, impl_->atomMask_);
     }
     if (!bContinue)
     {
@@ -453,10 +599,21 @@ bool TrajectoryAnalysisRunnerCommon::readNextFrame()
 
 void TrajectoryAnalysisRunnerCommon::initFrame()
 {
+    // Frames from the reader thread have already been made whole.
+    if (impl_->readAhead_ != nullptr)
+    {
+        return;
+    }
     if (impl_->gpbc_ != nullptr)
     {
         gmx_rmpbc_trxfr(impl_->gpbc_, impl_->fr);
     }
+    // Start reading ahead only after the first frame has been fully
+    // initialized, as the buffers are created as copies of it.
+    if (impl_->numReadAheadFrames_ > 0 && impl_->bTrajOpen_ && impl_->frameBuffers_.empty())
+    {
+        impl_->startReadAhead();
+    }
 }
 
 
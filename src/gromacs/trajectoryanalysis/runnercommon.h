@@ -43,6 +43,7 @@
 #ifndef GMX_TRAJECTORYANALYSIS_RUNNERCOMMON_H
 #define GMX_TRAJECTORYANALYSIS_RUNNERCOMMON_H
 
+#include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/classhelpers.h"
 
 struct t_trxframe;
@@ -104,18 +105,37 @@ public:
      * Can be called after selections have been compiled.
      */
     void initFrameIndexGroup();
+    /*! \brief
+     * Sets the atoms whose coordinates need to be read from the trajectory.
+     *
+     * \param[in] atoms  Indices of the needed atoms.
+     *
+     * Coordinates of other atoms may then not be read for subsequent
+     * frames (for XTC input, they are not decoded).  If molecules are
+     * made whole, all atoms in molecules with a needed atom are read.
+     * Has no effect if the trajectory only contains a subset of the
+     * atoms (`-fgroup`).
+     * Should be called after initFrameIndexGroup() and before the
+     * first call to initFrame().
+     */
+    void setRequiredAtoms(ArrayRef<const int> atoms);
     /*! \brief
      * Reads the next frame from the trajectory.
      *
      * \returns false if there were no more frames.
      *
      * After this call, frame() returns the newly loaded frame.
+     * If frames are read ahead in a separate thread (`-readahead`
+     * larger than zero), the new frame is in a different buffer, so references
+     * obtained from frame() earlier should not be used anymore.
      */
     bool readNextFrame();
     /*! \brief
      * Performs common initialization for the currently loaded frame.
      *
      * Currently, makes molecules whole if requested.
+     * After the first frame has been initialized, starts reading further
+     * frames in a separate thread if requested with `-readahead`.
      */
     void initFrame();
 
@@ -54,6 +54,7 @@
 #include "testutils/cmdlinetest.h"
 #include "testutils/refdata.h"
 #include "testutils/testasserts.h"
+#include "testutils/testfilemanager.h"
 #include "testutils/textblockmatchers.h"
 #include "testutils/xvgtest.h"
 
@@ -80,6 +81,16 @@ public:
         setOutputFile("-ac", ".xvg", toler);
         setOutputFile("-hc", ".xvg", toler);
         setInputFile("-f", "clustsize.pdb");
+        // Write the outputs that are not checked to the temporary directory
+        commandLine().addOption("-temp", fileManager().getTemporaryFilePath("temp.xvg"));
+        commandLine().addOption("-mcn", fileManager().getTemporaryFilePath("maxclust.ndx"));
+    }
+
+    //! Writes the cluster size matrices to the temporary directory without checking them
+    void setMatrixOutputsUnchecked()
+    {
+        commandLine().addOption("-o", fileManager().getTemporaryFilePath("csize.xpm"));
+        commandLine().addOption("-ow", fileManager().getTemporaryFilePath("csizew.xpm"));
     }
 
     void runTest(const CommandLine& args)
@@ -103,6 +114,8 @@ TEST_F(ClustsizeTest, NoMolDefaultCutoff)
 
     setInputFile("-n", "clustsize.ndx");
 
+    setMatrixOutputsUnchecked();
+
     runTest(args);
 }
 
@@ -113,6 +126,8 @@ TEST_F(ClustsizeTest, NoMolShortCutoff)
 
     setInputFile("-n", "clustsize.ndx");
 
+    setMatrixOutputsUnchecked();
+
     runTest(args);
 }
 
@@ -123,6 +138,8 @@ TEST_F(ClustsizeTest, MolDefaultCutoff)
 
     setInputFile("-s", "clustsize.tpr");
 
+    setMatrixOutputsUnchecked();
+
     runTest(args);
 }
 
@@ -133,6 +150,8 @@ TEST_F(ClustsizeTest, MolShortCutoff)
 
     setInputFile("-s", "clustsize.tpr");
 
+    setMatrixOutputsUnchecked();
+
     runTest(args);
 }
 
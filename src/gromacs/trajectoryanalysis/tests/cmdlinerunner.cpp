@@ -48,6 +48,7 @@
 
 #include "gromacs/commandline/cmdlinemodule.h"
 #include "gromacs/commandline/cmdlineoptionsmodule.h"
+#include "gromacs/math/vectypes.h"
 #include "gromacs/options/basicoptions.h"
 #include "gromacs/options/ioptionscontainer.h"
 #include "gromacs/trajectory/trajectoryframe.h"
@@ -135,6 +136,26 @@ TEST_F(TrajectoryAnalysisCommandLineRunnerTest, RunsWithSubsetTrajectory)
     EXPECT_NO_THROW_GMX(runTest(CommandLine(cmdline)));
 }
 
+TEST_F(TrajectoryAnalysisCommandLineRunnerTest, RunsWithReadAheadThread)
+{
+    const char* const cmdline[] = { "-fgroup", "atomnr 4 5 6 10 to 14", "-readahead", "1" };
+
+    using ::testing::_;
+    using ::testing::Truly;
+    auto isFirstFrame  = [](const t_trxframe& fr) { return fr.x[0][YY] == 4.0; };
+    auto isSecondFrame = [](const t_trxframe& fr) { return fr.x[0][YY] == 2.0; };
+    EXPECT_CALL(*mockModule_, initOptions(_, _));
+    EXPECT_CALL(*mockModule_, initAnalysis(_, _));
+    EXPECT_CALL(*mockModule_, analyzeFrame(0, Truly(isFirstFrame), _, _));
+    EXPECT_CALL(*mockModule_, analyzeFrame(1, Truly(isSecondFrame), _, _));
+    EXPECT_CALL(*mockModule_, finishAnalysis(2));
+    EXPECT_CALL(*mockModule_, writeOutput());
+
+    setInputFile("-s", "simple.gro");
+    setInputFile("-f", "simple-subset.gro");
+    EXPECT_NO_THROW_GMX(runTest(CommandLine(cmdline)));
+}
+
 TEST_F(TrajectoryAnalysisCommandLineRunnerTest, DetectsIncorrectTrajectorySubset)
 {
     const char* const cmdline[] = { "-fgroup", "atomnr 3 to 6 10 to 14" };
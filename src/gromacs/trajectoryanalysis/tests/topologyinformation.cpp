@@ -212,6 +212,7 @@ TEST(TopologyInformation, WorksWithTprFromPdbFile)
         caller.addOption("-p", TestFileManager::getInputFilePath(name));
         caller.addOption("-c", TestFileManager::getInputFilePath(name + ".pdb"));
         caller.addOption("-o", tprName);
+        caller.addOption("-po", fileManager.getTemporaryFilePath(name + "_mdout.mdp"));
         ASSERT_EQ(0, gmx_grompp(caller.argc(), caller.argv()));
     }
 
@@ -58,6 +58,7 @@
 #include "gromacs/gmxpreprocess/solvate.h"
 #include "gromacs/gmxpreprocess/x2top.h"
 #include "gromacs/tools/check.h"
+#include "gromacs/tools/colstore2xvg.h"
 #include "gromacs/tools/convert_tpr.h"
 #include "gromacs/tools/dump.h"
 #include "gromacs/tools/eneconv.h"
@@ -225,6 +226,9 @@ void registerLegacyModules(gmx::CommandLineModuleManager* manager)
                    "Order molecules according to their distance to a group");
     registerModule(manager, &gmx_xpm2ps, "xpm2ps",
                    "Convert XPM (XPixelMap) matrices to postscript or XPM");
+    gmx::ICommandLineOptionsModule::registerModuleFactory(manager, gmx::ColumnStoreToXvgInfo::name,
+                                                          gmx::ColumnStoreToXvgInfo::shortDescription,
+                                                          &gmx::ColumnStoreToXvgInfo::create);
 
     registerModule(manager, &gmx_anaeig, "anaeig", "Analyze eigenvectors/normal modes");
     registerModule(manager, &gmx_analyze, "analyze", "Analyze data sets");
@@ -360,6 +364,7 @@ void registerLegacyModules(gmx::CommandLineModuleManager* manager)
     }
     {
         gmx::CommandLineModuleGroup group = manager->addModuleGroup("Converting files");
+        group.addModule("colstore2xvg");
         group.addModule("editconf");
         group.addModule("eneconv");
         group.addModule("sigeps");
@@ -152,7 +152,17 @@ void NonbondedBenchmark::initOptions(IOptionsContainer* options, ICommandLineOpt
         "In the MD engine, any clusters where at most half of the atoms",
         "have LJ interactions will automatically use this kernel.",
         "And finally, the [TT]-energy[tt] option selects the computation",
-        "of energies, which are usually only needed infrequently."
+        "of energies, which are usually only needed infrequently.[PAR]",
+        "Instead of a box of water, the system can be read from a run",
+        "input file with [TT]-s[tt]. Only rectangular unit-cells are",
+        "supported and free-energy perturbations are ignored.",
+        "With [TT]-stages[tt], also the other parts of a step with",
+        "the non-bonded setup are timed for each kernel setup: putting atoms",
+        "on the grid together with pair search, dynamic pruning, and the",
+        "coordinate and force buffer operations. These are reported in",
+        "cycles per atom per iteration. With [TT]-json[tt], the results",
+        "are also written to a file in JSON format, which is convenient for",
+        "tracking performance across builds and hardware."
     };
 
     settings->setHelpText(desc);
@@ -208,6 +218,20 @@ void NonbondedBenchmark::initOptions(IOptionsContainer* options, ICommandLineOpt
     options->addOption(BooleanOption("cycles")
                                .store(&benchmarkOptions_.cyclesPerPair)
                                .description("Report cycles/pair instead of pairs/cycle"));
+    options->addOption(BooleanOption("stages")
+                               .store(&benchmarkOptions_.benchmarkStages)
+                               .description("Also benchmark search, pruning and buffer operations"));
+    options->addOption(FileNameOption("s")
+                               .filetype(eftRunInput)
+                               .inputFile()
+                               .store(&benchmarkOptions_.tprFileName)
+                               .description("Run input file with the system, instead of water"));
+    options->addOption(FileNameOption("json")
+                               .filetype(eftGenericData)
+                               .outputFile()
+                               .store(&benchmarkOptions_.jsonFileName)
+                               .defaultBasename("nonbonded-bench")
+                               .description("Results in JSON format"));
 }
 
 void NonbondedBenchmark::optionsFinished()
@@ -0,0 +1,207 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests that computing the CPU non-bonded and bonded interactions
+ * as interleaved tasks gives the same results as the normal path
+ *
+ * \ingroup module_mdrun_integration_tests
+ */
+#include "gmxpre.h"
+
+#include <cstdlib>
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/topology/ifunc.h"
+#include "gromacs/utility/stringutil.h"
+
+#include "testutils/mpitest.h"
+#include "testutils/setenv.h"
+#include "testutils/simulationdatabase.h"
+
+#include "moduletest.h"
+#include "simulatorcomparison.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+/*! \brief Test fixture comparing mdrun with and without GMX_CPU_FORCE_TASKS
+ *
+ * The system has bonded interactions, virtual sites, position restraints
+ * on the water and non-bonded interactions. Both paths compute the forces
+ * for the same coordinates: a trajectory is generated once and then rerun,
+ * and a run of zero steps computes the forces for the input coordinates.
+ * Reruns do not write the virial, so the shift forces, which only enter
+ * the results through the virial, are checked with the zero-step run.
+ * The tasks accumulate the forces in a different order, so the results
+ * are compared within a tolerance.
+ */
+class CpuForceTasksTest : public MdrunTestFixture
+{
+public:
+    //! The names of the trajectory and energy files written by a run
+    struct OutputFileNames
+    {
+        //! The trajectory file
+        std::string trajectory;
+        //! The energy file
+        std::string energy;
+    };
+
+    /*! \brief Runs mdrun with \p options without and with GMX_CPU_FORCE_TASKS
+     *
+     * \returns the output file names of the run without and with the tasks
+     */
+    std::array<OutputFileNames, 2> runWithoutAndWithTasks(const std::vector<SimulationOptionTuple>& options,
+                                                          const std::string& name);
+};
+
+std::array<CpuForceTasksTest::OutputFileNames, 2>
+CpuForceTasksTest::runWithoutAndWithTasks(const std::vector<SimulationOptionTuple>& options,
+                                          const std::string&                        name)
+{
+    const char*       environmentVariable          = "GMX_CPU_FORCE_TASKS";
+    const char*       backup                       = getenv(environmentVariable);
+    const bool        haveBackup                   = (backup != nullptr);
+    const std::string environmentVariableBackup    = haveBackup ? backup : "";
+    const int         overWriteEnvironmentVariable = 1;
+
+    std::array<OutputFileNames, 2> outputFileNames;
+    for (int useTasks = 0; useTasks < 2; useTasks++)
+    {
+        const std::string baseName = name + (useTasks ? "_tasks" : "_normal");
+        outputFileNames[useTasks]  = { fileManager_.getTemporaryFilePath(baseName + ".trr"),
+                                      fileManager_.getTemporaryFilePath(baseName + ".edr") };
+        if (useTasks)
+        {
+            gmxSetenv(environmentVariable, "1", overWriteEnvironmentVariable);
+        }
+        else
+        {
+            gmxUnsetenv(environmentVariable);
+        }
+        runner_.fullPrecisionTrajectoryFileName_ = outputFileNames[useTasks].trajectory;
+        runner_.edrFileName_                     = outputFileNames[useTasks].energy;
+        runMdrun(&runner_, options);
+    }
+
+    // Restore the environment to leave further tests undisturbed
+    if (haveBackup)
+    {
+        gmxSetenv(environmentVariable, environmentVariableBackup.c_str(), overWriteEnvironmentVariable);
+    }
+    else
+    {
+        gmxUnsetenv(environmentVariable);
+    }
+
+    return outputFileNames;
+}
+
+TEST_F(CpuForceTasksTest, MatchesNormalForceComputation)
+{
+    const std::string simulationName = "alanine_vsite_solvated";
+
+    const int numRanksAvailable = getNumberOfTestMpiRanks();
+    if (!isNumberOfPpRanksSupported(simulationName, numRanksAvailable))
+    {
+        fprintf(stdout,
+                "Test system '%s' cannot run with %d ranks.\n"
+                "The supported numbers are: %s\n",
+                simulationName.c_str(), numRanksAvailable,
+                reportNumbersOfPpRanksSupported(simulationName).c_str());
+        return;
+    }
+
+    auto mdpFieldValues     = prepareMdpFieldValues(simulationName.c_str(), "md", "no", "no");
+    mdpFieldValues["other"] = "define = -DPOSRES_WATER";
+
+    const auto           energyTolerance = relativeToleranceAsPrecisionDependentUlp(10.0, 24, 40);
+    EnergyTermsToCompare energyTermsToCompare{ {
+            { interaction_function[F_EPOT].longname, energyTolerance },
+            { interaction_function[F_LJ].longname, energyTolerance },
+            { interaction_function[F_COUL_SR].longname, energyTolerance },
+            { interaction_function[F_PDIHS].longname, energyTolerance },
+            { interaction_function[F_POSRES].longname, energyTolerance },
+    } };
+    EnergyTermsToCompare energyAndVirialTermsToCompare = energyTermsToCompare;
+    for (const char* virialTerm : { "Vir-XX", "Vir-XY", "Vir-YY", "Vir-ZZ" })
+    {
+        energyAndVirialTermsToCompare.emplace(
+                virialTerm, relativeToleranceAsPrecisionDependentFloatingPoint(10.0, 0.001, 0.0001));
+    }
+
+    TrajectoryFrameMatchSettings trajectoryMatchSettings{ true,
+                                                          true,
+                                                          true,
+                                                          ComparisonConditions::MustCompare,
+                                                          ComparisonConditions::MustCompare,
+                                                          ComparisonConditions::MustCompare };
+    TrajectoryComparison trajectoryComparison{ trajectoryMatchSettings,
+                                               TrajectoryComparison::s_defaultTrajectoryTolerances };
+    // Velocities are not written in reruns
+    trajectoryMatchSettings.velocitiesComparison = ComparisonConditions::NoComparison;
+    TrajectoryComparison rerunTrajectoryComparison{ trajectoryMatchSettings,
+                                                    TrajectoryComparison::s_defaultTrajectoryTolerances };
+
+    runner_.useTopGroAndNdxFromDatabase(simulationName);
+    runner_.useStringAsMdpFile(prepareMdpFileContents(mdpFieldValues));
+    runGrompp(&runner_);
+
+    const auto firstStep = runWithoutAndWithTasks({ SimulationOptionTuple("-nsteps", "0") }, "firststep");
+    compareEnergies(firstStep[0].energy, firstStep[1].energy, energyAndVirialTermsToCompare);
+    compareTrajectories(firstStep[0].trajectory, firstStep[1].trajectory, trajectoryComparison);
+
+    runner_.fullPrecisionTrajectoryFileName_ = fileManager_.getTemporaryFilePath("reference.trr");
+    runner_.edrFileName_                     = fileManager_.getTemporaryFilePath("reference.edr");
+    runMdrun(&runner_);
+    const auto rerun = runWithoutAndWithTasks(
+            { SimulationOptionTuple("-rerun", runner_.fullPrecisionTrajectoryFileName_) }, "rerun");
+    compareEnergies(rerun[0].energy, rerun[1].energy, energyTermsToCompare);
+    compareTrajectories(rerun[0].trajectory, rerun[1].trajectory, rerunTrajectoryComparison);
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -0,0 +1,190 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests that the overlapped halo exchange of domain decomposition
+ * gives the same results as the blocking exchange
+ *
+ * \ingroup module_mdrun_integration_tests
+ */
+#include "gmxpre.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/topology/ifunc.h"
+#include "gromacs/utility/stringutil.h"
+
+#include "testutils/cmdlinetest.h"
+#include "testutils/mpitest.h"
+#include "testutils/setenv.h"
+#include "testutils/simulationdatabase.h"
+
+#include "moduletest.h"
+#include "simulatorcomparison.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+/*! \brief Test fixture comparing the overlapped and the blocking halo exchange
+ *
+ * With GMX_DD_OVERLAP_HALO set, the coordinates are communicated with
+ * dd_move_x_start() and dd_move_x_finish() on steps without pair search
+ * and dd_move_f() sends and receives the forces without blocking.
+ * The same data is communicated and the forces are summed in the same
+ * order, so the results should be identical to those with the blocking
+ * dd_move_x() and dd_move_f().
+ *
+ * The parameter is the domain decomposition grid. With the cut-off of
+ * the spc216 system, four cells along x need two pulses and a 2x2 grid
+ * decomposes along two dimensions. Grids that do not match the number
+ * of ranks of the test are skipped.
+ */
+class HaloExchangeTest : public MdrunTestFixture, public ::testing::WithParamInterface<std::string>
+{
+};
+
+TEST_P(HaloExchangeTest, OverlappedMatchesBlocking)
+{
+    const std::string              simulationName = "spc216";
+    const std::string              ddGrid         = GetParam();
+    const std::vector<std::string> numCells       = splitString(ddGrid);
+
+    int numDomains = 1;
+    for (const std::string& n : numCells)
+    {
+        numDomains *= std::stoi(n);
+    }
+    const int numRanksAvailable = getNumberOfTestMpiRanks();
+    if (numDomains != numRanksAvailable)
+    {
+        fprintf(stdout, "Domain decomposition grid '%s' needs %d ranks, the test runs with %d.\n",
+                ddGrid.c_str(), numDomains, numRanksAvailable);
+        return;
+    }
+
+    SCOPED_TRACE(formatString("Comparing the overlapped and blocking halo exchange of '%s' "
+                              "with domain decomposition grid '%s'",
+                              simulationName.c_str(), ddGrid.c_str()));
+
+    /* The default nstlist of 8 and output every 4 steps gives energies,
+     * coordinates and forces from steps with and without pair search.
+     */
+    auto mdpFieldValues = prepareMdpFieldValues(simulationName.c_str(), "md", "no", "no");
+
+    EnergyTermsToCompare energyTermsToCompare{ {
+            { interaction_function[F_EPOT].longname, relativeToleranceAsPrecisionDependentUlp(10.0, 24, 80) },
+            { interaction_function[F_EKIN].longname, relativeToleranceAsPrecisionDependentUlp(10.0, 24, 80) },
+            { interaction_function[F_PRES].longname,
+              relativeToleranceAsPrecisionDependentFloatingPoint(10.0, 0.001, 0.0001) },
+    } };
+
+    TrajectoryFrameMatchSettings trajectoryMatchSettings{ true,
+                                                          true,
+                                                          true,
+                                                          ComparisonConditions::MustCompare,
+                                                          ComparisonConditions::MustCompare,
+                                                          ComparisonConditions::MustCompare };
+    TrajectoryComparison trajectoryComparison{ trajectoryMatchSettings,
+                                               TrajectoryComparison::s_defaultTrajectoryTolerances };
+
+    const std::string blockingTrajectoryFileName   = fileManager_.getTemporaryFilePath("blocking.trr");
+    const std::string blockingEdrFileName          = fileManager_.getTemporaryFilePath("blocking.edr");
+    const std::string overlappedTrajectoryFileName = fileManager_.getTemporaryFilePath("overlapped.trr");
+    const std::string overlappedEdrFileName = fileManager_.getTemporaryFilePath("overlapped.edr");
+
+    runner_.useTopGroAndNdxFromDatabase(simulationName);
+    runner_.useStringAsMdpFile(prepareMdpFileContents(mdpFieldValues));
+    runGrompp(&runner_);
+
+    /* Fix the grid and turn off load balancing, so both runs use the same decomposition */
+    CommandLine mdrunCaller;
+    mdrunCaller.append("mdrun");
+    mdrunCaller.append("-dd");
+    for (const std::string& n : numCells)
+    {
+        mdrunCaller.append(n);
+    }
+    mdrunCaller.addOption("-dlb", "no");
+    mdrunCaller.addOption("-npme", 0);
+    mdrunCaller.addOption("-nb", "cpu");
+
+    const char* environmentVariable = "GMX_DD_OVERLAP_HALO";
+    const char* backup              = getenv(environmentVariable);
+    const bool  haveBackup          = (backup != nullptr);
+    const std::string environmentVariableBackup = haveBackup ? backup : "";
+    const int         overWriteEnvironmentVariable = 1;
+
+    gmxUnsetenv(environmentVariable);
+    runner_.fullPrecisionTrajectoryFileName_ = blockingTrajectoryFileName;
+    runner_.edrFileName_                     = blockingEdrFileName;
+    ASSERT_EQ(0, runner_.callMdrun(mdrunCaller));
+
+    gmxSetenv(environmentVariable, "1", overWriteEnvironmentVariable);
+    runner_.fullPrecisionTrajectoryFileName_ = overlappedTrajectoryFileName;
+    runner_.edrFileName_                     = overlappedEdrFileName;
+    const int overlappedExitCode             = runner_.callMdrun(mdrunCaller);
+
+    // Restore the environment to leave further tests undisturbed
+    if (haveBackup)
+    {
+        gmxSetenv(environmentVariable, environmentVariableBackup.c_str(), overWriteEnvironmentVariable);
+    }
+    else
+    {
+        gmxUnsetenv(environmentVariable);
+    }
+    ASSERT_EQ(0, overlappedExitCode);
+
+    compareEnergies(blockingEdrFileName, overlappedEdrFileName, energyTermsToCompare);
+    compareTrajectories(blockingTrajectoryFileName, overlappedTrajectoryFileName, trajectoryComparison);
+}
+
+INSTANTIATE_TEST_CASE_P(HaloExchangeIsEquivalent,
+                        HaloExchangeTest,
+                        ::testing::Values("2 1 1", "4 1 1", "2 2 1"));
+
+} // namespace
+} // namespace test
+} // namespace gmx
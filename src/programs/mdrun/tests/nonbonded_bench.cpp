@@ -48,6 +48,7 @@
 
 #include "testutils/refdata.h"
 #include "testutils/testasserts.h"
+#include "testutils/testfilemanager.h"
 
 #include "moduletest.h"
 
@@ -67,6 +68,28 @@ TEST(NonbondedBenchTest, BasicEndToEndTest)
                          &gmx::NonbondedBenchmarkInfo::create, &cmdline));
 }
 
+TEST(NonbondedBenchTest, StagesWithJsonOutputTest)
+{
+    TestFileManager   fileManager;
+    const std::string jsonFileName = fileManager.getTemporaryFilePath("bench.dat");
+
+    const char* const command[] = { "nonbonded-benchmark" };
+    CommandLine       cmdline(command);
+    cmdline.addOption("-iter", 1);
+    cmdline.append("-stages");
+    cmdline.addOption("-json", jsonFileName);
+    ASSERT_EQ(0, gmx::test::CommandLineTestHelper::runModuleFactory(
+                         &gmx::NonbondedBenchmarkInfo::create, &cmdline));
+
+    const std::string json = TextReader::readFileToString(jsonFileName);
+    EXPECT_TRUE(startsWith(json, "{"));
+    for (const char* stage : { "\"kernel\"", "\"search\"", "\"prune\"", "\"xBufferOps\"",
+                               "\"fBufferOps\"" })
+    {
+        EXPECT_TRUE(contains(json, stage)) << "The JSON output should contain " << stage;
+    }
+}
+
 } // namespace
 } // namespace test
 } // namespace gmx
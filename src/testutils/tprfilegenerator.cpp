@@ -66,6 +66,7 @@ TprAndFileManager::TprAndFileManager(const std::string& name)
         caller.addOption("-p", TestFileManager::getInputFilePath(name + ".top"));
         caller.addOption("-c", TestFileManager::getInputFilePath(name + ".pdb"));
         caller.addOption("-o", tprFileName_);
+        caller.addOption("-po", fileManager_.getTemporaryFilePath(name + "_mdout.mdp"));
         EXPECT_EQ(0, gmx_grompp(caller.argc(), caller.argv()));
     }
 }